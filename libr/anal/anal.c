@@ -96,6 +96,7 @@ R_API RAnal *r_anal_new(void) {
 	r_event_hook (anal->zign_spaces.event, R_SPACE_EVENT_RENAME, zign_rename_for, NULL);
 	anal->sdb_fcns = sdb_ns (anal->sdb, "fcns", 1);
 	anal->sdb_meta = sdb_ns (anal->sdb, "meta", 1);
+	r_interval_tree_init (&anal->meta, r_meta_item_free);
 	r_anal_hint_storage_init (anal);
 	anal->sdb_types = sdb_ns (anal->sdb, "types", 1);
 	anal->sdb_fmts = sdb_ns (anal->sdb, "spec", 1);
@@ -127,6 +128,7 @@ R_API RAnal *r_anal_new(void) {
 		}
 	}
 	anal->cmdtail = r_strbuf_new (NULL);
+	r_anal_read_cache_setup (anal, R_ANAL_READ_CACHE_SLOTS, R_ANAL_READ_CACHE_BSIZE);
 	return anal;
 }
 
@@ -138,6 +140,16 @@ R_API void r_anal_plugin_free (RAnalPlugin *p) {
 
 void __block_free_rb(RBNode *node, void *user);
 
+static void plugin_data_use(RAnal *anal, RAnalPlugin *h) {
+	if (anal->cur == h && (anal->plugin_data || !h || !h->data_new)) {
+		return;
+	}
+	if (anal->cur && anal->cur->data_free) {
+		anal->cur->data_free (anal->plugin_data);
+	}
+	anal->plugin_data = (h && h->data_new)? h->data_new (anal): NULL;
+}
+
 R_API RAnal *r_anal_free(RAnal *a) {
 	if (!a) {
 		return NULL;
@@ -151,17 +163,19 @@ R_API RAnal *r_anal_free(RAnal *a) {
 	free (a->cpu);
 	free (a->os);
 	free (a->zign_path);
+	free (a->esil_trace_spill);
+	plugin_data_use (a, NULL);
 	r_list_free (a->plugins);
 	r_rbtree_free (a->bb_tree, __block_free_rb, NULL);
 	r_spaces_fini (&a->meta_spaces);
+	r_interval_tree_fini (&a->meta);
 	r_spaces_fini (&a->zign_spaces);
 	r_anal_pin_fini (a);
 	r_list_free (a->refs);
 	r_syscall_free (a->syscall);
 	r_reg_free (a->reg);
 	r_anal_op_free (a->queued);
-	ht_up_free (a->dict_refs);
-	ht_up_free (a->dict_xrefs);
+	r_anal_xrefs_fini (a);
 	r_list_free (a->leaddrs);
 	sdb_free (a->sdb);
 	if (a->esil) {
@@ -171,6 +185,7 @@ R_API RAnal *r_anal_free(RAnal *a) {
 	free (a->last_disasm_reg);
 	r_strbuf_free (a->cmdtail);
 	r_str_constpool_fini (&a->constpool);
+	r_anal_read_cache_fini (a);
 	free (a);
 	return NULL;
 }
@@ -203,6 +218,7 @@ R_API bool r_anal_use(RAnal *anal, const char *name) {
 				return true;
 			}
 #endif
+			plugin_data_use (anal, h);
 			anal->cur = h;
 			r_anal_set_reg_profile (anal);
 			if (change) {
@@ -431,6 +447,8 @@ R_API bool r_anal_op_is_eob(RAnalOp *op) {
 R_API int r_anal_purge (RAnal *anal) {
 	sdb_reset (anal->sdb_fcns);
 	sdb_reset (anal->sdb_meta);
+	r_interval_tree_fini (&anal->meta);
+	r_interval_tree_init (&anal->meta, r_meta_item_free);
 	r_anal_hint_clear (anal);
 	sdb_reset (anal->sdb_types);
 	sdb_reset (anal->sdb_zigns);
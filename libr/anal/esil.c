@@ -72,6 +72,83 @@ static bool popRN(RAnalEsil *esil, ut64 *n) {
 	return false;
 }
 
+#define ESIL_CODE_LIMIT 4096
+
+enum {
+	ESIL_WORD_STR,
+	ESIL_WORD_SLOT, // number or register, pushed typed
+	ESIL_WORD_OP,
+	ESIL_WORD_ELSE,
+	ESIL_WORD_ENDIF,
+};
+
+typedef struct {
+	int type;
+	const char *str;
+	RAnalEsilOp *op;
+	RAnalEsilSlot slot;
+} EsilWord;
+
+// An expression split in words once, with its ops and registers resolved,
+// so running it again doesn't tokenize, hash or format anything. The code
+// is only valid for the ops and register profile it was compiled with.
+typedef struct {
+	char *expr;
+	char *buf; // the words, nul separated
+	EsilWord *words;
+	int count;
+	RReg *reg;
+	ut32 reg_rev;
+	ut32 ops_rev;
+	bool transient;
+} EsilCode;
+
+static void esil_code_free(EsilCode *code) {
+	if (code) {
+		free (code->words);
+		free (code->buf);
+		free (code->expr);
+		free (code);
+	}
+}
+
+static void esil_code_free_kv(HtUPKv *kv) {
+	esil_code_free (kv->value);
+}
+
+static RRegItem *esil_slot_item(RAnalEsil *esil, const RAnalEsilSlot *slot) {
+	RReg *reg = esil->anal? esil->anal->reg: NULL;
+	return (slot->item && slot->reg == reg && slot->rev == reg->rev)? slot->item: NULL;
+}
+
+// the word the slot was pushed from, or the number formatted like pushnum does
+static const char *esil_slot_str(const RAnalEsilSlot *slot, char *buf, size_t size) {
+	if (slot->str) {
+		return slot->str;
+	}
+	snprintf (buf, size, "0x%" PFMT64x, slot->num);
+	return buf;
+}
+
+static bool esil_push_slot(RAnalEsil *esil, const RAnalEsilSlot *slot) {
+	if (esil->stackptr > (esil->stacksize - 1)) {
+		return false;
+	}
+	esil->stack[esil->stackptr] = NULL;
+	esil->slots[esil->stackptr++] = *slot;
+	return true;
+}
+
+// copies the words of the typed slots before the code owning them is freed
+static void esil_stack_own(RAnalEsil *esil) {
+	int i;
+	for (i = 0; i < esil->stackptr; i++) {
+		if (!esil->stack[i] && esil->slots[i].str) {
+			esil->stack[i] = strdup (esil->slots[i].str);
+		}
+	}
+}
+
 /* R_ANAL_ESIL API */
 
 R_API RAnalEsil *r_anal_esil_new(int stacksize, int iotrap, unsigned int addrsize) {
@@ -87,6 +164,15 @@ R_API RAnalEsil *r_anal_esil_new(int stacksize, int iotrap, unsigned int addrsiz
 		free (esil);
 		return NULL;
 	}
+	esil->slots = R_NEWS0 (RAnalEsilSlot, stacksize);
+	esil->code = ht_up_new (NULL, esil_code_free_kv, NULL);
+	if (!esil->slots || !esil->code) {
+		ht_up_free (esil->code);
+		free (esil->slots);
+		free (esil->stack);
+		free (esil);
+		return NULL;
+	}
 	esil->verbose = false;
 	esil->stacksize = stacksize;
 	esil->parse_goto_count = R_ANAL_ESIL_GOTO_LIMIT;
@@ -121,6 +207,7 @@ R_API bool r_anal_esil_set_op(RAnalEsil *esil, const char *op, RAnalEsilOpCb cod
 	eop->pop = pop;
 	eop->type = type;
 	eop->code = code;
+	esil->ops_rev++;
 	return true;
 }
 
@@ -175,10 +262,12 @@ R_API void r_anal_esil_free(RAnalEsil *esil) {
 	r_anal_esil_sources_fini (esil);
 	sdb_free (esil->stats);
 	esil->stats = NULL;
-	sdb_free (esil->db_trace);
-	esil->db_trace = NULL;
+	r_anal_esil_trace_free (esil->trace);
+	esil->trace = NULL;
 	r_anal_esil_stack_free (esil);
 	free (esil->stack);
+	free (esil->slots);
+	ht_up_free (esil->code);
 	if (esil->anal && esil->anal->cur && esil->anal->cur->esil_fini) {
 		esil->anal->cur->esil_fini (esil);
 	}
@@ -426,9 +515,11 @@ static int internal_esil_reg_write_no_null (RAnalEsil *esil, const char *regname
 }
 
 R_API bool r_anal_esil_pushnum(RAnalEsil *esil, ut64 num) {
-	char str[64];
-	snprintf (str, sizeof (str) - 1, "0x%" PFMT64x, num);
-	return r_anal_esil_push (esil, str);
+	if (!esil) {
+		return false;
+	}
+	RAnalEsilSlot slot = { .num = num };
+	return esil_push_slot (esil, &slot);
 }
 
 R_API bool r_anal_esil_push(RAnalEsil *esil, const char *str) {
@@ -444,7 +535,12 @@ R_API char *r_anal_esil_pop(RAnalEsil *esil) {
 	if (esil->stackptr < 1) {
 		return NULL;
 	}
-	return esil->stack[--esil->stackptr];
+	char *str = esil->stack[--esil->stackptr];
+	if (!str) {
+		char buf[32];
+		str = strdup (esil_slot_str (&esil->slots[esil->stackptr], buf, sizeof (buf)));
+	}
+	return str;
 }
 
 R_API int r_anal_esil_get_parm_type(RAnalEsil *esil, const char *str) {
@@ -549,28 +645,181 @@ R_API int r_anal_esil_reg_read(RAnalEsil *esil, const char *regname, ut64 *num,
 	return ret;
 }
 
+// A popped element. Typed slots are kept as they are, so the handlers
+// below read numbers and resolved registers without the string round trip
+// and fall back to the string api for everything else.
+typedef struct {
+	bool ok;
+	char *str;
+	RAnalEsilSlot slot;
+	char buf[32];
+} EsilArg;
+
+static bool esil_arg_pop(RAnalEsil *esil, EsilArg *a) {
+	a->str = NULL;
+	a->ok = esil->stackptr > 0;
+	if (a->ok) {
+		esil->stackptr--;
+		a->str = esil->stack[esil->stackptr];
+		a->slot = esil->slots[esil->stackptr];
+	}
+	return a->ok;
+}
+
+static void esil_arg_fini(EsilArg *a) {
+	free (a->str);
+}
+
+static const char *esil_arg_str(EsilArg *a) {
+	if (!a->ok) {
+		return NULL;
+	}
+	return a->str? a->str: esil_slot_str (&a->slot, a->buf, sizeof (a->buf));
+}
+
+// typed numbers start with a digit, so like in get_parm_type they never name a register
+static inline bool esil_arg_isnum(EsilArg *a) {
+	return a->ok && !a->str && !a->slot.item;
+}
+
+static RRegItem *esil_arg_item(RAnalEsil *esil, EsilArg *a) {
+	return (a->ok && !a->str)? esil_slot_item (esil, &a->slot): NULL;
+}
+
+static inline bool esil_reg_read_direct(RAnalEsil *esil, bool nocallback) {
+	return (nocallback || !esil->cb.hook_reg_read) && esil->cb.reg_read == internal_esil_reg_read;
+}
+
+static inline bool esil_reg_write_direct(RAnalEsil *esil) {
+	return !esil->cb.hook_reg_write && esil->cb.reg_write == internal_esil_reg_write;
+}
+
+static int esil_arg_parm_type(RAnalEsil *esil, EsilArg *a) {
+	if (esil_arg_isnum (a)) {
+		return R_ANAL_ESIL_PARM_NUM;
+	}
+	if (esil_arg_item (esil, a)) {
+		return R_ANAL_ESIL_PARM_REG;
+	}
+	return r_anal_esil_get_parm_type (esil, esil_arg_str (a));
+}
+
+static bool esil_arg_get_size(RAnalEsil *esil, EsilArg *a, ut64 *num, int *size) {
+	if (!a->ok) {
+		return false;
+	}
+	if (esil_arg_isnum (a)) {
+		*num = a->slot.num;
+		if (size) {
+			*size = esil->anal->bits;
+		}
+		return true;
+	}
+	RRegItem *ri = esil_arg_item (esil, a);
+	if (ri && esil_reg_read_direct (esil, false)) {
+		*num = r_reg_get_value (esil->anal->reg, ri);
+		if (size) {
+			*size = ri->size;
+		}
+		return true;
+	}
+	return r_anal_esil_get_parm_size (esil, esil_arg_str (a), num, size);
+}
+
+static bool esil_arg_get(RAnalEsil *esil, EsilArg *a, ut64 *num) {
+	return esil_arg_get_size (esil, a, num, NULL);
+}
+
+static bool esil_arg_reg_read(RAnalEsil *esil, EsilArg *a, ut64 *num, bool nocallback) {
+	if (!a->ok) {
+		return false;
+	}
+	RRegItem *ri = esil_arg_item (esil, a);
+	if (ri && esil_reg_read_direct (esil, nocallback)) {
+		*num = r_reg_get_value (esil->anal->reg, ri);
+		return true;
+	}
+	return nocallback
+		? r_anal_esil_reg_read_nocallback (esil, esil_arg_str (a), num, NULL)
+		: r_anal_esil_reg_read (esil, esil_arg_str (a), num, NULL);
+}
+
+static bool esil_arg_reg_write(RAnalEsil *esil, EsilArg *a, ut64 num) {
+	if (!a->ok) {
+		return false;
+	}
+	RRegItem *ri = esil_arg_item (esil, a);
+	if (ri && esil_reg_write_direct (esil)) {
+		IFDBG { eprintf ("%s=0x%" PFMT64x "\n", a->slot.str, num); }
+		r_reg_set_value (esil->anal->reg, ri, num);
+		return true;
+	}
+	return r_anal_esil_reg_write (esil, esil_arg_str (a), num);
+}
+
+static bool esil_arg_regornum(RAnalEsil *esil, EsilArg *a, ut64 *num) {
+	if (!a->ok) {
+		return false;
+	}
+	if (esil_reg_read_direct (esil, false)) {
+		RRegItem *ri = esil_arg_item (esil, a);
+		if (ri) {
+			*num = r_reg_get_value (esil->anal->reg, ri);
+			return true;
+		}
+		if (esil_arg_isnum (a)) {
+			*num = a->slot.num;
+			return true;
+		}
+	}
+	return isregornum (esil, esil_arg_str (a), num);
+}
+
+static bool esil_arg_isreg(RAnalEsil *esil, EsilArg *a) {
+	if (!a->ok || esil_arg_isnum (a)) {
+		return false;
+	}
+	return esil_arg_item (esil, a) || r_reg_get (esil->anal->reg, esil_arg_str (a), -1);
+}
+
+static bool esil_arg_ispacked(RAnalEsil *esil, EsilArg *a) {
+	if (!a->ok || esil_arg_isnum (a)) {
+		return false;
+	}
+	RRegItem *ri = esil_arg_item (esil, a);
+	return ri? ri->packed_size > 0: ispackedreg (esil, esil_arg_str (a));
+}
+
+static ut8 esil_arg_regsize(RAnalEsil *esil, EsilArg *a) {
+	if (!a->ok || esil_arg_isnum (a)) {
+		return 0;
+	}
+	RRegItem *ri = esil_arg_item (esil, a);
+	return ri? ri->size: esil_internal_sizeof_reg (esil, esil_arg_str (a));
+}
+
 static bool esil_zf(RAnalEsil *esil) {
 	return r_anal_esil_pushnum (esil, !(esil->cur & genmask (esil->lastsz - 1)));
 }
 
 // checks if there was a carry from bit x (x,$c)
 static bool esil_cf(RAnalEsil *esil) {
-	char *src = r_anal_esil_pop (esil);
+	EsilArg src;
 
-	if (!src) {
+	if (!esil_arg_pop (esil, &src)) {
 		return false;
 	}
 
-	if (r_anal_esil_get_parm_type (esil, src) != R_ANAL_ESIL_PARM_NUM) {
+	if (esil_arg_parm_type (esil, &src) != R_ANAL_ESIL_PARM_NUM) {
 		//I'd wish we could enforce consts here
 		//I can't say why, but I feel like "al,$c" would be cancer af
 		//	- condret
-		free (src);
+		esil_arg_fini (&src);
 		return false;
 	}
 	ut64 bit;
-	r_anal_esil_get_parm (esil, src, &bit);
-	free (src);
+	esil_arg_get (esil, &src, &bit);
+	esil_arg_fini (&src);
 	//carry from bit <src>
 	//range of src goes from 0 to 63
 	//
@@ -581,19 +830,19 @@ static bool esil_cf(RAnalEsil *esil) {
 
 // checks if there was a borrow from bit x (x,$b)
 static bool esil_bf(RAnalEsil *esil) {
-	char *src = r_anal_esil_pop (esil);
+	EsilArg src;
 
-	if (!src) {
+	if (!esil_arg_pop (esil, &src)) {
 		return false;
 	}
 
-	if (r_anal_esil_get_parm_type (esil, src) != R_ANAL_ESIL_PARM_NUM) {
-		free (src);
+	if (esil_arg_parm_type (esil, &src) != R_ANAL_ESIL_PARM_NUM) {
+		esil_arg_fini (&src);
 		return false;
 	}
 	ut64 bit;
-	r_anal_esil_get_parm (esil, src, &bit);
-	free (src);
+	esil_arg_get (esil, &src, &bit);
+	esil_arg_fini (&src);
 	//borrow from bit <src>
 	//range of src goes from 1 to 64
 	//	you cannot borrow from bit 0, bc bit -1 cannot not exist
@@ -618,24 +867,24 @@ static bool esil_pf(RAnalEsil *esil) {
 // checks overflow from bit x (x,$o)
 //	x,$o ===> x,$c,x-1,$c,^
 static bool esil_of(RAnalEsil *esil) {
-	char *p_bit = r_anal_esil_pop (esil);
+	EsilArg p_bit;
 
-	if (!p_bit) {
+	if (!esil_arg_pop (esil, &p_bit)) {
 		return false;
 	}
 
-	if (r_anal_esil_get_parm_type (esil, p_bit) != R_ANAL_ESIL_PARM_NUM) {
-		free (p_bit);
+	if (esil_arg_parm_type (esil, &p_bit) != R_ANAL_ESIL_PARM_NUM) {
+		esil_arg_fini (&p_bit);
 		return false;
 	}
 	ut64 bit;
 
-	if (!r_anal_esil_get_parm (esil, p_bit, &bit)) {
+	if (!esil_arg_get (esil, &p_bit, &bit)) {
 		ERR ("esil_of: empty stack");
-		free (p_bit);
+		esil_arg_fini (&p_bit);
 		return false;
 	}
-	free (p_bit);
+	esil_arg_fini (&p_bit);
 
 	const ut64 m[2] = {genmask (bit & 0x3f), genmask ((bit + 0x3f) & 0x3f)};
 	const ut64 result = ((esil->cur & m[0]) < (esil->old & m[0])) ^ ((esil->cur & m[1]) < (esil->old & m[1]));
@@ -647,16 +896,17 @@ static bool esil_of(RAnalEsil *esil) {
 static bool esil_sf(RAnalEsil *esil) {
 	r_return_val_if_fail (esil, false);
 
-	char *p_size = r_anal_esil_pop (esil);
-	r_return_val_if_fail (p_size, false);
+	EsilArg p_size;
+	const bool popped = esil_arg_pop (esil, &p_size);
+	r_return_val_if_fail (popped, false);
 
-	if (r_anal_esil_get_parm_type (esil, p_size) != R_ANAL_ESIL_PARM_NUM) {
-		free (p_size);
+	if (esil_arg_parm_type (esil, &p_size) != R_ANAL_ESIL_PARM_NUM) {
+		esil_arg_fini (&p_size);
 		return false;
 	}
 	ut64 size, num;
-	r_anal_esil_get_parm (esil, p_size, &size);
-	free (p_size);
+	esil_arg_get (esil, &p_size, &size);
+	esil_arg_fini (&p_size);
 
 	if (size > 63) {
 		num = 0;
@@ -728,31 +978,35 @@ static bool esil_weak_eq(RAnalEsil *esil) {
 static bool esil_eq(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (!src || !dst) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (!src.ok || !dst.ok) {
 		if (esil->verbose) {
 			eprintf ("Missing elements in the esil stack for '=' at 0x%08"PFMT64x"\n", esil->address);
 		}
+		esil_arg_fini (&dst);
+		esil_arg_fini (&src);
 		return false;
 	}
-	if (ispackedreg (esil, dst)) {
-		char *src2 = r_anal_esil_pop (esil);
-		char *newreg = r_str_newf ("%sl", dst);
-		if (r_anal_esil_get_parm (esil, src2, &num2)) {
+	if (esil_arg_ispacked (esil, &dst)) {
+		EsilArg src2;
+		esil_arg_pop (esil, &src2);
+		char *newreg = r_str_newf ("%sl", esil_arg_str (&dst));
+		if (esil_arg_get (esil, &src2, &num2)) {
 			ret = r_anal_esil_reg_write (esil, newreg, num2);
 		}
 		free (newreg);
-		free (src2);
+		esil_arg_fini (&src2);
 		goto beach;
 	}
 
-	if (src && dst && r_anal_esil_reg_read_nocallback (esil, dst, &num, NULL)) {
-		if (r_anal_esil_get_parm (esil, src, &num2)) {
-			ret = r_anal_esil_reg_write (esil, dst, num2);
+	if (esil_arg_reg_read (esil, &dst, &num, true)) {
+		if (esil_arg_get (esil, &src, &num2)) {
+			ret = esil_arg_reg_write (esil, &dst, num2);
 			esil->cur = num2;
 			esil->old = num;
-			esil->lastsz = esil_internal_sizeof_reg (esil, dst);
+			esil->lastsz = esil_arg_regsize (esil, &dst);
 		} else {
 			ERR ("esil_eq: invalid src");
 		}
@@ -761,31 +1015,31 @@ static bool esil_eq(RAnalEsil *esil) {
 	}
 
 beach:
-	free (src);
-	free (dst);
+	esil_arg_fini (&src);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
 static bool esil_neg(RAnalEsil *esil) {
 	bool ret = false;
-	char *src = r_anal_esil_pop (esil);
-	if (src) {
+	EsilArg src;
+	if (esil_arg_pop (esil, &src)) {
 		ut64 num;
-		if (r_anal_esil_get_parm (esil, src, &num)) {
+		if (esil_arg_get (esil, &src, &num)) {
 			r_anal_esil_pushnum (esil, !num);
 			ret = true;
 		} else {
-			if (isregornum (esil, src, &num)) {
+			if (esil_arg_regornum (esil, &src, &num)) {
 				ret = true;
 				r_anal_esil_pushnum (esil, !num);
 			} else {
-				eprintf ("0x%08"PFMT64x" esil_neg: unknown reg %s\n", esil->address, src);
+				eprintf ("0x%08"PFMT64x" esil_neg: unknown reg %s\n", esil->address, esil_arg_str (&src));
 			}
 		}
 	} else {
 		ERR ("esil_neg: empty stack");
 	}
-	free (src);
+	esil_arg_fini (&src);
 	return ret;
 }
 
@@ -812,61 +1066,64 @@ static bool esil_nop(RAnalEsil *esil) {
 static bool esil_andeq(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_reg_read (esil, dst, &num, NULL)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_reg_read (esil, &dst, &num, false)) {
+		if (esil_arg_get (esil, &src, &num2)) {
 			esil->old = num;
 			esil->cur = num & num2;
-			esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			r_anal_esil_reg_write (esil, dst, num & num2);
+			esil->lastsz = esil_arg_regsize (esil, &dst);
+			esil_arg_reg_write (esil, &dst, num & num2);
 			ret = true;
 		} else {
 			ERR ("esil_andeq: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_arg_fini (&src);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
 static bool esil_oreq(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_reg_read (esil, dst, &num, NULL)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_reg_read (esil, &dst, &num, false)) {
+		if (esil_arg_get (esil, &src, &num2)) {
 			esil->old = num;
 			esil->cur = num | num2;
-			esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			ret = r_anal_esil_reg_write (esil, dst, num | num2);
+			esil->lastsz = esil_arg_regsize (esil, &dst);
+			ret = esil_arg_reg_write (esil, &dst, num | num2);
 		} else {
 			ERR ("esil_ordeq: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_arg_fini (&src);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
 static bool esil_xoreq(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_reg_read (esil, dst, &num, NULL)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
-				esil->old = num;
-				esil->cur = num ^ num2;
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			ret = r_anal_esil_reg_write (esil, dst, num ^ num2);
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_reg_read (esil, &dst, &num, false)) {
+		if (esil_arg_get (esil, &src, &num2)) {
+			esil->old = num;
+			esil->cur = num ^ num2;
+			esil->lastsz = esil_arg_regsize (esil, &dst);
+			ret = esil_arg_reg_write (esil, &dst, num ^ num2);
 		} else {
 			ERR ("esil_xoreq: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_arg_fini (&src);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
@@ -961,25 +1218,26 @@ static bool esil_interrupt(RAnalEsil *esil) {
 static bool esil_cmp(RAnalEsil *esil) {
 	ut64 num, num2;
 	bool ret = false;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &dst, &num)) {
+		if (esil_arg_get (esil, &src, &num2)) {
 			esil->old = num;
 			esil->cur = num - num2;
 			ret = true;
-			if (r_reg_get (esil->anal->reg, dst, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			} else if (r_reg_get (esil->anal->reg, src, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, src);
+			if (esil_arg_isreg (esil, &dst)) {
+				esil->lastsz = esil_arg_regsize (esil, &dst);
+			} else if (esil_arg_isreg (esil, &src)) {
+				esil->lastsz = esil_arg_regsize (esil, &src);
 			} else {
 				// default size is set to 64 as internally operands are ut64
 				esil->lastsz = 64;
 			}
 		}
 	}
-	free (dst);
-	free (src);
+	esil_arg_fini (&dst);
+	esil_arg_fini (&src);
 	return ret;
 }
 
@@ -1048,25 +1306,28 @@ static bool esil_if(RAnalEsil *esil) {
 		esil->skip++;
 		return true;
 	}
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &num)) {
+	EsilArg src;
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &src, &num)) {
 		// condition not matching, skipping until
 		if (!num) {
 			esil->skip++;
 		}
-		free (src);
+		esil_arg_fini (&src);
 		return true;
 	}
+	esil_arg_fini (&src);
 	return false;
 }
 
 static bool esil_lsl(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &dst, &num)) {
+		if (esil_arg_get (esil, &src, &num2)) {
 			if (num2 > sizeof (ut64) * 8) {
 				ERR ("esil_lsl: shift is too big");
 			} else {
@@ -1081,18 +1342,19 @@ static bool esil_lsl(RAnalEsil *esil) {
 			ERR ("esil_lsl: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_arg_fini (&src);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
 static bool esil_lsleq(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_reg_read (esil, dst, &num, NULL)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_reg_read (esil, &dst, &num, false)) {
+		if (esil_arg_get (esil, &src, &num2)) {
 			if (num2 > sizeof (ut64) * 8) {
 				ERR ("esil_lsleq: shift is too big");
 			} else {
@@ -1103,26 +1365,27 @@ static bool esil_lsleq(RAnalEsil *esil) {
 					num <<= num2;
 				}
 				esil->cur = num;
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-				r_anal_esil_reg_write (esil, dst, num);
+				esil->lastsz = esil_arg_regsize (esil, &dst);
+				esil_arg_reg_write (esil, &dst, num);
 				ret = true;
 			}
 		} else {
 			ERR ("esil_lsleq: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_arg_fini (&src);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
 static bool esil_lsr(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &dst, &num)) {
+		if (esil_arg_get (esil, &src, &num2)) {
 			ut64 res = num >> R_MIN (num2, 63);
 			r_anal_esil_pushnum (esil, res);
 			ret = true;
@@ -1130,18 +1393,19 @@ static bool esil_lsr(RAnalEsil *esil) {
 			ERR ("esil_lsr: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_arg_fini (&src);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
 static bool esil_lsreq(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_reg_read (esil, dst, &num, NULL)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_reg_read (esil, &dst, &num, false)) {
+		if (esil_arg_get (esil, &src, &num2)) {
 			if (num2 > 63) {
 				if (esil->verbose) {
 					eprintf ("Invalid shift at 0x%08"PFMT64x"\n", esil->address);
@@ -1151,15 +1415,15 @@ static bool esil_lsreq(RAnalEsil *esil) {
 			esil->old = num;
 			num >>= num2;
 			esil->cur = num;
-			esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			r_anal_esil_reg_write (esil, dst, num);
+			esil->lastsz = esil_arg_regsize (esil, &dst);
+			esil_arg_reg_write (esil, &dst, num);
 			ret = true;
 		} else {
 			ERR ("esil_lsreq: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_arg_fini (&src);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
@@ -1290,10 +1554,11 @@ static bool esil_ror(RAnalEsil *esil) {
 	bool ret = 0;
 	int regsize;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm_size (esil, dst, &num, &regsize)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get_size (esil, &dst, &num, &regsize)) {
+		if (esil_arg_get (esil, &src, &num2)) {
 			ut64 mask = (regsize - 1);
 			num2 &= mask;
 			ut64 res = (num >> num2) | (num << ((-(st64)num2) & mask));
@@ -1303,8 +1568,8 @@ static bool esil_ror(RAnalEsil *esil) {
 			ERR ("esil_ror: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_arg_fini (&src);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
@@ -1312,10 +1577,11 @@ static bool esil_rol(RAnalEsil *esil) {
 	bool ret = 0;
 	int regsize;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm_size (esil, dst, &num, &regsize)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get_size (esil, &dst, &num, &regsize)) {
+		if (esil_arg_get (esil, &src, &num2)) {
 			ut64 mask = (regsize - 1);
 			num2 &= mask;
 			ut64 res = (num << num2) | (num >> ((-(st64)num2) & mask));
@@ -1325,18 +1591,19 @@ static bool esil_rol(RAnalEsil *esil) {
 			ERR ("esil_rol: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_arg_fini (&src);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
 static bool esil_and(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &dst, &num)) {
+		if (esil_arg_get (esil, &src, &num2)) {
 			num &= num2;
 			r_anal_esil_pushnum (esil, num);
 			ret = true;
@@ -1344,18 +1611,19 @@ static bool esil_and(RAnalEsil *esil) {
 			ERR ("esil_and: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_arg_fini (&src);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
 static bool esil_xor(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &dst, &num)) {
+		if (esil_arg_get (esil, &src, &num2)) {
 			num ^= num2;
 			r_anal_esil_pushnum (esil, num);
 			ret = true;
@@ -1363,18 +1631,19 @@ static bool esil_xor(RAnalEsil *esil) {
 			ERR ("esil_xor: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_arg_fini (&src);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
 static bool esil_or(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &dst, &num)) {
+		if (esil_arg_get (esil, &src, &num2)) {
 			num |= num2;
 			r_anal_esil_pushnum (esil, num);
 			ret = true;
@@ -1382,8 +1651,8 @@ static bool esil_or(RAnalEsil *esil) {
 			ERR ("esil_xor: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_arg_fini (&src);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
@@ -1424,7 +1693,10 @@ R_API bool r_anal_esil_dumpstack(RAnalEsil *esil) {
 		return false;
 	}
 	for (i = esil->stackptr - 1; i >= 0; i--) {
-		esil->anal->cb_printf ("%s\n", esil->stack[i]);
+		char buf[32];
+		const char *str = esil->stack[i]? esil->stack[i]
+			: esil_slot_str (&esil->slots[i], buf, sizeof (buf));
+		esil->anal->cb_printf ("%s\n", str);
 	}
 	return true;
 }
@@ -1435,9 +1707,9 @@ static bool esil_break(RAnalEsil *esil) {
 }
 
 static bool esil_clear(RAnalEsil *esil) {
-	char *r;
-	while ((r = r_anal_esil_pop (esil))) {
-		free (r);
+	EsilArg a;
+	while (esil_arg_pop (esil, &a)) {
+		esil_arg_fini (&a);
 	}
 	return 1;
 }
@@ -1473,18 +1745,20 @@ static bool esil_repeat(RAnalEsil *esil) {
 }
 
 static bool esil_pop(RAnalEsil *esil) {
-	char *dst = r_anal_esil_pop (esil);
-	free (dst);
+	EsilArg dst;
+	esil_arg_pop (esil, &dst);
+	esil_arg_fini (&dst);
 	return 1;
 }
 
 static bool esil_mod(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_get_parm (esil, dst, &d)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &src, &s)) {
+		if (esil_arg_get (esil, &dst, &d)) {
 			if (s == 0) {
 				if (esil->verbose > 0) {
 					eprintf ("0x%08"PFMT64x" esil_mod: Division by zero!\n", esil->address);
@@ -1499,23 +1773,24 @@ static bool esil_mod(RAnalEsil *esil) {
 	} else {
 		ERR ("esil_mod: invalid parameters");
 	}
-	free (dst);
-	free (src);
+	esil_arg_fini (&dst);
+	esil_arg_fini (&src);
 	return ret;
 }
 
 static bool esil_modeq(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_reg_read (esil, dst, &d, NULL)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &src, &s)) {
+		if (esil_arg_reg_read (esil, &dst, &d, false)) {
 			if (s) {
 				esil->old = d;
 				esil->cur = d % s;
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-				r_anal_esil_reg_write (esil, dst, d % s);
+				esil->lastsz = esil_arg_regsize (esil, &dst);
+				esil_arg_reg_write (esil, &dst, d % s);
 			} else {
 				ERR ("esil_modeq: Division by zero!");
 				esil->trap = R_ANAL_TRAP_DIVBYZERO;
@@ -1528,18 +1803,19 @@ static bool esil_modeq(RAnalEsil *esil) {
 	} else {
 		ERR ("esil_modeq: invalid parameters");
 	}
-	free (src);
-	free (dst);
+	esil_arg_fini (&src);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
 static bool esil_div(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_get_parm (esil, dst, &d)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &src, &s)) {
+		if (esil_arg_get (esil, &dst, &d)) {
 			if (s == 0) {
 				ERR ("esil_div: Division by zero!");
 				esil->trap = R_ANAL_TRAP_DIVBYZERO;
@@ -1552,23 +1828,24 @@ static bool esil_div(RAnalEsil *esil) {
 	} else {
 		ERR ("esil_div: invalid parameters");
 	}
-	free (src);
-	free (dst);
+	esil_arg_fini (&src);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
 static bool esil_diveq(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_reg_read (esil, dst, &d, NULL)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &src, &s)) {
+		if (esil_arg_reg_read (esil, &dst, &d, false)) {
 			if (s) {
 				esil->old = d;
 				esil->cur = d / s;
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-				r_anal_esil_reg_write (esil, dst, d / s);
+				esil->lastsz = esil_arg_regsize (esil, &dst);
+				esil_arg_reg_write (esil, &dst, d / s);
 			} else {
 				// eprintf ("0x%08"PFMT64x" esil_diveq: Division by zero!\n", esil->address);
 				esil->trap = R_ANAL_TRAP_DIVBYZERO;
@@ -1581,18 +1858,19 @@ static bool esil_diveq(RAnalEsil *esil) {
 	} else {
 		ERR ("esil_diveq: invalid parameters");
 	}
-	free (src);
-	free (dst);
+	esil_arg_fini (&src);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
 static bool esil_mul(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_get_parm (esil, dst, &d)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &src, &s)) {
+		if (esil_arg_get (esil, &dst, &d)) {
 			r_anal_esil_pushnum (esil, d * s);
 			ret = true;
 		} else {
@@ -1601,165 +1879,174 @@ static bool esil_mul(RAnalEsil *esil) {
 	} else {
 		ERR ("esil_mul: invalid parameters");
 	}
-	free (src);
-	free (dst);
+	esil_arg_fini (&src);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
 static bool esil_muleq(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_reg_read (esil, dst, &d, NULL)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &src, &s)) {
+		if (esil_arg_reg_read (esil, &dst, &d, false)) {
 			esil->old = d;
 			esil->cur = d * s;
-			esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			ret = r_anal_esil_reg_write (esil, dst, s * d);
+			esil->lastsz = esil_arg_regsize (esil, &dst);
+			ret = esil_arg_reg_write (esil, &dst, s * d);
 		} else {
 			ERR ("esil_muleq: empty stack");
 		}
 	} else {
 		ERR ("esil_muleq: invalid parameters");
 	}
-	free (dst);
-	free (src);
+	esil_arg_fini (&dst);
+	esil_arg_fini (&src);
 	return ret;
 }
 
 static bool esil_add(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if ((src && r_anal_esil_get_parm (esil, src, &s)) && (dst && r_anal_esil_get_parm (esil, dst, &d))) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &src, &s) && esil_arg_get (esil, &dst, &d)) {
 		r_anal_esil_pushnum (esil, s + d);
 		ret = true;
 	} else {
 		ERR ("esil_add: invalid parameters");
 	}
-	free (src);
-	free (dst);
+	esil_arg_fini (&src);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
 static bool esil_addeq(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_reg_read (esil, dst, &d, NULL)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &src, &s)) {
+		if (esil_arg_reg_read (esil, &dst, &d, false)) {
 			esil->old = d;
 			esil->cur = d + s;
-			esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			ret = r_anal_esil_reg_write (esil, dst, s + d);
+			esil->lastsz = esil_arg_regsize (esil, &dst);
+			ret = esil_arg_reg_write (esil, &dst, s + d);
 		}
 	} else {
 		ERR ("esil_addeq: invalid parameters");
 	}
-	free (src);
-	free (dst);
+	esil_arg_fini (&src);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
 static bool esil_inc(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 s;
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
+	EsilArg src;
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &src, &s)) {
 		s++;
 		ret = r_anal_esil_pushnum (esil, s);
 	} else {
 		ERR ("esil_inc: invalid parameters");
 	}
-	free (src);
+	esil_arg_fini (&src);
 	return ret;
 }
 
 static bool esil_inceq(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 sd;
-	char *src_dst = r_anal_esil_pop (esil);
-	if (src_dst && (r_anal_esil_get_parm_type (esil, src_dst) == R_ANAL_ESIL_PARM_REG) && r_anal_esil_get_parm (esil, src_dst, &sd)) {
+	EsilArg src_dst;
+	esil_arg_pop (esil, &src_dst);
+	if (src_dst.ok && (esil_arg_parm_type (esil, &src_dst) == R_ANAL_ESIL_PARM_REG) && esil_arg_get (esil, &src_dst, &sd)) {
 		// inc rax
 		esil->old = sd++;
 		esil->cur = sd;
-		r_anal_esil_reg_write (esil, src_dst, sd);
-		esil->lastsz = esil_internal_sizeof_reg (esil, src_dst);
+		esil_arg_reg_write (esil, &src_dst, sd);
+		esil->lastsz = esil_arg_regsize (esil, &src_dst);
 		ret = true;
 	} else {
 		ERR ("esil_inceq: invalid parameters");
 	}
-	free (src_dst);
+	esil_arg_fini (&src_dst);
 	return ret;
 }
 
 static bool esil_sub(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if ((src && r_anal_esil_get_parm (esil, src, &s)) && (dst && r_anal_esil_get_parm (esil, dst, &d))) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &src, &s) && esil_arg_get (esil, &dst, &d)) {
 		ret = r_anal_esil_pushnum (esil, d - s);
 	} else {
 		ERR ("esil_sub: invalid parameters");
 	}
-	free (src);
-	free (dst);
+	esil_arg_fini (&src);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
 static bool esil_subeq(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_reg_read (esil, dst, &d, NULL)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &src, &s)) {
+		if (esil_arg_reg_read (esil, &dst, &d, false)) {
 			esil->old = d;
 			esil->cur = d - s;
-			esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			ret = r_anal_esil_reg_write (esil, dst, d - s);
+			esil->lastsz = esil_arg_regsize (esil, &dst);
+			ret = esil_arg_reg_write (esil, &dst, d - s);
 		}
 	} else {
 		ERR ("esil_subeq: invalid parameters");
 	}
-	free (src);
-	free (dst);
+	esil_arg_fini (&src);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
 static bool esil_dec(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 s;
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
+	EsilArg src;
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &src, &s)) {
 		s--;
 		ret = r_anal_esil_pushnum (esil, s);
 	} else {
 		ERR ("esil_dec: invalid parameters");
 	}
-	free (src);
+	esil_arg_fini (&src);
 	return ret;
 }
 
 static bool esil_deceq(RAnalEsil *esil) {
 	bool ret = false;
 	ut64 sd;
-	char *src_dst = r_anal_esil_pop (esil);
-	if (src_dst && (r_anal_esil_get_parm_type (esil, src_dst) == R_ANAL_ESIL_PARM_REG) && r_anal_esil_get_parm (esil, src_dst, &sd)) {
+	EsilArg src_dst;
+	esil_arg_pop (esil, &src_dst);
+	if (src_dst.ok && (esil_arg_parm_type (esil, &src_dst) == R_ANAL_ESIL_PARM_REG) && esil_arg_get (esil, &src_dst, &sd)) {
 		esil->old = sd;
 		sd--;
 		esil->cur = sd;
-		r_anal_esil_reg_write (esil, src_dst, sd);
-		esil->lastsz = esil_internal_sizeof_reg (esil, src_dst);
+		esil_arg_reg_write (esil, &src_dst, sd);
+		esil->lastsz = esil_arg_regsize (esil, &src_dst);
 		ret = true;
 	} else {
 		ERR ("esil_deceq: invalid parameters");
 	}
-	free (src_dst);
+	esil_arg_fini (&src_dst);
 	return ret;
 }
 
@@ -1769,22 +2056,22 @@ static bool esil_poke_n(RAnalEsil *esil, int bits) {
 	ut64 num, num2, addr;
 	ut8 b[8] = {0};
 	ut64 n;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
+	EsilArg dst, src, src2 = {0};
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
 	int bytes = R_MIN (sizeof (b), bits / 8);
 	if (bits % 8) {
-		free (src);
-		free (dst);
+		esil_arg_fini (&src);
+		esil_arg_fini (&dst);
 		return false;
 	}
 	bool ret = false;
 	//eprintf ("GONA POKE %d src:%s dst:%s\n", bits, src, dst);
-	char *src2 = NULL;
-	if (src && r_anal_esil_get_parm (esil, src, &num)) {
-		if (dst && r_anal_esil_get_parm (esil, dst, &addr)) {
+	if (esil_arg_get (esil, &src, &num)) {
+		if (esil_arg_get (esil, &dst, &addr)) {
 			if (bits == 128) {
-				src2 = r_anal_esil_pop (esil);
-				if (src2 && r_anal_esil_get_parm (esil, src2, &num2)) {
+				esil_arg_pop (esil, &src2);
+				if (esil_arg_get (esil, &src2, &num2)) {
 					r_write_ble (b, num, esil->anal->big_endian, 64);
 					ret = r_anal_esil_mem_write (esil, addr, b, bytes);
 					if (ret == 0) {
@@ -1812,9 +2099,9 @@ static bool esil_poke_n(RAnalEsil *esil, int bits) {
 		}
 	}
 out:
-	free (src2);
-	free (src);
-	free (dst);
+	esil_arg_fini (&src2);
+	esil_arg_fini (&src);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
@@ -1898,26 +2185,23 @@ static bool esil_peek_n(RAnalEsil *esil, int bits) {
 		return false;
 	}
 	bool ret = false;
-	char res[32];
 	ut64 addr;
 	ut32 bytes = bits / 8;
-	char *dst = r_anal_esil_pop (esil);
-	if (!dst) {
+	EsilArg dst;
+	if (!esil_arg_pop (esil, &dst)) {
 		eprintf ("ESIL-ERROR at 0x%08"PFMT64x": Cannot peek memory without specifying an address\n", esil->address);
 		return false;
 	}
 	//eprintf ("GONA PEEK %d dst:%s\n", bits, dst);
-	if (dst && isregornum (esil, dst, &addr)) {
+	if (esil_arg_regornum (esil, &dst, &addr)) {
 		if (bits == 128) {
 			ut8 a[sizeof(ut64) * 2] = {0};
 			ret = r_anal_esil_mem_read (esil, addr, a, bytes);
 			ut64 b = r_read_ble64 (&a, 0); //esil->anal->big_endian);
 			ut64 c = r_read_ble64 (&a[8], 0); //esil->anal->big_endian);
-			snprintf (res, sizeof (res), "0x%" PFMT64x, b);
-			r_anal_esil_push (esil, res);
-			snprintf (res, sizeof (res), "0x%" PFMT64x, c);
-			r_anal_esil_push (esil, res);
-			free (dst);
+			r_anal_esil_pushnum (esil, b);
+			r_anal_esil_pushnum (esil, c);
+			esil_arg_fini (&dst);
 			return ret;
 		}
 		ut64 bitmask = genmask (bits - 1);
@@ -1927,11 +2211,10 @@ static bool esil_peek_n(RAnalEsil *esil, int bits) {
 		if (esil->anal->big_endian) {
 			r_mem_swapendian ((ut8*)&b, (const ut8*)&b, bytes);
 		}
-		snprintf (res, sizeof (res), "0x%" PFMT64x, b & bitmask);
-		r_anal_esil_push (esil, res);
+		r_anal_esil_pushnum (esil, b & bitmask);
 		esil->lastsz = bits;
 	}
-	free (dst);
+	esil_arg_fini (&dst);
 	return ret;
 }
 
@@ -2587,19 +2870,19 @@ static bool esil_mem_lsreq(RAnalEsil *esil) {
 
 /* get value of register or memory reference and push the value */
 static bool esil_num(RAnalEsil *esil) {
-	char *dup_me;
+	EsilArg dup_me;
 	ut64 dup;
 	if (!esil) {
 		return false;
 	}
-	if (!(dup_me = r_anal_esil_pop (esil))) {
+	if (!esil_arg_pop (esil, &dup_me)) {
 		return false;
 	}
-	if (!r_anal_esil_get_parm (esil, dup_me, &dup)) {
-		free (dup_me);
+	if (!esil_arg_get (esil, &dup_me, &dup)) {
+		esil_arg_fini (&dup_me);
 		return false;
 	}
-	free (dup_me);
+	esil_arg_fini (&dup_me);
 	return r_anal_esil_pushnum (esil, dup);
 }
 
@@ -2608,20 +2891,25 @@ static bool esil_dup(RAnalEsil *esil) {
 	if (!esil || !esil->stack || esil->stackptr < 1 || esil->stackptr > (esil->stacksize - 1)) {
 		return false;
 	}
-	return r_anal_esil_push (esil, esil->stack[esil->stackptr-1]);
+	const int top = esil->stackptr - 1;
+	if (!esil->stack[top]) {
+		return esil_push_slot (esil, &esil->slots[top]);
+	}
+	return r_anal_esil_push (esil, esil->stack[top]);
 }
 
 static bool esil_swap(RAnalEsil *esil) {
-	char *tmp;
 	if (!esil || !esil->stack || esil->stackptr < 2) {
 		return false;
 	}
-	if (!esil->stack[esil->stackptr-1] || !esil->stack[esil->stackptr-2]) {
-		return false;
-	}
-	tmp = esil->stack[esil->stackptr-1];
-	esil->stack[esil->stackptr-1] = esil->stack[esil->stackptr-2];
-	esil->stack[esil->stackptr-2] = tmp;
+	const int a = esil->stackptr - 1;
+	const int b = esil->stackptr - 2;
+	char *tmp = esil->stack[a];
+	esil->stack[a] = esil->stack[b];
+	esil->stack[b] = tmp;
+	RAnalEsilSlot slot = esil->slots[a];
+	esil->slots[a] = esil->slots[b];
+	esil->slots[b] = slot;
 	return true;
 }
 
@@ -2653,17 +2941,18 @@ static int signed_compare_gt(ut64 a, ut64 b, ut64 size) {
 static bool esil_smaller(RAnalEsil *esil) { // 'dst < src' => 'src,dst,<'
 	ut64 num, num2;
 	bool ret = false;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &dst, &num)) {
+		if (esil_arg_get (esil, &src, &num2)) {
 			esil->old = num;
 			esil->cur = num - num2;
 			ret = true;
-			if (r_reg_get (esil->anal->reg, dst, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			} else if (r_reg_get (esil->anal->reg, src, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, src);
+			if (esil_arg_isreg (esil, &dst)) {
+				esil->lastsz = esil_arg_regsize (esil, &dst);
+			} else if (esil_arg_isreg (esil, &src)) {
+				esil->lastsz = esil_arg_regsize (esil, &src);
 			} else {
 				// default size is set to 64 as internally operands are ut64
 				esil->lastsz = 64;
@@ -2672,25 +2961,26 @@ static bool esil_smaller(RAnalEsil *esil) { // 'dst < src' => 'src,dst,<'
 			                           !signed_compare_gt (num, num2, esil->lastsz));
 		}
 	}
-	free (dst);
-	free (src);
+	esil_arg_fini (&dst);
+	esil_arg_fini (&src);
 	return ret;
 }
 
 static bool esil_bigger(RAnalEsil *esil) { // 'dst > src' => 'src,dst,>'
 	ut64 num, num2;
 	bool ret = false;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &dst, &num)) {
+		if (esil_arg_get (esil, &src, &num2)) {
 			esil->old = num;
 			esil->cur = num - num2;
 			ret = true;
-			if (r_reg_get (esil->anal->reg, dst, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			} else if (r_reg_get (esil->anal->reg, src, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, src);
+			if (esil_arg_isreg (esil, &dst)) {
+				esil->lastsz = esil_arg_regsize (esil, &dst);
+			} else if (esil_arg_isreg (esil, &src)) {
+				esil->lastsz = esil_arg_regsize (esil, &src);
 			} else {
 				// default size is set to 64 as internally operands are ut64
 				esil->lastsz = 64;
@@ -2698,25 +2988,26 @@ static bool esil_bigger(RAnalEsil *esil) { // 'dst > src' => 'src,dst,>'
 			r_anal_esil_pushnum (esil, signed_compare_gt (num, num2, esil->lastsz));
 		}
 	}
-	free (dst);
-	free (src);
+	esil_arg_fini (&dst);
+	esil_arg_fini (&src);
 	return ret;
 }
 
 static bool esil_smaller_equal(RAnalEsil *esil) { // 'dst <= src' => 'src,dst,<='
 	ut64 num, num2;
 	bool ret = false;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &dst, &num)) {
+		if (esil_arg_get (esil, &src, &num2)) {
 			esil->old = num;
 			esil->cur = num - num2;
 			ret = true;
-			if (r_reg_get (esil->anal->reg, dst, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			} else if (r_reg_get (esil->anal->reg, src, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, src);
+			if (esil_arg_isreg (esil, &dst)) {
+				esil->lastsz = esil_arg_regsize (esil, &dst);
+			} else if (esil_arg_isreg (esil, &src)) {
+				esil->lastsz = esil_arg_regsize (esil, &src);
 			} else {
 				// default size is set to 64 as internally operands are ut64
 				esil->lastsz = 64;
@@ -2724,25 +3015,26 @@ static bool esil_smaller_equal(RAnalEsil *esil) { // 'dst <= src' => 'src,dst,<=
 			r_anal_esil_pushnum (esil, !signed_compare_gt (num, num2, esil->lastsz));
 		}
 	}
-	free (dst);
-	free (src);
+	esil_arg_fini (&dst);
+	esil_arg_fini (&src);
 	return ret;
 }
 
 static bool esil_bigger_equal(RAnalEsil *esil) { // 'dst >= src' => 'src,dst,>='
 	ut64 num, num2;
 	bool ret = false;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	EsilArg dst, src;
+	esil_arg_pop (esil, &dst);
+	esil_arg_pop (esil, &src);
+	if (esil_arg_get (esil, &dst, &num)) {
+		if (esil_arg_get (esil, &src, &num2)) {
 			esil->old = num;
 			esil->cur = num - num2;
 			ret = true;
-			if (r_reg_get (esil->anal->reg, dst, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			} else if (r_reg_get (esil->anal->reg, src, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, src);
+			if (esil_arg_isreg (esil, &dst)) {
+				esil->lastsz = esil_arg_regsize (esil, &dst);
+			} else if (esil_arg_isreg (esil, &src)) {
+				esil->lastsz = esil_arg_regsize (esil, &src);
 			} else {
 				// default size is set to 64 as internally operands are ut64
 				esil->lastsz = 64;
@@ -2751,8 +3043,8 @@ static bool esil_bigger_equal(RAnalEsil *esil) { // 'dst >= src' => 'src,dst,>='
 			                           signed_compare_gt (num, num2, esil->lastsz));
 		}
 	}
-	free (dst);
-	free (src);
+	esil_arg_fini (&dst);
+	esil_arg_fini (&src);
 	return ret;
 }
 
@@ -2972,24 +3264,213 @@ static bool __stepOut(RAnalEsil *esil, const char *cmd) {
 	return false;
 }
 
-R_API int r_anal_esil_parse(RAnalEsil *esil, const char *str) {
+static void esil_word_compile(RAnalEsil *esil, EsilWord *w, const char *str) {
+	RReg *reg = esil->anal->reg;
+	RAnalEsilOp *op = NULL;
+	w->str = str;
+	w->type = ESIL_WORD_STR;
+	if (!strcmp (str, "}{")) {
+		w->type = ESIL_WORD_ELSE;
+	} else if (!strcmp (str, "}")) {
+		w->type = ESIL_WORD_ENDIF;
+	} else if (iscommand (esil, str, &op) && op) {
+		w->type = ESIL_WORD_OP;
+		w->op = op;
+	} else switch (r_anal_esil_get_parm_type (esil, str)) {
+	case R_ANAL_ESIL_PARM_NUM:
+		// "-1" is a number for get_parm but not for isnum
+		if (IS_DIGIT (*str)) {
+			w->type = ESIL_WORD_SLOT;
+			w->slot.num = r_num_get (NULL, str);
+			w->slot.str = str;
+		}
+		break;
+	case R_ANAL_ESIL_PARM_REG:
+		w->type = ESIL_WORD_SLOT;
+		w->slot.str = str;
+		w->slot.item = r_reg_get (reg, str, -1);
+		w->slot.reg = reg;
+		w->slot.rev = reg->rev;
+		break;
+	}
+}
+
+// returns NULL for the expressions only the string parser understands
+static EsilCode *esil_code_new(RAnalEsil *esil, const char *expr) {
+	const size_t len = strlen (expr);
+	if (*expr == ',' || expr[len - 1] == ',' || strchr (expr, ';')
+			|| strstr (expr, ",,") || strstr (expr, "#!")) {
+		return NULL;
+	}
+	EsilCode *code = R_NEW0 (EsilCode);
+	if (!code) {
+		return NULL;
+	}
+	code->expr = strdup (expr);
+	code->buf = strdup (expr);
+	code->words = R_NEWS0 (EsilWord, r_str_char_count (expr, ',') + 1);
+	if (!code->expr || !code->buf || !code->words) {
+		esil_code_free (code);
+		return NULL;
+	}
+	code->reg = esil->anal->reg;
+	code->reg_rev = code->reg->rev;
+	code->ops_rev = esil->ops_rev;
+	char *word = code->buf;
+	for (;;) {
+		char *next = strchr (word, ',');
+		if (next) {
+			*next = 0;
+		}
+		if (strlen (word) > 62) {
+			esil_code_free (code);
+			return NULL;
+		}
+		esil_word_compile (esil, &code->words[code->count++], word);
+		if (!next) {
+			break;
+		}
+		word = next + 1;
+	}
+	return code;
+}
+
+static EsilCode *esil_code_get(RAnalEsil *esil, const char *expr) {
+	if (esil->Reil || !esil->code || !esil->anal || !esil->anal->reg) {
+		return NULL;
+	}
+	RReg *reg = esil->anal->reg;
+	EsilCode *code = ht_up_find (esil->code, esil->address, NULL);
+	if (code && code->reg == reg && code->reg_rev == reg->rev
+			&& code->ops_rev == esil->ops_rev && !strcmp (code->expr, expr)) {
+		return code;
+	}
+	code = esil_code_new (esil, expr);
+	if (!code) {
+		return NULL;
+	}
+	if (esil->parse_depth > 0) {
+		// the cached code may be running, don't touch the cache
+		code->transient = true;
+		return code;
+	}
+	esil_stack_own (esil);
+	if (esil->code->count >= ESIL_CODE_LIMIT) {
+		ht_up_free (esil->code);
+		esil->code = ht_up_new (NULL, esil_code_free_kv, NULL);
+		if (!esil->code) {
+			code->transient = true;
+			return code;
+		}
+	}
+	ht_up_update (esil->code, esil->address, code);
+	return code;
+}
+
+// same as runword () with the word already resolved
+static int esil_code_step(RAnalEsil *esil, EsilWord *w) {
+	bool ok;
+	esil->parse_goto_count--;
+	if (esil->parse_goto_count < 1) {
+		ERR ("ESIL infinite loop detected\n");
+		esil->trap = 1;       // INTERNAL ERROR
+		esil->parse_stop = 1; // INTERNAL ERROR
+		return 0;
+	}
+	switch (w->type) {
+	case ESIL_WORD_ELSE:
+		if (esil->skip == 1) {
+			esil->skip = 0;
+		} else if (esil->skip == 0) {
+			esil->skip = 1;
+		}
+		return 1;
+	case ESIL_WORD_ENDIF:
+		if (esil->skip) {
+			esil->skip--;
+		}
+		return 1;
+	}
+	if (esil->skip && strcmp (w->str, "?{")) {
+		return 1;
+	}
+	switch (w->type) {
+	case ESIL_WORD_OP:
+		if (esil->cb.hook_command) {
+			if (esil->cb.hook_command (esil, w->str)) {
+				return 1; // XXX cannot return != 1
+			}
+		}
+		esil->current_opstr = (char *)w->str;
+		ok = w->op->code (esil);
+		esil->current_opstr = NULL;
+		if (!ok) {
+			if (esil->verbose) {
+				eprintf ("%s returned 0\n", w->str);
+			}
+		}
+		return ok;
+	case ESIL_WORD_SLOT:
+		ok = esil_push_slot (esil, &w->slot);
+		break;
+	default:
+		ok = r_anal_esil_push (esil, w->str);
+		break;
+	}
+	if (!ok) {
+		ERR ("ESIL stack is full");
+		esil->trap = 1;
+		esil->trap_code = 1;
+	}
+	return 1;
+}
+
+static int esil_code_run(RAnalEsil *esil, EsilCode *code) {
+	int i;
+loop:
+	esil->repeat = 0;
+	esil->skip = 0;
+	esil->parse_goto = -1;
+	esil->parse_stop = 0;
+	esil->parse_goto_count = esil->anal? esil->anal->esil_goto_limit: R_ANAL_ESIL_GOTO_LIMIT;
+	for (i = 0; i < code->count;) {
+		if (!esil_code_step (esil, &code->words[i])) {
+			return 0;
+		}
+		// same order as evalWord ()
+		if (esil->repeat) {
+			goto loop;
+		}
+		if (esil->parse_goto != -1) {
+			if (esil->parse_goto < 0 || esil->parse_goto >= code->count) {
+				if (esil->verbose) {
+					eprintf ("Cannot find word %d\n", esil->parse_goto);
+				}
+				return 0;
+			}
+			i = esil->parse_goto;
+			esil->parse_goto = -1;
+			continue;
+		}
+		if (esil->parse_stop) {
+			if (esil->parse_stop == 2) {
+				const char *rest = (i + 1 < code->count)
+					? code->expr + (code->words[i + 1].str - code->buf): "";
+				eprintf ("[esil at 0x%08"PFMT64x"] TODO: %s\n", esil->address, rest);
+			}
+			return 0;
+		}
+		i++;
+	}
+	return 1;
+}
+
+static int esil_parse_str(RAnalEsil *esil, const char *str) {
 	int wordi = 0;
 	int dorunword;
 	char word[64];
 	const char *ostr = str;
-	r_return_val_if_fail (esil && R_STR_ISNOTEMPTY (str), 0);
-
-	if (__stepOut (esil, esil->cmd_step)) {
-		(void)__stepOut (esil, esil->cmd_step_out);
-		return true;
-	}
 	const char *hashbang = strstr (str, "#!");
-	esil->trap = 0;
-	if (esil->cmd && esil->cmd_todo) {
-		if (!strncmp (str, "TODO", 4)) {
-			esil->cmd (esil, esil->cmd_todo, esil->address, 0);
-		}
-	}
 loop:
 	esil->repeat = 0;
 	esil->skip = 0;
@@ -3010,7 +3491,6 @@ repeat:
 		}
 		if (wordi > 62) {
 			ERR ("Invalid esil string");
-			__stepOut (esil, esil->cmd_step_out);
 			return -1;
 		}
 		dorunword = 0;
@@ -3025,20 +3505,16 @@ repeat:
 		if (dorunword) {
 			if (*word) {
 				if (!runword (esil, word)) {
-					__stepOut (esil, esil->cmd_step_out);
 					return 0;
 				}
 				word[wordi] = ',';
 				wordi = 0;
 				switch (evalWord (esil, ostr, &str)) {
 				case 0: goto loop;
-				case 1:
-					__stepOut (esil, esil->cmd_step_out);
-					return 0;
+				case 1: return 0;
 				case 2: continue;
 				}
 				if (dorunword == 1) {
-					__stepOut (esil, esil->cmd_step_out);
 					return 0;
 				}
 			}
@@ -3054,20 +3530,43 @@ repeat:
 	word[wordi] = 0;
 	if (*word) {
 		if (!runword (esil, word)) {
-			__stepOut (esil, esil->cmd_step_out);
 			return 0;
 		}
 		switch (evalWord (esil, ostr, &str)) {
 		case 0: goto loop;
-		case 1: __stepOut (esil, esil->cmd_step_out);
-			return 0;
+		case 1: return 0;
 		case 2: goto repeat;
 		}
 	}
-	__stepOut (esil, esil->cmd_step_out);
 	return 1;
 }
 
+R_API int r_anal_esil_parse(RAnalEsil *esil, const char *str) {
+	r_return_val_if_fail (esil && R_STR_ISNOTEMPTY (str), 0);
+
+	if (__stepOut (esil, esil->cmd_step)) {
+		(void)__stepOut (esil, esil->cmd_step_out);
+		return true;
+	}
+	esil->trap = 0;
+	if (esil->cmd && esil->cmd_todo) {
+		if (!strncmp (str, "TODO", 4)) {
+			esil->cmd (esil, esil->cmd_todo, esil->address, 0);
+		}
+	}
+	// run the compiled words when possible, they are cached by address
+	EsilCode *code = esil_code_get (esil, str);
+	esil->parse_depth++;
+	int ret = code? esil_code_run (esil, code): esil_parse_str (esil, str);
+	esil->parse_depth--;
+	if (code && code->transient) {
+		esil_stack_own (esil);
+		esil_code_free (code);
+	}
+	__stepOut (esil, esil->cmd_step_out);
+	return ret;
+}
+
 R_API int r_anal_esil_runword(RAnalEsil *esil, const char *word) {
 	const char *str = NULL;
 	runword (esil, word);
@@ -1,15 +1,142 @@
-/* radare - LGPL - Copyright 2015-2018 - pancake */
+/* radare - LGPL - Copyright 2015-2020 - pancake */
 
 #include <r_anal.h>
 
-#define DB esil->db_trace
-#define KEY(x) sdb_fmt ("%d."x, esil->trace_idx)
-#define KEYAT(x,y) sdb_fmt ("%d."x".0x%"PFMT64x, esil->trace_idx, y)
-#define KEYREG(x,y) sdb_fmt ("%d."x".%s", esil->trace_idx, y)
+#define TRACE_MAGIC 0x45535452 // "ESTR"
+#define TRACE_VERSION 1
+#define ALIGN8(x) (((x) + 7) & ~(ut64)7)
+
+/* a trace file is a sequence of chunks, each one is this header followed by
+ * the nul separated register names, the steps, the accesses and the arena.
+ * every part is padded to 8 bytes so the records are aligned in the mapped
+ * file. loading reads them from the mapping and copies them into the trace,
+ * rebasing the register names, access indexes and arena offsets */
+typedef struct {
+	ut32 magic;
+	ut32 version;
+	ut32 names_size;
+	ut32 nsteps;
+	ut64 naccesses;
+	ut64 arena_size;
+} TraceChunk;
+
+typedef void (*TraceKeyCallback)(void *user, const char *key, const char *value);
+
+static const char *trace_kinds[] = { "reg.read", "reg.write", "mem.read", "mem.write" };
 
 static int ocbs_set = false;
 static RAnalEsilCallbacks ocbs = {0};
 
+static void addr_steps_free(HtUPKv *kv) {
+	r_vector_free (kv->value);
+}
+
+R_API RAnalEsilTrace *r_anal_esil_trace_new(void) {
+	RAnalEsilTrace *trace = R_NEW0 (RAnalEsilTrace);
+	if (!trace) {
+		return NULL;
+	}
+	r_vector_init (&trace->steps, sizeof (RAnalEsilTraceStep), NULL, NULL);
+	r_vector_init (&trace->accesses, sizeof (RAnalEsilTraceAccess), NULL, NULL);
+	r_vector_init (&trace->arena, sizeof (ut8), NULL, NULL);
+	r_pvector_init (&trace->names, free);
+	trace->name_idx = ht_pp_new0 ();
+	trace->addr_steps = ht_up_new (NULL, addr_steps_free, NULL);
+	if (!trace->name_idx || !trace->addr_steps) {
+		r_anal_esil_trace_free (trace);
+		return NULL;
+	}
+	return trace;
+}
+
+R_API void r_anal_esil_trace_free(RAnalEsilTrace *trace) {
+	if (!trace) {
+		return;
+	}
+	r_vector_clear (&trace->steps);
+	r_vector_clear (&trace->accesses);
+	r_vector_clear (&trace->arena);
+	r_pvector_clear (&trace->names);
+	ht_pp_free (trace->name_idx);
+	ht_up_free (trace->addr_steps);
+	free (trace);
+}
+
+static bool trace_clear(RAnalEsilTrace *trace) {
+	HtUP *addr_steps = ht_up_new (NULL, addr_steps_free, NULL);
+	if (!addr_steps) {
+		return false;
+	}
+	ht_up_free (trace->addr_steps);
+	trace->addr_steps = addr_steps;
+	r_vector_clear (&trace->steps);
+	r_vector_clear (&trace->accesses);
+	r_vector_clear (&trace->arena);
+	return true;
+}
+
+R_API void r_anal_esil_trace_reset(RAnalEsil *esil) {
+	r_return_if_fail (esil);
+	if (esil->trace) {
+		trace_clear (esil->trace);
+	}
+}
+
+static bool access_is_mem(const RAnalEsilTraceAccess *a) {
+	return a->type == R_ANAL_ESIL_TRACE_MEM_READ || a->type == R_ANAL_ESIL_TRACE_MEM_WRITE;
+}
+
+static inline RAnalEsilTraceAccess *trace_access_at(RAnalEsilTrace *trace, ut64 i) {
+	return (RAnalEsilTraceAccess *)trace->accesses.a + i;
+}
+
+static ut32 trace_name(RAnalEsilTrace *trace, const char *name) {
+	size_t idx = (size_t)ht_pp_find (trace->name_idx, name, NULL);
+	if (!idx) {
+		char *s = strdup (name);
+		if (!s || !r_pvector_push (&trace->names, s)) {
+			free (s);
+			return UT32_MAX;
+		}
+		idx = r_pvector_len (&trace->names);
+		ht_pp_insert (trace->name_idx, name, (void *)idx);
+	}
+	return (ut32)(idx - 1);
+}
+
+static void trace_index(RAnalEsilTrace *trace, ut64 addr, ut32 idx) {
+	RVector *v = ht_up_find (trace->addr_steps, addr, NULL);
+	if (!v) {
+		v = r_vector_new (sizeof (ut32), NULL, NULL);
+		if (!v) {
+			return;
+		}
+		ht_up_insert (trace->addr_steps, addr, v);
+	}
+	r_vector_push (v, &idx);
+}
+
+static void trace_add(RAnalEsil *esil, ut32 type, ut64 addr, ut64 value, const ut8 *buf, int len) {
+	RAnalEsilTrace *trace = esil->trace;
+	RAnalEsilTraceAccess a = { addr, value, 0, type };
+	if (r_vector_empty (&trace->steps)) {
+		return;
+	}
+	if (buf) {
+		a.value = trace->arena.len;
+		if (len > 0) {
+			if (!r_vector_insert_range (&trace->arena, trace->arena.len, (void *)buf, len)) {
+				return;
+			}
+			a.size = len;
+		}
+	}
+	if (r_vector_push (&trace->accesses, &a)) {
+		RAnalEsilTraceStep *step = r_vector_index_ptr (&trace->steps, trace->steps.len - 1);
+		step->count++;
+	}
+}
+
 static int trace_hook_reg_read(RAnalEsil *esil, const char *name, ut64 *res, int *size) {
 	int ret = 0;
 	if (*name == '0') {
@@ -26,21 +153,20 @@ static int trace_hook_reg_read(RAnalEsil *esil, const char *name, ut64 *res, int
 		ret = esil->cb.reg_read (esil, name, res, size);
 	}
 	if (ret) {
-		ut64 val = *res;
-		//eprintf ("[ESIL] REG READ %s 0x%08"PFMT64x"\n", name, val);
-		sdb_array_add (DB, KEY ("reg.read"), name, 0);
-		sdb_num_set (DB, KEYREG ("reg.read", name), val, 0);
-	} //else {
-		//eprintf ("[ESIL] REG READ %s FAILED\n", name);
-	//}
+		ut32 reg = trace_name (esil->trace, name);
+		if (reg != UT32_MAX) {
+			trace_add (esil, R_ANAL_ESIL_TRACE_REG_READ, reg, *res, NULL, 0);
+		}
+	}
 	return ret;
 }
 
 static int trace_hook_reg_write(RAnalEsil *esil, const char *name, ut64 *val) {
 	int ret = 0;
-	//eprintf ("[ESIL] REG WRITE %s 0x%08"PFMT64x"\n", name, *val);
-	sdb_array_add (DB, KEY ("reg.write"), name, 0);
-	sdb_num_set (DB, KEYREG ("reg.write", name), *val, 0);
+	ut32 reg = trace_name (esil->trace, name);
+	if (reg != UT32_MAX) {
+		trace_add (esil, R_ANAL_ESIL_TRACE_REG_WRITE, reg, *val, NULL, 0);
+	}
 	if (ocbs.hook_reg_write) {
 		RAnalEsilCallbacks cbs = esil->cb;
 		esil->cb = ocbs;
@@ -51,17 +177,11 @@ static int trace_hook_reg_write(RAnalEsil *esil, const char *name, ut64 *val) {
 }
 
 static int trace_hook_mem_read(RAnalEsil *esil, ut64 addr, ut8 *buf, int len) {
-	char *hexbuf = calloc ((1 + len), 4);
 	int ret = 0;
 	if (esil->cb.mem_read) {
 		ret = esil->cb.mem_read (esil, addr, buf, len);
 	}
-	sdb_array_add_num (DB, KEY ("mem.read"), addr, 0);
-	r_hex_bin2str (buf, len, hexbuf);
-	sdb_set (DB, KEYAT ("mem.read.data", addr), hexbuf, 0);
-	//eprintf ("[ESIL] MEM READ 0x%08"PFMT64x" %s\n", addr, hexbuf);
-	free (hexbuf);
-
+	trace_add (esil, R_ANAL_ESIL_TRACE_MEM_READ, addr, 0, buf, len);
 	if (ocbs.hook_mem_read) {
 		RAnalEsilCallbacks cbs = esil->cb;
 		esil->cb = ocbs;
@@ -73,13 +193,7 @@ static int trace_hook_mem_read(RAnalEsil *esil, ut64 addr, ut8 *buf, int len) {
 
 static int trace_hook_mem_write(RAnalEsil *esil, ut64 addr, const ut8 *buf, int len) {
 	int ret = 0;
-	char *hexbuf = malloc ((1+len)*3);
-	sdb_array_add_num (DB, KEY ("mem.write"), addr, 0);
-	r_hex_bin2str (buf, len, hexbuf);
-	sdb_set (DB, KEYAT ("mem.write.data", addr), hexbuf, 0);
-	//eprintf ("[ESIL] MEM WRITE 0x%08"PFMT64x" %s\n", addr, hexbuf);
-	free (hexbuf);
-
+	trace_add (esil, R_ANAL_ESIL_TRACE_MEM_WRITE, addr, 0, buf, len);
 	if (ocbs.hook_mem_write) {
 		RAnalEsilCallbacks cbs = esil->cb;
 		esil->cb = ocbs;
@@ -89,6 +203,113 @@ static int trace_hook_mem_write(RAnalEsil *esil, ut64 addr, const ut8 *buf, int
 	return ret;
 }
 
+/* writes the first nsteps steps, which use the first naccesses accesses
+ * and arena_size bytes of the arena, as one chunk of a trace file */
+static bool trace_dump(RAnalEsilTrace *trace, const char *file, ut32 nsteps, ut64 naccesses, ut64 arena_size, bool append) {
+	void **it;
+	ut64 names_size = 0;
+	r_pvector_foreach (&trace->names, it) {
+		names_size += strlen (*it) + 1;
+	}
+	TraceChunk hdr = {
+		.magic = TRACE_MAGIC,
+		.version = TRACE_VERSION,
+		.names_size = ALIGN8 (names_size),
+		.nsteps = nsteps,
+		.naccesses = naccesses,
+		.arena_size = ALIGN8 (arena_size),
+	};
+	ut64 steps_size = (ut64)nsteps * sizeof (RAnalEsilTraceStep);
+	ut64 accesses_size = naccesses * sizeof (RAnalEsilTraceAccess);
+	ut64 size = sizeof (hdr) + hdr.names_size + steps_size + accesses_size + hdr.arena_size;
+	if (size > ST32_MAX) {
+		eprintf ("The esil trace is too big to be saved at once\n");
+		return false;
+	}
+	ut8 *buf = calloc (1, size);
+	if (!buf) {
+		return false;
+	}
+	ut8 *p = buf;
+	memcpy (p, &hdr, sizeof (hdr));
+	p += sizeof (hdr);
+	ut8 *names = p;
+	r_pvector_foreach (&trace->names, it) {
+		size_t len = strlen (*it) + 1;
+		memcpy (names, *it, len);
+		names += len;
+	}
+	p += hdr.names_size;
+	if (steps_size) {
+		memcpy (p, trace->steps.a, steps_size);
+		p += steps_size;
+	}
+	if (accesses_size) {
+		memcpy (p, trace->accesses.a, accesses_size);
+		p += accesses_size;
+	}
+	if (arena_size) {
+		memcpy (p, trace->arena.a, arena_size);
+	}
+	bool ret = r_file_dump (file, buf, (int)size, append);
+	free (buf);
+	return ret;
+}
+
+static void vector_drop_front(RVector *vec, size_t n) {
+	if (n < vec->len) {
+		memmove (vec->a, (ut8 *)vec->a + n * vec->elem_size, (vec->len - n) * vec->elem_size);
+		vec->len -= n;
+	} else {
+		vec->len = 0;
+	}
+}
+
+/* keeps at most anal->esil_trace_max steps in memory, dropping the
+ * oldest half when it is exceeded, after appending it to the spill file */
+static void trace_bound(RAnalEsil *esil) {
+	RAnalEsilTrace *trace = esil->trace;
+	int max = esil->anal? esil->anal->esil_trace_max: 0;
+	if (max < 1 || trace->steps.len <= (size_t)max) {
+		return;
+	}
+	size_t i, n = trace->steps.len / 2;
+	RAnalEsilTraceStep *step = r_vector_index_ptr (&trace->steps, n);
+	ut64 acut = step->start;
+	ut64 bcut = trace->arena.len;
+	for (i = acut; i < trace->accesses.len; i++) {
+		RAnalEsilTraceAccess *a = trace_access_at (trace, i);
+		if (access_is_mem (a)) {
+			bcut = a->value;
+			break;
+		}
+	}
+	const char *spill = esil->anal->esil_trace_spill;
+	if (R_STR_ISNOTEMPTY (spill) && !trace_dump (trace, spill, n, acut, bcut, r_file_exists (spill))) {
+		eprintf ("Cannot append the esil trace to %s\n", spill);
+	}
+	vector_drop_front (&trace->steps, n);
+	vector_drop_front (&trace->accesses, acut);
+	vector_drop_front (&trace->arena, bcut);
+	HtUP *addr_steps = ht_up_new (NULL, addr_steps_free, NULL);
+	if (addr_steps) {
+		ht_up_free (trace->addr_steps);
+		trace->addr_steps = addr_steps;
+	}
+	r_vector_foreach (&trace->steps, step) {
+		step->start -= acut;
+		if (addr_steps) {
+			trace_index (trace, step->addr, step->idx);
+		}
+	}
+	RAnalEsilTraceAccess *a;
+	r_vector_foreach (&trace->accesses, a) {
+		if (access_is_mem (a)) {
+			a->value -= bcut;
+		}
+	}
+}
+
 R_API void r_anal_esil_trace (RAnalEsil *esil, RAnalOp *op) {
 	if (!esil || !op) {
 		return;
@@ -98,23 +319,26 @@ R_API void r_anal_esil_trace (RAnalEsil *esil, RAnalOp *op) {
 		// do nothing
 		return;
 	}
+	if (!esil->trace) {
+		esil->trace = r_anal_esil_trace_new ();
+		if (!esil->trace) {
+			return;
+		}
+	}
 	int esil_verbose = esil->verbose;
 	if (ocbs_set) {
 		eprintf ("cannot call recursively\n");
 	}
 	ocbs = esil->cb;
 	ocbs_set = true;
-	if (!DB) {
-		DB = sdb_new0 ();
+	RAnalEsilTraceStep step = {
+		.addr = op->addr,
+		.idx = esil->trace_idx,
+		.start = esil->trace->accesses.len
+	};
+	if (r_vector_push (&esil->trace->steps, &step)) {
+		trace_index (esil->trace, op->addr, step.idx);
 	}
-	sdb_num_set (DB, "idx", esil->trace_idx, 0);
-	sdb_num_set (DB, KEY ("addr"), op->addr, 0);
-//	sdb_set (DB, KEY ("opcode"), op->mnemonic, 0);
-//	sdb_set (DB, KEY ("addr"), expr, 0);
-
-	//eprintf ("[ESIL] ADDR 0x%08"PFMT64x"\n", op->addr);
-	//eprintf ("[ESIL] OPCODE %s\n", op->mnemonic);
-	//eprintf ("[ESIL] EXPR = %s\n", expr);
 	/* set hooks */
 	esil->verbose = 0;
 	esil->cb.hook_reg_read = trace_hook_reg_read;
@@ -129,127 +353,420 @@ R_API void r_anal_esil_trace (RAnalEsil *esil, RAnalOp *op) {
 	ocbs_set = false;
 	esil->verbose = esil_verbose;
 	esil->trace_idx ++;
+	trace_bound (esil);
 }
 
-static int cmp_strings_by_leading_number(void *data1, void *data2) {
-	const char* a = sdbkv_key ((const SdbKv *)data1);
-	const char* b = sdbkv_key ((const SdbKv *)data2);
-	int i = 0;
-	int j = 0;
-	int k = 0;
-	while (a[i] >= '0' && a[i] <= '9') {
-		i++;
+R_API RAnalEsilTraceStep *r_anal_esil_trace_step(RAnalEsil *esil, int idx) {
+	r_return_val_if_fail (esil, NULL);
+	RAnalEsilTrace *trace = esil->trace;
+	if (!trace || r_vector_empty (&trace->steps) || idx < 0) {
+		return NULL;
 	}
-	while (b[j] >= '0' && b[j] <= '9') {
-		j++;
+	RAnalEsilTraceStep *steps = trace->steps.a;
+	// steps are usually contiguous, otherwise bisect
+	ut64 guess = (ut64)(ut32)idx - steps[0].idx;
+	if (guess < trace->steps.len && steps[guess].idx == (ut32)idx) {
+		return &steps[guess];
 	}
-	if (!i) {
-		return 1;
+	size_t lo = 0, hi = trace->steps.len;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (steps[mid].idx < (ut32)idx) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
 	}
-	if (!j) {
-		return -1;
+	return (lo < trace->steps.len && steps[lo].idx == (ut32)idx)? &steps[lo]: NULL;
+}
+
+R_API const char *r_anal_esil_trace_regname(RAnalEsil *esil, RAnalEsilTraceAccess *a) {
+	r_return_val_if_fail (esil && esil->trace && a, NULL);
+	if (access_is_mem (a) || a->addr >= r_pvector_len (&esil->trace->names)) {
+		return NULL;
 	}
-	i--;
-	j--;
-	if (i > j) {
-		return 1;
+	return r_pvector_at (&esil->trace->names, a->addr);
+}
+
+R_API const ut8 *r_anal_esil_trace_data(RAnalEsil *esil, RAnalEsilTraceAccess *a) {
+	r_return_val_if_fail (esil && esil->trace && a, NULL);
+	if (!access_is_mem (a) || a->value + a->size > esil->trace->arena.len) {
+		return NULL;
+	}
+	return (const ut8 *)esil->trace->arena.a + a->value;
+}
+
+static bool access_match(RAnalEsil *esil, RAnalEsilTraceAccess *a, int type, const char *regname) {
+	if (a->type != type) {
+		return false;
 	}
-	if (j > i) {
-		return -1;
+	if (regname && !access_is_mem (a)) {
+		const char *name = r_anal_esil_trace_regname (esil, a);
+		return name && !strcmp (name, regname);
 	}
-	while (k <= i) {
-		if (a[k] < b[k]) {
-			return -1;
+	return true;
+}
+
+/* first access of the given type made by the step idx, if regname is
+ * given only the accesses to that register are considered */
+R_API RAnalEsilTraceAccess *r_anal_esil_trace_access(RAnalEsil *esil, int idx, int type, const char *regname) {
+	RAnalEsilTraceStep *step = r_anal_esil_trace_step (esil, idx);
+	if (!step) {
+		return NULL;
+	}
+	ut64 i;
+	for (i = step->start; i < step->start + step->count; i++) {
+		RAnalEsilTraceAccess *a = trace_access_at (esil->trace, i);
+		if (access_match (esil, a, type, regname)) {
+			return a;
+		}
+	}
+	return NULL;
+}
+
+// true if an access before i in the step has the same type and register or address
+static bool access_seen(RAnalEsilTrace *trace, RAnalEsilTraceStep *step, ut64 i) {
+	RAnalEsilTraceAccess *a = trace_access_at (trace, i);
+	ut64 j;
+	for (j = step->start; j < i; j++) {
+		RAnalEsilTraceAccess *b = trace_access_at (trace, j);
+		if (b->type == a->type && b->addr == a->addr) {
+			return true;
 		}
-		if (a[k] > b[k]) {
-			return 1;
+	}
+	return false;
+}
+
+// last access of the step with the same type and register or address as i
+static RAnalEsilTraceAccess *access_last(RAnalEsilTrace *trace, RAnalEsilTraceStep *step, ut64 i) {
+	RAnalEsilTraceAccess *a = trace_access_at (trace, i);
+	ut64 j;
+	for (j = step->start + step->count; j-- > i;) {
+		RAnalEsilTraceAccess *b = trace_access_at (trace, j);
+		if (b->type == a->type && b->addr == a->addr) {
+			return b;
 		}
-		k++;
 	}
-	for (; a[i] && b[i]; i++) {
-		if (a[i] > b[i]) {
-			return 1;
+	return a;
+}
+
+static void access_key(RAnalEsil *esil, RAnalEsilTraceAccess *a, char *buf, size_t len) {
+	if (access_is_mem (a)) {
+		snprintf (buf, len, "0x%"PFMT64x, a->addr);
+	} else {
+		const char *name = r_anal_esil_trace_regname (esil, a);
+		r_str_ncpy (buf, name? name: "", len);
+	}
+}
+
+static char *trace_step_regs(RAnalEsil *esil, RAnalEsilTraceStep *step, int type) {
+	RStrBuf *sb = NULL;
+	char key[64];
+	ut64 i;
+	for (i = step->start; i < step->start + step->count; i++) {
+		RAnalEsilTraceAccess *a = trace_access_at (esil->trace, i);
+		if (a->type != type || access_seen (esil->trace, step, i)) {
+			continue;
 		}
-		if (a[i] < b[i]) {
-			return -1;
+		access_key (esil, a, key, sizeof (key));
+		if (!sb) {
+			sb = r_strbuf_new (key);
+		} else {
+			r_strbuf_appendf (sb, ",%s", key);
 		}
 	}
-	if (!a[i] && b[i]) {
-		return -1;
+	return sb? r_strbuf_drain (sb): NULL;
+}
+
+/* comma separated list of the registers (or memory addresses) accessed by
+ * the step idx with the given type, in the order they were first accessed */
+R_API char *r_anal_esil_trace_regs(RAnalEsil *esil, int idx, int type) {
+	RAnalEsilTraceStep *step = r_anal_esil_trace_step (esil, idx);
+	return step? trace_step_regs (esil, step, type): NULL;
+}
+
+static void trace_step_keys(RAnalEsil *esil, RAnalEsilTraceStep *step, TraceKeyCallback cb, void *user) {
+	static const int order[] = {
+		R_ANAL_ESIL_TRACE_MEM_READ, R_ANAL_ESIL_TRACE_MEM_WRITE,
+		R_ANAL_ESIL_TRACE_REG_READ, R_ANAL_ESIL_TRACE_REG_WRITE
+	};
+	char key[128], val[64], name[64];
+	int k;
+	ut64 i;
+	snprintf (key, sizeof (key), "%u.addr", step->idx);
+	snprintf (val, sizeof (val), "0x%"PFMT64x, step->addr);
+	cb (user, key, val);
+	for (k = 0; k < R_ARRAY_SIZE (order); k++) {
+		int type = order[k];
+		const char *kind = trace_kinds[type];
+		char *list = trace_step_regs (esil, step, type);
+		if (!list) {
+			continue;
+		}
+		snprintf (key, sizeof (key), "%u.%s", step->idx, kind);
+		cb (user, key, list);
+		free (list);
+		for (i = step->start; i < step->start + step->count; i++) {
+			RAnalEsilTraceAccess *a = trace_access_at (esil->trace, i);
+			if (a->type != type || access_seen (esil->trace, step, i)) {
+				continue;
+			}
+			a = access_last (esil->trace, step, i);
+			access_key (esil, a, name, sizeof (name));
+			if (access_is_mem (a)) {
+				const ut8 *data = r_anal_esil_trace_data (esil, a);
+				char *hex = calloc (1, (a->size * 2) + 1);
+				if (hex) {
+					if (data) {
+						r_hex_bin2str (data, a->size, hex);
+					}
+					snprintf (key, sizeof (key), "%u.%s.data.%s", step->idx, kind, name);
+					cb (user, key, hex);
+					free (hex);
+				}
+			} else {
+				snprintf (key, sizeof (key), "%u.%s.%s", step->idx, kind, name);
+				snprintf (val, sizeof (val), "0x%"PFMT64x, a->value);
+				cb (user, key, val);
+			}
+		}
+	}
+}
+
+static void trace_keys(RAnalEsil *esil, TraceKeyCallback cb, void *user) {
+	RAnalEsilTrace *trace = esil->trace;
+	RAnalEsilTraceStep *step;
+	if (!trace || r_vector_empty (&trace->steps)) {
+		return;
 	}
-	if (!b[i] && a[i]) {
-		return 1;
+	r_vector_foreach (&trace->steps, step) {
+		trace_step_keys (esil, step, cb, user);
 	}
-	return 0;
+	step = r_vector_index_ptr (&trace->steps, trace->steps.len - 1);
+	char val[32];
+	snprintf (val, sizeof (val), "0x%x", step->idx);
+	cb (user, "idx", val);
+}
+
+static void print_key(void *user, const char *key, const char *value) {
+	PrintfCallback p = user;
+	p ("%s=%s\n", key, value);
+}
+
+static void sdb_key(void *user, const char *key, const char *value) {
+	sdb_set ((Sdb *)user, key, value, 0);
 }
 
 R_API void r_anal_esil_trace_list (RAnalEsil *esil) {
-	PrintfCallback p = esil->anal->cb_printf;
-	SdbKv *kv;
-	SdbListIter *iter;
-	SdbList *list = sdb_foreach_list (esil->db_trace, true);
-	ls_sort (list, (SdbListComparator) cmp_strings_by_leading_number);
-	ls_foreach (list, iter, kv) {
-		p ("%s=%s\n", sdbkv_key (kv), sdbkv_value (kv));
+	r_return_if_fail (esil);
+	trace_keys (esil, print_key, esil->anal->cb_printf);
+}
+
+/* builds a database with the keys that were used by the old sdb based trace */
+R_API Sdb *r_anal_esil_trace_sdb(RAnalEsil *esil) {
+	r_return_val_if_fail (esil, NULL);
+	Sdb *db = sdb_new0 ();
+	if (db) {
+		trace_keys (esil, sdb_key, db);
 	}
-	ls_free (list);
+	return db;
 }
 
 R_API void r_anal_esil_trace_show(RAnalEsil *esil, int idx) {
 	PrintfCallback p = esil->anal->cb_printf;
-	const char *str2;
-	const char *str;
-	int trace_idx = esil->trace_idx;
-	esil->trace_idx = idx;
-
-	str2 = sdb_const_get (DB, KEY ("addr"), 0);
-	if (!str2) {
+	RAnalEsilTraceStep *step = r_anal_esil_trace_step (esil, idx);
+	if (!step) {
 		return;
 	}
-	p ("ar PC = %s\n", str2);
+	RAnalEsilTrace *trace = esil->trace;
+	char name[64];
+	ut64 i;
+	p ("ar PC = 0x%"PFMT64x"\n", step->addr);
 	/* registers */
-	str = sdb_const_get (DB, KEY ("reg.read"), 0);
-	if (str) {
-		char regname[32];
-		const char *next, *ptr = str;
-		if (ptr && *ptr) {
-			do {
-				next = sdb_const_anext (ptr);
-				int len = next? (int)(size_t)(next-ptr)-1 : strlen (ptr);
-				if (len <sizeof(regname)) {
-					memcpy (regname, ptr, len);
-					regname[len] = 0;
-					str2 = sdb_const_get (DB, KEYREG ("reg.read", regname), 0);
-					p ("ar %s = %s\n", regname, str2);
-				} else {
-					eprintf ("Invalid entry in reg.read\n");
-				}
-				ptr = next;
-			} while (next);
+	for (i = step->start; i < step->start + step->count; i++) {
+		RAnalEsilTraceAccess *a = trace_access_at (trace, i);
+		if (a->type != R_ANAL_ESIL_TRACE_REG_READ || access_seen (trace, step, i)) {
+			continue;
 		}
+		a = access_last (trace, step, i);
+		access_key (esil, a, name, sizeof (name));
+		p ("ar %s = 0x%"PFMT64x"\n", name, a->value);
 	}
 	/* memory */
-	str = sdb_const_get (DB, KEY ("mem.read"), 0);
-	if (str) {
-		char addr[64];
-		const char *next, *ptr = str;
-		if (ptr && *ptr) {
-			do {
-				next = sdb_const_anext (ptr);
-				int len = next? (int)(size_t)(next-ptr)-1 : strlen (ptr);
-				if (len <sizeof(addr)) {
-					memcpy (addr, ptr, len);
-					addr[len] = 0;
-					str2 = sdb_const_get (DB, KEYAT ("mem.read.data",
-						r_num_get (NULL, addr)), 0);
-					p ("wx %s @ %s\n", str2, addr);
-				} else {
-					eprintf ("Invalid entry in reg.read\n");
-				}
-				ptr = next;
-			} while (next);
+	for (i = step->start; i < step->start + step->count; i++) {
+		RAnalEsilTraceAccess *a = trace_access_at (trace, i);
+		if (a->type != R_ANAL_ESIL_TRACE_MEM_READ || access_seen (trace, step, i)) {
+			continue;
+		}
+		a = access_last (trace, step, i);
+		const ut8 *data = r_anal_esil_trace_data (esil, a);
+		char *hex = calloc (1, (a->size * 2) + 1);
+		if (data && hex) {
+			r_hex_bin2str (data, a->size, hex);
+			p ("wx %s @ 0x%"PFMT64x"\n", hex, a->addr);
+		}
+		free (hex);
+	}
+}
+
+/* lists the steps that traced the instruction at addr */
+R_API void r_anal_esil_trace_addr(RAnalEsil *esil, ut64 addr) {
+	r_return_if_fail (esil);
+	PrintfCallback p = esil->anal->cb_printf;
+	if (!esil->trace) {
+		return;
+	}
+	RVector *v = ht_up_find (esil->trace->addr_steps, addr, NULL);
+	ut32 *idx;
+	if (v) {
+		r_vector_foreach (v, idx) {
+			p ("%u\n", *idx);
 		}
 	}
+}
+
+R_API bool r_anal_esil_trace_save(RAnalEsil *esil, const char *file) {
+	r_return_val_if_fail (esil && file, false);
+	RAnalEsilTrace *trace = esil->trace;
+	if (!trace) {
+		return r_file_dump (file, NULL, 0, false);
+	}
+	return trace_dump (trace, file, trace->steps.len, trace->accesses.len, trace->arena.len, false);
+}
+
+typedef struct {
+	ut64 off;
+	ut64 size;
+	ut32 first; // idx of the first step of the chunk
+} TraceChunkRef;
+
+static int trace_chunk_cmp(const void *va, const void *vb) {
+	const TraceChunkRef *a = va, *b = vb;
+	if (a->first != b->first) {
+		return a->first < b->first? -1: 1;
+	}
+	return a->off < b->off? -1: a->off > b->off;
+}
+
+// size of the chunk at buf, 0 if it is not a valid one
+static ut64 trace_chunk_size(const ut8 *buf, ut64 len) {
+	const TraceChunk *hdr = (const TraceChunk *)buf;
+	if (len < sizeof (TraceChunk) || hdr->magic != TRACE_MAGIC || hdr->version != TRACE_VERSION) {
+		return 0;
+	}
+	ut64 steps_size = (ut64)hdr->nsteps * sizeof (RAnalEsilTraceStep);
+	ut64 accesses_size = hdr->naccesses * sizeof (RAnalEsilTraceAccess);
+	if (hdr->naccesses > len || hdr->arena_size > len
+			|| sizeof (TraceChunk) + hdr->names_size + steps_size + accesses_size + hdr->arena_size > len) {
+		return 0;
+	}
+	return sizeof (TraceChunk) + hdr->names_size + steps_size + accesses_size + hdr->arena_size;
+}
 
-	esil->trace_idx = trace_idx;
+// appends a chunk validated by trace_chunk_size to the trace
+static void trace_load_chunk(RAnalEsilTrace *trace, const ut8 *buf) {
+	const TraceChunk *hdr = (const TraceChunk *)buf;
+	ut64 steps_size = (ut64)hdr->nsteps * sizeof (RAnalEsilTraceStep);
+	ut64 accesses_size = hdr->naccesses * sizeof (RAnalEsilTraceAccess);
+	const char *names = (const char *)buf + sizeof (TraceChunk);
+	const RAnalEsilTraceStep *steps = (const RAnalEsilTraceStep *)(names + hdr->names_size);
+	const RAnalEsilTraceAccess *accesses = (const RAnalEsilTraceAccess *)((const ut8 *)steps + steps_size);
+	const ut8 *arena = (const ut8 *)accesses + accesses_size;
+	RVector remap;
+	r_vector_init (&remap, sizeof (ut32), NULL, NULL);
+	const char *name = names;
+	while (name < names + hdr->names_size && *name) {
+		size_t n = r_str_nlen (name, names + hdr->names_size - name);
+		if (name + n >= names + hdr->names_size) {
+			break;
+		}
+		ut32 idx = trace_name (trace, name);
+		r_vector_push (&remap, &idx);
+		name += n + 1;
+	}
+	ut64 abase = trace->accesses.len;
+	ut64 bbase = trace->arena.len;
+	ut32 i;
+	for (i = 0; i < hdr->nsteps; i++) {
+		RAnalEsilTraceStep step = steps[i];
+		if (step.start + step.count > hdr->naccesses) {
+			break;
+		}
+		step.start += abase;
+		if (r_vector_push (&trace->steps, &step)) {
+			trace_index (trace, step.addr, step.idx);
+		}
+	}
+	ut64 j;
+	for (j = 0; j < hdr->naccesses; j++) {
+		RAnalEsilTraceAccess a = accesses[j];
+		if (access_is_mem (&a)) {
+			if (a.value + a.size > hdr->arena_size) {
+				a.size = 0;
+			}
+			a.value += bbase;
+		} else {
+			ut32 *idx = a.addr < remap.len? r_vector_index_ptr (&remap, a.addr): NULL;
+			a.addr = idx? *idx: UT32_MAX;
+		}
+		r_vector_push (&trace->accesses, &a);
+	}
+	if (hdr->arena_size) {
+		r_vector_insert_range (&trace->arena, trace->arena.len, (void *)arena, hdr->arena_size);
+	}
+	r_vector_clear (&remap);
+}
+
+/* replaces the trace with the one stored in file, by r_anal_esil_trace_save
+ * or by the steps dropped with esil.trace.max and esil.trace.spill */
+R_API bool r_anal_esil_trace_load(RAnalEsil *esil, const char *file) {
+	r_return_val_if_fail (esil && file, false);
+	if (!esil->trace) {
+		esil->trace = r_anal_esil_trace_new ();
+		if (!esil->trace) {
+			return false;
+		}
+	}
+	RMmap *m = r_file_mmap (file, false, 0);
+	if (!m) {
+		return false;
+	}
+	RAnalEsilTrace *trace = esil->trace;
+	bool ret = trace_clear (trace);
+	ut64 off = 0;
+	ut64 len = m->len > 0? m->len: 0;
+	// chunks are in the order they were written, a reused spill file or
+	// concatenated files have them out of step order
+	RVector chunks;
+	r_vector_init (&chunks, sizeof (TraceChunkRef), NULL, NULL);
+	while (ret && off < len) {
+		const TraceChunk *hdr = (const TraceChunk *)(m->buf + off);
+		TraceChunkRef ref = { off, trace_chunk_size (m->buf + off, len - off), UT32_MAX };
+		if (!ref.size) {
+			eprintf ("Invalid esil trace chunk at 0x%"PFMT64x"\n", off);
+			ret = false;
+			break;
+		}
+		if (hdr->nsteps) {
+			const RAnalEsilTraceStep *steps = (const RAnalEsilTraceStep *)(m->buf + off + sizeof (TraceChunk) + hdr->names_size);
+			ref.first = steps[0].idx;
+		}
+		r_vector_push (&chunks, &ref);
+		off += ref.size;
+	}
+	qsort (chunks.a, chunks.len, sizeof (TraceChunkRef), trace_chunk_cmp);
+	size_t i;
+	for (i = 0; i < chunks.len; i++) {
+		const TraceChunkRef *ref = r_vector_index_ptr (&chunks, i);
+		trace_load_chunk (trace, m->buf + ref->off);
+	}
+	r_vector_clear (&chunks);
+	r_file_mmap_free (m);
+	if (!r_vector_empty (&trace->steps)) {
+		RAnalEsilTraceStep *last = r_vector_index_ptr (&trace->steps, trace->steps.len - 1);
+		if (last->idx >= (ut32)esil->trace_idx) {
+			esil->trace_idx = last->idx + 1;
+		}
+	}
+	return ret;
 }
@@ -5,7 +5,6 @@
 #include <r_util.h>
 #include <r_list.h>
 
-#define READ_AHEAD 1
 #define SDB_KEY_BB "bb.0x%"PFMT64x ".0x%"PFMT64x
 // XXX must be configurable by the user
 #define JMPTBLSZ 512
@@ -49,48 +48,6 @@ R_API const char *r_anal_fcn_type_tostring(int type) {
 	return "unk";
 }
 
-#if READ_AHEAD
-static ut64 cache_addr = UT64_MAX;
-
-// TODO: move into io :?
-static int read_ahead(RAnal *anal, ut64 addr, ut8 *buf, int len) {
-	static ut8 cache[1024];
-	const int cache_len = sizeof (cache);
-
-	if (len < 1) {
-		return 0;
-	}
-	if (len > cache_len) {
-		int a = anal->iob.read_at (anal->iob.io, addr, buf, len); // double read
-		memcpy (cache, buf, cache_len);
-		cache_addr = addr;
-		return a;
-	}
-
-	ut64 addr_end = UT64_ADD_OVFCHK (addr, len)? UT64_MAX: addr + len;
-	ut64 cache_addr_end = UT64_ADD_OVFCHK (cache_addr, cache_len)? UT64_MAX: cache_addr + cache_len;
-	bool isCached = ((addr != UT64_MAX) && (addr >= cache_addr) && (addr_end < cache_addr_end));
-	if (isCached) {
-		memcpy (buf, cache + (addr - cache_addr), len);
-	} else {
-		anal->iob.read_at (anal->iob.io, addr, cache, sizeof (cache));
-		memcpy (buf, cache, len);
-		cache_addr = addr;
-	}
-	return len;
-}
-#else
-static int read_ahead(RAnal *anal, ut64 addr, ut8 *buf, int len) {
-	return anal->iob.read_at (anal->iob.io, addr, buf, len);
-}
-#endif
-
-R_API void r_anal_fcn_invalidate_read_ahead_cache() {
-#if READ_AHEAD
-	cache_addr = UT64_MAX;
-#endif
-}
-
 static int cmpaddr(const void *_a, const void *_b) {
 	const RAnalBlock *a = _a, *b = _b;
 	return a->addr > b->addr ? 1 : (a->addr < b->addr ? -1 : 0);
@@ -225,7 +182,7 @@ static bool is_delta_pointer_table(RAnal *anal, RAnalFunction *fcn, ut64 addr, u
 	RAnalOp mov_aop = {0};
 	RAnalOp add_aop = {0};
 
-	read_ahead (anal, addr, (ut8*)buf, sizeof (buf));
+	r_anal_read_cache_read (anal, addr, (ut8*)buf, sizeof (buf));
 	bool isValid = false;
 	for (i = 0; i + 8 < JMPTBL_LEA_SEARCH_SZ; i++) {
 		ut64 at = addr + i;
@@ -270,7 +227,7 @@ static bool is_delta_pointer_table(RAnal *anal, RAnalFunction *fcn, ut64 addr, u
 	}
 #endif
 	/* check if jump table contains valid deltas */
-	read_ahead (anal, *jmptbl_addr, (ut8 *)&jmptbl, 64);
+	r_anal_read_cache_read (anal, *jmptbl_addr, (ut8 *)&jmptbl, 64);
 	for (i = 0; i < 3; i++) {
 		dst = lea_ptr + (st32)r_read_le32 (jmptbl);
 		if (!anal->iob.is_valid_offset (anal->iob.io, dst, 0)) {
@@ -546,7 +503,7 @@ repeat:
 		ut32 at_delta = addrbytes * idx;
 		ut64 at = addr + at_delta;
 		ut64 bytes_read = R_MIN (len - at_delta, sizeof (buf));
-		ret = read_ahead (anal, at, buf, bytes_read);
+		ret = r_anal_read_cache_read (anal, at, buf, bytes_read);
 
 		if (ret < 0) {
 			eprintf ("Failed to read\n");
@@ -1426,7 +1383,6 @@ R_API bool r_anal_fcn_add_bb(RAnal *a, RAnalFunction *fcn, ut64 addr, ut64 size,
 	const bool is_x86 = a->cur->arch && !strcmp (a->cur->arch, "x86");
 	// TODO fix this x86-ism
 	if (is_x86) {
-		r_anal_fcn_invalidate_read_ahead_cache ();
 		fcn_recurse (a, fcn, addr, size, 1);
 		block = r_anal_get_block_at (a, addr);
 		if (block) {
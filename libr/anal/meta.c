@@ -18,68 +18,172 @@ Keys:
   'meta.<type>.count=<int>'     number of added metas where 'type' is a single char
   'meta.<type>.<last>=<array>'  split array, each block contains K elements
   'meta.<type>.<addr>=<string>' string representing extra information of the meta type at given address
-  'range.<baddr>=<array>'       store valid addresses in a base range array
+  'meta.<addr>=<array>'         types of the metas listed at given address
+
+The items are mirrored in a->meta, an interval tree of MetaNode by the
+range they cover, which answers the lookups without parsing the sdb values.
 #endif
 
 #include <r_anal.h>
 #include <r_core.h>
 
-#define META_RANGE_BASE(x) ((x)>>5)
 #undef DB
 #define DB a->sdb_meta
 
-static char *meta_inrange_get(RAnal *a, ut64 addr, int size) {
-	if (size <= 0) {
-		return NULL;
+typedef struct {
+	RAnalMetaItem item; // first, so r_meta_item_free releases the node
+	ut64 seq; // position in the meta.<addr> list, 0 when not listed there
+} MetaNode;
+
+static RIntervalNode *meta_node_find(RAnal *a, int type, ut64 addr) {
+	RBIter it = r_interval_tree_first_at (&a->meta, addr);
+	while (r_rbtree_iter_has (&it)) {
+		RIntervalNode *node = r_rbtree_iter_get (&it, RIntervalNode, node);
+		if (node->start != addr) {
+			break;
+		}
+		MetaNode *mn = node->data;
+		if (mn->item.type == type) {
+			return node;
+		}
+		r_rbtree_iter_next (&it);
+	}
+	return NULL;
+}
+
+// mirrors setting meta.<type>.<addr>
+static MetaNode *meta_node_set(RAnal *a, int type, int subtype, ut64 addr, ut64 size, const char *str, const RSpace *space) {
+	RIntervalNode *node = meta_node_find (a, type, addr);
+	MetaNode *mn;
+	if (node) {
+		mn = node->data;
+		if (mn->item.size != size) {
+			r_interval_tree_resize (&a->meta, node, addr, addr + size);
+		}
+		free (mn->item.str);
+	} else {
+		mn = R_NEW0 (MetaNode);
+		if (!mn) {
+			return NULL;
+		}
+		if (!r_interval_tree_insert (&a->meta, addr, addr + size, mn)) {
+			free (mn);
+			return NULL;
+		}
+	}
+	mn->item.from = addr;
+	mn->item.to = addr + size;
+	mn->item.size = size;
+	mn->item.type = type;
+	mn->item.subtype = subtype;
+	mn->item.str = str? strdup (str): NULL;
+	mn->item.space = space;
+	return mn;
+}
+
+static void meta_collect_cb(RIntervalNode *node, void *user) {
+	r_pvector_push (user, node);
+}
+
+// drops the nodes at addr whose sdb item is gone and orders the rest like meta.<addr>
+static void meta_sync_at(RAnal *a, ut64 addr) {
+	RPVector nodes;
+	void **it;
+	r_pvector_init (&nodes, NULL);
+	r_interval_tree_all_at (&a->meta, addr, meta_collect_cb, &nodes);
+	const char *types = sdb_const_get (DB, sdb_fmt ("meta.0x%"PFMT64x, addr), 0);
+	r_pvector_foreach (&nodes, it) {
+		RIntervalNode *node = *it;
+		MetaNode *mn = node->data;
+		if (!sdb_exists (DB, sdb_fmt ("meta.%c.0x%"PFMT64x, mn->item.type, addr))) {
+			r_interval_tree_delete (&a->meta, node, true);
+		} else {
+			const char *pos = types? strchr (types, mn->item.type): NULL;
+			mn->seq = pos? pos - types + 1: 0;
+		}
 	}
-	ut64 base = META_RANGE_BASE (addr);
-	ut64 base2 = META_RANGE_BASE (addr + size - 1);
-	char *res = NULL;
-	// return string array of all the offsets where there are stuff
-	for (; base <= base2; base++) {
-		const char *key = sdb_fmt ("range.0x%"PFMT64x, base);
-		const char *r = sdb_const_get (DB, key, 0);
-		if (r) {
-			if (res) {
-				res = r_str_append (res, ",");
+	r_pvector_clear (&nodes);
+}
+
+static void meta_del_type(RAnal *a, int type) {
+	RPVector nodes;
+	RIntervalNode *in;
+	RBIter iter;
+	void **it;
+	r_pvector_init (&nodes, NULL);
+	if (a->meta.root) {
+		r_rbtree_foreach (&a->meta.root->node, iter, in, RIntervalNode, node) {
+			if (((MetaNode *)in->data)->item.type == type) {
+				r_pvector_push (&nodes, in);
 			}
-			res = r_str_append (res, r);
 		}
 	}
-	return res;
+	r_pvector_foreach (&nodes, it) {
+		r_interval_tree_delete (&a->meta, *it, true);
+	}
+	r_pvector_clear (&nodes);
 }
 
-static bool meta_inrange_add(RAnal *a, ut64 addr, int size) {
-	if (size <= 0) {
-		return false;
+static void meta_reset(RAnal *a) {
+	r_interval_tree_fini (&a->meta);
+	r_interval_tree_init (&a->meta, r_meta_item_free);
+}
+
+static RAnalMetaItem *meta_item_dup(const RAnalMetaItem *it) {
+	RAnalMetaItem *mi = r_mem_dup (it, sizeof (RAnalMetaItem));
+	if (mi && it->str) {
+		mi->str = strdup (it->str);
 	}
-	bool set = false;
-	ut64 base, base2;
-	base = META_RANGE_BASE (addr);
-	base2 = META_RANGE_BASE (addr + size - 1);
-	for (; base <= base2; base++) {
-		const char *key = sdb_fmt ("range.0x%"PFMT64x, base);
-		if (sdb_array_add_num (DB, key, addr, 0)) {
-			set = true;
+	return mi;
+}
+
+// the item of type at addr, or the first one listed there for R_META_TYPE_ANY
+R_API const RAnalMetaItem *r_meta_get_at(RAnal *a, ut64 addr, int type) {
+	if (type != R_META_TYPE_ANY) {
+		RIntervalNode *node = meta_node_find (a, type, addr);
+		return node? &((MetaNode *)node->data)->item: NULL;
+	}
+	MetaNode *best = NULL;
+	RBIter it = r_interval_tree_first_at (&a->meta, addr);
+	while (r_rbtree_iter_has (&it)) {
+		RIntervalNode *node = r_rbtree_iter_get (&it, RIntervalNode, node);
+		if (node->start != addr) {
+			break;
+		}
+		MetaNode *mn = node->data;
+		if (mn->seq && (!best || mn->seq < best->seq)) {
+			best = mn;
 		}
+		r_rbtree_iter_next (&it);
 	}
-	return set;
+	return best? &best->item: NULL;
 }
 
-static bool meta_inrange_del(RAnal *a, ut64 addr, int size) {
-	if (size <= 0) {
-		return false;
+static int meta_seq_cmp(const void *a, const void *b) {
+	const MetaNode *ma = a, *mb = b;
+	return ma->seq < mb->seq? -1: ma->seq > mb->seq;
+}
+
+// the items listed at addr, in the order of meta.<addr>
+R_API RPVector *r_meta_get_all_at(RAnal *a, ut64 addr) {
+	RPVector *items = r_pvector_new (NULL);
+	if (!items) {
+		return NULL;
 	}
-	bool set = false;
-	ut64 base = META_RANGE_BASE (addr);
-	ut64 base2 = META_RANGE_BASE (addr + size - 1);
-	for (; base <= base2; base++) {
-		const char *key = sdb_fmt ("range.0x%"PFMT64x, base);
-		if (sdb_array_remove_num (DB, key, addr, 0)) {
-			set = true;
+	RBIter it = r_interval_tree_first_at (&a->meta, addr);
+	while (r_rbtree_iter_has (&it)) {
+		RIntervalNode *node = r_rbtree_iter_get (&it, RIntervalNode, node);
+		if (node->start != addr) {
+			break;
+		}
+		MetaNode *mn = node->data;
+		if (mn->seq) {
+			r_pvector_push (items, mn);
 		}
+		r_rbtree_iter_next (&it);
 	}
-	return set;
+	r_pvector_sort (items, meta_seq_cmp);
+	return items;
 }
 
 // 512 = 1.5s
@@ -114,7 +218,6 @@ R_API bool r_meta_set_string(RAnal *a, int type, ut64 addr, const char *s) {
 	size = sdb_array_get_num (DB, key, 0, 0);
 	if (!size) {
 		size = strlen (s);
-		meta_inrange_add (a, addr, size);
 		ret = true;
 	} else {
 		ret = false;
@@ -129,6 +232,7 @@ R_API bool r_meta_set_string(RAnal *a, int type, ut64 addr, const char *s) {
 	snprintf (val, sizeof (val) - 1, "%d,%s,%s", (int)size, space, z);
 	sdb_set (DB, key, val, 0);
 	free (z);
+	meta_node_set (a, type, 0, addr, size, s, r_spaces_current (&a->meta_spaces));
 
 	/* send event */
 	REventMeta rems = {
@@ -153,7 +257,6 @@ R_API bool r_meta_set_var_comment(RAnal *a, int type, ut64 idx, ut64 addr, const
 	size = sdb_array_get_num (DB, key, 0, 0);
 	if (!size) {
 		size = strlen (s);
-		meta_inrange_add (a, addr, size);
 		ret = true;
 	} else {
 		ret = false;
@@ -166,30 +269,8 @@ R_API bool r_meta_set_var_comment(RAnal *a, int type, ut64 idx, ut64 addr, const
 }
 
 R_API char *r_meta_get_string(RAnal *a, int type, ut64 addr) {
-	char key[100];
-	const char *k, *p, *p2, *p3;
-	snprintf (key, sizeof (key)-1, "meta.%c.0x%"PFMT64x, type, addr);
-	k = sdb_const_get (DB, key, NULL);
-	if (!k) {
-		return NULL;
-	}
-	p = strchr (k, SDB_RS);
-	if (!p) {
-		return NULL;
-	}
-	k = p + 1;
-	p2 = strchr (k, SDB_RS);
-	if (!p2) {
-		return (char *)sdb_decode (k, NULL);
-	}
-	k = p2 + 1;
-	if (type == R_META_TYPE_STRING) {
-		p3 = strchr (k, SDB_RS);
-		if (p3) {
-			return (char *)sdb_decode (p3 + 1, NULL);
-		}
-	}
-	return (char *)sdb_decode (k, NULL);
+	const RAnalMetaItem *mi = r_meta_get_at (a, addr, type);
+	return (mi && mi->str)? strdup (mi->str): NULL;
 }
 
 R_API char *r_meta_get_var_comment (RAnal *a, int type, ut64 idx, ut64 addr) {
@@ -212,19 +293,6 @@ R_API char *r_meta_get_var_comment (RAnal *a, int type, ut64 idx, ut64 addr) {
 	return (char *)sdb_decode (p2+1, NULL);
 }
 
-static bool mustDeleteMetaEntry(RAnal *a, ut64 addr) {
-	const char *tt = sdb_const_get (DB, sdb_fmt ("meta.t.0x%"PFMT64x, addr), NULL);
-	const char *ss = sdb_const_get (DB, sdb_fmt ("meta.s.0x%"PFMT64x, addr), NULL);
-	const char *dd = sdb_const_get (DB, sdb_fmt ("meta.d.0x%"PFMT64x, addr), NULL);
-	const char *cc = sdb_const_get (DB, sdb_fmt ("meta.C.0x%"PFMT64x, addr), NULL);
-	int count = 0;
-	if (tt) count++;
-	if (ss) count++;
-	if (dd) count++;
-	if (cc) count++;
-	return (count == 0);
-}
-
 // delete all the metas of a specific type, addr is ignored,
 static void r_meta_del_cb(RAnal *a, int type, int rad, SdbForeachCallback cb, void *user, ut64 addr) {
 	SdbList *ls = sdb_foreach_list (DB, true);
@@ -253,8 +321,10 @@ R_API int r_meta_del(RAnal *a, int type, ut64 addr, ut64 size) {
 		// XXX: this thing ignores the type
 		if (type == R_META_TYPE_ANY) {
 			sdb_reset (DB);
+			meta_reset (a);
 		} else {
 			r_meta_del_cb (a, type, type, NULL, NULL, UT64_MAX);
+			meta_del_type (a, type);
 		}
 		return false;
 	}
@@ -282,6 +352,7 @@ R_API int r_meta_del(RAnal *a, int type, ut64 addr, ut64 size) {
 				}
 			}
 			sdb_unset (DB, key, 0);
+			meta_sync_at (a, addr);
 			return false;
 		}
 		if (strchr (val, ',')) {
@@ -301,9 +372,7 @@ R_API int r_meta_del(RAnal *a, int type, ut64 addr, ut64 size) {
 		sdb_unset (DB, key, 0);
 	}
 	sdb_unset (DB, key, 0);
-	if (mustDeleteMetaEntry (a, addr)) {
-		meta_inrange_del (a, addr, size);
-	}
+	meta_sync_at (a, addr);
 	return false;
 }
 
@@ -430,7 +499,9 @@ static int meta_add(RAnal *a, int type, int subtype, ut64 from, ut64 to, const c
 	val[0] = type;
 	val[1] = '\0';
 	sdb_array_add (DB, key, val, 0);
-	meta_inrange_add (a, from, to - from);
+	// adding an existing type reorders the list
+	meta_node_set (a, type, subtype, from, to - from, str, space);
+	meta_sync_at (a, from);
 	return true;
 }
 
@@ -443,42 +514,26 @@ R_API int r_meta_add_with_subtype(RAnal *a, int type, int subtype, ut64 from, ut
 }
 
 static RAnalMetaItem *r_meta_find_(RAnal *a, ut64 at, int type, int where, int excl_type) {
-	const char *infos, *metas;
-	char key[100];
-	Sdb *s = a->sdb_meta;
-	RAnalMetaItem *mi = NULL;
 	if (where != R_META_WHERE_HERE) {
 		eprintf ("THIS WAS NOT SUPPOSED TO HAPPEN\n");
 		return NULL;
 	}
-
-	snprintf (key, sizeof (key), "meta.0x%" PFMT64x, at);
-	infos = sdb_const_get (s, key, 0);
-	if (!infos) {
-		return NULL;
-	}
-	mi =  R_NEW0 (RAnalMetaItem);
-	for (; *infos; infos++) {
-		if (*infos == ',') {
-			continue;
-		}
-		if (type != R_META_TYPE_ANY && type != *infos) {
-			continue;
+	MetaNode *best = NULL;
+	RBIter it = r_interval_tree_first_at (&a->meta, at);
+	while (r_rbtree_iter_has (&it)) {
+		RIntervalNode *node = r_rbtree_iter_get (&it, RIntervalNode, node);
+		if (node->start != at) {
+			break;
 		}
-		if (excl_type && excl_type == *infos) {
-			continue;
-		}
-		snprintf (key, sizeof (key), "meta.%c.0x%" PFMT64x, *infos, at);
-		metas = sdb_const_get (s, key, 0);
-		if (metas) {
-			if (!r_meta_deserialize_val (a, mi, *infos, at, metas)) {
-				continue;
-			}
-			return mi;
+		MetaNode *mn = node->data;
+		if (mn->seq && (type == R_META_TYPE_ANY || type == mn->item.type)
+				&& (!excl_type || excl_type != mn->item.type)
+				&& (!best || mn->seq < best->seq)) {
+			best = mn;
 		}
+		r_rbtree_iter_next (&it);
 	}
-	r_meta_item_free (mi);
-	return NULL;
+	return best? meta_item_dup (&best->item): NULL;
 }
 
 // TODO should be named get imho
@@ -490,71 +545,61 @@ R_API RAnalMetaItem *r_meta_find_any_except(RAnal *a, ut64 at, int type, int whe
 	return r_meta_find_ (a, at, R_META_TYPE_ANY, where, type);
 }
 
-R_API RAnalMetaItem *r_meta_find_in(RAnal *a, ut64 at, int type, int where) {
-	char *res = meta_inrange_get (a, at, 1);
-	if (!res) {
-		return NULL;
+typedef struct {
+	int type;
+	MetaNode *best;
+	RPVector *nodes;
+} MetaInCtx;
+
+static void meta_in_cb(RIntervalNode *node, void *user) {
+	MetaInCtx *ctx = user;
+	MetaNode *mn = node->data;
+	if (!mn->seq || (ctx->type != R_META_TYPE_ANY && ctx->type != mn->item.type)) {
+		return;
 	}
-	RList *list = r_str_split_list (res, ",", 0);
-	RListIter *iter;
-	const char *meta;
-	r_list_foreach (list, iter, meta) {
-		ut64 mia = r_num_math (NULL, meta);
-		RAnalMetaItem *mi = r_meta_find (a, mia, type, where);
-		if (mi) {
-			if ((at >= mi->from && at < mi->to)) {
-				free (res);
-				return mi;
-			}
-			r_meta_item_free (mi);
-		}
+	if (!ctx->best || mn->seq < ctx->best->seq) {
+		ctx->best = mn;
 	}
-	r_list_free (list);
-	free (res);
-	return NULL;
+	if (ctx->nodes) {
+		r_pvector_push (ctx->nodes, mn);
+	}
+}
+
+static int meta_in_cmp(const void *a, const void *b) {
+	const MetaNode *ma = a, *mb = b;
+	if (ma->item.from != mb->item.from) {
+		return ma->item.from < mb->item.from? -1: 1;
+	}
+	return meta_seq_cmp (a, b);
 }
 
+R_API RAnalMetaItem *r_meta_find_in(RAnal *a, ut64 at, int type, int where) {
+	MetaInCtx ctx = { type };
+	r_interval_tree_all_in (&a->meta, at, false, meta_in_cb, &ctx);
+	return ctx.best? meta_item_dup (&ctx.best->item): NULL;
+}
+
+// all the listed metas covering at, by start address
 R_API RList *r_meta_find_list_in(RAnal *a, ut64 at, int type, int where) {
-	char *res = meta_inrange_get (a, at, 1);
-	if (!res) {
+	RPVector nodes;
+	MetaInCtx ctx = { R_META_TYPE_ANY, NULL, &nodes };
+	void **it;
+	r_pvector_init (&nodes, NULL);
+	r_interval_tree_all_in (&a->meta, at, false, meta_in_cb, &ctx);
+	if (r_pvector_empty (&nodes)) {
 		return NULL;
 	}
-	RList *list = r_str_split_list (res, ",", 0);
+	r_pvector_sort (&nodes, meta_in_cmp);
 	RList *out = r_list_newf (r_meta_item_free);
-	if (!out) {
-		return NULL;
-	}
-	RListIter *iter;
-	const char *meta;
-	r_list_foreach (list, iter, meta) {
-		Sdb *s = a->sdb_meta;
-		ut64 mia = r_num_math (NULL, meta);
-		const char *key = sdb_fmt ("meta.0x%" PFMT64x, mia);
-		const char *infos = sdb_const_get (s, key, 0);
-		if (!infos) {
-			continue;
-		}
-		for (; *infos; infos++) {
-			if (*infos == ',') {
-				continue;
-			}
-			const char *key = sdb_fmt ("meta.%c.0x%" PFMT64x, *infos, mia);
-			const char *metas = sdb_const_get (s, key, 0);
-			if (metas) {
-				RAnalMetaItem *mi = R_NEW0 (RAnalMetaItem);
-				if (mi) {
-					if (r_meta_deserialize_val (a, mi, *infos, mia, metas) &&
-						(at >= mi->from && at < mi->to)) {
-						r_list_append (out, mi);
-					} else {
-						r_meta_item_free (mi);
-					}
-				}
+	if (out) {
+		r_pvector_foreach (&nodes, it) {
+			RAnalMetaItem *mi = meta_item_dup (&((MetaNode *)*it)->item);
+			if (mi) {
+				r_list_append (out, mi);
 			}
 		}
 	}
-	r_list_free (list);
-	free (res);
+	r_pvector_clear (&nodes);
 	return out;
 }
 
@@ -955,6 +1000,10 @@ static int meta_unset_cb(void *user, const char *k, const char *v) {
 		it.space = NULL;
 		meta_serialize (&it, nk, sizeof (nk), nv, sizeof (nv));
 		sdb_set (DB, nk, nv, 0);
+		RIntervalNode *node = meta_node_find (a, it.type, it.from);
+		if (node) {
+			((MetaNode *)node->data)->item.space = NULL;
+		}
 	}
 	return 1;
 }
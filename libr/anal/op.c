@@ -131,6 +131,10 @@ static int defaultCycles(RAnalOp *op) {
 	}
 }
 
+/* Thread-safety: the decoder state of the plugins lives in anal->plugin_data,
+ * so r_anal_op can run concurrently on different RAnal instances, each one
+ * owned by a single thread. Calls on the same RAnal must be serialized: the
+ * plugin state, anal->reg and the coreb.archbits callback are not locked. */
 R_API int r_anal_op(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *data, int len, RAnalOpMask mask) {
 	r_anal_op_init (op);
 	r_return_val_if_fail (anal && op && len > 0, -1);
@@ -16,10 +16,14 @@
 #if CAPSTONE_HAS_MOS65XX
 #include <capstone/mos65xx.h>
 
-static csh handle = 0;
+// per RAnal instance decoder state, see RAnalPlugin.data_new
+typedef struct {
+	csh handle;
+	int omode;
+} CapstoneContext;
 
 static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask) {
-	static int omode = 0;
+	CapstoneContext *ctx = a->plugin_data;
 #if USE_ITER_API
 	static
 #endif
@@ -27,15 +31,18 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 	int mode = 0;
 	int n, ret;
 
-	if (handle && mode != omode) {
-		cs_close (&handle);
-		handle = 0;
+	if (!ctx) {
+		return -1;
 	}
-	omode = mode;
-	if (handle == 0) {
-		ret = cs_open (CS_ARCH_MOS65XX, mode, &handle);
+	if (ctx->handle && mode != ctx->omode) {
+		cs_close (&ctx->handle);
+		ctx->handle = 0;
+	}
+	ctx->omode = mode;
+	if (ctx->handle == 0) {
+		ret = cs_open (CS_ARCH_MOS65XX, mode, &ctx->handle);
 		if (ret != CS_ERR_OK) {
-			handle = 0;
+			ctx->handle = 0;
 			return 0;
 		}
 	}
@@ -51,20 +58,20 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 	op->size = 0;
 	op->delay = 0;
 	r_strbuf_init (&op->esil);
-	cs_option (handle, CS_OPT_DETAIL, CS_OPT_ON);
+	cs_option (ctx->handle, CS_OPT_DETAIL, CS_OPT_ON);
 	// capstone-next
 #if USE_ITER_API
 	{
 		ut64 naddr = addr;
 		size_t size = len;
 		if (!insn) {
-			insn = cs_malloc (handle);
+			insn = cs_malloc (ctx->handle);
 		}
-		n = cs_disasm_iter (handle, (const uint8_t**)&buf,
+		n = cs_disasm_iter (ctx->handle, (const uint8_t**)&buf,
 			&size, (uint64_t*)&naddr, insn);
 	}
 #else
-	n = cs_disasm (handle, (const ut8*)buf, len, addr, 1, &insn);
+	n = cs_disasm (ctx->handle, (const ut8*)buf, len, addr, 1, &insn);
 #endif
 	if (n < 1) {
 		op->type = R_ANAL_OP_TYPE_ILL;
@@ -179,6 +186,18 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 	return op->size;
 }
 
+static void *data_new(RAnal *anal) {
+	return R_NEW0 (CapstoneContext);
+}
+
+static void data_free(void *data) {
+	CapstoneContext *ctx = data;
+	if (ctx && ctx->handle) {
+		cs_close (&ctx->handle);
+	}
+	free (ctx);
+}
+
 static int set_reg_profile(RAnal *anal) {
 	char *p =
 		"=PC	pc\n"
@@ -209,6 +228,8 @@ RAnalPlugin r_anal_plugin_6502_cs = {
 	.arch = "6502",
 	.bits = 8,
 	.op = &analop,
+	.data_new = data_new,
+	.data_free = data_free,
 	.set_reg_profile = &set_reg_profile,
 };
 
@@ -58,8 +58,15 @@
 #define ISPREINDEX64() ((OPCOUNT64() == 3) && (ISMEM64(2)) && (ISWRITEBACK64()))
 #define ISPOSTINDEX64() ((OPCOUNT64() == 4) && (ISIMM64(3)) && (ISWRITEBACK64()))
 
-static RRegItem base_regs[4];
-static RRegItem regdelta_regs[4];
+// per RAnal instance decoder state, see RAnalPlugin.data_new
+typedef struct {
+	csh handle;
+	int omode;
+	int obits;
+	// op->src/dst registers point here, valid until the next analop call
+	RRegItem base_regs[4];
+	RRegItem regdelta_regs[4];
+} CapstoneContext;
 
 static const ut64 bitmask_by_width[] = {
 	0x1, 0x3, 0x7, 0xf, 0x1f, 0x3f, 0x7f, 0xff, 0x1ff, 0x3ff, 0x7ff,
@@ -3018,13 +3025,13 @@ static void set_opdir(RAnalOp *op) {
         }
 }
 
-static void set_src_dst(RAnalValue *val, csh *handle, cs_insn *insn, int x, int bits) {
+static void set_src_dst(CapstoneContext *ctx, RAnalValue *val, cs_insn *insn, int x, int bits) {
 	cs_arm_op armop = INSOP (x);
 	cs_arm64_op arm64op = INSOP64 (x);
 	if (bits == 64) {
-		parse_reg64_name (&base_regs[x], &regdelta_regs[x], *handle, insn, x);
+		parse_reg64_name (&ctx->base_regs[x], &ctx->regdelta_regs[x], ctx->handle, insn, x);
 	} else {
-		parse_reg_name (&base_regs[x], &regdelta_regs[x], *handle, insn, x);
+		parse_reg_name (&ctx->base_regs[x], &ctx->regdelta_regs[x], ctx->handle, insn, x);
 	}
 	switch (armop.type) {
 	case ARM_OP_REG:
@@ -3036,31 +3043,26 @@ static void set_src_dst(RAnalValue *val, csh *handle, cs_insn *insn, int x, int
 			val->mul = armop.mem.scale;
 			val->delta = armop.mem.disp;
 		}
-		val->regdelta = &regdelta_regs[x];
+		val->regdelta = &ctx->regdelta_regs[x];
 		break;
 	default:
 		break;
 	}
-	val->reg = &base_regs[x];
+	val->reg = &ctx->base_regs[x];
 }
 
-static void create_src_dst(RAnalOp *op) {
+static void create_src_dst(CapstoneContext *ctx, RAnalOp *op) {
 	op->src[0] = r_anal_value_new ();
 	op->src[1] = r_anal_value_new ();
 	op->src[2] = r_anal_value_new ();
 	op->dst = r_anal_value_new ();
-	ZERO_FILL (base_regs[0]);
-	ZERO_FILL (base_regs[1]);
-	ZERO_FILL (base_regs[2]);
-	ZERO_FILL (base_regs[3]);
-	ZERO_FILL (regdelta_regs[0]);
-	ZERO_FILL (regdelta_regs[1]);
-	ZERO_FILL (regdelta_regs[2]);
-	ZERO_FILL (regdelta_regs[3]);
+	ZERO_FILL (ctx->base_regs);
+	ZERO_FILL (ctx->regdelta_regs);
 }
 
-static void op_fillval(RAnalOp *op , csh handle, cs_insn *insn, int bits) {
-	create_src_dst (op);
+static void op_fillval(CapstoneContext *ctx, RAnalOp *op, cs_insn *insn, int bits) {
+	csh handle = ctx->handle;
+	create_src_dst (ctx, op);
 	switch (op->type & R_ANAL_OP_TYPE_MASK) {
 	case R_ANAL_OP_TYPE_LOAD:
 	case R_ANAL_OP_TYPE_MOV:
@@ -3071,14 +3073,14 @@ static void op_fillval(RAnalOp *op , csh handle, cs_insn *insn, int bits) {
 	case R_ANAL_OP_TYPE_MUL:
 	case R_ANAL_OP_TYPE_CMP:
 	case R_ANAL_OP_TYPE_OR:
-		set_src_dst (op->src[2], &handle, insn, 3, bits);
-		set_src_dst (op->src[1], &handle, insn, 2, bits);
-		set_src_dst (op->src[0], &handle, insn, 1, bits);
-		set_src_dst (op->dst, &handle, insn, 0, bits);
+		set_src_dst (ctx, op->src[2], insn, 3, bits);
+		set_src_dst (ctx, op->src[1], insn, 2, bits);
+		set_src_dst (ctx, op->src[0], insn, 1, bits);
+		set_src_dst (ctx, op->dst, insn, 0, bits);
 		break;
 	case R_ANAL_OP_TYPE_STORE:
-		set_src_dst (op->dst, &handle, insn, 1, bits);
-		set_src_dst (op->src[0], &handle, insn, 0, bits);
+		set_src_dst (ctx, op->dst, insn, 1, bits);
+		set_src_dst (ctx, op->src[0], insn, 0, bits);
 		break;
 	default:
 		break;
@@ -3092,9 +3094,7 @@ static void op_fillval(RAnalOp *op , csh handle, cs_insn *insn, int bits) {
 }
 
 static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask) {
-	static csh handle = 0;
-	static int omode = -1;
-	static int obits = 32;
+	CapstoneContext *ctx = a->plugin_data;
 	cs_insn *insn = NULL;
 	int mode = (a->bits==16)? CS_MODE_THUMB: CS_MODE_ARM;
 	int n, ret;
@@ -3102,12 +3102,14 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 	if (a->cpu && strstr (a->cpu, "cortex")) {
 		mode |= CS_MODE_MCLASS;
 	}
-
-	if (mode != omode || a->bits != obits) {
-		cs_close (&handle);
-		handle = 0; // unnecessary
-		omode = mode;
-		obits = a->bits;
+	if (!ctx) {
+		return -1;
+	}
+	if (mode != ctx->omode || a->bits != ctx->obits) {
+		cs_close (&ctx->handle);
+		ctx->handle = 0; // unnecessary
+		ctx->omode = mode;
+		ctx->obits = a->bits;
 	}
 	op->type = R_ANAL_OP_TYPE_NULL; // SHOULD BE ILL but this makes some stuff to fail
 	op->size = (a->bits==16)? 2: 4;
@@ -3118,13 +3120,13 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 	op->ptr = op->val = -1;
 	op->refptr = 0;
 	r_strbuf_init (&op->esil);
-	if (handle == 0) {
+	if (ctx->handle == 0) {
 		ret = (a->bits == 64)?
-			cs_open (CS_ARCH_ARM64, mode, &handle):
-			cs_open (CS_ARCH_ARM, mode, &handle);
-		cs_option (handle, CS_OPT_DETAIL, CS_OPT_ON);
+			cs_open (CS_ARCH_ARM64, mode, &ctx->handle):
+			cs_open (CS_ARCH_ARM, mode, &ctx->handle);
+		cs_option (ctx->handle, CS_OPT_DETAIL, CS_OPT_ON);
 		if (ret != CS_ERR_OK) {
-			handle = 0;
+			ctx->handle = 0;
 			return -1;
 		}
 	}
@@ -3133,7 +3135,7 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 		return haa;
 	}
 
-	n = cs_disasm (handle, (ut8*)buf, len, addr, 1, &insn);
+	n = cs_disasm (ctx->handle, (ut8*)buf, len, addr, 1, &insn);
 	if (n < 1) {
 		op->type = R_ANAL_OP_TYPE_ILL;
 		if (mask & R_ANAL_OP_MASK_DISASM) {
@@ -3151,32 +3153,43 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 		op->size = insn->size;
 		op->id = insn->id;
 		if (a->bits == 64) {
-			anop64 (handle, op, insn);
+			anop64 (ctx->handle, op, insn);
 			if (mask & R_ANAL_OP_MASK_OPEX) {
-				opex64 (&op->opex, handle, insn);
+				opex64 (&op->opex, ctx->handle, insn);
 			}
 			if (mask & R_ANAL_OP_MASK_ESIL) {
-				analop64_esil (a, op, addr, buf, len, &handle, insn);
+				analop64_esil (a, op, addr, buf, len, &ctx->handle, insn);
 			}
 		} else {
-			anop32 (a, handle, op, insn, thumb, (ut8*)buf, len);
+			anop32 (a, ctx->handle, op, insn, thumb, (ut8*)buf, len);
 			if (mask & R_ANAL_OP_MASK_OPEX) {
-				opex (&op->opex, handle, insn);
+				opex (&op->opex, ctx->handle, insn);
 			}
 			if (mask & R_ANAL_OP_MASK_ESIL) {
-				analop_esil (a, op, addr, buf, len, &handle, insn, thumb);
+				analop_esil (a, op, addr, buf, len, &ctx->handle, insn, thumb);
 			}
 		}
 		set_opdir (op);
 		if (mask & R_ANAL_OP_MASK_VAL) {
-			op_fillval (op, handle, insn, a->bits);
+			op_fillval (ctx, op, insn, a->bits);
 		}
 		cs_free (insn, n);
 	}
-//		cs_close (&handle);
 	return op->size;
 }
 
+static void *data_new(RAnal *anal) {
+	return R_NEW0 (CapstoneContext);
+}
+
+static void data_free(void *data) {
+	CapstoneContext *ctx = data;
+	if (ctx && ctx->handle) {
+		cs_close (&ctx->handle);
+	}
+	free (ctx);
+}
+
 static char *get_reg_profile(RAnal *anal) {
 	const char *p;
 	if (anal->bits == 64) {
@@ -3655,6 +3668,8 @@ RAnalPlugin r_anal_plugin_arm_cs = {
 	.preludes = anal_preludes,
 	.bits = 16 | 32 | 64,
 	.op = &analop,
+	.data_new = data_new,
+	.data_free = data_free,
 };
 
 #ifndef R2_PLUGIN_INCORE
@@ -59,31 +59,39 @@ static int m680xmode(const char *str) {
 #define IMM(x) insn->detail->m680x.operands[x].imm
 #define REL(x) insn->detail->m680x.operands[x].rel
 
+// per RAnal instance decoder state, see RAnalPlugin.data_new
+typedef struct {
+	csh handle;
+	int omode;
+	int obits;
+} CapstoneContext;
+
 static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask) {
 	int n, ret, opsize = -1;
-	static csh handle = 0;
-	static int omode = -1;
-	static int obits = 32;
+	CapstoneContext *ctx = a->plugin_data;
 	cs_insn* insn;
 
 	int mode = m680xmode (a->cpu);
 
-	if (mode != omode || a->bits != obits) {
-		cs_close (&handle);
-		handle = 0;
-		omode = mode;
-		obits = a->bits;
+	if (!ctx) {
+		return -1;
+	}
+	if (mode != ctx->omode || a->bits != ctx->obits) {
+		cs_close (&ctx->handle);
+		ctx->handle = 0;
+		ctx->omode = mode;
+		ctx->obits = a->bits;
 	}
 	op->delay = 0;
 	op->size = 4;
-	if (handle == 0) {
-		ret = cs_open (CS_ARCH_M680X, mode, &handle);
+	if (ctx->handle == 0) {
+		ret = cs_open (CS_ARCH_M680X, mode, &ctx->handle);
 		if (ret != CS_ERR_OK) {
 			goto fin;
 		}
-		cs_option (handle, CS_OPT_DETAIL, CS_OPT_ON);
+		cs_option (ctx->handle, CS_OPT_DETAIL, CS_OPT_ON);
 	}
-	n = cs_disasm (handle, (ut8*)buf, len, addr, 1, &insn);
+	n = cs_disasm (ctx->handle, (ut8*)buf, len, addr, 1, &insn);
 	if (n < 1 || insn->size < 1) {
 		op->type = R_ANAL_OP_TYPE_ILL;
 		op->size = 2;
@@ -517,6 +525,18 @@ fin:
 	return opsize;
 }
 
+static void *data_new(RAnal *anal) {
+	return R_NEW0 (CapstoneContext);
+}
+
+static void data_free(void *data) {
+	CapstoneContext *ctx = data;
+	if (ctx && ctx->handle) {
+		cs_close (&ctx->handle);
+	}
+	free (ctx);
+}
+
 // XXX 
 static int set_reg_profile(RAnal *anal) {
 	const char *p = \
@@ -540,6 +560,8 @@ RAnalPlugin r_anal_plugin_m680x_cs = {
 	.set_reg_profile = &set_reg_profile,
 	.bits = 16 | 32,
 	.op = &analop,
+	.data_new = data_new,
+	.data_free = data_free,
 };
 #else
 RAnalPlugin r_anal_plugin_m680x_cs = {
@@ -128,28 +128,37 @@ static int parse_reg_name(RRegItem *reg, csh handle, cs_insn *insn, int reg_num)
 	return 0;
 }
 
-static void op_fillval(RAnalOp *op, csh handle, cs_insn *insn) {
-	static RRegItem reg;
+// per RAnal instance decoder state, see RAnalPlugin.data_new
+typedef struct {
+	csh handle;
+	int omode;
+	int obits;
+	RRegItem reg;
+} CapstoneContext;
+
+static void op_fillval(CapstoneContext *ctx, RAnalOp *op, cs_insn *insn) {
+	csh handle = ctx->handle;
+	RRegItem *reg = &ctx->reg;
 	switch (op->type & R_ANAL_OP_TYPE_MASK) {
 	case R_ANAL_OP_TYPE_MOV:
-		ZERO_FILL (reg);
+		ZERO_FILL (*reg);
 		if (OPERAND(1).type == M68K_OP_MEM) {
 			op->src[0] = r_anal_value_new ();
-			op->src[0]->reg = &reg;
+			op->src[0]->reg = reg;
 			parse_reg_name (op->src[0]->reg, handle, insn, 1);
 			op->src[0]->delta = OPERAND(0).mem.disp;
 		} else if (OPERAND(0).type == M68K_OP_MEM) {
 			op->dst = r_anal_value_new ();
-			op->dst->reg = &reg;
+			op->dst->reg = reg;
 			parse_reg_name (op->dst->reg, handle, insn, 0);
 			op->dst->delta = OPERAND(1).mem.disp;
 		}
 		break;
 	case R_ANAL_OP_TYPE_LEA:
-		ZERO_FILL (reg);
+		ZERO_FILL (*reg);
 		if (OPERAND(1).type == M68K_OP_MEM) {
 			op->dst = r_anal_value_new ();
-			op->dst->reg = &reg;
+			op->dst->reg = reg;
 			parse_reg_name (op->dst->reg, handle, insn, 1);
 			op->dst->delta = OPERAND(1).mem.disp;
 		}
@@ -159,21 +168,22 @@ static void op_fillval(RAnalOp *op, csh handle, cs_insn *insn) {
 
 static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask) {
 	int n, ret, opsize = -1;
-	static csh handle = 0;
-	static int omode = -1;
-	static int obits = 32;
+	CapstoneContext *ctx = a->plugin_data;
 	cs_insn* insn;
 	cs_m68k *m68k;
 	cs_detail *detail;
 
 	int mode = a->big_endian? CS_MODE_BIG_ENDIAN: CS_MODE_LITTLE_ENDIAN;
 
+	if (!ctx) {
+		return -1;
+	}
 	//mode |= (a->bits==64)? CS_MODE_64: CS_MODE_32;
-	if (mode != omode || a->bits != obits) {
-		cs_close (&handle);
-		handle = 0;
-		omode = mode;
-		obits = a->bits;
+	if (mode != ctx->omode || a->bits != ctx->obits) {
+		cs_close (&ctx->handle);
+		ctx->handle = 0;
+		ctx->omode = mode;
+		ctx->obits = a->bits;
 	}
 // XXX no arch->cpu ?!?! CS_MODE_MICRO, N64
 	op->delay = 0;
@@ -197,14 +207,14 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 		mode |= CS_MODE_M68K_060;
 	}
 	op->size = 4;
-	if (handle == 0) {
-		ret = cs_open (CS_ARCH_M68K, mode, &handle);
+	if (ctx->handle == 0) {
+		ret = cs_open (CS_ARCH_M68K, mode, &ctx->handle);
 		if (ret != CS_ERR_OK) {
 			goto fin;
 		}
-		cs_option (handle, CS_OPT_DETAIL, CS_OPT_ON);
+		cs_option (ctx->handle, CS_OPT_DETAIL, CS_OPT_ON);
 	}
-	n = cs_disasm (handle, (ut8*)buf, len, addr, 1, &insn);
+	n = cs_disasm (ctx->handle, (ut8*)buf, len, addr, 1, &insn);
 	if (n < 1 || insn->size < 1) {
 		op->type = R_ANAL_OP_TYPE_ILL;
 		op->size = 2;
@@ -224,7 +234,7 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 	op->id = insn->id;
 	opsize = op->size = insn->size;
 	if (mask & R_ANAL_OP_MASK_OPEX) {
-		opex (&op->opex, handle, insn);
+		opex (&op->opex, ctx->handle, insn);
 	}
 	switch (insn->id) {
 	case M68K_INS_INVALID:
@@ -696,7 +706,7 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 		break;
 	}
 	if (mask & R_ANAL_OP_MASK_VAL) {
-		op_fillval (op, handle, insn);
+		op_fillval (ctx, op, insn);
 	}
 beach:
 	cs_free (insn, n);
@@ -705,6 +715,18 @@ fin:
 	return opsize;
 }
 
+static void *data_new(RAnal *anal) {
+	return R_NEW0 (CapstoneContext);
+}
+
+static void data_free(void *data) {
+	CapstoneContext *ctx = data;
+	if (ctx && ctx->handle) {
+		cs_close (&ctx->handle);
+	}
+	free (ctx);
+}
+
 static int set_reg_profile(RAnal *anal) {
 	const char *p = \
 		"=PC    pc\n"
@@ -772,6 +794,8 @@ RAnalPlugin r_anal_plugin_m68k_cs = {
 	.set_reg_profile = &set_reg_profile,
 	.bits = 32,
 	.op = &analop,
+	.data_new = data_new,
+	.data_free = data_free,
 };
 #else
 RAnalPlugin r_anal_plugin_m68k_cs = {
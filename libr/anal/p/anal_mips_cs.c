@@ -604,24 +604,33 @@ static int parse_reg_name(RRegItem *reg, csh handle, cs_insn *insn, int reg_num)
 	return 0;
 }
 
-static void op_fillval(RAnal *anal, RAnalOp *op, csh *handle, cs_insn *insn) {
-	static RRegItem reg;
+// per RAnal instance decoder state, see RAnalPlugin.data_new
+typedef struct {
+	csh handle;
+	int omode;
+	int obits;
+	RRegItem reg;
+} CapstoneContext;
+
+static void op_fillval(RAnal *anal, RAnalOp *op, CapstoneContext *ctx, cs_insn *insn) {
+	csh handle = ctx->handle;
+	RRegItem *reg = &ctx->reg;
 	switch (op->type & R_ANAL_OP_TYPE_MASK) {
 	case R_ANAL_OP_TYPE_LOAD:
 		if (OPERAND(1).type == MIPS_OP_MEM) {
-			ZERO_FILL (reg);
+			ZERO_FILL (*reg);
 			op->src[0] = r_anal_value_new ();
-			op->src[0]->reg = &reg;
-			parse_reg_name (op->src[0]->reg, *handle, insn, 1);
+			op->src[0]->reg = reg;
+			parse_reg_name (op->src[0]->reg, handle, insn, 1);
 			op->src[0]->delta = OPERAND(1).mem.disp;
 		}
 		break;
 	case R_ANAL_OP_TYPE_STORE:
 		if (OPERAND(1).type == MIPS_OP_MEM) {
-			ZERO_FILL (reg);
+			ZERO_FILL (*reg);
 			op->dst = r_anal_value_new ();
-			op->dst->reg = &reg;
-			parse_reg_name (op->dst->reg, *handle, insn, 1);
+			op->dst->reg = reg;
+			parse_reg_name (op->dst->reg, handle, insn, 1);
 			op->dst->delta = OPERAND(1).mem.disp;
 		}
 		break;
@@ -704,9 +713,7 @@ static void set_opdir(RAnalOp *op) {
 
 static int analop(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask) {
 	int n, ret, opsize = -1;
-	static csh hndl = 0;
-	static int omode = -1;
-	static int obits = 32;
+	CapstoneContext *ctx = anal->plugin_data;
 	cs_insn* insn;
 	int mode = anal->big_endian? CS_MODE_BIG_ENDIAN: CS_MODE_LITTLE_ENDIAN;
 
@@ -724,11 +731,14 @@ static int analop(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *buf, int len,
 		}
 	}
 	mode |= (anal->bits==64)? CS_MODE_MIPS64: CS_MODE_MIPS32;
-	if (mode != omode || anal->bits != obits) {
-		cs_close (&hndl);
-		hndl = 0;
-		omode = mode;
-		obits = anal->bits;
+	if (!ctx) {
+		return -1;
+	}
+	if (mode != ctx->omode || anal->bits != ctx->obits) {
+		cs_close (&ctx->handle);
+		ctx->handle = 0;
+		ctx->omode = mode;
+		ctx->obits = anal->bits;
 	}
 // XXX no arch->cpu ?!?! CS_MODE_MICRO, N64
 	op->delay = 0;
@@ -738,14 +748,14 @@ static int analop(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *buf, int len,
 		return -1;
 	}
 	op->size = 4;
-	if (hndl == 0) {
-		ret = cs_open (CS_ARCH_MIPS, mode, &hndl);
+	if (ctx->handle == 0) {
+		ret = cs_open (CS_ARCH_MIPS, mode, &ctx->handle);
 		if (ret != CS_ERR_OK) {
 			goto fin;
 		}
-		cs_option (hndl, CS_OPT_DETAIL, CS_OPT_ON);
+		cs_option (ctx->handle, CS_OPT_DETAIL, CS_OPT_ON);
 	}
-	n = cs_disasm (hndl, (ut8*)buf, len, addr, 1, &insn);
+	n = cs_disasm (ctx->handle, (ut8*)buf, len, addr, 1, &insn);
 	if (n < 1 || insn->size < 1) {
 		if (mask & R_ANAL_OP_MASK_DISASM) {
 			op->mnemonic = strdup ("invalid");
@@ -1043,15 +1053,15 @@ static int analop(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *buf, int len,
 beach:
 	set_opdir (op);
 	if (insn && mask & R_ANAL_OP_MASK_OPEX) {
-		opex (&op->opex, hndl, insn);
+		opex (&op->opex, ctx->handle, insn);
 	}
 	if (mask & R_ANAL_OP_MASK_ESIL) {
-		if (analop_esil (anal, op, addr, buf, len, &hndl, insn) != 0) {
+		if (analop_esil (anal, op, addr, buf, len, &ctx->handle, insn) != 0) {
 			r_strbuf_fini (&op->esil);
 		}
 	}
 	if (mask & R_ANAL_OP_MASK_VAL) {
-		op_fillval (anal, op, &hndl, insn);
+		op_fillval (anal, op, ctx, insn);
 	}
 	cs_free (insn, n);
 	//cs_close (&handle);
@@ -1059,6 +1069,18 @@ fin:
 	return opsize;
 }
 
+static void *data_new(RAnal *anal) {
+	return R_NEW0 (CapstoneContext);
+}
+
+static void data_free(void *data) {
+	CapstoneContext *ctx = data;
+	if (ctx && ctx->handle) {
+		cs_close (&ctx->handle);
+	}
+	free (ctx);
+}
+
 static char *get_reg_profile(RAnal *anal) {
 	const char *p = NULL;
 	switch (anal->bits) {
@@ -1185,6 +1207,8 @@ RAnalPlugin r_anal_plugin_mips_cs = {
 	.preludes = anal_preludes,
 	.bits = 16|32|64,
 	.op = &analop,
+	.data_new = data_new,
+	.data_free = data_free,
 };
 
 #ifndef R2_PLUGIN_INCORE
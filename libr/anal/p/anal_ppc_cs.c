@@ -17,6 +17,10 @@ struct Getarg {
 	csh handle;
 	cs_insn *insn;
 	int bits;
+	// scratch space for the strings returned by getarg2, getspr and cmask
+	char words[8][64];
+	char cspr[16];
+	char cmask[32];
 };
 
 #define INSOPS insn->detail->ppc.op_count
@@ -39,8 +43,8 @@ static ut32 mask32(ut32 mb, ut32 me) {
 	return (mb <= me) ? maskmb & maskme : maskmb | maskme;
 }
 
-static const char* cmask64(const char *mb_c, const char *me_c) {
-	static char cmask[32];
+static const char* cmask64(struct Getarg *gop, const char *mb_c, const char *me_c) {
+	char *cmask = gop->cmask;
 	ut64 mb = 0;
 	ut64 me = 0;
 	if (mb_c) {
@@ -49,12 +53,12 @@ static const char* cmask64(const char *mb_c, const char *me_c) {
 	if (me_c) {
 		me = strtol (me_c, NULL, 16);
 	}
-	snprintf (cmask, sizeof (cmask), "0x%"PFMT64x"", mask64 (mb, me));
+	snprintf (cmask, sizeof (gop->cmask), "0x%"PFMT64x"", mask64 (mb, me));
 	return cmask;
 }
 
-static const char* cmask32(const char *mb_c, const char *me_c) {
-	static char cmask[32];
+static const char* cmask32(struct Getarg *gop, const char *mb_c, const char *me_c) {
+	char *cmask = gop->cmask;
 	ut32 mb = 0;
 	ut32 me = 0;
 	if (mb_c) {
@@ -63,7 +67,7 @@ static const char* cmask32(const char *mb_c, const char *me_c) {
 	if (me_c) {
 		me = strtol (me_c, NULL, 16);
 	}
-	snprintf (cmask, sizeof (cmask), "0x%"PFMT32x"", mask32 (mb, me));
+	snprintf (cmask, sizeof (gop->cmask), "0x%"PFMT32x"", mask32 (mb, me));
 	return cmask;
 }
 
@@ -91,7 +95,7 @@ static const char *getreg(struct Getarg *gop, int n) {
 static char *getarg2(struct Getarg *gop, int n, const char *setstr) {
 	cs_insn *insn = gop->insn;
 	csh handle = gop->handle;
-	static char words[8][64];
+	char (*words)[64] = gop->words;
 	cs_ppc_op op;
 
 	if (n < 0 || n >= 8) {
@@ -104,21 +108,21 @@ static char *getarg2(struct Getarg *gop, int n, const char *setstr) {
 		//strcpy (words[n], "invalid");
 		break;
 	case PPC_OP_REG:
-		snprintf (words[n], sizeof (words[n]),
+		snprintf (words[n], sizeof (gop->words[n]),
 				"%s%s", cs_reg_name (handle, op.reg), setstr);
 		break;
 	case PPC_OP_IMM:
-		snprintf (words[n], sizeof (words[n]),
+		snprintf (words[n], sizeof (gop->words[n]),
 				"0x%"PFMT64x"%s", (ut64) op.imm, setstr);
 		break;
 	case PPC_OP_MEM:
-		snprintf (words[n], sizeof (words[n]),
+		snprintf (words[n], sizeof (gop->words[n]),
 				"%"PFMT64d",%s,+,%s",
 				(ut64) op.mem.disp,
 				cs_reg_name (handle, op.mem.base), setstr);
 		break;
 	case PPC_OP_CRX: // Condition Register field
-		snprintf (words[n], sizeof (words[n]),
+		snprintf (words[n], sizeof (gop->words[n]),
 				"%"PFMT64d"%s", (ut64) op.imm, setstr);
 		break;
 	}
@@ -155,7 +159,7 @@ static ut64 getarg(struct Getarg *gop, int n) {
 }
 
 static const char* getspr(struct Getarg *gop, int n) {
-	static char cspr[16];
+	char *cspr = gop->cspr;
 	ut32 spr = 0;
 	if (n < 0 || n >= 8) {
 		return NULL;
@@ -175,7 +179,7 @@ static const char* getspr(struct Getarg *gop, int n) {
 	case SPR_HID6:
 		return "hid6";
 	default:
-		snprintf (cspr, sizeof (cspr), "spr_%u", spr);
+		snprintf (cspr, sizeof (gop->cspr), "spr_%u", spr);
 		break;
 	}
 	return cspr;
@@ -534,23 +538,32 @@ static int parse_reg_name(RRegItem *reg, csh handle, cs_insn *insn, int reg_num)
 	return 0;
 }
 
-static void op_fillval(RAnalOp *op, csh handle, cs_insn *insn) {
-	static RRegItem reg;
+// per RAnal instance decoder state, see RAnalPlugin.data_new
+typedef struct {
+	csh handle;
+	int omode;
+	int obits;
+	RRegItem reg;
+} CapstoneContext;
+
+static void op_fillval(CapstoneContext *ctx, RAnalOp *op, cs_insn *insn) {
+	csh handle = ctx->handle;
+	RRegItem *reg = &ctx->reg;
 	switch (op->type & R_ANAL_OP_TYPE_MASK) {
 	case R_ANAL_OP_TYPE_LOAD:
 		if (INSOP(1).type == PPC_OP_MEM) {
-			ZERO_FILL (reg);
+			ZERO_FILL (*reg);
 			op->src[0] = r_anal_value_new ();
-			op->src[0]->reg = &reg;
+			op->src[0]->reg = reg;
 			parse_reg_name (op->src[0]->reg, handle, insn, 1);
 			op->src[0]->delta = INSOP(1).mem.disp;
 		}
 		break;
 	case R_ANAL_OP_TYPE_STORE:
 		if (INSOP(1).type == PPC_OP_MEM) {
-			ZERO_FILL (reg);
+			ZERO_FILL (*reg);
 			op->dst = r_anal_value_new ();
-			op->dst->reg = &reg;
+			op->dst->reg = reg;
 			parse_reg_name (op->dst->reg, handle, insn, 1);
 			op->dst->delta = INSOP(1).mem.disp;
 		}
@@ -559,13 +572,12 @@ static void op_fillval(RAnalOp *op, csh handle, cs_insn *insn) {
 }
 
 static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask) {
-	static csh handle = 0;
-	static int omode = -1, obits = -1;
 	int n, ret;
 	cs_insn *insn;
 	char *op1;
 	int mode = (a->bits == 64) ? CS_MODE_64 : (a->bits == 32) ? CS_MODE_32 : 0;
 	mode |= a->big_endian ? CS_MODE_BIG_ENDIAN : CS_MODE_LITTLE_ENDIAN;
+	CapstoneContext *ctx = a->plugin_data;
 
 	op->delay = 0;
 	op->type = R_ANAL_OP_TYPE_NULL;
@@ -583,18 +595,21 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 		}
 	}
 
-	if (mode != omode || a->bits != obits) {
-		cs_close (&handle);
-		handle = 0;
-		omode = mode;
-		obits = a->bits;
+	if (!ctx) {
+		return -1;
 	}
-	if (handle == 0) {
-		ret = cs_open (CS_ARCH_PPC, mode, &handle);
+	if (mode != ctx->omode || a->bits != ctx->obits) {
+		cs_close (&ctx->handle);
+		ctx->handle = 0;
+		ctx->omode = mode;
+		ctx->obits = a->bits;
+	}
+	if (ctx->handle == 0) {
+		ret = cs_open (CS_ARCH_PPC, mode, &ctx->handle);
 		if (ret != CS_ERR_OK) {
 			return -1;
 		}
-		cs_option (handle, CS_OPT_DETAIL, CS_OPT_ON);
+		cs_option (ctx->handle, CS_OPT_DETAIL, CS_OPT_ON);
 	}
 	op->size = 4;
 
@@ -602,15 +617,15 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 	r_strbuf_set (&op->esil, "");
 
 	// capstone-next
-	n = cs_disasm (handle, (const ut8*)buf, len, addr, 1, &insn);
+	n = cs_disasm (ctx->handle, (const ut8*)buf, len, addr, 1, &insn);
 	if (n < 1) {
 		op->type = R_ANAL_OP_TYPE_ILL;
 	} else {
 		if (mask & R_ANAL_OP_MASK_OPEX) {
-			opex (&op->opex, handle, insn);
+			opex (&op->opex, ctx->handle, insn);
 		}
 		struct Getarg gop = {
-			.handle = handle,
+			.handle = ctx->handle,
 			.insn = insn,
 			.bits = a->bits
 		};
@@ -659,11 +674,11 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 			break;
 		case PPC_INS_CLRLWI:
 			op->type = R_ANAL_OP_TYPE_AND;
-			esilprintf (op, "%s,%s,&,%s,=", ARG (1), cmask32 (ARG (2), "0x1F"), ARG (0));
+			esilprintf (op, "%s,%s,&,%s,=", ARG (1), cmask32 (&gop, ARG (2), "0x1F"), ARG (0));
 			break;
 		case PPC_INS_RLWINM:
 			op->type = R_ANAL_OP_TYPE_ROL;
-			esilprintf (op, "%s,%s,<<<,%s,&,%s,=", ARG (2), ARG (1), cmask32 (ARG (3), ARG (4)), ARG (0));
+			esilprintf (op, "%s,%s,<<<,%s,&,%s,=", ARG (2), ARG (1), cmask32 (&gop, ARG (3), ARG (4)), ARG (0));
 			break;
 		case PPC_INS_SC:
 			op->type = R_ANAL_OP_TYPE_SWI;
@@ -1209,7 +1224,7 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 			break;
 		case PPC_INS_CLRLDI:
 			op->type = R_ANAL_OP_TYPE_AND;
-			esilprintf (op, "%s,%s,&,%s,=", ARG (1), cmask64 (ARG (2), "0x3F"), ARG (0));
+			esilprintf (op, "%s,%s,&,%s,=", ARG (1), cmask64 (&gop, ARG (2), "0x3F"), ARG (0));
 			break;
 		case PPC_INS_ROTLDI:
 			op->type = R_ANAL_OP_TYPE_ROL;
@@ -1218,16 +1233,16 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 		case PPC_INS_RLDCL:
 		case PPC_INS_RLDICL:
 			op->type = R_ANAL_OP_TYPE_ROL;
-			esilprintf (op, "%s,%s,<<<,%s,&,%s,=", ARG (2), ARG (1), cmask64 (ARG (3), "0x3F"), ARG (0));
+			esilprintf (op, "%s,%s,<<<,%s,&,%s,=", ARG (2), ARG (1), cmask64 (&gop, ARG (3), "0x3F"), ARG (0));
 			break;
 		case PPC_INS_RLDCR:
 		case PPC_INS_RLDICR:
 			op->type = R_ANAL_OP_TYPE_ROL;
-			esilprintf (op, "%s,%s,<<<,%s,&,%s,=", ARG (2), ARG (1), cmask64 (0, ARG (3)), ARG (0));
+			esilprintf (op, "%s,%s,<<<,%s,&,%s,=", ARG (2), ARG (1), cmask64 (&gop, 0, ARG (3)), ARG (0));
 			break;
 		}
 		if (mask & R_ANAL_OP_MASK_VAL) {
-			op_fillval (op, handle, insn);
+			op_fillval (ctx, op, insn);
 		}
 		if (!(mask & R_ANAL_OP_MASK_ESIL)) {
 			r_strbuf_fini (&op->esil);
@@ -1238,6 +1253,18 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 	return op->size;
 }
 
+static void *data_new(RAnal *anal) {
+	return R_NEW0 (CapstoneContext);
+}
+
+static void data_free(void *data) {
+	CapstoneContext *ctx = data;
+	if (ctx && ctx->handle) {
+		cs_close (&ctx->handle);
+	}
+	free (ctx);
+}
+
 static int archinfo(RAnal *a, int q) {
 	if (a->cpu && !strncmp (a->cpu, "vle", 3)) {
 		return 2;
@@ -1262,6 +1289,8 @@ RAnalPlugin r_anal_plugin_ppc_cs = {
 	.archinfo = archinfo,
 	.preludes = anal_preludes,
 	.op = &analop,
+	.data_new = data_new,
+	.data_free = data_free,
 	.set_reg_profile = &set_reg_profile,
 };
 
@@ -70,23 +70,31 @@ static int parse_reg_name(RRegItem *reg, csh handle, cs_insn *insn, int reg_num)
 	return 0;
 }
 
-static void op_fillval(RAnalOp *op, csh handle, cs_insn *insn) {
-	static RRegItem reg;
+// per RAnal instance decoder state, see RAnalPlugin.data_new
+typedef struct {
+	csh handle;
+	int omode;
+	RRegItem reg;
+} CapstoneContext;
+
+static void op_fillval(CapstoneContext *ctx, RAnalOp *op, cs_insn *insn) {
+	csh handle = ctx->handle;
+	RRegItem *reg = &ctx->reg;
 	switch (op->type & R_ANAL_OP_TYPE_MASK) {
 	case R_ANAL_OP_TYPE_LOAD:
 		if (INSOP(0).type == SPARC_OP_MEM) {
-			ZERO_FILL (reg);
+			ZERO_FILL (*reg);
 			op->src[0] = r_anal_value_new ();
-			op->src[0]->reg = &reg;
+			op->src[0]->reg = reg;
 			parse_reg_name (op->src[0]->reg, handle, insn, 0);
 			op->src[0]->delta = INSOP(0).mem.disp;
 		}
 		break;
 	case R_ANAL_OP_TYPE_STORE:
 		if (INSOP(1).type == SPARC_OP_MEM) {
-			ZERO_FILL (reg);
+			ZERO_FILL (*reg);
 			op->dst = r_anal_value_new ();
-			op->dst->reg = &reg;
+			op->dst->reg = reg;
 			parse_reg_name (op->dst->reg, handle, insn, 1);
 			op->dst->delta = INSOP(1).mem.disp;
 		}
@@ -95,11 +103,13 @@ static void op_fillval(RAnalOp *op, csh handle, cs_insn *insn) {
 }
 
 static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask) {
-	static csh handle = 0;
-	static int omode;
 	cs_insn *insn;
 	int mode, n, ret;
+	CapstoneContext *ctx = a->plugin_data;
 
+	if (!ctx) {
+		return -1;
+	}
 	if (!a->big_endian) {
 		return -1;
 	}
@@ -108,17 +118,17 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 	if (!strcmp (a->cpu, "v9")) {
 		mode |= CS_MODE_V9;
 	}
-	if (mode != omode) {
-		cs_close (&handle);
-		handle = 0;
-		omode = mode;
+	if (mode != ctx->omode) {
+		cs_close (&ctx->handle);
+		ctx->handle = 0;
+		ctx->omode = mode;
 	}
-	if (handle == 0) {
-		ret = cs_open (CS_ARCH_SPARC, mode, &handle);
+	if (ctx->handle == 0) {
+		ret = cs_open (CS_ARCH_SPARC, mode, &ctx->handle);
 		if (ret != CS_ERR_OK) {
 			return -1;
 		}
-		cs_option (handle, CS_OPT_DETAIL, CS_OPT_ON);
+		cs_option (ctx->handle, CS_OPT_DETAIL, CS_OPT_ON);
 	}
 	op->type = R_ANAL_OP_TYPE_NULL;
 	op->size = 0;
@@ -129,12 +139,12 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 	op->ptr = UT64_MAX;
 	r_strbuf_init (&op->esil);
 	// capstone-next
-	n = cs_disasm (handle, (const ut8*)buf, len, addr, 1, &insn);
+	n = cs_disasm (ctx->handle, (const ut8*)buf, len, addr, 1, &insn);
 	if (n < 1) {
 		op->type = R_ANAL_OP_TYPE_ILL;
 	} else {
 		if (mask & R_ANAL_OP_MASK_OPEX) {
-			opex (&op->opex, handle, insn);
+			opex (&op->opex, ctx->handle, insn);
 		}
 		op->size = insn->size;
 		op->id = insn->id;
@@ -319,13 +329,25 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 			break;
 		}
 		if (mask & R_ANAL_OP_MASK_VAL) {
-			op_fillval (op, handle, insn);
+			op_fillval (ctx, op, insn);
 		}
 		cs_free (insn, n);
 	}
 	return op->size;
 }
 
+static void *data_new(RAnal *anal) {
+	return R_NEW0 (CapstoneContext);
+}
+
+static void data_free(void *data) {
+	CapstoneContext *ctx = data;
+	if (ctx && ctx->handle) {
+		cs_close (&ctx->handle);
+	}
+	free (ctx);
+}
+
 static int set_reg_profile(RAnal *anal) {
 	const char *p = \
 		"=PC	pc\n"
@@ -391,6 +413,8 @@ RAnalPlugin r_anal_plugin_sparc_cs = {
 	.bits = 32|64,
 	.archinfo = archinfo,
 	.op = &analop,
+	.data_new = data_new,
+	.data_free = data_free,
 	.set_reg_profile = &set_reg_profile,
 };
 
@@ -117,6 +117,10 @@ RAnalPlugin r_anal_plugin_tms320 = {
 	.fini = tms320_fini,
 	.license = "LGPLv3",
 	.op = &tms320_op,
+#ifdef CAPSTONE_TMS320C64X_H
+	.data_new = tms320c64x_data_new,
+	.data_free = tms320c64x_data_free,
+#endif
 };
 
 #ifndef R2_PLUGIN_INCORE
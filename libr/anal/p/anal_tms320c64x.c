@@ -59,23 +59,43 @@ static void opex(RStrBuf *buf, csh handle, cs_insn *insn) {
 	r_strbuf_append (buf, "]}");
 }
 
+// decoder state kept in the plugin_data of the including plugin
+typedef struct {
+	csh handle;
+	int omode;
+} Tms320c64xContext;
+
+static void *tms320c64x_data_new(RAnal *anal) {
+	return R_NEW0 (Tms320c64xContext);
+}
+
+static void tms320c64x_data_free(void *data) {
+	Tms320c64xContext *ctx = data;
+	if (ctx && ctx->handle) {
+		cs_close (&ctx->handle);
+	}
+	free (ctx);
+}
+
 static int tms320c64x_analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask) {
-	static csh handle = 0;
-	static int omode;
+	Tms320c64xContext *ctx = a->plugin_data;
 	cs_insn *insn;
 	int mode = 0, n, ret;
 
-	if (mode != omode) {
-		cs_close (&handle);
-		handle = 0;
-		omode = mode;
+	if (!ctx) {
+		return -1;
+	}
+	if (mode != ctx->omode) {
+		cs_close (&ctx->handle);
+		ctx->handle = 0;
+		ctx->omode = mode;
 	}
-	if (handle == 0) {
-		ret = cs_open (CS_ARCH_TMS320C64X, mode, &handle);
+	if (ctx->handle == 0) {
+		ret = cs_open (CS_ARCH_TMS320C64X, mode, &ctx->handle);
 		if (ret != CS_ERR_OK) {
 			return -1;
 		}
-		cs_option (handle, CS_OPT_DETAIL, CS_OPT_ON);
+		cs_option (ctx->handle, CS_OPT_DETAIL, CS_OPT_ON);
 	}
 	op->type = R_ANAL_OP_TYPE_NULL;
 	op->size = 0;
@@ -86,12 +106,12 @@ static int tms320c64x_analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, i
 	op->ptr = UT64_MAX;
 	r_strbuf_init (&op->esil);
 	// capstone-next
-	n = cs_disasm (handle, (const ut8*)buf, len, addr, 1, &insn);
+	n = cs_disasm (ctx->handle, (const ut8*)buf, len, addr, 1, &insn);
 	if (n < 1) {
 		op->type = R_ANAL_OP_TYPE_ILL;
 	} else {
 		if (mask & R_ANAL_OP_MASK_OPEX) {
-			opex (&op->opex, handle, insn);
+			opex (&op->opex, ctx->handle, insn);
 		}
 		op->size = insn->size;
 		op->id = insn->id;
@@ -54,17 +54,22 @@ call = 4
 #define ARG1_AR      1
 #define ARG2_AR      2
 
-static RRegItem base_regs[4];
-static RRegItem regdelta_regs[4];
+// per RAnal instance decoder state, see RAnalPlugin.data_new
+typedef struct {
+	csh handle;
+	int omode;
+	// op->src/dst registers point here, valid until the next analop call
+	RRegItem base_regs[4];
+	RRegItem regdelta_regs[4];
+} CapstoneContext;
 
 struct Getarg {
 	csh handle;
 	cs_insn *insn;
 	int bits;
+	char buf[AR_DIM][BUF_SZ]; // the operands returned by getarg
 };
 
-static csh handle = 0;
-
 static void hidden_op(cs_insn *insn, cs_x86 *x, int mode) {
 	unsigned int id = insn->id;
 	int regsz = 4;
@@ -109,7 +114,7 @@ static void hidden_op(cs_insn *insn, cs_x86 *x, int mode) {
 	}
 }
 
-static void opex(RStrBuf *buf, cs_insn *insn, int mode) {
+static void opex(RStrBuf *buf, csh handle, cs_insn *insn, int mode) {
 	int i;
 	r_strbuf_init (buf);
 	r_strbuf_append (buf, "{");
@@ -229,12 +234,11 @@ static bool is_xmm_reg(cs_x86_op op) {
  * @param  n       Operand index
  * @param  set     if 1 it adds set (=) to the operand
  * @param  setoper Extra operation for the set (^, -, +, etc...)
- * @param  sel     Selector for output buffer in staic array
- * @return         Pointer to esil operand in static array
+ * @param  sel     Selector for output buffer in gop
+ * @return         Pointer to esil operand in gop
  */
 static char *getarg(struct Getarg* gop, int n, int set, char *setop, int sel, ut32 *bitsize) {
-	static char buf[AR_DIM][BUF_SZ];
-	char *out = buf[sel];
+	char *out = gop->buf[sel];
 	char *setarg = setop ? setop : "";
 	cs_insn *insn = gop->insn;
 	csh handle = gop->handle;
@@ -1898,24 +1902,18 @@ static int parse_reg_name(RRegItem *reg_base, RRegItem *reg_delta, csh *handle,
 	(op)->src[1] = r_anal_value_new ();\
 	(op)->src[2] = r_anal_value_new ();\
 	(op)->dst = r_anal_value_new ();\
-	ZERO_FILL (base_regs[0]);\
-	ZERO_FILL (base_regs[1]);\
-	ZERO_FILL (base_regs[2]);\
-	ZERO_FILL (base_regs[3]);\
-	ZERO_FILL (regdelta_regs[0]);\
-	ZERO_FILL (regdelta_regs[1]);\
-	ZERO_FILL (regdelta_regs[2]);\
-	ZERO_FILL (regdelta_regs[3]);
-
-static void set_src_dst(RAnalValue *val, csh *handle, cs_insn *insn, int x) {
-	parse_reg_name (&base_regs[x], &regdelta_regs[x], handle, insn, x);
+	ZERO_FILL (ctx->base_regs);\
+	ZERO_FILL (ctx->regdelta_regs);
+
+static void set_src_dst(CapstoneContext *ctx, RAnalValue *val, cs_insn *insn, int x) {
+	parse_reg_name (&ctx->base_regs[x], &ctx->regdelta_regs[x], &ctx->handle, insn, x);
 	switch (INSOP (x).type) {
 	case X86_OP_MEM:
 		val->mul = INSOP (x).mem.scale;
 		val->delta = INSOP (x).mem.disp;
 		val->sel = INSOP (x).mem.segment;
 		val->memref = INSOP (x).size;
-		val->regdelta = &regdelta_regs[x];
+		val->regdelta = &ctx->regdelta_regs[x];
 		break;
 	case X86_OP_REG:
 		break;
@@ -1925,10 +1923,10 @@ static void set_src_dst(RAnalValue *val, csh *handle, cs_insn *insn, int x) {
 	default:
 		break;
 	}
-	val->reg = &base_regs[x];	
+	val->reg = &ctx->base_regs[x];
 }
 
-static void op_fillval(RAnal *a, RAnalOp *op, csh *handle, cs_insn *insn) {
+static void op_fillval(RAnal *a, RAnalOp *op, CapstoneContext *ctx, cs_insn *insn) {
 	switch (op->type & R_ANAL_OP_TYPE_MASK) {
 	case R_ANAL_OP_TYPE_MOV:
 	case R_ANAL_OP_TYPE_CMP:
@@ -1950,15 +1948,15 @@ static void op_fillval(RAnal *a, RAnalOp *op, csh *handle, cs_insn *insn) {
 	case R_ANAL_OP_TYPE_NOT:
 	case R_ANAL_OP_TYPE_ACMP:
 		CREATE_SRC_DST (op);
-		set_src_dst (op->dst, handle, insn, 0);
-		set_src_dst (op->src[0], handle, insn, 1);
-		set_src_dst (op->src[1], handle, insn, 2);
-		set_src_dst (op->src[2], handle, insn, 3);
+		set_src_dst (ctx, op->dst, insn, 0);
+		set_src_dst (ctx, op->src[0], insn, 1);
+		set_src_dst (ctx, op->src[1], insn, 2);
+		set_src_dst (ctx, op->src[2], insn, 3);
 		break;
 	case R_ANAL_OP_TYPE_UPUSH:
 		if ((op->type & R_ANAL_OP_TYPE_REG)) {
 			CREATE_SRC_DST (op);
-			set_src_dst (op->src[0], handle, insn, 0);
+			set_src_dst (ctx, op->src[0], insn, 0);
 		}
 		break;
 	default:
@@ -3002,7 +3000,7 @@ static int cs_len_prefix_opcode(uint8_t *item) {
 }
 
 static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask) {
-	static int omode = 0;
+	CapstoneContext *ctx = a->plugin_data;
 #if USE_ITER_API
 	static
 #endif
@@ -3012,17 +3010,18 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 		(a->bits==16)? CS_MODE_16: 0;
 	int n, ret;
 
-	if (handle && mode != omode) {
-		if (handle != 0) {
-			cs_close (&handle);
-			handle = 0;
-		}
+	if (!ctx) {
+		return -1;
 	}
-	omode = mode;
-	if (handle == 0) {
-		ret = cs_open (CS_ARCH_X86, mode, &handle);
+	if (ctx->handle && mode != ctx->omode) {
+		cs_close (&ctx->handle);
+		ctx->handle = 0;
+	}
+	ctx->omode = mode;
+	if (ctx->handle == 0) {
+		ret = cs_open (CS_ARCH_X86, mode, &ctx->handle);
 		if (ret != CS_ERR_OK) {
-			handle = 0;
+			ctx->handle = 0;
 			return 0;
 		}
 	}
@@ -3038,20 +3037,20 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 	op->size = 0;
 	op->delay = 0;
 	r_strbuf_init (&op->esil);
-	cs_option (handle, CS_OPT_DETAIL, CS_OPT_ON);
+	cs_option (ctx->handle, CS_OPT_DETAIL, CS_OPT_ON);
 	// capstone-next
 #if USE_ITER_API
 	{
 		ut64 naddr = addr;
 		size_t size = len;
 		if (!insn) {
-			insn = cs_malloc (handle);
+			insn = cs_malloc (ctx->handle);
 		}
-		n = cs_disasm_iter (handle, (const uint8_t**)&buf,
+		n = cs_disasm_iter (ctx->handle, (const uint8_t**)&buf,
 			&size, (uint64_t*)&naddr, insn);
 	}
 #else
-	n = cs_disasm (handle, (const ut8*)buf, len, addr, 1, &insn);
+	n = cs_disasm (ctx->handle, (const ut8*)buf, len, addr, 1, &insn);
 #endif
 	if (n < 1) {
 		op->type = R_ANAL_OP_TYPE_ILL;
@@ -3088,22 +3087,22 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 			op->family = R_ANAL_OP_FAMILY_THREAD; // XXX ?
 			break;
 		}
-		anop (a, op, addr, buf, len, &handle, insn);
+		anop (a, op, addr, buf, len, &ctx->handle, insn);
 		set_opdir (op, insn);
 		if (mask & R_ANAL_OP_MASK_ESIL) {
-			anop_esil (a, op, addr, buf, len, &handle, insn);
+			anop_esil (a, op, addr, buf, len, &ctx->handle, insn);
 		}
 		if (mask & R_ANAL_OP_MASK_OPEX) {
-			opex (&op->opex, insn, mode);
+			opex (&op->opex, ctx->handle, insn, mode);
 		}
 		if (mask & R_ANAL_OP_MASK_VAL) {
-			op_fillval (a, op, &handle, insn);
+			op_fillval (a, op, ctx, insn);
 		}
 	}
 //#if X86_GRP_PRIVILEGE>0
 	if (insn) {
 #if HAVE_CSGRP_PRIVILEGE
-		if (cs_insn_group (handle, insn, X86_GRP_PRIVILEGE)) {
+		if (cs_insn_group (ctx->handle, insn, X86_GRP_PRIVILEGE)) {
 			op->family = R_ANAL_OP_FAMILY_PRIV;
 		}
 #endif
@@ -3111,7 +3110,6 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 		cs_free (insn, n);
 #endif
 	}
-	//cs_close (&handle);
 	return op->size;
 }
 
@@ -3168,18 +3166,16 @@ static int esil_x86_cs_init(RAnalEsil *esil) {
 	return true;
 }
 
-static int init(void *p) {
-	handle = 0;
-	return true;
+static void *data_new(RAnal *anal) {
+	return R_NEW0 (CapstoneContext);
 }
 
-static int fini(void *p) {
-	if (handle != 0) {
-		// SEGFAULTS RANDOMLY, better leak on exit
-		// cs_close (&handle);
-		handle = 0;
+static void data_free(void *data) {
+	CapstoneContext *ctx = data;
+	if (ctx && ctx->handle) {
+		cs_close (&ctx->handle);
 	}
-	return true;
+	free (ctx);
 }
 
 static int esil_x86_cs_fini(RAnalEsil *esil) {
@@ -3627,8 +3623,8 @@ RAnalPlugin r_anal_plugin_x86_cs = {
 	.preludes = anal_preludes,
 	.archinfo = archinfo,
 	.get_reg_profile = &get_reg_profile,
-	.init = init,
-	.fini = fini,
+	.data_new = data_new,
+	.data_free = data_free,
 	.esil_init = esil_x86_cs_init,
 	.esil_fini = esil_x86_cs_fini,
 //	.esil_intr = esil_x86_cs_intr,
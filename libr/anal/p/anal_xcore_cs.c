@@ -50,40 +50,48 @@ static void opex(RStrBuf *buf, csh handle, cs_insn *insn) {
 	r_strbuf_append (buf, "}");
 }
 
+// per RAnal instance decoder state, see RAnalPlugin.data_new
+typedef struct {
+	csh handle;
+	int omode;
+} CapstoneContext;
+
 static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAnalOpMask mask) {
-	static csh handle = 0;
-	static int omode = 0;
 	cs_insn *insn;
 	int mode, n, ret;
+	CapstoneContext *ctx = a->plugin_data;
+	if (!ctx) {
+		return -1;
+	}
 	mode = CS_MODE_BIG_ENDIAN;
 	if (!strcmp (a->cpu, "v9")) {
 		mode |= CS_MODE_V9;
 	}
-	if (mode != omode) {
-		if (handle) {
-			cs_close (&handle);
-			handle = 0;
+	if (mode != ctx->omode) {
+		if (ctx->handle) {
+			cs_close (&ctx->handle);
+			ctx->handle = 0;
 		}
-		omode = mode;
+		ctx->omode = mode;
 	}
-	if (handle == 0) {
-		ret = cs_open (CS_ARCH_XCORE, mode, &handle);
+	if (ctx->handle == 0) {
+		ret = cs_open (CS_ARCH_XCORE, mode, &ctx->handle);
 		if (ret != CS_ERR_OK) {
 			return -1;
 		}
-		cs_option (handle, CS_OPT_DETAIL, CS_OPT_ON);
+		cs_option (ctx->handle, CS_OPT_DETAIL, CS_OPT_ON);
 	}
 	op->type = R_ANAL_OP_TYPE_NULL;
 	op->size = 0;
 	op->delay = 0;
 	r_strbuf_init (&op->esil);
 	// capstone-next
-	n = cs_disasm (handle, (const ut8*)buf, len, addr, 1, &insn);
+	n = cs_disasm (ctx->handle, (const ut8*)buf, len, addr, 1, &insn);
 	if (n < 1) {
 		op->type = R_ANAL_OP_TYPE_ILL;
 	} else {
 		if (mask & R_ANAL_OP_MASK_OPEX) {
-			opex (&op->opex, handle, insn);
+			opex (&op->opex, ctx->handle, insn);
 		}
 		op->size = insn->size;
 		op->id = insn->id;
@@ -122,10 +130,21 @@ static int analop(RAnal *a, RAnalOp *op, ut64 addr, const ut8 *buf, int len, RAn
 		}
 		cs_free (insn, n);
 	}
-	//	cs_close (&handle);
 	return op->size;
 }
 
+static void *data_new(RAnal *anal) {
+	return R_NEW0 (CapstoneContext);
+}
+
+static void data_free(void *data) {
+	CapstoneContext *ctx = data;
+	if (ctx && ctx->handle) {
+		cs_close (&ctx->handle);
+	}
+	free (ctx);
+}
+
 RAnalPlugin r_anal_plugin_xcore_cs = {
 	.name = "xcore",
 	.desc = "Capstone XCORE analysis",
@@ -134,6 +153,8 @@ RAnalPlugin r_anal_plugin_xcore_cs = {
 	.arch = "xcore",
 	.bits = 32,
 	.op = &analop,
+	.data_new = data_new,
+	.data_free = data_free,
 	//.set_reg_profile = &set_reg_profile,
 };
 
@@ -0,0 +1,98 @@
+/* radare - LGPL - Copyright 2020 - radare */
+
+#include <r_anal.h>
+
+// The code analysis reads a few bytes at a time while it jumps between the
+// basic blocks of a function, so the reads are served from a small set of
+// aligned blocks, evicting the least recently used one. A block is stale
+// once io->rev changes, which happens on every write and map change.
+
+R_API void r_anal_read_cache_fini(RAnal *anal) {
+	RAnalReadCache *rc = &anal->rcache;
+	int i;
+	for (i = 0; i < rc->nslots; i++) {
+		free (rc->slots[i].buf);
+	}
+	R_FREE (rc->slots);
+	rc->nslots = 0;
+	rc->bsize = 0;
+}
+
+// nslots or bsize set to 0 disables the cache
+R_API bool r_anal_read_cache_setup(RAnal *anal, int nslots, int bsize) {
+	r_return_val_if_fail (anal && nslots >= 0 && bsize >= 0, false);
+	RAnalReadCache *rc = &anal->rcache;
+	int i;
+	r_anal_read_cache_fini (anal);
+	if (!nslots || !bsize) {
+		return true;
+	}
+	rc->slots = R_NEWS0 (RAnalReadCacheSlot, nslots);
+	if (!rc->slots) {
+		return false;
+	}
+	rc->nslots = nslots;
+	rc->bsize = bsize;
+	for (i = 0; i < nslots; i++) {
+		rc->slots[i].addr = UT64_MAX;
+		rc->slots[i].buf = malloc (bsize);
+		if (!rc->slots[i].buf) {
+			r_anal_read_cache_fini (anal);
+			return false;
+		}
+	}
+	return true;
+}
+
+R_API void r_anal_read_cache_invalidate(RAnal *anal) {
+	RAnalReadCache *rc = &anal->rcache;
+	int i;
+	for (i = 0; i < rc->nslots; i++) {
+		rc->slots[i].addr = UT64_MAX;
+	}
+}
+
+static RAnalReadCacheSlot *read_cache_block(RAnal *anal, ut64 addr) {
+	RAnalReadCache *rc = &anal->rcache;
+	RIO *io = anal->iob.io;
+	RAnalReadCacheSlot *lru = NULL;
+	int i;
+	for (i = 0; i < rc->nslots; i++) {
+		RAnalReadCacheSlot *s = &rc->slots[i];
+		if (s->addr == addr && s->rev == io->rev) {
+			s->used = ++rc->clock;
+			return s;
+		}
+		if (!lru || s->used < lru->used) {
+			lru = s;
+		}
+	}
+	anal->iob.read_at (io, addr, lru->buf, rc->bsize);
+	lru->addr = addr;
+	lru->rev = io->rev;
+	lru->used = ++rc->clock;
+	return lru;
+}
+
+// reads larger than a block go straight to io
+R_API int r_anal_read_cache_read(RAnal *anal, ut64 addr, ut8 *buf, int len) {
+	r_return_val_if_fail (anal && buf, -1);
+	RAnalReadCache *rc = &anal->rcache;
+	int done = 0;
+	if (len < 1) {
+		return 0;
+	}
+	if (!rc->nslots || len > rc->bsize || !anal->iob.io) {
+		return anal->iob.read_at (anal->iob.io, addr, buf, len);
+	}
+	while (done < len) {
+		const ut64 at = addr + done;
+		const ut64 block = at - (at % rc->bsize);
+		const int delta = at - block;
+		const int n = R_MIN (len - done, rc->bsize - delta);
+		RAnalReadCacheSlot *s = read_cache_block (anal, block);
+		memcpy (buf + done, s->buf + delta, n);
+		done += n;
+	}
+	return len;
+}
@@ -1011,6 +1011,302 @@ static double matchGraph(RSignItem *a, RSignItem *b) {
 	return total / 5.0;
 }
 
+/* candidates of the other space for r_sign_diff. A pair can only reach the
+ * bytes threshold with sizes close enough, and the graph threshold with
+ * every metric close enough, so the pairs out of these ranges are never
+ * scored. The pairs scored and the order they are printed in is the same
+ * as comparing every pair */
+typedef struct {
+	RSignItem *it;
+	int id; // position in the other space, the print order
+} SignDiffEntry;
+
+typedef struct {
+	RAnal *anal;
+	double bt, gt;
+	RSignItem **la;
+	RSignItem **lb;
+	int nb;
+	SignDiffEntry *bytes; // sorted by size
+	int nbytes;
+	SignDiffEntry *graphs; // sorted by bbsum, nbbs, cc, edges, ebbs
+	int ngraphs;
+	RVector odd; // ids of graphs with negative metrics, scored against everything
+	bool all; // a threshold matches any pair
+} SignDiff;
+
+typedef struct {
+	SignDiff *sd;
+	int from, to; // range of the current space
+	RStrBuf *sb; // output, NULL to print it right away
+} SignDiffJob;
+
+static int cmpid(const void *a, const void *b) {
+	return *(const int *)a - *(const int *)b;
+}
+
+static bool graphOdd(RSignGraph *g) {
+	return g->cc < -1 || g->nbbs < -1 || g->edges < -1 || g->ebbs < -1 || g->bbsum < -1;
+}
+
+static int cmpDiffBytes(const void *a, const void *b) {
+	const SignDiffEntry *ea = a, *eb = b;
+	int d = ea->it->bytes->size - eb->it->bytes->size;
+	return d? d: ea->id - eb->id;
+}
+
+static int cmpGraphKey(RSignGraph *a, RSignGraph *b) {
+	if (a->bbsum != b->bbsum) {
+		return a->bbsum < b->bbsum? -1: 1;
+	}
+	if (a->nbbs != b->nbbs) {
+		return a->nbbs < b->nbbs? -1: 1;
+	}
+	if (a->cc != b->cc) {
+		return a->cc < b->cc? -1: 1;
+	}
+	if (a->edges != b->edges) {
+		return a->edges < b->edges? -1: 1;
+	}
+	if (a->ebbs != b->ebbs) {
+		return a->ebbs < b->ebbs? -1: 1;
+	}
+	return 0;
+}
+
+static int cmpDiffGraph(const void *a, const void *b) {
+	const SignDiffEntry *ea = a, *eb = b;
+	int d = cmpGraphKey (ea->it->graph, eb->it->graph);
+	return d? d: ea->id - eb->id;
+}
+
+// first entry of the size sorted bytes with a size not below size
+static int diffBytesBound(SignDiff *sd, double size) {
+	int lo = 0, hi = sd->nbytes;
+	while (lo < hi) {
+		int m = lo + (hi - lo) / 2;
+		if (sd->bytes[m].it->bytes->size < size) {
+			lo = m + 1;
+		} else {
+			hi = m;
+		}
+	}
+	return lo;
+}
+
+// first graph entry above key when upper, or not below key
+static int diffGraphBound(SignDiff *sd, RSignGraph *key, bool upper) {
+	int lo = 0, hi = sd->ngraphs;
+	while (lo < hi) {
+		int m = lo + (hi - lo) / 2;
+		int c = cmpGraphKey (sd->graphs[m].it->graph, key);
+		if (c < 0 || (upper && !c)) {
+			lo = m + 1;
+		} else {
+			hi = m;
+		}
+	}
+	return lo;
+}
+
+// first graph entry with a bbsum not below bbsum
+static int diffBbsumBound(SignDiff *sd, double bbsum) {
+	int lo = 0, hi = sd->ngraphs;
+	while (lo < hi) {
+		int m = lo + (hi - lo) / 2;
+		if (sd->graphs[m].it->graph->bbsum < bbsum) {
+			lo = m + 1;
+		} else {
+			hi = m;
+		}
+	}
+	return lo;
+}
+
+// the first integer above x
+static double diffAbove(double x) {
+	return x >= INT_MAX? INT_MAX: (int)x + 1;
+}
+
+static void diffCandidates(SignDiff *sd, RSignItem *si, RVector *ids) {
+	int i, lo, hi;
+	if (si->bytes && si->bytes->size > 0) {
+		// min / max >= bt
+		lo = diffBytesBound (sd, si->bytes->size * sd->bt - 1e-6);
+		hi = diffBytesBound (sd, diffAbove (si->bytes->size / sd->bt + 1e-6));
+		for (i = lo; i < hi; i++) {
+			r_vector_push (ids, &sd->bytes[i].id);
+		}
+	}
+	if (si->graph) {
+		if (graphOdd (si->graph)) {
+			lo = 0;
+			hi = sd->ngraphs;
+		} else if (sd->gt >= 1.0) {
+			lo = diffGraphBound (sd, si->graph, false);
+			hi = diffGraphBound (sd, si->graph, true);
+		} else if (si->graph->bbsum > 0) {
+			// the other four metrics are at most 1, so each one is at least 5 * gt - 4
+			double s = 5 * sd->gt - 4;
+			lo = diffBbsumBound (sd, si->graph->bbsum * s - 1e-6);
+			hi = diffBbsumBound (sd, diffAbove (si->graph->bbsum / s + 1e-6));
+		} else {
+			lo = diffBbsumBound (sd, si->graph->bbsum);
+			hi = diffBbsumBound (sd, si->graph->bbsum + 1);
+		}
+		for (i = lo; i < hi; i++) {
+			r_vector_push (ids, &sd->graphs[i].id);
+		}
+		r_vector_insert_range (ids, ids->len, sd->odd.a, sd->odd.len);
+	}
+	if (ids->len > 1) {
+		qsort (ids->a, ids->len, sizeof (int), cmpid);
+	}
+}
+
+static void diffLine(SignDiffJob *job, char *line) {
+	if (line) {
+		if (job->sb) {
+			r_strbuf_append (job->sb, line);
+		} else {
+			job->sd->anal->cb_printf ("%s", line);
+		}
+		free (line);
+	}
+}
+
+static void diffPair(SignDiffJob *job, RSignItem *si, RSignItem *si2) {
+	double bytesScore = matchBytes (si, si2);
+	double graphScore = matchGraph (si, si2);
+
+	if (bytesScore >= job->sd->bt) {
+		diffLine (job, r_str_newf ("0x%08"PFMT64x" 0x%08"PFMT64x " %02.5lf B %s\n", si->addr, si2->addr, bytesScore, si->name));
+	}
+
+	if (graphScore >= job->sd->gt) {
+		diffLine (job, r_str_newf ("0x%08"PFMT64x" 0x%08"PFMT64x" %02.5lf G %s\n", si->addr, si2->addr, graphScore, si->name));
+	}
+}
+
+static void diffRange(SignDiffJob *job) {
+	SignDiff *sd = job->sd;
+	RVector ids;
+	int i, j, *id;
+	r_vector_init (&ids, sizeof (int), NULL, NULL);
+	for (i = job->from; i < job->to; i++) {
+		RSignItem *si = sd->la[i];
+		if (strstr (si->name, "imp.")) {
+			continue;
+		}
+		if (sd->all) {
+			for (j = 0; j < sd->nb; j++) {
+				if (!strstr (sd->lb[j]->name, "imp.")) {
+					diffPair (job, si, sd->lb[j]);
+				}
+			}
+			continue;
+		}
+		r_vector_clear (&ids);
+		diffCandidates (sd, si, &ids);
+		for (j = 0; j < ids.len; j++) {
+			id = r_vector_index_ptr (&ids, j);
+			// scored once when it is a bytes and a graph candidate
+			if (!j || *id != id[-1]) {
+				diffPair (job, si, sd->lb[*id]);
+			}
+		}
+	}
+	r_vector_clear (&ids);
+}
+
+static RThreadFunctionRet diffRangeTh(RThread *th) {
+	diffRange (th->user);
+	return R_TH_STOP;
+}
+
+static RSignItem **diffItems(RList *list) {
+	RSignItem **items = R_NEWS (RSignItem *, r_list_length (list) + 1);
+	if (items) {
+		RListIter *iter;
+		RSignItem *it;
+		int i = 0;
+		r_list_foreach (list, iter, it) {
+			items[i++] = it;
+		}
+	}
+	return items;
+}
+
+static bool diffPrepare(SignDiff *sd) {
+	int i;
+	sd->bytes = R_NEWS (SignDiffEntry, sd->nb + 1);
+	sd->graphs = R_NEWS (SignDiffEntry, sd->nb + 1);
+	r_vector_init (&sd->odd, sizeof (int), NULL, NULL);
+	if (!sd->bytes || !sd->graphs) {
+		return false;
+	}
+	// no score is below zero, and the graph metrics can't be bounded one by one below 0.8
+	sd->all = sd->bt <= 0.0 || 5 * sd->gt - 4 < 1e-6;
+	for (i = 0; i < sd->nb; i++) {
+		RSignItem *it = sd->lb[i];
+		if (strstr (it->name, "imp.")) {
+			continue;
+		}
+		if (it->bytes && it->bytes->size > 0) {
+			sd->bytes[sd->nbytes++] = (SignDiffEntry){ it, i };
+		}
+		if (it->graph) {
+			if (graphOdd (it->graph)) {
+				r_vector_push (&sd->odd, &i);
+			} else {
+				sd->graphs[sd->ngraphs++] = (SignDiffEntry){ it, i };
+			}
+		}
+	}
+	qsort (sd->bytes, sd->nbytes, sizeof (SignDiffEntry), cmpDiffBytes);
+	qsort (sd->graphs, sd->ngraphs, sizeof (SignDiffEntry), cmpDiffGraph);
+	return true;
+}
+
+static void diffRun(SignDiff *sd, int na, int jobs) {
+	int i;
+	jobs = R_MAX (1, R_MIN (jobs, na / 64));
+	if (jobs < 2) {
+		SignDiffJob job = { sd, 0, na, NULL };
+		diffRange (&job);
+		return;
+	}
+	SignDiffJob *js = R_NEWS0 (SignDiffJob, jobs);
+	RThread **th = R_NEWS0 (RThread *, jobs);
+	if (!js || !th) {
+		free (js);
+		free (th);
+		SignDiffJob job = { sd, 0, na, NULL };
+		diffRange (&job);
+		return;
+	}
+	for (i = 0; i < jobs; i++) {
+		js[i].sd = sd;
+		js[i].from = (ut64)na * i / jobs;
+		js[i].to = (ut64)na * (i + 1) / jobs;
+		js[i].sb = r_strbuf_new (NULL);
+		th[i] = r_th_new (diffRangeTh, &js[i], 0);
+		if (!th[i]) {
+			diffRange (&js[i]);
+		}
+	}
+	for (i = 0; i < jobs; i++) {
+		if (th[i]) {
+			r_th_wait (th[i]);
+			r_th_free (th[i]);
+		}
+		sd->anal->cb_printf ("%s", r_strbuf_get (js[i].sb));
+		r_strbuf_free (js[i].sb);
+	}
+	free (js);
+	free (th);
+}
+
 R_API bool r_sign_diff(RAnal *a, RSignOptions *options, const char *other_space_name) {
 	char k[R_SIGN_KEY_MAXSZ];
 
@@ -1070,39 +1366,28 @@ R_API bool r_sign_diff(RAnal *a, RSignOptions *options, const char *other_space_
 	ls_free (current_zigns);
 	ls_free (other_zigns);
 
-	RListIter *itr;
-	RListIter *itr2;
-	RSignItem *si;
-	RSignItem *si2;
-
 	// do the sign diff here
-	r_list_foreach (la, itr, si) {
-		if (strstr (si->name, "imp.")) {
-			continue;
-		}
-		r_list_foreach (lb, itr2, si2) {
-			if (strstr (si2->name, "imp.")) {
-				continue;
-			}
-			double bytesScore = matchBytes (si, si2);
-			double graphScore = matchGraph (si, si2);
-			bool bytesMatch = bytesScore >= (options ? options->bytes_diff_threshold : SIGN_DIFF_MATCH_BYTES_THRESHOLD);
-			bool graphMatch = graphScore >= (options ? options->graph_diff_threshold : SIGN_DIFF_MATCH_GRAPH_THRESHOLD);
-
-			if (bytesMatch) {
-				a->cb_printf ("0x%08"PFMT64x" 0x%08"PFMT64x " %02.5lf B %s\n", si->addr, si2->addr, bytesScore, si->name);
-			}
-
-			if (graphMatch) {
-				a->cb_printf ("0x%08"PFMT64x" 0x%08"PFMT64x" %02.5lf G %s\n", si->addr, si2->addr, graphScore, si->name);
-			}
-		}
-	}
-
+	SignDiff sd = {
+		.anal = a,
+		.bt = options ? options->bytes_diff_threshold : SIGN_DIFF_MATCH_BYTES_THRESHOLD,
+		.gt = options ? options->graph_diff_threshold : SIGN_DIFF_MATCH_GRAPH_THRESHOLD,
+		.la = diffItems (la),
+		.lb = diffItems (lb),
+		.nb = r_list_length (lb),
+	};
+	bool retval = sd.la && sd.lb && diffPrepare (&sd);
+	if (retval) {
+		diffRun (&sd, r_list_length (la), options ? options->jobs : 1);
+	}
+	free (sd.la);
+	free (sd.lb);
+	free (sd.bytes);
+	free (sd.graphs);
+	r_vector_clear (&sd.odd);
 	r_list_free (la);
 	r_list_free (lb);
 
-	return true;
+	return retval;
 beach:
 	ls_free (current_zigns);
 	ls_free (other_zigns);
@@ -1112,6 +1397,11 @@ beach:
 	return false;
 }
 
+static void diffNamesFree(HtPPKv *kv) {
+	free (kv->key);
+	r_list_free (kv->value);
+}
+
 R_API bool r_sign_diff_by_name(RAnal *a, RSignOptions * options, const char *other_space_name, bool not_matching) {
 	char k[R_SIGN_KEY_MAXSZ];
 
@@ -1178,14 +1468,32 @@ R_API bool r_sign_diff_by_name(RAnal *a, RSignOptions * options, const char *oth
 	size_t current_space_name_len = strlen (current_space->name);
 	size_t other_space_name_len = strlen (other_space->name);
 
+	// zignatures of the other space by name, in their order
+	HtPP *names = ht_pp_new (NULL, diffNamesFree, NULL);
+	if (!names) {
+		r_list_free (la);
+		r_list_free (lb);
+		return false;
+	}
+	r_list_foreach (lb, itr2, si2) {
+		const char *name = si2->name + other_space_name_len + 1;
+		RList *same = ht_pp_find (names, name, NULL);
+		if (!same) {
+			same = r_list_new ();
+			if (!same || !ht_pp_insert (names, name, same)) {
+				r_list_free (same);
+				continue;
+			}
+		}
+		r_list_append (same, si2);
+	}
+
 	r_list_foreach (la, itr, si) {
 		if (strstr (si->name, "imp.")) {
 			continue;
 		}
-		r_list_foreach (lb, itr2, si2) {
-			if (strcmp (si->name + current_space_name_len + 1, si2->name + other_space_name_len + 1)) {
-				continue;
-			}
+		RList *same = ht_pp_find (names, si->name + current_space_name_len + 1, NULL);
+		r_list_foreach (same, itr2, si2) {
 			// TODO: add config variable for threshold
 			double bytesScore = matchBytes (si, si2);
 			double graphScore = matchGraph (si, si2);
@@ -1200,6 +1508,7 @@ R_API bool r_sign_diff_by_name(RAnal *a, RSignOptions * options, const char *oth
 		}
 	}
 
+	ht_pp_free (names);
 	r_list_free (la);
 	r_list_free (lb);
 
@@ -1914,34 +2223,59 @@ static int matchCount(int a, int b) {
 	return R_ABS (c) < m;
 }
 
-static bool fcnMetricsCmp(RSignItem *it, RAnalFunction *fcn) {
+static void fcnMetrics(RAnalFunction *fcn, RSignGraph *m) {
+	m->cc = r_anal_fcn_cc (NULL, fcn);
+	m->nbbs = r_list_length (fcn->bbs);
+	m->ebbs = -1;
+	m->edges = r_anal_fcn_count_edges (fcn, &m->ebbs);
+	m->bbsum = r_anal_function_linear_size (fcn);
+}
+
+static bool fcnMetricsCmp(RSignItem *it, RSignGraph *m) {
 	RSignGraph *graph = it->graph;
-	int ebbs = -1;
 
-	if (graph->cc != -1 && graph->cc != r_anal_fcn_cc (NULL, fcn)) {
+	if (graph->cc != -1 && graph->cc != m->cc) {
 		return false;
 	}
-	if (graph->nbbs != -1 && graph->nbbs != r_list_length (fcn->bbs)) {
+	if (graph->nbbs != -1 && graph->nbbs != m->nbbs) {
 		return false;
 	}
-	if (graph->edges != -1 && graph->edges != r_anal_fcn_count_edges (fcn, &ebbs)) {
+	if (graph->edges != -1 && graph->edges != m->edges) {
 		return false;
 	}
-	if (graph->ebbs != -1 && graph->ebbs != ebbs) {
+	// ebbs is only known when the edges are counted
+	if (graph->ebbs != -1 && (graph->edges == -1 || graph->ebbs != m->ebbs)) {
 		return false;
 	}
-	if (graph->bbsum > 0 && matchCount (graph->bbsum, r_anal_function_linear_size (fcn))) {
+	if (graph->bbsum > 0 && matchCount (graph->bbsum, m->bbsum)) {
 		return false;
 	}
 	return true;
 }
 
+static bool listEq(RList *a, RList *b) {
+	RListIter *ia = r_list_iterator (a);
+	RListIter *ib = r_list_iterator (b);
+	while (ia && ib) {
+		if (strcmp (ia->data, ib->data)) {
+			return false;
+		}
+		ia = ia->n;
+		ib = ib->n;
+	}
+	return ia == ib;
+}
+
 struct ctxFcnMatchCB {
 	RAnal *anal;
 	RAnalFunction *fcn;
 	RSignGraphMatchCallback cb;
 	void *user;
 	int mincc;
+	// the function side of the match, computed once for all the zignatures
+	RSignGraph metrics;
+	char *bbhash;
+	RList *list; // refs, vars or types
 };
 
 static int graphMatchCB(RSignItem *it, void *user) {
@@ -1956,7 +2290,7 @@ static int graphMatchCB(RSignItem *it, void *user) {
 		return 1;
 	}
 
-	if (!fcnMetricsCmp (it, ctx->fcn)) {
+	if (!fcnMetricsCmp (it, &ctx->metrics)) {
 		return 1;
 	}
 
@@ -1967,12 +2301,6 @@ static int graphMatchCB(RSignItem *it, void *user) {
 	return 1;
 }
 
-R_API bool r_sign_match_graph(RAnal *a, RAnalFunction *fcn, int mincc, RSignGraphMatchCallback cb, void *user) {
-	r_return_val_if_fail (a && fcn && cb, false);
-	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, mincc };
-	return r_sign_foreach (a, graphMatchCB, &ctx);
-}
-
 static int addrMatchCB(RSignItem *it, void *user) {
 	struct ctxFcnMatchCB *ctx = (struct ctxFcnMatchCB *) user;
 
@@ -1991,12 +2319,6 @@ static int addrMatchCB(RSignItem *it, void *user) {
 	return 1;
 }
 
-R_API bool r_sign_match_addr(RAnal *a, RAnalFunction *fcn, RSignOffsetMatchCallback cb, void *user) {
-	r_return_val_if_fail (a && fcn && cb, false);
-	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, 0 };
-	return r_sign_foreach (a, addrMatchCB, &ctx);
-}
-
 static int hashMatchCB(RSignItem *it, void *user) {
 	struct ctxFcnMatchCB *ctx = (struct ctxFcnMatchCB *) user;
 	RSignHash *hash = it->hash;
@@ -2005,173 +2327,339 @@ static int hashMatchCB(RSignItem *it, void *user) {
 		return 1;
 	}
 
-	char *digest_hex = r_sign_calc_bbhash (ctx->anal, ctx->fcn);
-	bool retval = false;
-	if (digest_hex && strcmp (hash->bbhash, digest_hex)) {
-		goto beach;
+	if (strcmp (hash->bbhash, ctx->bbhash)) {
+		return 1;
 	}
 
 	if (ctx->cb) {
-		retval = ctx->cb (it, ctx->fcn, ctx->user);
+		return ctx->cb (it, ctx->fcn, ctx->user);
 	}
-beach:
-	free (digest_hex);
-	return retval;
-}
 
-R_API bool r_sign_match_hash(RAnal *a, RAnalFunction *fcn, RSignHashMatchCallback cb, void *user) {
-	r_return_val_if_fail (a && fcn && cb, false);
-	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, 0 };
-	return r_sign_foreach (a, hashMatchCB, &ctx);
+	return 1;
 }
 
-
 static int refsMatchCB(RSignItem *it, void *user) {
 	struct ctxFcnMatchCB *ctx = (struct ctxFcnMatchCB *) user;
-	RList *refs = NULL;
-	char *ref_a = NULL, *ref_b = NULL;
-	int i = 0, retval = 1;
 
-	if (!it->refs) {
+	if (!it->refs || !listEq (it->refs, ctx->list)) {
 		return 1;
 	}
 
-	// TODO(nibble): slow operation, add cache
-	refs = r_sign_fcn_refs (ctx->anal, ctx->fcn);
-	if (!refs) {
-		return 1;
+	if (ctx->cb) {
+		return ctx->cb (it, ctx->fcn, ctx->user);
 	}
 
-	for (i = 0; ; i++) {
-		ref_a = (char *) r_list_get_n (it->refs, i);
-		ref_b = (char *) r_list_get_n (refs, i);
+	return 1;
+}
 
-		if (!ref_a || !ref_b) {
-			if (ref_a != ref_b) {
-				retval = 1;
-				goto out;
-			}
-			break;
-		}
-		if (strcmp (ref_a, ref_b)) {
-			retval = 1;
-			goto out;
-		}
+static int varsMatchCB(RSignItem *it, void *user) {
+	struct ctxFcnMatchCB *ctx = (struct ctxFcnMatchCB *) user;
+
+	if (!it->vars || !listEq (it->vars, ctx->list)) {
+		return 1;
 	}
 
 	if (ctx->cb) {
-		retval = ctx->cb (it, ctx->fcn, ctx->user);
-		goto out;
+		return ctx->cb (it, ctx->fcn, ctx->user);
 	}
 
-out:
-	r_list_free (refs);
-
-	return retval;
-}
-
-R_API bool r_sign_match_refs(RAnal *a, RAnalFunction *fcn, RSignRefsMatchCallback cb, void *user) {
-	r_return_val_if_fail (a && fcn && cb, false);
-	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, 0 };
-	return r_sign_foreach (a, refsMatchCB, &ctx);
+	return 1;
 }
 
-static int varsMatchCB(RSignItem *it, void *user) {
+static int typesMatchCB(RSignItem *it, void *user) {
 	struct ctxFcnMatchCB *ctx = (struct ctxFcnMatchCB *) user;
-	RList *vars = NULL;
-	char *var_a = NULL, *var_b = NULL;
-	int i = 0, retval = 1;
 
-	if (!it->vars) {
+	if (!it->types || !listEq (it->types, ctx->list)) {
 		return 1;
 	}
 
-	// TODO(nibble): slow operation, add cache
-	vars = r_sign_fcn_vars (ctx->anal, ctx->fcn);
-	if (!vars) {
-		return 1;
+	if (ctx->cb) {
+		return ctx->cb (it, ctx->fcn, ctx->user);
 	}
 
-	for (i = 0; ; i++) {
-		var_a = (char *) r_list_get_n (it->vars, i);
-		var_b = (char *) r_list_get_n (vars, i);
+	return 1;
+}
+
+/* zignature index */
 
-		if (!var_a || !var_b) {
-			if (var_a != var_b) {
-				retval = 1;
-				goto out;
-			}
-			break;
-		}
-		if (strcmp (var_a, var_b)) {
-			retval = 1;
-			goto out;
+static void indexFreeKv(HtPPKv *kv) {
+	free (kv->key);
+	r_vector_free (kv->value);
+}
+
+static void indexFreeKvUP(HtUPKv *kv) {
+	r_vector_free (kv->value);
+}
+
+static bool indexAdd(RVector *ids, int id) {
+	return ids && r_vector_push (ids, &id);
+}
+
+static bool indexAddStr(HtPP *ht, const char *key, int id) {
+	RVector *ids = ht_pp_find (ht, key, NULL);
+	if (!ids) {
+		ids = r_vector_new (sizeof (int), NULL, NULL);
+		if (!ids || !ht_pp_insert (ht, key, ids)) {
+			r_vector_free (ids);
+			return false;
 		}
 	}
+	return indexAdd (ids, id);
+}
 
-	if (ctx->cb) {
-		retval = ctx->cb (it, ctx->fcn, ctx->user);
-		goto out;
+static bool indexAddNum(HtUP *ht, ut64 key, int id) {
+	RVector *ids = ht_up_find (ht, key, NULL);
+	if (!ids) {
+		ids = r_vector_new (sizeof (int), NULL, NULL);
+		if (!ids || !ht_up_insert (ht, key, ids)) {
+			r_vector_free (ids);
+			return false;
+		}
 	}
+	return indexAdd (ids, id);
+}
 
-out:
-	r_list_free (vars);
-
-	return retval;
+static ut64 graphKey(int nbbs, int cc) {
+	return ((ut64)(ut32)nbbs << 32) | (ut32)cc;
 }
 
-R_API bool r_sign_match_vars(RAnal *a, RAnalFunction *fcn, RSignVarsMatchCallback cb, void *user) {
-	r_return_val_if_fail (a && fcn && cb, false);
-	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, 0 };
-	return r_sign_foreach (a, varsMatchCB, &ctx);
+static bool indexAddList(HtPP *ht, RList *list, int id) {
+	char *key = r_str_list_join (list, "\n");
+	bool ret = key && indexAddStr (ht, key, id);
+	free (key);
+	return ret;
 }
 
-static int typesMatchCB(RSignItem *it, void *user) {
-	struct ctxFcnMatchCB *ctx = (struct ctxFcnMatchCB *) user;
-	RList *types = NULL;
-	char *type_a = NULL, *type_b = NULL;
-	int i = 0, retval = 1;
+static bool indexAddItem(RSignIndex *idx, RSignItem *it, int id) {
+	bool ret = true;
+	if (it->graph) {
+		ret &= indexAddNum (idx->graphs, graphKey (it->graph->nbbs, it->graph->cc), id);
+	}
+	if (it->addr != UT64_MAX) {
+		ret &= indexAddNum (idx->addrs, it->addr, id);
+	}
+	if (it->hash && it->hash->bbhash && *it->hash->bbhash) {
+		ret &= indexAddStr (idx->bbhashes, it->hash->bbhash, id);
+	}
+	if (it->refs) {
+		ret &= indexAddList (idx->refs, it->refs, id);
+	}
+	if (it->vars) {
+		ret &= indexAddList (idx->vars, it->vars, id);
+	}
+	if (it->types) {
+		ret &= indexAddList (idx->types, it->types, id);
+	}
+	return ret;
+}
 
-	if (!it->types) {
+static int indexCB(void *user, const char *k, const char *v) {
+	RSignIndex *idx = (RSignIndex *) user;
+	RSignItem *it = r_sign_item_new ();
+	if (!it) {
+		return 0;
+	}
+	if (!r_sign_deserialize (idx->anal, it, k, v)) {
+		eprintf ("error: cannot deserialize zign\n");
+		r_sign_item_free (it);
 		return 1;
 	}
-	// TODO(nibble | oxcabe): slow operation, add cache
-	types = r_sign_fcn_types (ctx->anal, ctx->fcn);
-	if (!types) {
+	if (it->space != r_spaces_current (&idx->anal->zign_spaces)) {
+		r_sign_item_free (it);
 		return 1;
 	}
-	for (i = 0; ; i++) {
-		type_a = (char *) r_list_get_n (it->types, i);
-		type_b = (char *) r_list_get_n (types, i);
+	const int id = r_pvector_len (&idx->items);
+	if (!r_pvector_push (&idx->items, it)) {
+		r_sign_item_free (it);
+		return 0;
+	}
+	return indexAddItem (idx, it, id);
+}
 
-		if (!type_a || !type_b) {
-			if (type_a != type_b) {
-				retval = 1;
-				goto out;
-			}
-			break;
+R_API void r_sign_index_free(RSignIndex *idx) {
+	if (!idx) {
+		return;
+	}
+	ht_up_free (idx->graphs);
+	ht_up_free (idx->addrs);
+	ht_pp_free (idx->bbhashes);
+	ht_pp_free (idx->refs);
+	ht_pp_free (idx->vars);
+	ht_pp_free (idx->types);
+	r_pvector_clear (&idx->items);
+	free (idx);
+}
+
+// deserializes the zignatures of the current space once and buckets them by what the matchers compare
+R_API RSignIndex *r_sign_index_new(RAnal *a) {
+	r_return_val_if_fail (a, NULL);
+	RSignIndex *idx = R_NEW0 (RSignIndex);
+	if (!idx) {
+		return NULL;
+	}
+	idx->anal = a;
+	r_pvector_init (&idx->items, (RPVectorFree) r_sign_item_free);
+	idx->graphs = ht_up_new (NULL, indexFreeKvUP, NULL);
+	idx->addrs = ht_up_new (NULL, indexFreeKvUP, NULL);
+	idx->bbhashes = ht_pp_new (NULL, indexFreeKv, NULL);
+	idx->refs = ht_pp_new (NULL, indexFreeKv, NULL);
+	idx->vars = ht_pp_new (NULL, indexFreeKv, NULL);
+	idx->types = ht_pp_new (NULL, indexFreeKv, NULL);
+	if (!idx->graphs || !idx->addrs || !idx->bbhashes || !idx->refs || !idx->vars || !idx->types) {
+		r_sign_index_free (idx);
+		return NULL;
+	}
+	if (!sdb_foreach (a->sdb_zigns, indexCB, idx)) {
+		r_sign_index_free (idx);
+		return NULL;
+	}
+	return idx;
+}
+
+// calls cb on the zignatures of ids, that are sorted like in r_sign_foreach
+static void indexForeach(RSignIndex *idx, RVector *ids, RSignForeachCallback cb, void *user) {
+	int *id;
+	if (ids) {
+		r_vector_foreach (ids, id) {
+			cb (r_pvector_at (&idx->items, *id), user);
 		}
-		if (strcmp (type_a, type_b)) {
-			retval = 1;
-			goto out;
+	}
+}
+
+static bool fcnMatchGraph(RAnal *a, RSignIndex *idx, RAnalFunction *fcn, int mincc, RSignGraphMatchCallback cb, void *user) {
+	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, mincc };
+	fcnMetrics (fcn, &ctx.metrics);
+	if (!idx) {
+		return r_sign_foreach (a, graphMatchCB, &ctx);
+	}
+	// the candidates have the same nbbs and cc as the function, or leave them unset
+	RVector ids;
+	r_vector_init (&ids, sizeof (int), NULL, NULL);
+	const int nbbs[] = { -1, ctx.metrics.nbbs };
+	const int cc[] = { -1, ctx.metrics.cc };
+	int i, j;
+	for (i = 0; i < 2; i++) {
+		for (j = 0; j < 2; j++) {
+			if ((i && nbbs[i] == -1) || (j && cc[j] == -1)) {
+				continue;
+			}
+			RVector *bucket = ht_up_find (idx->graphs, graphKey (nbbs[i], cc[j]), NULL);
+			if (bucket) {
+				r_vector_insert_range (&ids, ids.len, bucket->a, bucket->len);
+			}
 		}
 	}
+	if (ids.len > 1) {
+		qsort (ids.a, ids.len, sizeof (int), cmpid);
+	}
+	indexForeach (idx, &ids, graphMatchCB, &ctx);
+	r_vector_clear (&ids);
+	return true;
+}
 
-	if (ctx->cb) {
-		retval = ctx->cb (it, ctx->fcn, ctx->user);
-		goto out;
+static bool fcnMatchAddr(RAnal *a, RSignIndex *idx, RAnalFunction *fcn, RSignOffsetMatchCallback cb, void *user) {
+	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, 0 };
+	if (!idx) {
+		return r_sign_foreach (a, addrMatchCB, &ctx);
 	}
+	indexForeach (idx, ht_up_find (idx->addrs, fcn->addr, NULL), addrMatchCB, &ctx);
+	return true;
+}
 
-out:
-	r_list_free (types);
+static bool fcnMatchHash(RAnal *a, RSignIndex *idx, RAnalFunction *fcn, RSignHashMatchCallback cb, void *user) {
+	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, 0 };
+	ctx.bbhash = r_sign_calc_bbhash (a, fcn);
+	if (!ctx.bbhash) {
+		return false;
+	}
+	bool retval = true;
+	if (idx) {
+		indexForeach (idx, ht_pp_find (idx->bbhashes, ctx.bbhash, NULL), hashMatchCB, &ctx);
+	} else {
+		retval = r_sign_foreach (a, hashMatchCB, &ctx);
+	}
+	free (ctx.bbhash);
+	return retval;
+}
 
+static bool fcnMatchList(RAnal *a, RSignIndex *idx, HtPP *ht, RList *list, RAnalFunction *fcn, RSignForeachCallback match, RSignGraphMatchCallback cb, void *user) {
+	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, 0 };
+	if (!list) {
+		return false;
+	}
+	ctx.list = list;
+	bool retval = true;
+	if (idx) {
+		char *key = r_str_list_join (list, "\n");
+		if (key) {
+			indexForeach (idx, ht_pp_find (ht, key, NULL), match, &ctx);
+			free (key);
+		}
+	} else {
+		retval = r_sign_foreach (a, match, &ctx);
+	}
+	r_list_free (list);
 	return retval;
 }
 
+R_API bool r_sign_match_graph(RAnal *a, RAnalFunction *fcn, int mincc, RSignGraphMatchCallback cb, void *user) {
+	r_return_val_if_fail (a && fcn && cb, false);
+	return fcnMatchGraph (a, NULL, fcn, mincc, cb, user);
+}
+
+R_API bool r_sign_match_addr(RAnal *a, RAnalFunction *fcn, RSignOffsetMatchCallback cb, void *user) {
+	r_return_val_if_fail (a && fcn && cb, false);
+	return fcnMatchAddr (a, NULL, fcn, cb, user);
+}
+
+R_API bool r_sign_match_hash(RAnal *a, RAnalFunction *fcn, RSignHashMatchCallback cb, void *user) {
+	r_return_val_if_fail (a && fcn && cb, false);
+	return fcnMatchHash (a, NULL, fcn, cb, user);
+}
+
+R_API bool r_sign_match_refs(RAnal *a, RAnalFunction *fcn, RSignRefsMatchCallback cb, void *user) {
+	r_return_val_if_fail (a && fcn && cb, false);
+	return fcnMatchList (a, NULL, NULL, r_sign_fcn_refs (a, fcn), fcn, refsMatchCB, cb, user);
+}
+
+R_API bool r_sign_match_vars(RAnal *a, RAnalFunction *fcn, RSignVarsMatchCallback cb, void *user) {
+	r_return_val_if_fail (a && fcn && cb, false);
+	return fcnMatchList (a, NULL, NULL, r_sign_fcn_vars (a, fcn), fcn, varsMatchCB, cb, user);
+}
+
 R_API bool r_sign_match_types(RAnal *a, RAnalFunction *fcn, RSignVarsMatchCallback cb, void *user) {
 	r_return_val_if_fail (a && fcn && cb, false);
-	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, 0 };
-	return r_sign_foreach (a, typesMatchCB, &ctx);
+	return fcnMatchList (a, NULL, NULL, r_sign_fcn_types (a, fcn), fcn, typesMatchCB, cb, user);
+}
+
+R_API bool r_sign_index_match_graph(RSignIndex *idx, RAnalFunction *fcn, int mincc, RSignGraphMatchCallback cb, void *user) {
+	r_return_val_if_fail (idx && fcn && cb, false);
+	return fcnMatchGraph (idx->anal, idx, fcn, mincc, cb, user);
+}
+
+R_API bool r_sign_index_match_addr(RSignIndex *idx, RAnalFunction *fcn, RSignOffsetMatchCallback cb, void *user) {
+	r_return_val_if_fail (idx && fcn && cb, false);
+	return fcnMatchAddr (idx->anal, idx, fcn, cb, user);
+}
+
+R_API bool r_sign_index_match_hash(RSignIndex *idx, RAnalFunction *fcn, RSignHashMatchCallback cb, void *user) {
+	r_return_val_if_fail (idx && fcn && cb, false);
+	return fcnMatchHash (idx->anal, idx, fcn, cb, user);
+}
+
+R_API bool r_sign_index_match_refs(RSignIndex *idx, RAnalFunction *fcn, RSignRefsMatchCallback cb, void *user) {
+	r_return_val_if_fail (idx && fcn && cb, false);
+	return fcnMatchList (idx->anal, idx, idx->refs, r_sign_fcn_refs (idx->anal, fcn), fcn, refsMatchCB, cb, user);
+}
+
+R_API bool r_sign_index_match_vars(RSignIndex *idx, RAnalFunction *fcn, RSignVarsMatchCallback cb, void *user) {
+	r_return_val_if_fail (idx && fcn && cb, false);
+	return fcnMatchList (idx->anal, idx, idx->vars, r_sign_fcn_vars (idx->anal, fcn), fcn, varsMatchCB, cb, user);
+}
+
+R_API bool r_sign_index_match_types(RSignIndex *idx, RAnalFunction *fcn, RSignVarsMatchCallback cb, void *user) {
+	r_return_val_if_fail (idx && fcn && cb, false);
+	return fcnMatchList (idx->anal, idx, idx->types, r_sign_fcn_types (idx->anal, fcn), fcn, typesMatchCB, cb, user);
 }
 
 R_API RSignItem *r_sign_item_new() {
@@ -2415,6 +2903,7 @@ R_API RSignOptions *r_sign_options_new(const char *bytes_thresh, const char *gra
 		return NULL;
 	}
 
+	options->jobs = 1;
 	options->bytes_diff_threshold = r_num_get_float (NULL, bytes_thresh);
 	options->graph_diff_threshold = r_num_get_float (NULL, graph_thresh);
 
@@ -3,26 +3,35 @@
 #include <r_anal.h>
 #include <r_cons.h>
 
-#if 0
-DICT
-====
+/* Both directions are kept in a RAnalXrefs, sorted by (key, val) pairs:
 
-refs
+refs (key: from, val: to)
   10 -> 20 C
   16 -> 10 J
   20 -> 10 C
 
-xrefs
-  20 -> [ 10 C ]
-  10 -> [ 16 J, 20 C ]
+xrefs (key: to, val: from)
+  10 <- 16 J
+  10 <- 20 C
+  20 <- 10 C
 
 10: call 20
 16: jmp 10
 20: call 10
-#endif
 
-// XXX: is it possible to have multiple type for the same (from, to) pair?
-//      if it is, things need to be adjusted
+The pairs are stored by column in pages of XREFS_PAGE entries, so a range of
+keys is walked without chasing pointers or allocating, and a page is split
+in two when an entry is inserted in the middle of a full one. Only one type
+is kept for each (from, to) pair, the last one set. */
+
+#define XREFS_PAGE 256
+
+typedef struct {
+	int n;
+	ut64 key[XREFS_PAGE];
+	ut64 val[XREFS_PAGE];
+	ut8 type[XREFS_PAGE];
+} XrefsPage;
 
 static RAnalRef *r_anal_ref_new(ut64 addr, ut64 at, ut64 type) {
 	RAnalRef *ref = R_NEW (RAnalRef);
@@ -42,17 +51,217 @@ R_API RList *r_anal_ref_list_new() {
 	return r_list_newf (r_anal_ref_free);
 }
 
-static void xrefs_ht_free(HtUPKv *kv) {
-	ht_up_free (kv->value);
+static RAnalXrefs *xrefs_new(void) {
+	RAnalXrefs *x = R_NEW0 (RAnalXrefs);
+	if (x) {
+		r_pvector_init (&x->pages, free);
+	}
+	return x;
+}
+
+static void xrefs_free(RAnalXrefs *x) {
+	if (x) {
+		r_pvector_clear (&x->pages);
+		free (x);
+	}
+}
+
+static inline int pair_cmp(ut64 ak, ut64 av, ut64 bk, ut64 bv) {
+	if (ak != bk) {
+		return ak < bk? -1: 1;
+	}
+	if (av != bv) {
+		return av < bv? -1: 1;
+	}
+	return 0;
+}
+
+// the last page starting at or before (k, v), or the first one
+static int xrefs_page_find(RAnalXrefs *x, ut64 k, ut64 v) {
+	int lo = 0, hi = r_pvector_len (&x->pages);
+	while (hi - lo > 1) {
+		int mid = lo + (hi - lo) / 2;
+		XrefsPage *p = r_pvector_at (&x->pages, mid);
+		if (pair_cmp (p->key[0], p->val[0], k, v) <= 0) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+// the first entry of the page not below (k, v)
+static int page_lower(XrefsPage *p, ut64 k, ut64 v) {
+	int lo = 0, hi = p->n;
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+		if (pair_cmp (p->key[mid], p->val[mid], k, v) < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+// whether an entry next to the i-th one of page pi has the same key
+static bool xrefs_key_shared(RAnalXrefs *x, int pi, int i) {
+	XrefsPage *p = r_pvector_at (&x->pages, pi);
+	const ut64 k = p->key[i];
+	if (i > 0) {
+		if (p->key[i - 1] == k) {
+			return true;
+		}
+	} else if (pi > 0) {
+		XrefsPage *q = r_pvector_at (&x->pages, pi - 1);
+		if (q->key[q->n - 1] == k) {
+			return true;
+		}
+	}
+	if (i + 1 < p->n) {
+		return p->key[i + 1] == k;
+	}
+	if (pi + 1 < r_pvector_len (&x->pages)) {
+		XrefsPage *q = r_pvector_at (&x->pages, pi + 1);
+		return q->key[0] == k;
+	}
+	return false;
+}
+
+static void page_move(XrefsPage *dst, int di, XrefsPage *src, int si, int n) {
+	memmove (dst->key + di, src->key + si, n * sizeof (ut64));
+	memmove (dst->val + di, src->val + si, n * sizeof (ut64));
+	memmove (dst->type + di, src->type + si, n);
+}
+
+static bool xrefs_set(RAnalXrefs *x, ut64 k, ut64 v, ut8 type) {
+	const int len = r_pvector_len (&x->pages);
+	XrefsPage *p = NULL;
+	int pi = 0, i = 0;
+	if (len) {
+		pi = xrefs_page_find (x, k, v);
+		p = r_pvector_at (&x->pages, pi);
+		i = page_lower (p, k, v);
+		if (i < p->n && p->key[i] == k && p->val[i] == v) {
+			p->type[i] = type;
+			return true;
+		}
+	}
+	if (!p || p->n == XREFS_PAGE) {
+		XrefsPage *q = R_NEW (XrefsPage);
+		if (!q) {
+			return false;
+		}
+		q->n = 0;
+		if (!p || (pi == len - 1 && i == p->n)) {
+			// appending in order leaves the previous pages full
+			r_pvector_push (&x->pages, q);
+			pi = len;
+			p = q;
+			i = 0;
+		} else {
+			const int half = XREFS_PAGE / 2;
+			q->n = p->n - half;
+			page_move (q, 0, p, half, q->n);
+			p->n = half;
+			r_pvector_insert (&x->pages, pi + 1, q);
+			if (i > half) {
+				p = q;
+				pi++;
+				i -= half;
+			}
+		}
+	}
+	page_move (p, i + 1, p, i, p->n - i);
+	p->key[i] = k;
+	p->val[i] = v;
+	p->type[i] = type;
+	p->n++;
+	x->count++;
+	if (!xrefs_key_shared (x, pi, i)) {
+		x->nkeys++;
+	}
+	return true;
+}
+
+static bool xrefs_del(RAnalXrefs *x, ut64 k, ut64 v) {
+	if (r_pvector_empty (&x->pages)) {
+		return false;
+	}
+	int pi = xrefs_page_find (x, k, v);
+	XrefsPage *p = r_pvector_at (&x->pages, pi);
+	int i = page_lower (p, k, v);
+	if (i >= p->n || p->key[i] != k || p->val[i] != v) {
+		return false;
+	}
+	if (!xrefs_key_shared (x, pi, i)) {
+		x->nkeys--;
+	}
+	page_move (p, i, p, i + 1, p->n - i - 1);
+	p->n--;
+	x->count--;
+	if (!p->n) {
+		free (r_pvector_remove_at (&x->pages, pi));
+	} else if (p->n < XREFS_PAGE / 4 && pi + 1 < r_pvector_len (&x->pages)) {
+		XrefsPage *q = r_pvector_at (&x->pages, pi + 1);
+		if (p->n + q->n <= XREFS_PAGE / 2) {
+			page_move (p, p->n, q, 0, q->n);
+			p->n += q->n;
+			free (r_pvector_remove_at (&x->pages, pi + 1));
+		}
+	}
+	return true;
 }
 
-static void xrefs_ref_free(HtUPKv *kv) {
-	r_anal_ref_free (kv->value);
+// removes all the entries of k
+static bool xrefs_del_key(RAnalXrefs *x, ut64 k) {
+	bool res = false;
+	while (!r_pvector_empty (&x->pages)) {
+		int pi = xrefs_page_find (x, k, 0);
+		XrefsPage *p = r_pvector_at (&x->pages, pi);
+		int i = page_lower (p, k, 0);
+		if (i == p->n && pi + 1 < r_pvector_len (&x->pages)) {
+			p = r_pvector_at (&x->pages, pi + 1);
+			i = 0;
+		}
+		if (i >= p->n || p->key[i] != k) {
+			break;
+		}
+		res |= xrefs_del (x, k, p->val[i]);
+	}
+	return res;
 }
 
-static bool appendRef(void *u, const ut64 k, const void *v) {
-	RList *list = (RList *)u;
-	RAnalRef *ref = (RAnalRef *)v;
+// calls cb with the entries whose key is in [from, to], cb must not modify x
+static bool xrefs_foreach(RAnalXrefs *x, bool xref, ut64 from, ut64 to, RAnalRefCmp cb, void *user) {
+	const int len = r_pvector_len (&x->pages);
+	if (!len) {
+		return true;
+	}
+	int pi = xrefs_page_find (x, from, 0);
+	int i = page_lower (r_pvector_at (&x->pages, pi), from, 0);
+	for (; pi < len; pi++, i = 0) {
+		XrefsPage *p = r_pvector_at (&x->pages, pi);
+		for (; i < p->n; i++) {
+			if (p->key[i] > to) {
+				return true;
+			}
+			RAnalRef ref = {
+				.addr = xref? p->key[i]: p->val[i],
+				.at = xref? p->val[i]: p->key[i],
+				.type = p->type[i]
+			};
+			if (!cb (&ref, user)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static bool appendRef(RAnalRef *ref, void *user) {
+	RList *list = (RList *)user;
 	RAnalRef *cloned = r_anal_ref_new (ref->addr, ref->at, ref->type);
 	if (cloned) {
 		r_list_append (list, cloned);
@@ -61,12 +270,6 @@ static bool appendRef(void *u, const ut64 k, const void *v) {
 	return false;
 }
 
-static bool mylistrefs_cb(void *list, const ut64 k, const void *v) {
-	HtUP *ht = (HtUP *)v;
-	ht_up_foreach (ht, appendRef, list);
-	return true;
-}
-
 static int ref_cmp(const RAnalRef *a, const RAnalRef *b) {
 	if (a->at < b->at) {
 		return -1;
@@ -87,33 +290,12 @@ static void sortxrefs(RList *list) {
 	r_list_sort (list, (RListComparator)ref_cmp);
 }
 
-static void listxrefs(HtUP *m, ut64 addr, RList *list) {
+// the lists come out sorted, the indexes are ordered like ref_cmp
+static void listxrefs(RAnalXrefs *m, bool xref, ut64 addr, RList *list) {
 	if (addr == UT64_MAX) {
-		ht_up_foreach (m, mylistrefs_cb, list);
+		xrefs_foreach (m, xref, 0, UT64_MAX, appendRef, list);
 	} else {
-		bool found;
-		HtUP *d = ht_up_find (m, addr, &found);
-		if (!found) {
-			return;
-		}
-
-		ht_up_foreach (d, appendRef, list);
-	}
-}
-
-static void setxref(HtUP *m, ut64 from, ut64 to, int type) {
-	bool found;
-	HtUP *ht = ht_up_find (m, from, &found);
-	if (!found) {
-		ht = ht_up_new (NULL, xrefs_ref_free, NULL);
-		if (!ht) {
-			return;
-		}
-		ht_up_insert (m, from, ht);
-	}
-	RAnalRef *ref = r_anal_ref_new (to, from, type);
-	if (ref) {
-		ht_up_update (ht, to, ref);
+		xrefs_foreach (m, xref, addr, addr, appendRef, list);
 	}
 }
 
@@ -128,8 +310,14 @@ R_API int r_anal_xrefs_set(RAnal *anal, ut64 from, ut64 to, const RAnalRefType t
 	if (!anal->iob.is_valid_offset (anal->iob.io, to, 0)) {
 		return false;
 	}
-	setxref (anal->dict_xrefs, to, from, type);
-	setxref (anal->dict_refs, from, to, type);
+	const ut8 t = (type == -1)? R_ANAL_REF_TYPE_CODE: type;
+	if (!xrefs_set (anal->dict_xrefs, to, from, t)) {
+		return false;
+	}
+	if (!xrefs_set (anal->dict_refs, from, to, t)) {
+		xrefs_del (anal->dict_xrefs, to, from);
+		return false;
+	}
 	return true;
 }
 
@@ -137,24 +325,19 @@ R_API int r_anal_xrefs_deln(RAnal *anal, ut64 from, ut64 to, const RAnalRefType
 	if (!anal) {
 		return false;
 	}
-	ht_up_delete (anal->dict_refs, from);
-	ht_up_delete (anal->dict_xrefs, to);
+	// drops every ref from the source and every xref to the target
+	xrefs_del_key (anal->dict_refs, from);
+	xrefs_del_key (anal->dict_xrefs, to);
 	return true;
 }
 
 R_API int r_anal_xref_del(RAnal *anal, ut64 from, ut64 to) {
-	bool res = false;
-	res |= r_anal_xrefs_deln (anal, from, to, R_ANAL_REF_TYPE_NULL);
-	res |= r_anal_xrefs_deln (anal, from, to, R_ANAL_REF_TYPE_CODE);
-	res |= r_anal_xrefs_deln (anal, from, to, R_ANAL_REF_TYPE_CALL);
-	res |= r_anal_xrefs_deln (anal, from, to, R_ANAL_REF_TYPE_DATA);
-	res |= r_anal_xrefs_deln (anal, from, to, R_ANAL_REF_TYPE_STRING);
-	return res;
+	// deln does not look at the type, one call removes them all
+	return r_anal_xrefs_deln (anal, from, to, R_ANAL_REF_TYPE_NULL);
 }
 
 R_API int r_anal_xrefs_from(RAnal *anal, RList *list, const char *kind, const RAnalRefType type, ut64 addr) {
-	listxrefs (anal->dict_refs, addr, list);
-	sortxrefs (list);
+	listxrefs (anal->dict_refs, false, addr, list);
 	return true;
 }
 
@@ -163,8 +346,7 @@ R_API RList *r_anal_xrefs_get(RAnal *anal, ut64 to) {
 	if (!list) {
 		return NULL;
 	}
-	listxrefs (anal->dict_xrefs, to, list);
-	sortxrefs (list);
+	listxrefs (anal->dict_xrefs, true, to, list);
 	if (r_list_empty (list)) {
 		r_list_free (list);
 		list = NULL;
@@ -177,8 +359,7 @@ R_API RList *r_anal_refs_get(RAnal *anal, ut64 from) {
 	if (!list) {
 		return NULL;
 	}
-	listxrefs (anal->dict_refs, from, list);
-	sortxrefs (list);
+	listxrefs (anal->dict_refs, false, from, list);
 	if (r_list_empty (list)) {
 		r_list_free (list);
 		list = NULL;
@@ -191,8 +372,7 @@ R_API RList *r_anal_xrefs_get_from(RAnal *anal, ut64 to) {
 	if (!list) {
 		return NULL;
 	}
-	listxrefs (anal->dict_refs, to, list);
-	sortxrefs (list);
+	listxrefs (anal->dict_refs, false, to, list);
 	if (r_list_empty (list)) {
 		r_list_free (list);
 		list = NULL;
@@ -200,13 +380,30 @@ R_API RList *r_anal_xrefs_get_from(RAnal *anal, ut64 to) {
 	return list;
 }
 
+// calls cb for the xrefs to addresses in [from, to), in (addr, at) order
+R_API bool r_anal_xrefs_foreach_in(RAnal *anal, ut64 from, ut64 to, RAnalRefCmp cb, void *user) {
+	r_return_val_if_fail (anal && cb, false);
+	if (from >= to) {
+		return true;
+	}
+	return xrefs_foreach (anal->dict_xrefs, true, from, to - 1, cb, user);
+}
+
+// calls cb for the refs from addresses in [from, to), in (at, addr) order
+R_API bool r_anal_refs_foreach_in(RAnal *anal, ut64 from, ut64 to, RAnalRefCmp cb, void *user) {
+	r_return_val_if_fail (anal && cb, false);
+	if (from >= to) {
+		return true;
+	}
+	return xrefs_foreach (anal->dict_refs, false, from, to - 1, cb, user);
+}
+
 R_API void r_anal_xrefs_list(RAnal *anal, int rad) {
 	RListIter *iter;
 	RAnalRef *ref;
 	PJ *pj = NULL;
 	RList *list = r_anal_ref_list_new();
-	listxrefs (anal->dict_refs, UT64_MAX, list);
-	sortxrefs (list);
+	listxrefs (anal->dict_refs, false, UT64_MAX, list);
 	if (rad == 'j') {
 		pj = pj_new ();
 		if (!pj) {
@@ -307,32 +504,46 @@ R_API RAnalRefType r_anal_xrefs_type(char ch) {
 }
 
 R_API bool r_anal_xrefs_init(RAnal *anal) {
-	ht_up_free (anal->dict_refs);
-	anal->dict_refs = NULL;
-	ht_up_free (anal->dict_xrefs);
-	anal->dict_xrefs = NULL;
-
-	HtUP *tmp = ht_up_new (NULL, xrefs_ht_free, NULL);
-	if (!tmp) {
-		return false;
-	}
-	anal->dict_refs = tmp;
-
-	tmp = ht_up_new (NULL, xrefs_ht_free, NULL);
-	if (!tmp) {
-		ht_up_free (anal->dict_refs);
-		anal->dict_refs = NULL;
+	r_anal_xrefs_fini (anal);
+	anal->dict_refs = xrefs_new ();
+	anal->dict_xrefs = xrefs_new ();
+	if (!anal->dict_refs || !anal->dict_xrefs) {
+		r_anal_xrefs_fini (anal);
 		return false;
 	}
-	anal->dict_xrefs = tmp;
 	return true;
 }
 
+R_API void r_anal_xrefs_fini(RAnal *anal) {
+	xrefs_free (anal->dict_refs);
+	anal->dict_refs = NULL;
+	xrefs_free (anal->dict_xrefs);
+	anal->dict_xrefs = NULL;
+}
+
+// number of addresses with xrefs
 R_API int r_anal_xrefs_count(RAnal *anal) {
-	return anal->dict_xrefs->count;
+	return anal->dict_xrefs->nkeys;
+}
+
+typedef struct {
+	RAnalBlock *bb;
+	int i; // first instruction not before the last ref
+	bool xref;
+	RList *list;
+} FcnRefsCtx;
+
+static bool fcn_refs_cb(RAnalRef *ref, void *user) {
+	FcnRefsCtx *ctx = user;
+	const ut64 addr = ctx->xref? ref->addr: ref->at;
+	ut64 at;
+	while ((at = r_anal_bb_opaddr_i (ctx->bb, ctx->i)) < addr) {
+		ctx->i++;
+	}
+	return at != addr || appendRef (ref, ctx->list);
 }
 
-static RList *fcn_get_refs(RAnalFunction *fcn, HtUP *ht) {
+static RList *fcn_get_refs(RAnalFunction *fcn, RAnalXrefs *x, bool xref) {
 	RListIter *iter;
 	RAnalBlock *bb;
 	RList *list = r_anal_ref_list_new ();
@@ -341,12 +552,12 @@ static RList *fcn_get_refs(RAnalFunction *fcn, HtUP *ht) {
 	}
 
 	r_list_foreach (fcn->bbs, iter, bb) {
-		int i;
-
-		for (i = 0; i < bb->ninstr; i++) {
-			ut64 at = bb->addr + r_anal_bb_offset_inst (bb, i);
-			listxrefs (ht, at, list);
+		if (bb->ninstr < 1) {
+			continue;
 		}
+		FcnRefsCtx ctx = { bb, 0, xref, list };
+		const ut64 last = r_anal_bb_opaddr_i (bb, bb->ninstr - 1);
+		xrefs_foreach (x, xref, bb->addr, last, fcn_refs_cb, &ctx);
 	}
 	sortxrefs (list);
 	return list;
@@ -354,11 +565,11 @@ static RList *fcn_get_refs(RAnalFunction *fcn, HtUP *ht) {
 
 R_API RList *r_anal_fcn_get_refs(RAnal *anal, RAnalFunction *fcn) {
 	r_return_val_if_fail (anal && fcn, NULL);
-	return fcn_get_refs (fcn, anal->dict_refs);
+	return fcn_get_refs (fcn, anal->dict_refs, false);
 }
 
 R_API RList *r_anal_fcn_get_xrefs(RAnal *anal, RAnalFunction *fcn) {
-	return fcn_get_refs (fcn, anal->dict_xrefs);
+	return fcn_get_refs (fcn, anal->dict_xrefs, true);
 }
 
 R_API const char *r_anal_ref_type_tostring(RAnalRefType t) {
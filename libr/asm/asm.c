@@ -242,10 +242,21 @@ R_API int r_asm_filter_output(RAsm *a, const char *f) {
 	return true;
 }
 
+static void plugin_data_use(RAsm *a, RAsmPlugin *h) {
+	if (a->cur == h && (a->plugin_data || !h || !h->data_new)) {
+		return;
+	}
+	if (a->cur && a->cur->data_free) {
+		a->cur->data_free (a->plugin_data);
+	}
+	a->plugin_data = (h && h->data_new)? h->data_new (a): NULL;
+}
+
 R_API void r_asm_free(RAsm *a) {
 	if (!a) {
 		return;
 	}
+	plugin_data_use (a, NULL);
 	if (a->cur && a->cur->fini) {
 		a->cur->fini (a->cur->user);
 	}
@@ -340,6 +351,7 @@ R_API bool r_asm_use(RAsm *a, const char *name) {
 				}
 				free (r2prefix);
 			}
+			plugin_data_use (a, h);
 			a->cur = h;
 			return true;
 		}
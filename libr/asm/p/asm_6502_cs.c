@@ -12,36 +12,47 @@
 
 #if CAPSTONE_HAS_MOS65XX
 
-static csh cd = 0;
+// per RAsm instance decoder state, see RAsmPlugin.data_new
+typedef struct {
+	csh cd;
+	int omode;
+} CapstoneContext;
 
-static bool the_end(void *p) {
-	if (cd) {
-		cs_close (&cd);
-		cd = 0;
+static void *data_new(RAsm *a) {
+	return R_NEW0 (CapstoneContext);
+}
+
+static void data_free(void *data) {
+	CapstoneContext *ctx = data;
+	if (ctx && ctx->cd) {
+		cs_close (&ctx->cd);
 	}
-	return true;
+	free (ctx);
 }
 
 static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
-	static int omode = 0;
+	CapstoneContext *ctx = a->plugin_data;
 	int mode, n, ret;
 	ut64 off = a->pc;
 	cs_insn* insn = NULL;
+	if (!ctx) {
+		return -1;
+	}
 	mode = CS_MODE_LITTLE_ENDIAN;
-	if (cd && mode != omode) {
-		cs_close (&cd);
-		cd = 0;
+	if (ctx->cd && mode != ctx->omode) {
+		cs_close (&ctx->cd);
+		ctx->cd = 0;
 	}
 	op->size = 0;
-	omode = mode;
-	if (cd == 0) {
-		ret = cs_open (CS_ARCH_MOS65XX, mode, &cd);
+	ctx->omode = mode;
+	if (ctx->cd == 0) {
+		ret = cs_open (CS_ARCH_MOS65XX, mode, &ctx->cd);
 		if (ret) {
 			return 0;
 		}
-		cs_option (cd, CS_OPT_DETAIL, CS_OPT_OFF);
+		cs_option (ctx->cd, CS_OPT_DETAIL, CS_OPT_OFF);
 	}
-	n = cs_disasm (cd, (const ut8*)buf, len, off, 1, &insn);
+	n = cs_disasm (ctx->cd, (const ut8*)buf, len, off, 1, &insn);
 	if (n>0) {
 		if (insn->size > 0) {
 			op->size = insn->size;
@@ -66,7 +77,8 @@ RAsmPlugin r_asm_plugin_6502_cs = {
 	.arch = "6502",
 	.bits = 8|32,
 	.endian = R_SYS_ENDIAN_LITTLE,
-	.fini = the_end,
+	.data_new = data_new,
+	.data_free = data_free,
 	.disassemble = &disassemble,
 };
 
@@ -6,11 +6,29 @@
 #include "../arch/arm/asm-arm.h"
 
 bool arm64ass(const char *str, ut64 addr, ut32 *op);
-static csh cd = 0;
+
+// per RAsm instance decoder state, see RAsmPlugin.data_new
+typedef struct {
+	csh cd;
+	int omode;
+	int obits;
+} CapstoneContext;
+
+static void *data_new(RAsm *a) {
+	return R_NEW0 (CapstoneContext);
+}
+
+static void data_free(void *data) {
+	CapstoneContext *ctx = data;
+	if (ctx && ctx->cd) {
+		cs_close (&ctx->cd);
+	}
+	free (ctx);
+}
 
 #include "cs_mnemonics.c"
 
-static bool check_features(RAsm *a, cs_insn *insn) {
+static bool check_features(RAsm *a, csh cd, cs_insn *insn) {
 	int i;
 	if (!insn || !insn->detail) {
 		return true;
@@ -40,21 +58,16 @@ static bool check_features(RAsm *a, cs_insn *insn) {
 }
 
 static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
-	static int omode = -1;
-	static int obits = 32;
+	CapstoneContext *ctx = a->plugin_data;
 	bool disp_hash = a->immdisp;
 	cs_insn* insn = NULL;
 	cs_mode mode = 0;
 	int ret, n = 0;
+	if (!ctx) {
+		return -1;
+	}
 	mode |= (a->bits == 16)? CS_MODE_THUMB: CS_MODE_ARM;
 	mode |= (a->big_endian)? CS_MODE_BIG_ENDIAN: CS_MODE_LITTLE_ENDIAN;
-	if (mode != omode || a->bits != obits) {
-		cs_close (&cd);
-		cd = 0; // unnecessary
-		omode = mode;
-		obits = a->bits;
-	}
-
 	if (a->cpu) {
 		if (strstr (a->cpu, "cortex")) {
 			mode |= CS_MODE_MCLASS;
@@ -74,24 +87,31 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 		op->size = 4;
 		r_strbuf_set (&op->buf_asm, "");
 	}
-	if (!cd || mode != omode) {
+	// the handle is kept open until the mode or the bits change
+	if (ctx->cd && (mode != ctx->omode || a->bits != ctx->obits)) {
+		cs_close (&ctx->cd);
+		ctx->cd = 0;
+	}
+	ctx->omode = mode;
+	ctx->obits = a->bits;
+	if (!ctx->cd) {
 		ret = (a->bits == 64)?
-			cs_open (CS_ARCH_ARM64, mode, &cd):
-			cs_open (CS_ARCH_ARM, mode, &cd);
+			cs_open (CS_ARCH_ARM64, mode, &ctx->cd):
+			cs_open (CS_ARCH_ARM, mode, &ctx->cd);
 		if (ret) {
 			ret = -1;
 			goto beach;
 		}
 	}
-	cs_option (cd, CS_OPT_SYNTAX, (a->syntax == R_ASM_SYNTAX_REGNUM)
+	cs_option (ctx->cd, CS_OPT_SYNTAX, (a->syntax == R_ASM_SYNTAX_REGNUM)
 			? CS_OPT_SYNTAX_NOREGNAME
 			: CS_OPT_SYNTAX_DEFAULT);
-	cs_option (cd, CS_OPT_DETAIL, (a->features && *a->features)
+	cs_option (ctx->cd, CS_OPT_DETAIL, (a->features && *a->features)
 		? CS_OPT_ON: CS_OPT_OFF);
 	if (!buf) {
 		goto beach;
 	}
-	n = cs_disasm (cd, buf, R_MIN (4, len), a->pc, 1, &insn);
+	n = cs_disasm (ctx->cd, buf, R_MIN (4, len), a->pc, 1, &insn);
 	if (n < 1 || insn->size < 1) {
 		ret = -1;
 		goto beach;
@@ -100,7 +120,7 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 		op->size = 0;
 	}
 	if (a->features && *a->features) {
-		if (!check_features (a, insn) && op) {
+		if (!check_features (a, ctx->cd, insn) && op) {
 			op->size = insn->size;
 			r_strbuf_set (&op->buf_asm, "illegal");
 		}
@@ -118,7 +138,6 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 	}
 	cs_free (insn, n);
 	beach:
-	cs_close (&cd);
 	if (op) {
 		if (!*r_strbuf_get (&op->buf_asm)) {
 			r_strbuf_set (&op->buf_asm, "invalid");
@@ -189,6 +208,8 @@ RAsmPlugin r_asm_plugin_arm_cs = {
 	.disassemble = &disassemble,
 	.mnemonics = mnemonics,
 	.assemble = &assemble,
+	.data_new = data_new,
+	.data_free = data_free,
 #if 0
 	// arm32 and arm64
 	"crypto,databarrier,divide,fparmv8,multpro,neon,t2extractpack,"
@@ -21,21 +21,42 @@
 #define M68K_LONGEST_INSTRUCTION 10
 
 static bool check_features(RAsm *a, cs_insn *insn);
-static csh cd = 0;
+
+// per RAsm instance decoder state, see RAsmPlugin.data_new
+typedef struct {
+	csh cd;
+	int omode;
+	int obits;
+} CapstoneContext;
+
+static void *data_new(RAsm *a) {
+	return R_NEW0 (CapstoneContext);
+}
+
+static void data_free(void *data) {
+	CapstoneContext *ctx = data;
+	if (ctx && ctx->cd) {
+		cs_close (&ctx->cd);
+	}
+	free (ctx);
+}
+
 #include "cs_mnemonics.c"
 
 static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 	const char *buf_asm = NULL;
-	static int omode = -1;
-	static int obits = 32;
+	CapstoneContext *ctx = a->plugin_data;
 	cs_insn* insn = NULL;
 	int ret = 0, n = 0;
+	if (!ctx) {
+		return -1;
+	}
 	cs_mode mode = a->big_endian? CS_MODE_BIG_ENDIAN: CS_MODE_LITTLE_ENDIAN;
-	if (mode != omode || a->bits != obits) {
-		cs_close (&cd);
-		cd = 0; // unnecessary
-		omode = mode;
-		obits = a->bits;
+	if (mode != ctx->omode || a->bits != ctx->obits) {
+		cs_close (&ctx->cd);
+		ctx->cd = 0; // unnecessary
+		ctx->omode = mode;
+		ctx->obits = a->bits;
 	}
 
 	// replace this with the asm.features?
@@ -60,17 +81,17 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 	if (op) {
 		op->size = 4;
 	}
-	if (cd == 0) {
-		ret = cs_open (CS_ARCH_M68K, mode, &cd);
+	if (ctx->cd == 0) {
+		ret = cs_open (CS_ARCH_M68K, mode, &ctx->cd);
 		if (ret) {
 			ret = -1;
 			goto beach;
 		}
 	}
 	if (a->features && *a->features) {
-		cs_option (cd, CS_OPT_DETAIL, CS_OPT_ON);
+		cs_option (ctx->cd, CS_OPT_DETAIL, CS_OPT_ON);
 	} else {
-		cs_option (cd, CS_OPT_DETAIL, CS_OPT_OFF);
+		cs_option (ctx->cd, CS_OPT_DETAIL, CS_OPT_OFF);
 	}
 	if (!buf) {
 		goto beach;
@@ -80,7 +101,7 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 	int mylen = R_MIN (M68K_LONGEST_INSTRUCTION, len);
 	memcpy (mybuf, buf, mylen);
 
-	n = cs_disasm (cd, mybuf, mylen, a->pc, 1, &insn);
+	n = cs_disasm (ctx->cd, mybuf, mylen, a->pc, 1, &insn);
 	if (n < 1) {
 		ret = -1;
 		goto beach;
@@ -134,6 +155,8 @@ RAsmPlugin r_asm_plugin_m68k_cs = {
 	.endian = R_SYS_ENDIAN_BIG,
 	.disassemble = &disassemble,
 	.mnemonics = &mnemonics,
+	.data_new = data_new,
+	.data_free = data_free,
 };
 
 static bool check_features(RAsm *a, cs_insn *insn) {
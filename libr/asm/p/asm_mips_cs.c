@@ -6,16 +6,34 @@
 
 R_IPI int mips_assemble(const char *str, ut64 pc, ut8 *out);
 
-static csh cd = 0;
+// per RAsm instance decoder state, see RAsmPlugin.data_new
+typedef struct {
+	csh cd;
+	int omode;
+} CapstoneContext;
+
+static void *data_new(RAsm *a) {
+	return R_NEW0 (CapstoneContext);
+}
+
+static void data_free(void *data) {
+	CapstoneContext *ctx = data;
+	if (ctx && ctx->cd) {
+		cs_close (&ctx->cd);
+	}
+	free (ctx);
+}
+
 #include "cs_mnemonics.c"
 
 static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
+	CapstoneContext *ctx = a->plugin_data;
 	cs_insn* insn;
 	int mode, n, ret = -1;
-	mode = (a->big_endian)? CS_MODE_BIG_ENDIAN: CS_MODE_LITTLE_ENDIAN;
-	if (!op) {
-		return 0;
+	if (!ctx) {
+		return -1;
 	}
+	mode = (a->big_endian)? CS_MODE_BIG_ENDIAN: CS_MODE_LITTLE_ENDIAN;
 	if (a->cpu && *a->cpu) {
 		if (!strcmp (a->cpu, "micro")) {
 			mode |= CS_MODE_MICRO;
@@ -30,22 +48,29 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 		}
 	}
 	mode |= (a->bits == 64)? CS_MODE_MIPS64 : CS_MODE_MIPS32;
-	memset (op, 0, sizeof (RAsmOp));
-	op->size = 4;
-	if (cd != 0) {
-		cs_close (&cd);
+	if (ctx->cd && mode != ctx->omode) {
+		cs_close (&ctx->cd);
+		ctx->cd = 0;
 	}
-	ret = cs_open (CS_ARCH_MIPS, mode, &cd);
-	if (ret) {
-		goto fin;
+	ctx->omode = mode;
+	if (!ctx->cd) {
+		ret = cs_open (CS_ARCH_MIPS, mode, &ctx->cd);
+		if (ret) {
+			return -1;
+		}
 	}
+	if (!op) {
+		return 0;
+	}
+	memset (op, 0, sizeof (RAsmOp));
+	op->size = 4;
 	if (a->syntax == R_ASM_SYNTAX_REGNUM) {
-		cs_option (cd, CS_OPT_SYNTAX, CS_OPT_SYNTAX_NOREGNAME);
+		cs_option (ctx->cd, CS_OPT_SYNTAX, CS_OPT_SYNTAX_NOREGNAME);
 	} else {
-		cs_option (cd, CS_OPT_SYNTAX, CS_OPT_SYNTAX_DEFAULT);
+		cs_option (ctx->cd, CS_OPT_SYNTAX, CS_OPT_SYNTAX_DEFAULT);
 	}
-	cs_option (cd, CS_OPT_DETAIL, CS_OPT_OFF);
-	n = cs_disasm (cd, (ut8*)buf, len, a->pc, 1, &insn);
+	cs_option (ctx->cd, CS_OPT_DETAIL, CS_OPT_OFF);
+	n = cs_disasm (ctx->cd, (ut8*)buf, len, a->pc, 1, &insn);
 	if (n < 1) {
 		r_asm_op_set_asm (op, "invalid");
 		op->size = 4;
@@ -64,8 +89,6 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 	}
 	cs_free (insn, n);
 beach:
-	// cs_close (&cd);
-fin:
 	return op->size;
 }
 
@@ -94,7 +117,9 @@ RAsmPlugin r_asm_plugin_mips_cs = {
 	.endian = R_SYS_ENDIAN_LITTLE | R_SYS_ENDIAN_BIG,
 	.disassemble = &disassemble,
 	.mnemonics = mnemonics,
-	.assemble = &assemble
+	.assemble = &assemble,
+	.data_new = data_new,
+	.data_free = data_free,
 };
 
 #ifndef R2_PLUGIN_INCORE
@@ -6,14 +6,23 @@
 #include "../arch/ppc/libvle/vle.h"
 #include "../arch/ppc/libps/libps.h"
 
-static csh handle = 0;
+// per RAsm instance decoder state, see RAsmPlugin.data_new
+typedef struct {
+	csh cd;
+	int omode;
+	int obits;
+} CapstoneContext;
 
-static bool the_end(void *p) {
-	if (handle) {
-		cs_close (&handle);
-		handle = 0;
+static void *data_new(RAsm *a) {
+	return R_NEW0 (CapstoneContext);
+}
+
+static void data_free(void *data) {
+	CapstoneContext *ctx = data;
+	if (ctx && ctx->cd) {
+		cs_close (&ctx->cd);
 	}
-	return true;
+	free (ctx);
 }
 
 static int decompile_vle(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
@@ -54,7 +63,7 @@ static int decompile_ps(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 }
 
 static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
-	static int omode = -1, obits = -1;
+	CapstoneContext *ctx = a->plugin_data;
 	int n, ret;
 	ut64 off = a->pc;
 	cs_insn* insn;
@@ -80,21 +89,24 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 			return op->size;
 		}
 	}
-	if (mode != omode || a->bits != obits) {
-		cs_close (&handle);
-		handle = 0;
-		omode = mode;
-		obits = a->bits;
+	if (!ctx) {
+		return -1;
+	}
+	if (mode != ctx->omode || a->bits != ctx->obits) {
+		cs_close (&ctx->cd);
+		ctx->cd = 0;
+		ctx->omode = mode;
+		ctx->obits = a->bits;
 	}
-	if (handle == 0) {
-		ret = cs_open (CS_ARCH_PPC, mode, &handle);
+	if (ctx->cd == 0) {
+		ret = cs_open (CS_ARCH_PPC, mode, &ctx->cd);
 		if (ret != CS_ERR_OK) {
 			return -1;
 		}
 	}
 	op->size = 4;
-	cs_option (handle, CS_OPT_DETAIL, CS_OPT_OFF);
-	n = cs_disasm (handle, (const ut8*) buf, len, off, 1, &insn);
+	cs_option (ctx->cd, CS_OPT_DETAIL, CS_OPT_OFF);
+	n = cs_disasm (ctx->cd, (const ut8*) buf, len, off, 1, &insn);
 	op->size = 4;
 	if (n > 0 && insn->size > 0) {
 		const char *opstr = sdb_fmt ("%s%s%s", insn->mnemonic,
@@ -118,7 +130,8 @@ RAsmPlugin r_asm_plugin_ppc_cs = {
 	.cpus = "ppc,vle,ps",
 	.bits = 32 | 64,
 	.endian = R_SYS_ENDIAN_LITTLE | R_SYS_ENDIAN_BIG,
-	.fini = the_end,
+	.data_new = data_new,
+	.data_free = data_free,
 	.disassemble = &disassemble,
 };
 
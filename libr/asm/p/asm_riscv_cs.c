@@ -6,29 +6,54 @@
 
 #if CSNEXT
 
-static csh cd = 0;
+// per RAsm instance decoder state, see RAsmPlugin.data_new
+typedef struct {
+	csh cd;
+	int omode;
+} CapstoneContext;
+
+static void *data_new(RAsm *a) {
+	return R_NEW0 (CapstoneContext);
+}
+
+static void data_free(void *data) {
+	CapstoneContext *ctx = data;
+	if (ctx && ctx->cd) {
+		cs_close (&ctx->cd);
+	}
+	free (ctx);
+}
+
 #include "cs_mnemonics.c"
 
 static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
+	CapstoneContext *ctx = a->plugin_data;
 	cs_insn* insn;
 	int mode = (a->bits == 64)? CS_MODE_RISCV64 : CS_MODE_RISCV32;
-	op->size = 4;
-	if (cd != 0) {
-		cs_close (&cd);
+	if (!ctx) {
+		return -1;
+	}
+	if (ctx->cd && mode != ctx->omode) {
+		cs_close (&ctx->cd);
+		ctx->cd = 0;
 	}
-	int ret = cs_open (CS_ARCH_RISCV, mode, &cd);
-	if (ret) {
-		goto fin;
+	ctx->omode = mode;
+	if (!ctx->cd && cs_open (CS_ARCH_RISCV, mode, &ctx->cd)) {
+		return -1;
 	}
+	if (!op) {
+		return 0;
+	}
+	op->size = 4;
 #if 0
 	if (a->syntax == R_ASM_SYNTAX_REGNUM) {
-		cs_option (cd, CS_OPT_SYNTAX, CS_OPT_SYNTAX_NOREGNAME);
+		cs_option (ctx->cd, CS_OPT_SYNTAX, CS_OPT_SYNTAX_NOREGNAME);
 	} else {
-		cs_option (cd, CS_OPT_SYNTAX, CS_OPT_SYNTAX_DEFAULT);
+		cs_option (ctx->cd, CS_OPT_SYNTAX, CS_OPT_SYNTAX_DEFAULT);
 	}
-	cs_option (cd, CS_OPT_DETAIL, CS_OPT_OFF);
+	cs_option (ctx->cd, CS_OPT_DETAIL, CS_OPT_OFF);
 #endif
-	int n = cs_disasm (cd, (ut8*)buf, len, a->pc, 1, &insn);
+	int n = cs_disasm (ctx->cd, (ut8*)buf, len, a->pc, 1, &insn);
 	if (n < 1) {
 		r_asm_op_set_asm (op, "invalid");
 		op->size = 2;
@@ -47,8 +72,6 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 	}
 	cs_free (insn, n);
 beach:
-	// cs_close (&cd);
-fin:
 	return op->size;
 }
 
@@ -62,6 +85,8 @@ RAsmPlugin r_asm_plugin_riscv_cs = {
 	.endian = R_SYS_ENDIAN_LITTLE | R_SYS_ENDIAN_BIG,
 	.disassemble = &disassemble,
 	.mnemonics = mnemonics,
+	.data_new = data_new,
+	.data_free = data_free,
 };
 
 #ifndef R2_PLUGIN_INCORE
@@ -3,13 +3,35 @@
 #include <r_asm.h>
 #include <r_lib.h>
 #include <capstone/capstone.h>
-static csh cd = 0;
+
+// per RAsm instance decoder state, see RAsmPlugin.data_new
+typedef struct {
+	csh cd;
+	int omode;
+} CapstoneContext;
+
+static void *data_new(RAsm *a) {
+	return R_NEW0 (CapstoneContext);
+}
+
+static void data_free(void *data) {
+	CapstoneContext *ctx = data;
+	if (ctx && ctx->cd) {
+		cs_close (&ctx->cd);
+	}
+	free (ctx);
+}
+
 #include "cs_mnemonics.c"
 
 static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
+	CapstoneContext *ctx = a->plugin_data;
 	cs_insn* insn;
 	int n = -1, ret = -1;
 	int mode = CS_MODE_BIG_ENDIAN;
+	if (!ctx) {
+		return -1;
+	}
 	if (a->cpu && *a->cpu) {
 		if (!strcmp (a->cpu, "v9")) {
 			mode |= CS_MODE_V9;
@@ -19,19 +41,23 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 		memset (op, 0, sizeof (RAsmOp));
 		op->size = 4;
 	}
-	if (cd != 0) {
-		cs_close (&cd);
+	if (ctx->cd && mode != ctx->omode) {
+		cs_close (&ctx->cd);
+		ctx->cd = 0;
 	}
-	ret = cs_open (CS_ARCH_SPARC, mode, &cd);
-	if (ret) {
-		goto fin;
+	ctx->omode = mode;
+	if (!ctx->cd) {
+		ret = cs_open (CS_ARCH_SPARC, mode, &ctx->cd);
+		if (ret) {
+			return -1;
+		}
 	}
-	cs_option (cd, CS_OPT_DETAIL, CS_OPT_OFF);
+	cs_option (ctx->cd, CS_OPT_DETAIL, CS_OPT_OFF);
 	if (!op) {
 		return 0;
 	}
 	if (a->big_endian) {
-		n = cs_disasm (cd, buf, len, a->pc, 1, &insn);
+		n = cs_disasm (ctx->cd, buf, len, a->pc, 1, &insn);
 	}
 	if (n < 1) {
 		r_asm_op_set_asm (op, "invalid");
@@ -53,8 +79,6 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 	// TODO: remove the '$'<registername> in the string
 	cs_free (insn, n);
 	beach:
-	// cs_close (&cd);
-	fin:
 	return ret;
 }
 
@@ -67,7 +91,9 @@ RAsmPlugin r_asm_plugin_sparc_cs = {
 	.bits = 32|64,
 	.endian = R_SYS_ENDIAN_BIG | R_SYS_ENDIAN_LITTLE,
 	.disassemble = &disassemble,
-	.mnemonics = mnemonics
+	.mnemonics = mnemonics,
+	.data_new = data_new,
+	.data_free = data_free,
 };
 
 #ifndef R2_PLUGIN_INCORE
@@ -12,8 +12,6 @@
 #include <r_asm.h>
 #include <capstone/capstone.h>
 
-static csh cd = 0;
-
 #ifdef CAPSTONE_TMS320C64X_H
 #define CAPSTONE_HAS_TMS320C64X 1
 //#include "cs_mnemonics.c"
@@ -24,26 +22,46 @@ static csh cd = 0;
 
 #if CAPSTONE_HAS_TMS320C64X
 
+// per RAsm instance decoder state for c64x, see RAsmPlugin.data_new
+typedef struct {
+	csh cd;
+} CapstoneContext;
+
+static void *data_new(RAsm *a) {
+	return R_NEW0 (CapstoneContext);
+}
+
+static void data_free(void *data) {
+	CapstoneContext *ctx = data;
+	if (ctx && ctx->cd) {
+		cs_close (&ctx->cd);
+	}
+	free (ctx);
+}
+
 static int tms320c64x_disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
+	CapstoneContext *ctx = a->plugin_data;
 	cs_insn* insn;
 	int n = -1, ret = -1;
 	int mode = 0;
+	if (!ctx) {
+		return -1;
+	}
 	if (op) {
 		memset (op, 0, sizeof (RAsmOp));
 		op->size = 4;
 	}
-	if (cd != 0) {
-		cs_close (&cd);
-	}
-	ret = cs_open (CS_ARCH_TMS320C64X, mode, &cd);
-	if (ret) {
-		goto fin;
+	if (!ctx->cd) {
+		ret = cs_open (CS_ARCH_TMS320C64X, mode, &ctx->cd);
+		if (ret) {
+			return -1;
+		}
 	}
-	cs_option (cd, CS_OPT_DETAIL, CS_OPT_OFF);
+	cs_option (ctx->cd, CS_OPT_DETAIL, CS_OPT_OFF);
 	if (!op) {
 		return 0;
 	}
-	n = cs_disasm (cd, buf, len, a->pc, 1, &insn);
+	n = cs_disasm (ctx->cd, buf, len, a->pc, 1, &insn);
 	if (n < 1) {
 		r_asm_op_set_asm (op, "invalid");
 		op->size = 4;
@@ -62,8 +80,6 @@ static int tms320c64x_disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len)
 	r_asm_op_set_asm (op, buf_asm);
 	cs_free (insn, n);
 	beach:
-	// cs_close (&cd);
-	fin:
 	return ret;
 }
 #endif
@@ -116,6 +132,10 @@ RAsmPlugin r_asm_plugin_tms320 = {
 	.endian = R_SYS_ENDIAN_LITTLE | R_SYS_ENDIAN_BIG,
 	.init = tms320_init,
 	.fini = tms320_fini,
+#if CAPSTONE_HAS_TMS320C64X
+	.data_new = data_new,
+	.data_free = data_free,
+#endif
 	.disassemble = &tms320_disassemble,
 };
 
@@ -3,7 +3,25 @@
 #include <r_asm.h>
 #include <r_lib.h>
 #include <capstone/capstone.h>
-static csh cd = 0;
+
+// per RAsm instance decoder state, see RAsmPlugin.data_new
+typedef struct {
+	csh cd;
+	int omode;
+} CapstoneContext;
+
+static void *data_new(RAsm *a) {
+	return R_NEW0 (CapstoneContext);
+}
+
+static void data_free(void *data) {
+	CapstoneContext *ctx = data;
+	if (ctx && ctx->cd) {
+		cs_close (&ctx->cd);
+	}
+	free (ctx);
+}
+
 #include "cs_mnemonics.c"
 
 #ifdef CAPSTONE_TMS320C64X_H
@@ -16,25 +34,33 @@ static csh cd = 0;
 #if CAPSTONE_HAS_TMS320C64X
 
 static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
+	CapstoneContext *ctx = a->plugin_data;
 	cs_insn* insn;
 	int n = -1, ret = -1;
 	int mode = 0;
+	if (!ctx) {
+		return -1;
+	}
 	if (op) {
 		memset (op, 0, sizeof (RAsmOp));
 		op->size = 4;
 	}
-	if (cd != 0) {
-		cs_close (&cd);
+	if (ctx->cd && mode != ctx->omode) {
+		cs_close (&ctx->cd);
+		ctx->cd = 0;
 	}
-	ret = cs_open (CS_ARCH_TMS320C64X, mode, &cd);
-	if (ret) {
-		goto fin;
+	ctx->omode = mode;
+	if (!ctx->cd) {
+		ret = cs_open (CS_ARCH_TMS320C64X, mode, &ctx->cd);
+		if (ret) {
+			return -1;
+		}
 	}
-	cs_option (cd, CS_OPT_DETAIL, CS_OPT_OFF);
+	cs_option (ctx->cd, CS_OPT_DETAIL, CS_OPT_OFF);
 	if (!op) {
 		return 0;
 	}
-	n = cs_disasm (cd, buf, len, a->pc, 1, &insn);
+	n = cs_disasm (ctx->cd, buf, len, a->pc, 1, &insn);
 	if (n < 1) {
 		r_asm_op_set_asm (op, "invalid");
 		op->size = 4;
@@ -54,8 +80,6 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 	r_str_case (r_strbuf_get (&op->buf_asm), false);
 	cs_free (insn, n);
 	beach:
-	// cs_close (&cd);
-	fin:
 	return ret;
 }
 
@@ -67,7 +91,9 @@ RAsmPlugin r_asm_plugin_tms320c64x = {
 	.bits = 32,
 	.endian = R_SYS_ENDIAN_BIG | R_SYS_ENDIAN_LITTLE,
 	.disassemble = &disassemble,
-	.mnemonics = mnemonics
+	.mnemonics = mnemonics,
+	.data_new = data_new,
+	.data_free = data_free,
 };
 
 #else
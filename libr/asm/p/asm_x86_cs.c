@@ -6,71 +6,74 @@
 
 #define USE_ITER_API 0
 
-static csh cd = 0;
-static int n = 0;
+// per RAsm instance decoder state, see RAsmPlugin.data_new
+typedef struct {
+	csh cd;
+	int omode;
+} CapstoneContext;
 
-static bool the_end(void *p) {
-#if 0
-#if !USE_ITER_API
-	if (insn) {
-		cs_free (insn, n);
-		insn = NULL;
-	}
-#endif
-#endif
-	if (cd) {
-		cs_close (&cd);
-		cd = 0;
+static void *data_new(RAsm *a) {
+	return R_NEW0 (CapstoneContext);
+}
+
+static void data_free(void *data) {
+	CapstoneContext *ctx = data;
+	if (ctx && ctx->cd) {
+		cs_close (&ctx->cd);
 	}
-	return true;
+	free (ctx);
 }
 
-static int check_features(RAsm *a, cs_insn *insn);
+static int check_features(RAsm *a, csh cd, cs_insn *insn);
 
 #include "cs_mnemonics.c"
 
 #include "asm_x86_vm.c"
 
 static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
-	static int omode = 0;
-	int mode, ret;
+	CapstoneContext *ctx = a->plugin_data;
+	int mode, n, ret;
 	ut64 off = a->pc;
 
+	if (!ctx) {
+		return -1;
+	}
+
 	mode =  (a->bits == 64)? CS_MODE_64:
 		(a->bits == 32)? CS_MODE_32:
 		(a->bits == 16)? CS_MODE_16: 0;
-	if (cd && mode != omode) {
-		cs_close (&cd);
-		cd = 0;
+	if (ctx->cd && mode != ctx->omode) {
+		cs_close (&ctx->cd);
+		ctx->cd = 0;
 	}
 	if (op) {
 		op->size = 0;
 	}
-	omode = mode;
-	if (cd == 0) {
-		ret = cs_open (CS_ARCH_X86, mode, &cd);
+	ctx->omode = mode;
+	if (ctx->cd == 0) {
+		ret = cs_open (CS_ARCH_X86, mode, &ctx->cd);
 		if (ret) {
 			return 0;
 		}
 	}
 	if (a->features && *a->features) {
-		cs_option (cd, CS_OPT_DETAIL, CS_OPT_ON);
+		cs_option (ctx->cd, CS_OPT_DETAIL, CS_OPT_ON);
 	} else {
-		cs_option (cd, CS_OPT_DETAIL, CS_OPT_OFF);
+		cs_option (ctx->cd, CS_OPT_DETAIL, CS_OPT_OFF);
 	}
 	// always unsigned immediates (kernel addresses)
 	// maybe r2 should have an option for this too?
 #if CS_API_MAJOR >= 4
-	cs_option (cd, CS_OPT_UNSIGNED, CS_OPT_ON);
+	cs_option (ctx->cd, CS_OPT_UNSIGNED, CS_OPT_ON);
 #endif
 	if (a->syntax == R_ASM_SYNTAX_MASM) {
 #if CS_API_MAJOR >= 4
-		cs_option (cd, CS_OPT_SYNTAX, CS_OPT_SYNTAX_MASM);
+		cs_option (ctx->cd, CS_OPT_SYNTAX, CS_OPT_SYNTAX_MASM);
 #endif
 	} else if (a->syntax == R_ASM_SYNTAX_ATT) {
-		cs_option (cd, CS_OPT_SYNTAX, CS_OPT_SYNTAX_ATT);
+		cs_option (ctx->cd, CS_OPT_SYNTAX, CS_OPT_SYNTAX_ATT);
 	} else {
-		cs_option (cd, CS_OPT_SYNTAX, CS_OPT_SYNTAX_INTEL);
+		cs_option (ctx->cd, CS_OPT_SYNTAX, CS_OPT_SYNTAX_INTEL);
 	}
 	if (!op) {
 		return true;
@@ -80,8 +83,8 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 #if USE_ITER_API
 	{
 		size_t size = len;
-		if (!insn || cd < 1) {
-			insn = cs_malloc (cd);
+		if (!insn || ctx->cd < 1) {
+			insn = cs_malloc (ctx->cd);
 		}
 		if (!insn) {
 			cs_free (insn, n);
@@ -89,16 +92,16 @@ static int disassemble(RAsm *a, RAsmOp *op, const ut8 *buf, int len) {
 		}
 		memset (insn, 0, insn->size);
 		insn->size = 1;
-		n = cs_disasm_iter (cd, (const uint8_t**)&buf, &size, (uint64_t*)&off, insn);
+		n = cs_disasm_iter (ctx->cd, (const uint8_t**)&buf, &size, (uint64_t*)&off, insn);
 	}
 #else
-	n = cs_disasm (cd, (const ut8*)buf, len, off, 1, &insn);
+	n = cs_disasm (ctx->cd, (const ut8*)buf, len, off, 1, &insn);
 #endif
 	if (op) {
 		op->size = 0;
 	}
 	if (a->features && *a->features) {
-		if (!check_features (a, insn)) {
+		if (!check_features (a, ctx->cd, insn)) {
 			op->size = insn->size;
 			r_asm_op_set_asm (op, "illegal");
 		}
@@ -162,7 +165,8 @@ RAsmPlugin r_asm_plugin_x86_cs = {
 	.arch = "x86",
 	.bits = 16|32|64,
 	.endian = R_SYS_ENDIAN_LITTLE,
-	.fini = the_end,
+	.data_new = data_new,
+	.data_free = data_free,
 	.mnemonics = mnemonics,
 	.disassemble = &disassemble,
 	.features = "vm,3dnow,aes,adx,avx,avx2,avx512,bmi,bmi2,cmov,"
@@ -170,7 +174,7 @@ RAsmPlugin r_asm_plugin_x86_cs = {
 		"sse3,sse41,sse42,sse4a,ssse3,pclmul,xop"
 };
 
-static int check_features(RAsm *a, cs_insn *insn) {
+static int check_features(RAsm *a, csh cd, cs_insn *insn) {
 	const char *name;
 	int i;
 	if (!insn || !insn->detail) {
@@ -1,6 +1,12 @@
+// expects the including plugin to keep its CapstoneContext in a->plugin_data
 static char *mnemonics(RAsm *a, int id, bool json) {
+	CapstoneContext *ctx = a->plugin_data;
 	int i;
 	a->cur->disassemble (a, NULL, NULL, -1);
+	if (!ctx || !ctx->cd) {
+		return NULL;
+	}
+	csh cd = ctx->cd;
 	if (id != -1) {
 		const char *name = cs_insn_name (cd, id);
 		if (json) {
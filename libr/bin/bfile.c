@@ -7,6 +7,29 @@
 // maybe too big sometimes? 2KB of stack eaten here..
 #define R_STRING_SCAN_BUFFER_SIZE 2048
 #define R_STRING_MAX_UNI_BLOCKS 4
+#define R_STRING_SCAN_CHUNK (4 * 1024 * 1024)
+// room for the longest string (R_STRING_SCAN_BUFFER_SIZE utf32 runes) that starts in a chunk
+#define R_STRING_SCAN_OVERLAP (64 * 1024)
+#define R_BIN_HASH_BLOCK_SIZE (4 * 1024 * 1024)
+
+typedef struct {
+	ut64 at; // top of the scan loop the string was found at
+	RBinString *bs;
+} StringScanHit;
+
+typedef struct {
+	RBinFile *bf;
+	int min;
+	int type;
+	ut64 from, to; // whole range
+	ut64 cs, ce; // chunk
+	ut64 wfrom, wto; // bytes in buf
+	ut8 *buf;
+	ut8 *tops; // bitmap of the loop tops in [cs, cs + R_STRING_SCAN_OVERLAP)
+	RVector hits;
+	ut64 end; // first loop top at or past ce
+	bool breaked;
+} StringScan;
 
 static RBinClass *__getClass(RBinFile *bf, const char *name) {
 	r_return_val_if_fail (bf && bf->o && bf->o->classes_ht && name, NULL);
@@ -112,58 +135,86 @@ static void print_string(RBinFile *bf, RBinString *string, int raw, PJ *pj) {
 	}
 }
 
-static int string_scan_range(RList *list, RBinFile *bf, int min,
-			      const ut64 from, const ut64 to, int type, int raw, RBinSection *section) {
-	RBin *bin = bf->rbin;
-	ut8 tmp[R_STRING_SCAN_BUFFER_SIZE];
-	ut64 str_start, needle = from;
-	int count = 0, i, rc, runes;
-	int str_type = R_STRING_TYPE_DETECT;
-
-	// if list is null it means its gonna dump
-	r_return_val_if_fail (bf, -1);
-
-	if (type == -1) {
-		type = R_STRING_TYPE_DETECT;
-	}
-	if (from == to) {
-		return 0;
+/* Bytes at the top of the scan loop that only move the needle to the next
+ * byte: non printable ascii that is not an escape (unless the bytes after
+ * it look like a wide string) and bytes that never start an utf8 sequence.
+ * Reads p[0..4]. */
+static inline bool string_scan_skip(const ut8 *p) {
+	const ut8 b = p[0];
+	if (b >= 0x80) {
+		return b < 0xc0 || b >= 0xf8;
 	}
-	if (from > to) {
-		eprintf ("Invalid range to find strings 0x%"PFMT64x" .. 0x%"PFMT64x"\n", from, to);
-		return -1;
+	if (b > 0x1f && b != 0x7f) {
+		return false;
 	}
-	int len = to - from;
-	ut8 *buf = calloc (len, 1);
-	if (!buf || !min) {
-		free (buf);
-		return -1;
+	switch (b) {
+	case '\a': case '\b': case '\t': case '\n': case '\v': case '\f': case '\r': case '\033':
+		return false;
 	}
-	st64 vdelta = 0, pdelta = 0;
-	RBinSection *s = NULL;
+	// x 00 y 00 is taken as utf16le and x 00 00 00 y 00 as utf32le
+	return p[1] || p[3] || (!p[2] && !p[4]);
+}
+
+/* Runs the scanner from needle until the top of its loop reaches stop. The
+ * tops in the first R_STRING_SCAN_OVERLAP bytes of the chunk are recorded in
+ * tops, or if sync is given the scan stops at the first top recorded there:
+ * from that point on both scans are the same. Returns the last top. */
+static ut64 string_scan(StringScan *sc, ut64 needle, ut64 stop, ut8 *tops, const ut8 *sync, RVector *hits) {
+	RBin *bin = sc->bf->rbin;
+	const ut64 from = sc->from;
+	const ut64 to = sc->to;
+	const int min = sc->min;
+	ut8 tmp[R_STRING_SCAN_BUFFER_SIZE];
+	ut64 str_start;
+	int i, rc, runes;
+	int str_type = R_STRING_TYPE_DETECT;
 	bool ascii_only = false;
-	PJ *pj = NULL;
-	if (bf->strmode == R_MODE_JSON && !list) {
-		pj = pj_new ();
-		if (pj) {
-			pj_a (pj);
-		}
-	}
-	r_buf_read_at (bf->buf, from, buf, len);
-	// may oobread
+
+#define B(x) (sc->buf + (x) - sc->wfrom)
 	while (needle < to) {
+		if (!ascii_only) {
+			if (needle >= stop) {
+				break;
+			}
+			const ut64 d = needle - sc->cs;
+			if (d < R_STRING_SCAN_OVERLAP) {
+				if (sync && (sync[d >> 3] & (1 << (d & 7)))) {
+					break;
+				}
+				if (tops) {
+					tops[d >> 3] |= 1 << (d & 7);
+				}
+			} else if (needle + 12 <= sc->wto && string_scan_skip (B (needle))) {
+				// nothing to sync here, skip whole words of zeros and the bytes no string starts with
+				ut64 n = needle + 1;
+				while (n < stop && n + 12 <= sc->wto) {
+					const ut8 *p = B (n);
+					if (n + 8 <= stop && !r_read_le64 (p) && !r_read_le32 (p + 8)) {
+						n += 8;
+					} else if (string_scan_skip (p)) {
+						n++;
+					} else {
+						break;
+					}
+				}
+				needle = n;
+				continue;
+			}
+		}
 		if (bin && bin->consb.is_breaked) {
 			if (bin->consb.is_breaked ()) {
+				sc->breaked = true;
 				break;
 			}
 		}
-		rc = r_utf8_decode (buf + needle - from, to - needle, NULL);
+		const ut64 top = needle;
+		rc = r_utf8_decode (B (needle), to - needle, NULL);
 		if (!rc) {
 			needle++;
 			continue;
 		}
-		if (type == R_STRING_TYPE_DETECT) {
-			char *w = (char *)buf + needle + rc - from;
+		if (sc->type == R_STRING_TYPE_DETECT) {
+			char *w = (char *)B (needle + rc);
 			if ((to - needle) > 5 + rc) {
 				bool is_wide32 = (needle + rc + 2 < to) && (!w[0] && !w[1] && !w[2] && w[3] && !w[4]);
 				if (is_wide32) {
@@ -176,7 +227,7 @@ static int string_scan_range(RList *list, RBinFile *bf, int min,
 				str_type = R_STRING_TYPE_ASCII;
 			}
 		} else {
-			str_type = type;
+			str_type = sc->type;
 		}
 		runes = 0;
 		str_start = needle;
@@ -186,17 +237,17 @@ static int string_scan_range(RList *list, RBinFile *bf, int min,
 			RRune r = {0};
 
 			if (str_type == R_STRING_TYPE_WIDE32) {
-				rc = r_utf32le_decode (buf + needle - from, to - needle, &r);
+				rc = r_utf32le_decode (B (needle), to - needle, &r);
 				if (rc) {
 					rc = 4;
 				}
 			} else if (str_type == R_STRING_TYPE_WIDE) {
-				rc = r_utf16le_decode (buf + needle - from, to - needle, &r);
+				rc = r_utf16le_decode (B (needle), to - needle, &r);
 				if (rc == 1) {
 					rc = 2;
 				}
 			} else {
-				rc = r_utf8_decode (buf + needle - from, to - needle, &r);
+				rc = r_utf8_decode (B (needle), to - needle, &r);
 				if (rc > 1) {
 					str_type = R_STRING_TYPE_UTF8;
 				}
@@ -248,16 +299,6 @@ static int string_scan_range(RList *list, RBinFile *bf, int min,
 			// reduce false positives
 			int j, num_blocks, *block_list;
 			int *freq_list = NULL, expected_ascii, actual_ascii, num_chars;
-			if (str_type == R_STRING_TYPE_ASCII) {
-				for (j = 0; j < i; j++) {
-					char ch = tmp[j];
-					if (ch != '\n' && ch != '\r' && ch != '\t') {
-						if (!IS_PRINTABLE (tmp[j])) {
-							continue;
-						}
-					}
-				}
-			}
 			switch (str_type) {
 			case R_STRING_TYPE_UTF8:
 			case R_STRING_TYPE_WIDE:
@@ -300,12 +341,11 @@ static int string_scan_range(RList *list, RBinFile *bf, int min,
 			bs->type = str_type;
 			bs->length = runes;
 			bs->size = needle - str_start;
-			bs->ordinal = count++;
 			// TODO: move into adjust_offset
 			switch (str_type) {
 			case R_STRING_TYPE_WIDE:
 				if (str_start - from > 1) {
-					const ut8 *p = buf + str_start - 2 - from;
+					const ut8 *p = B (str_start - 2);
 					if (p[0] == 0xff && p[1] == 0xfe) {
 						str_start -= 2; // \xff\xfe
 					}
@@ -313,44 +353,194 @@ static int string_scan_range(RList *list, RBinFile *bf, int min,
 				break;
 			case R_STRING_TYPE_WIDE32:
 				if (str_start - from > 3) {
-					const ut8 *p = buf + str_start - 4 - from;
+					const ut8 *p = B (str_start - 4);
 					if (p[0] == 0xff && p[1] == 0xfe) {
 						str_start -= 4; // \xff\xfe\x00\x00
 					}
 				}
 				break;
 			}
-			if (!s) {
-				if (section) {
-					s = section;
-				} else if (bf->o) {
-					s = r_bin_get_section_at (bf->o, str_start, false);
-				}
-				if (s) {
-					vdelta = s->vaddr;
-					pdelta = s->paddr;
-				}
-			}
 			bs->paddr = str_start;
-			bs->vaddr = str_start - pdelta + vdelta;
 			bs->string = r_str_ndup ((const char *)tmp, i);
-			if (list) {
-				r_list_append (list, bs);
-				if (bf->o) {
-					ht_up_insert (bf->o->strings_db, bs->vaddr, bs);
-				}
-			} else {
-				print_string (bf, bs, raw, pj);
+			StringScanHit *hit = r_vector_push (hits, NULL);
+			if (!hit) {
 				r_bin_string_free (bs);
+				break;
 			}
-			if (from == 0 && to == bf->size) {
-				/* force lookup section at the next one */
-				s = NULL;
-			}
+			hit->at = top;
+			hit->bs = bs;
 		}
 		ascii_only = false;
 	}
-	free (buf);
+#undef B
+	return needle;
+}
+
+static RThreadFunctionRet string_scan_th(RThread *th) {
+	StringScan *sc = th->user;
+	sc->end = string_scan (sc, sc->cs, sc->ce, sc->tops, NULL, &sc->hits);
+	return R_TH_STOP;
+}
+
+static void string_scan_hit_fini(void *e, void *user) {
+	StringScanHit *hit = e;
+	r_bin_string_free (hit->bs);
+}
+
+/* The range is read in chunks of R_STRING_SCAN_CHUNK bytes plus the overlap
+ * a string started in a chunk can take from the next one, and up to
+ * bin.str.jobs chunks are scanned at once. A chunk is scanned from its
+ * start, but the serial scan may cross into it at another byte, so the
+ * merge rescans from there until it hits one of the loop tops the chunk
+ * scan went through (usually within a few bytes) and takes its strings
+ * from that point on. */
+static int string_scan_range(RList *list, RBinFile *bf, int min,
+			      const ut64 from, const ut64 to, int type, int raw, RBinSection *section) {
+	RBin *bin = bf->rbin;
+	int count = 0, k;
+
+	// if list is null it means its gonna dump
+	r_return_val_if_fail (bf, -1);
+
+	if (type == -1) {
+		type = R_STRING_TYPE_DETECT;
+	}
+	if (from == to) {
+		return 0;
+	}
+	if (from > to) {
+		eprintf ("Invalid range to find strings 0x%"PFMT64x" .. 0x%"PFMT64x"\n", from, to);
+		return -1;
+	}
+	if (!min) {
+		return -1;
+	}
+	// every job holds a chunk buffer, so there are no more jobs than chunks
+	const ut64 nchunks = (to - from + R_STRING_SCAN_CHUNK - 1) / R_STRING_SCAN_CHUNK;
+	const int njobs = R_MAX (1, R_MIN (bin? bin->strjobs: 1, nchunks));
+	const ut64 bufsz = R_MIN (to - from, R_STRING_SCAN_CHUNK + R_STRING_SCAN_OVERLAP + 16);
+	StringScan *scans = R_NEWS0 (StringScan, njobs);
+	RThread **th = R_NEWS0 (RThread *, njobs);
+	if (!scans || !th) {
+		free (scans);
+		free (th);
+		return -1;
+	}
+	for (k = 0; k < njobs; k++) {
+		StringScan *sc = &scans[k];
+		sc->bf = bf;
+		sc->min = min;
+		sc->type = type;
+		sc->from = from;
+		sc->to = to;
+		r_vector_init (&sc->hits, sizeof (StringScanHit), string_scan_hit_fini, NULL);
+		sc->buf = malloc (bufsz);
+		sc->tops = malloc (R_STRING_SCAN_OVERLAP / 8);
+		if (!sc->buf || !sc->tops) {
+			count = -1;
+			goto beach;
+		}
+	}
+	st64 vdelta = 0, pdelta = 0;
+	RBinSection *s = NULL;
+	PJ *pj = NULL;
+	if (bf->strmode == R_MODE_JSON && !list) {
+		pj = pj_new ();
+		if (pj) {
+			pj_a (pj);
+		}
+	}
+	RVector fix;
+	r_vector_init (&fix, sizeof (StringScanHit), string_scan_hit_fini, NULL);
+	ut64 cs, needle = from;
+	bool breaked = false;
+	for (cs = from; cs < to && !breaked; cs += (ut64)njobs * R_STRING_SCAN_CHUNK) {
+		int n = 0;
+		for (k = 0; k < njobs && cs + (ut64)k * R_STRING_SCAN_CHUNK < to; k++, n++) {
+			StringScan *sc = &scans[k];
+			sc->cs = cs + (ut64)k * R_STRING_SCAN_CHUNK;
+			sc->ce = R_MIN (sc->cs + R_STRING_SCAN_CHUNK, to);
+			sc->wfrom = (sc->cs - from > 16)? sc->cs - 16: from;
+			sc->wto = R_MIN (to, sc->ce + R_STRING_SCAN_OVERLAP);
+			sc->breaked = false;
+			memset (sc->tops, 0, R_STRING_SCAN_OVERLAP / 8);
+			r_buf_read_at (bf->buf, sc->wfrom, sc->buf, sc->wto - sc->wfrom);
+		}
+		for (k = 0; k < n; k++) {
+			th[k] = (n > 1)? r_th_new (string_scan_th, &scans[k], 0): NULL;
+			if (!th[k]) {
+				StringScan *sc = &scans[k];
+				sc->end = string_scan (sc, sc->cs, sc->ce, sc->tops, NULL, &sc->hits);
+			}
+		}
+		for (k = 0; k < n; k++) {
+			if (th[k]) {
+				r_th_wait (th[k]);
+				th[k] = r_th_free (th[k]);
+			}
+		}
+		for (k = 0; k < n && !breaked; k++) {
+			StringScan *sc = &scans[k];
+			ut64 at = needle;
+			bool synced = true;
+			if (needle >= sc->ce) {
+				// a string from the previous chunks took this one
+				synced = false;
+			} else if (needle != sc->cs) {
+				at = string_scan (sc, needle, sc->ce, NULL, sc->tops, &fix);
+				synced = at < sc->ce && !sc->breaked;
+				needle = at;
+			}
+			breaked = sc->breaked;
+			int pass;
+			for (pass = 0; pass < 2; pass++) {
+				RVector *hits = pass? &sc->hits: &fix;
+				StringScanHit *hit;
+				r_vector_foreach (hits, hit) {
+					RBinString *bs = hit->bs;
+					if (pass && (!synced || hit->at < at)) {
+						continue;
+					}
+					hit->bs = NULL;
+					bs->ordinal = count++;
+					if (!s) {
+						if (section) {
+							s = section;
+						} else if (bf->o) {
+							s = r_bin_get_section_at (bf->o, bs->paddr, false);
+						}
+						if (s) {
+							vdelta = s->vaddr;
+							pdelta = s->paddr;
+						}
+					}
+					bs->vaddr = bs->paddr - pdelta + vdelta;
+					if (list) {
+						r_list_append (list, bs);
+						if (bf->o) {
+							ht_up_insert (bf->o->strings_db, bs->vaddr, bs);
+						}
+					} else {
+						print_string (bf, bs, raw, pj);
+						r_bin_string_free (bs);
+					}
+					if (from == 0 && to == bf->size) {
+						/* force lookup section at the next one */
+						s = NULL;
+					}
+				}
+				r_vector_clear (hits);
+			}
+			if (synced) {
+				needle = sc->end;
+				breaked |= sc->breaked;
+			}
+		}
+		for (k = 0; k < n; k++) {
+			r_vector_clear (&scans[k].hits);
+		}
+	}
+	r_vector_clear (&fix);
 	if (pj) {
 		pj_end (pj);
 		RIO *io = bin->iob.io;
@@ -359,6 +549,14 @@ static int string_scan_range(RList *list, RBinFile *bf, int min,
 		}
 		pj_free (pj);
 	}
+beach:
+	for (k = 0; k < njobs; k++) {
+		r_vector_clear (&scans[k].hits);
+		free (scans[k].buf);
+		free (scans[k].tops);
+	}
+	free (scans);
+	free (th);
 	return count;
 }
 
@@ -856,9 +1054,13 @@ R_API bool r_bin_file_close(RBin *bin, int bd) {
 	return false;
 }
 
+static bool compute_hashes_read_at(void *user, ut64 addr, ut8 *buf, int len) {
+	return r_io_desc_read_at ((RIODesc *)user, addr, buf, len) == len;
+}
+
 R_API RList *r_bin_file_compute_hashes(RBin *bin, ut64 limit) {
 	r_return_val_if_fail (bin && bin->cur && bin->cur->o, NULL);
-	ut64 buf_len = 0, r = 0;
+	ut64 buf_len = 0;
 	RBinFile *bf = bin->cur;
 	RBinObject *o = bf->o;
 
@@ -873,37 +1075,17 @@ R_API RList *r_bin_file_compute_hashes(RBin *bin, ut64 limit) {
 		eprintf ("Warning: r_bin_file_hash: file exceeds bin.hashlimit\n");
 		return NULL;
 	}
-	const size_t blocksize = 64000;
-	ut8 *buf = malloc (blocksize);
-	if (!buf) {
-		eprintf ("Cannot allocate computation buffer\n");
-		return NULL;
-	}
-
 	char hash[128];
-	RHash *ctx = r_hash_new (false, R_HASH_MD5 | R_HASH_SHA1 | R_HASH_SHA256);
-	while (r + blocksize < buf_len) {
-		r_io_desc_seek (iod, r, R_IO_SEEK_SET);
-		int b = r_io_desc_read (iod, buf, blocksize);
-		(void)r_hash_do_md5 (ctx, buf, blocksize);
-		(void)r_hash_do_sha1 (ctx, buf, blocksize);
-		(void)r_hash_do_sha256 (ctx, buf, blocksize);
-		r += b;
-	}
-	if (r < buf_len) {
-		r_io_desc_seek (iod, r, R_IO_SEEK_SET);
-		const size_t rem_len = buf_len-r;
-		int b = r_io_desc_read (iod, buf, rem_len);
-		if (b < 1) {
-			eprintf ("r_io_desc_read: error\n");
-		} else {
-			(void)r_hash_do_md5 (ctx, buf, b);
-			(void)r_hash_do_sha1 (ctx, buf, b);
-			(void)r_hash_do_sha256 (ctx, buf, b);
-		}
+	RHash *ctx[R_HASH_NBITS] = {0};
+	ctx[R_HASH_IDX_MD5] = r_hash_new (false, R_HASH_MD5);
+	ctx[R_HASH_IDX_SHA1] = r_hash_new (false, R_HASH_SHA1);
+	ctx[R_HASH_IDX_SHA256] = r_hash_new (false, R_HASH_SHA256);
+	if (!r_hash_calculate_range (ctx, R_HASH_MD5 | R_HASH_SHA1 | R_HASH_SHA256,
+			compute_hashes_read_at, iod, 0, buf_len, R_BIN_HASH_BLOCK_SIZE, 3)) {
+		eprintf ("r_io_desc_read: error\n");
 	}
-	r_hash_do_end (ctx, R_HASH_MD5);
-	r_hex_bin2str (ctx->digest, R_HASH_SIZE_MD5, hash);
+	r_hash_do_end (ctx[R_HASH_IDX_MD5], R_HASH_MD5);
+	r_hex_bin2str (ctx[R_HASH_IDX_MD5]->digest, R_HASH_SIZE_MD5, hash);
 
 	RList *file_hashes = r_list_newf ((RListFree) r_bin_file_hash_free);
 	RBinFileHash *md5h = R_NEW0 (RBinFileHash);
@@ -912,8 +1094,8 @@ R_API RList *r_bin_file_compute_hashes(RBin *bin, ut64 limit) {
 		md5h->hex = strdup (hash);
 		r_list_push (file_hashes, md5h);
 	}
-	r_hash_do_end (ctx, R_HASH_SHA1);
-	r_hex_bin2str (ctx->digest, R_HASH_SIZE_SHA1, hash);
+	r_hash_do_end (ctx[R_HASH_IDX_SHA1], R_HASH_SHA1);
+	r_hex_bin2str (ctx[R_HASH_IDX_SHA1]->digest, R_HASH_SIZE_SHA1, hash);
 
 	RBinFileHash *sha1h = R_NEW0 (RBinFileHash);
 	if (sha1h) {
@@ -921,8 +1103,8 @@ R_API RList *r_bin_file_compute_hashes(RBin *bin, ut64 limit) {
 		sha1h->hex = strdup (hash);
 		r_list_push (file_hashes, sha1h);
 	}
-	r_hash_do_end (ctx, R_HASH_SHA256);
-	r_hex_bin2str (ctx->digest, R_HASH_SIZE_SHA256, hash);
+	r_hash_do_end (ctx[R_HASH_IDX_SHA256], R_HASH_SHA256);
+	r_hex_bin2str (ctx[R_HASH_IDX_SHA256]->digest, R_HASH_SIZE_SHA256, hash);
 
 	RBinFileHash *sha256h = R_NEW0 (RBinFileHash);
 	if (sha256h) {
@@ -938,8 +1120,9 @@ R_API RList *r_bin_file_compute_hashes(RBin *bin, ut64 limit) {
 	}
 	// TODO: add here more rows
 
-	free (buf);
-	r_hash_free (ctx);
+	r_hash_free (ctx[R_HASH_IDX_MD5]);
+	r_hash_free (ctx[R_HASH_IDX_SHA1]);
+	r_hash_free (ctx[R_HASH_IDX_SHA256]);
 	return file_hashes;
 }
 
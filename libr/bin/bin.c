@@ -845,6 +845,7 @@ R_API RBin *r_bin_new() {
 	bin->cb_printf = (PrintfCallback)printf;
 	bin->plugins = r_list_newf ((RListFree)r_bin_plugin_free);
 	bin->minstrlen = 0;
+	bin->strjobs = 1;
 	bin->strpurge = NULL;
 	bin->want_dbginfo = true;
 	bin->cur = NULL;
@@ -31,6 +31,8 @@ R_API RBreakpoint *r_bp_new() {
 	bp->traces = r_bp_traptrace_new ();
 	bp->cb_printf = (PrintfCallback)printf;
 	bp->bps = r_list_newf ((RListFree)r_bp_item_free);
+	bp->bps_at = ht_up_new0 ();
+	r_interval_tree_init (&bp->bps_in, NULL);
 	bp->plugins = r_list_newf ((RListFree)free);
 	bp->nhwbps = 0;
 	for (i = 0; bp_static_plugins[i]; i++) {
@@ -44,6 +46,8 @@ R_API RBreakpoint *r_bp_new() {
 }
 
 R_API RBreakpoint *r_bp_free(RBreakpoint *bp) {
+	r_interval_tree_fini (&bp->bps_in);
+	ht_up_free (bp->bps_at);
 	r_list_free (bp->bps);
 	r_list_free (bp->plugins);
 	r_list_free (bp->traces);
@@ -88,15 +92,49 @@ repeat:
 	return 0;
 }
 
-R_API RBreakpointItem *r_bp_get_at(RBreakpoint *bp, ut64 addr) {
-	RListIter *iter;
-	RBreakpointItem *b;
-	r_list_foreach(bp->bps, iter, b) {
-		if (b->addr == addr) {
-			return b;
+/* both indices must follow b->addr, use r_bp_item_set_addr to move an item */
+static void bp_index_add(RBreakpoint *bp, RBreakpointItem *b) {
+	// keeps the older one if there's already a bp at this address
+	ht_up_insert (bp->bps_at, b->addr, b);
+	r_interval_tree_insert (&bp->bps_in, b->addr, b->addr + b->size, b);
+}
+
+static void bp_index_del(RBreakpoint *bp, RBreakpointItem *b) {
+	RIntervalNode *node = r_interval_tree_node_at_data (&bp->bps_in, b->addr, b);
+	if (node) {
+		r_interval_tree_delete (&bp->bps_in, node, false);
+	}
+	if (ht_up_find (bp->bps_at, b->addr, NULL) != b) {
+		return;
+	}
+	ht_up_delete (bp->bps_at, b->addr);
+	// promote another breakpoint at the same address, if any
+	RBIter it = r_interval_tree_first_at (&bp->bps_in, b->addr);
+	if (r_rbtree_iter_has (&it)) {
+		node = r_rbtree_iter_get (&it, RIntervalNode, node);
+		if (node->start == b->addr) {
+			ht_up_insert (bp->bps_at, b->addr, node->data);
 		}
 	}
-	return NULL;
+}
+
+R_API void r_bp_item_add(RBreakpoint *bp, RBreakpointItem *b) {
+	bp->nbps++;
+	r_list_append (bp->bps, b);
+	bp_index_add (bp, b);
+}
+
+R_API void r_bp_item_set_addr(RBreakpoint *bp, RBreakpointItem *b, ut64 addr) {
+	if (b->addr == addr) {
+		return;
+	}
+	bp_index_del (bp, b);
+	b->addr = addr;
+	bp_index_add (bp, b);
+}
+
+R_API RBreakpointItem *r_bp_get_at(RBreakpoint *bp, ut64 addr) {
+	return ht_up_find (bp->bps_at, addr, NULL);
 }
 
 static inline bool inRange(RBreakpointItem *b, ut64 addr) {
@@ -107,17 +145,29 @@ static inline bool matchProt(RBreakpointItem *b, int perm) {
 	return (!perm || (perm && b->perm));
 }
 
-R_API RBreakpointItem *r_bp_get_in(RBreakpoint *bp, ut64 addr, int perm) {
+typedef struct {
+	int perm;
 	RBreakpointItem *b;
-	RListIter *iter;
-	r_list_foreach (bp->bps, iter, b) {
-		// eprintf ("---ataddr--- 0x%08"PFMT64x" %d %d %x\n", b->addr, b->size, b->recoil, b->perm);
-		// Check addr within range and provided perm matches (or null)
-		if (inRange (b, addr) && matchProt (b, perm)) {
-			return b;
-		}
+} BpInCtx;
+
+static void bp_in_cb(RIntervalNode *node, void *user) {
+	BpInCtx *ctx = user;
+	RBreakpointItem *b = node->data;
+	// the tree is end exclusive already, just check the perm
+	if (!ctx->b && matchProt (b, ctx->perm)) {
+		ctx->b = b;
 	}
-	return NULL;
+}
+
+R_API RBreakpointItem *r_bp_get_in(RBreakpoint *bp, ut64 addr, int perm) {
+	// most lookups are sw breakpoints hit at their exact address
+	RBreakpointItem *b = r_bp_get_at (bp, addr);
+	if (b && inRange (b, addr) && matchProt (b, perm)) {
+		return b;
+	}
+	BpInCtx ctx = { perm, NULL };
+	r_interval_tree_all_in (&bp->bps_in, addr, false, bp_in_cb, &ctx);
+	return ctx.b;
 }
 
 R_API RBreakpointItem *r_bp_enable(RBreakpoint *bp, ut64 addr, int set, int count) {
@@ -151,6 +201,7 @@ static void unlinkBreakpoint(RBreakpoint *bp, RBreakpointItem *b) {
 			bp->bps_idx[i] = NULL;
 		}
 	}
+	bp_index_del (bp, b);
 	r_list_delete_data (bp->bps, b);
 }
 
@@ -203,8 +254,7 @@ static RBreakpointItem *r_bp_add(RBreakpoint *bp, const ut8 *obytes, ut64 addr,
 		}
 		b->recoil = ret;
 	}
-	bp->nbps++;
-	r_list_append (bp->bps, b);
+	r_bp_item_add (bp, b);
 	return b;
 }
 
@@ -238,6 +288,10 @@ R_API RBreakpointItem* r_bp_add_hw(RBreakpoint *bp, ut64 addr, int size, int per
 R_API int r_bp_del_all(RBreakpoint *bp) {
 	int i;
 	if (!r_list_empty (bp->bps)) {
+		r_interval_tree_fini (&bp->bps_in);
+		r_interval_tree_init (&bp->bps_in, NULL);
+		ht_up_free (bp->bps_at);
+		bp->bps_at = ht_up_new0 ();
 		r_list_purge (bp->bps);
 		for (i = 0; i < bp->bps_idx_count; i++) {
 			bp->bps_idx[i] = NULL;
@@ -248,15 +302,10 @@ R_API int r_bp_del_all(RBreakpoint *bp) {
 }
 
 R_API int r_bp_del(RBreakpoint *bp, ut64 addr) {
-	RListIter *iter;
-	RBreakpointItem *b;
-	/* No _safe loop necessary because we return immediately after the delete. */
-	r_list_foreach (bp->bps, iter, b) {
-		if (b->addr == addr) {
-			unlinkBreakpoint (bp, b);
-			// r_list_delete (bp->bps, iter);
-			return true;
-		}
+	RBreakpointItem *b = r_bp_get_at (bp, addr);
+	if (b) {
+		unlinkBreakpoint (bp, b);
+		return true;
 	}
 	return false;
 }
@@ -391,6 +440,9 @@ R_API int r_bp_get_index_at (RBreakpoint *bp, ut64 addr) {
 
 R_API int r_bp_del_index(RBreakpoint *bp, int idx) {
 	if (idx >= 0 && idx < bp->bps_idx_count) {
+		if (bp->bps_idx[idx]) {
+			bp_index_del (bp, bp->bps_idx[idx]);
+		}
 		r_list_delete_data (bp->bps, bp->bps_idx[idx]);
 		bp->bps_idx[idx] = 0;
 		return true;
@@ -28,6 +28,44 @@ R_API int r_bp_restore(RBreakpoint *bp, bool set) {
 	return r_bp_restore_except (bp, set, UT64_MAX);
 }
 
+#define BP_PAGE_SIZE 0x1000
+
+static int bp_cmp_addr(const void *a, const void *b) {
+	const RBreakpointItem *ba = a, *bb = b;
+	return ba->addr < bb->addr? -1: ba->addr > bb->addr;
+}
+
+/* write the bytes of all the breakpoints in the same page with a single io call */
+static void bp_restore_page(RBreakpoint *bp, RPVector *page, bool set) {
+	RBreakpointItem *b, *first = r_pvector_at (page, 0);
+	size_t i, n = r_pvector_len (page);
+	ut64 to = first->addr;
+	if (n == 1) {
+		r_bp_restore_one (bp, first, set);
+		return;
+	}
+	for (i = 0; i < n; i++) {
+		b = r_pvector_at (page, i);
+		to = R_MAX (to, b->addr + b->size);
+	}
+	int len = to - first->addr;
+	ut8 *buf = malloc (len);
+	// the gaps between breakpoints must be preserved, never write them unread
+	if (!buf || !bp->iob.read_at (bp->iob.io, first->addr, buf, len)) {
+		for (i = 0; i < n; i++) {
+			r_bp_restore_one (bp, r_pvector_at (page, i), set);
+		}
+		free (buf);
+		return;
+	}
+	for (i = 0; i < n; i++) {
+		b = r_pvector_at (page, i);
+		memcpy (buf + (b->addr - first->addr), set? b->bbytes: b->obytes, b->size);
+	}
+	bp->iob.write_at (bp->iob.io, first->addr, buf, len);
+	free (buf);
+}
+
 /**
  * reflect all r_bp stuff in the process using dbg->bp_write or ->breakpoint
  *
@@ -42,6 +80,11 @@ R_API bool r_bp_restore_except(RBreakpoint *bp, bool set, ut64 addr) {
 		bp->corebind.syncDebugMaps (bp->corebind.core);
 	}
 
+	// software breakpoints left to write, batched by page once all the others are done
+	RPVector *sw = r_pvector_new (NULL);
+	if (!sw) {
+		return false;
+	}
 	r_list_foreach (bp->bps, iter, b) {
 		if (addr && b->addr == addr) {
 			continue;
@@ -59,8 +102,32 @@ R_API bool r_bp_restore_except(RBreakpoint *bp, bool set, ut64 addr) {
 		}
 
 		/* write (o|b)bytes from every breakpoint in r_bp if not handled by plugin */
-		r_bp_restore_one (bp, b, set);
-		rc = true;
+		if (b->hw || !(set? b->bbytes: b->obytes) || !bp->iob.read_at) {
+			r_bp_restore_one (bp, b, set);
+			continue;
+		}
+		r_pvector_push (sw, b);
+	}
+	// breakpoints never overlap, so writing them by address gives the same memory
+	r_pvector_sort (sw, bp_cmp_addr);
+	RPVector page;
+	r_pvector_init (&page, NULL);
+	void **it;
+	r_pvector_foreach (sw, it) {
+		b = *it;
+		if (!r_pvector_empty (&page)) {
+			RBreakpointItem *first = r_pvector_at (&page, 0);
+			if ((first->addr & ~(BP_PAGE_SIZE - 1)) != (b->addr & ~(BP_PAGE_SIZE - 1))) {
+				bp_restore_page (bp, &page, set);
+				r_pvector_clear (&page);
+			}
+		}
+		r_pvector_push (&page, b);
+	}
+	if (!r_pvector_empty (&page)) {
+		bp_restore_page (bp, &page, set);
 	}
+	r_pvector_clear (&page);
+	r_pvector_free (sw);
 	return rc;
 }
@@ -29,8 +29,7 @@ R_API RBreakpointItem* r_bp_watch_add(RBreakpoint *bp, ut64 addr, int size, int
 		eprintf ("[TODO]: Software watchpoint is not implemented yet (use ESIL)\n");
 		/* TODO */
 	}
-	bp->nbps++;
-	r_list_append (bp->bps, b);
+	r_bp_item_add (bp, b);
 	return b;
 }
 
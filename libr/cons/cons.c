@@ -844,8 +844,128 @@ R_API void r_cons_echo(const char *msg) {
 	}
 }
 
-R_API void r_cons_flush(void) {
+static void cons_tee(const char *buf, int len) {
 	const char *tee = I.teefile;
+	if (tee && *tee) {
+		FILE *d = r_sandbox_fopen (tee, "a+");
+		if (d) {
+			if (len != fwrite (buf, 1, len, d)) {
+				eprintf ("r_cons_flush: fwrite: error (%s)\n", tee);
+			}
+			fclose (d);
+		} else {
+			eprintf ("Cannot write on '%s'\n", tee);
+		}
+	}
+}
+
+static inline bool cons_stream_active(void) {
+	RConsStream *s = &I.context->stream;
+	return s->active && !s->hold && r_stack_is_empty (I.context->cons_stack);
+}
+
+/* writes out what the running command printed so far. With a filter only the
+ * complete lines are consumed, unless it is the end of the output */
+static void cons_stream_write(bool all) {
+	RConsStream *s = &I.context->stream;
+	char *buf = I.context->buffer;
+	int len = I.context->buffer_len;
+	if (!buf || len < 1) {
+		return;
+	}
+	if (s->grep_used) {
+		RStrBuf *ob = r_strbuf_new (NULL);
+		if (!ob) {
+			return;
+		}
+		int n = r_cons_grep_stream (s, buf, len, ob);
+		if (n < 0 || all) {
+			n = len;
+		}
+		int olen = r_strbuf_length (ob);
+		if (olen > 0) {
+			const char *out = r_strbuf_get (ob);
+			cons_tee (out, olen);
+			__cons_write (out, olen);
+		}
+		r_strbuf_free (ob);
+		memmove (buf, buf + n, len - n);
+		len -= n;
+	} else {
+		cons_tee (buf, len);
+		__cons_write (buf, len);
+		len = 0;
+	}
+	I.context->buffer_len = len;
+	buf[len] = 0;
+	I.lastline = buf;
+}
+
+/* Called when a command starts with its ~ filter (or NULL). If scr.stream is
+ * set and the output is going to the terminal, the buffer is written every
+ * I.stream bytes instead of when the command is done, filtering it a line at
+ * a time. Filters that need the whole output keep the command buffered. */
+R_API bool r_cons_stream_begin(const char *grep) {
+	RConsStream *s = &I.context->stream;
+	if (s->depth > 0) {
+		s->depth++;
+		if (s->active && grep && r_stack_is_empty (I.context->cons_stack)) {
+			// the nested filter is applied to the rest of the buffer on flush
+			s->hold = true;
+		}
+		return false;
+	}
+	if (I.stream < 1) {
+		return false;
+	}
+	s->depth = 1;
+	if (!r_cons_context_is_main () || !r_stack_is_empty (I.context->cons_stack)) {
+		return false;
+	}
+	if (I.context->buffer_len > 0 || I.noflush || I.null || I.is_html || I.flush
+			|| I.highlight || I.linesleep > 0 || I.filter) {
+		return false;
+	}
+	RConsGrep *cg = &I.context->grep;
+	if (cg->nstrings > 0 || cg->tokens_used || cg->less || cg->json) {
+		return false;
+	}
+	if (r_cons_is_interactive () && I.fdout == 1 && I.pager && *I.pager) {
+		return false;
+	}
+	cons_grep_reset (&s->grep);
+	if (grep && !r_cons_grep_stream_parse (&s->grep, grep)) {
+		R_FREE (s->grep.json_path);
+		cons_grep_reset (&s->grep);
+		return false;
+	}
+	s->grep_used = s->grep.nstrings > 0 || s->grep.tokens_used;
+	s->lines = 0;
+	s->show = false;
+	s->hold = false;
+	s->active = true;
+	return true;
+}
+
+/* Returns true if all the output of the command has been written, so its
+ * filter must not be applied again */
+R_API bool r_cons_stream_end(void) {
+	RConsStream *s = &I.context->stream;
+	if (s->depth < 1 || --s->depth > 0) {
+		return false;
+	}
+	bool done = s->active && !s->hold;
+	if (done) {
+		cons_stream_write (true);
+	}
+	s->active = false;
+	s->hold = false;
+	R_FREE (s->grep.json_path);
+	cons_grep_reset (&s->grep);
+	return done;
+}
+
+R_API void r_cons_flush(void) {
 	if (I.noflush) {
 		return;
 	}
@@ -853,6 +973,10 @@ R_API void r_cons_flush(void) {
 		r_cons_reset ();
 		return;
 	}
+	if (cons_stream_active ()) {
+		cons_stream_write (false);
+		return;
+	}
 	if (lastMatters () && !CTX (lastMode)) {
 		// snapshot of the output
 		if (CTX (buffer_len) > CTX (lastLength)) {
@@ -904,17 +1028,7 @@ R_API void r_cons_flush(void) {
 			r_cons_set_raw (true);
 		}
 	}
-	if (tee && *tee) {
-		FILE *d = r_sandbox_fopen (tee, "a+");
-		if (d) {
-			if (I.context->buffer_len != fwrite (I.context->buffer, 1, I.context->buffer_len, d)) {
-				eprintf ("r_cons_flush: fwrite: error (%s)\n", tee);
-			}
-			fclose (d);
-		} else {
-			eprintf ("Cannot write on '%s'\n", tee);
-		}
-	}
+	cons_tee (I.context->buffer, I.context->buffer_len);
 	r_cons_highlight (I.highlight);
 
 	// is_html must be a filter, not a write endpoint
@@ -1115,6 +1229,9 @@ club:
 			}
 			I.context->buffer_len += written;
 			I.context->buffer[I.context->buffer_len] = 0;
+			if (I.stream > 0 && I.context->buffer_len >= I.stream && cons_stream_active ()) {
+				cons_stream_write (false);
+			}
 		}
 	} else {
 		r_cons_strcat (format);
@@ -1161,6 +1278,9 @@ R_API int r_cons_memcat(const char *str, int len) {
 			memcpy (I.context->buffer + I.context->buffer_len, str, len);
 			I.context->buffer_len += len;
 			I.context->buffer[I.context->buffer_len] = 0;
+			if (I.stream > 0 && I.context->buffer_len >= I.stream && cons_stream_active ()) {
+				cons_stream_write (false);
+			}
 		}
 	}
 	if (I.flush) {
@@ -1180,6 +1300,9 @@ R_API void r_cons_memset(char ch, int len) {
 			memset (I.context->buffer + I.context->buffer_len, ch, len);
 			I.context->buffer_len += len;
 			I.context->buffer[I.context->buffer_len] = 0;
+			if (I.stream > 0 && I.context->buffer_len >= I.stream && cons_stream_active ()) {
+				cons_stream_write (false);
+			}
 		}
 	}
 }
@@ -71,7 +71,9 @@ R_API void r_cons_grep_help(void) {
 
 #define R_CONS_GREP_BUFSIZE 4096
 
-static void parse_grep_expression(const char *str) {
+static int grep_line(RConsGrep *grep, int lines, char *buf, int len);
+
+static void parse_grep_expression(RConsGrep *grep, const char *str) {
 	static char buf[R_CONS_GREP_BUFSIZE];
 	int wlen, len, is_range, num_is_parsed, fail = 0;
 	char *ptr, *optr, *ptr2, *ptr3, *end_ptr = NULL, last;
@@ -81,7 +83,6 @@ static void parse_grep_expression(const char *str) {
 		return;
 	}
 	RCons *cons = r_cons_singleton ();
-	RConsGrep *grep = &cons->context->grep;
 	sorted_column = 0;
 	bool first = true;
 	while (*str) {
@@ -177,8 +178,10 @@ static void parse_grep_expression(const char *str) {
 				grep->charCounter = true;
 				str++;
 			} else if (*str == '?') {
-				cons->filter = true;
-				r_cons_grep_help ();
+				if (grep == &cons->context->grep) {
+					cons->filter = true;
+					r_cons_grep_help ();
+				}
 				return;
 			}
 			break;
@@ -401,7 +404,7 @@ R_API void r_cons_grep_parsecmd(char *cmd, const char *quotestr) {
 	char *ptr = preprocess_filter_expr (cmd, quotestr);
 	if (ptr) {
 		r_str_trim (cmd);
-		parse_grep_expression (ptr);
+		parse_grep_expression (&r_cons_singleton ()->context->grep, ptr);
 		free (ptr);
 	}
 }
@@ -418,7 +421,7 @@ R_API char *r_cons_grep_strip(char *cmd, const char *quotestr) {
 
 R_API void r_cons_grep_process(char * grep) {
 	if (grep) {
-		parse_grep_expression (grep);
+		parse_grep_expression (&r_cons_singleton ()->context->grep, grep);
 		free (grep);
 	}
 }
@@ -458,13 +461,93 @@ static int cmp(const void *a, const void *b) {
 	return strcmp (a, b);
 }
 
+/* Filters the complete lines of buf into ob, leaving a trailing partial line
+ * alone. *lines counts the matching lines and *show keeps the state of a
+ * :s..e range, so the buffer can be filtered a chunk at a time. Returns the
+ * number of bytes consumed or -1 if the line filter failed. */
+static int grep_lines(RConsGrep *grep, const char *buf, int len, RStrBuf *ob, int *lines, bool *show) {
+	RCons *cons = r_cons_singleton ();
+	const char *in = buf;
+	int ret, l, tl;
+	while ((int) (size_t) (in - buf) < len) {
+		char *p = strchr (in, '\n');
+		if (!p || p >= buf + len) {
+			break;
+		}
+		l = p - in;
+		if (l > 0) {
+			char *tline = r_str_ndup (in, l);
+			if (cons->grep_color) {
+				tl = l;
+			} else {
+				tl = r_str_ansi_filter (tline, NULL, NULL, l);
+			}
+			if (tl < 0) {
+				ret = -1;
+			} else {
+				ret = grep_line (grep, *lines, tline, tl);
+				if (!grep->range_line) {
+					if (grep->line == *lines) {
+						*show = true;
+					}
+				} else if (grep->range_line == 1) {
+					if (grep->f_line == *lines) {
+						*show = true;
+					}
+					if (grep->l_line == *lines) {
+						*show = false;
+					}
+				} else {
+					*show = true;
+				}
+			}
+			if (ret > 0) {
+				if (*show) {
+					char *str = r_str_ndup (tline, ret);
+					if (cons->grep_highlight) {
+						int i;
+						for (i = 0; i < grep->nstrings; i++) {
+							char *newstr = r_str_newf (Color_INVERT"%s"Color_RESET, grep->strings[i]);
+							if (str && newstr) {
+								if (grep->icase) {
+									str = r_str_replace_icase (str, grep->strings[i], newstr, 1, 1);
+								} else {
+									str = r_str_replace (str, grep->strings[i], newstr, 1);
+								}
+							}
+							free (newstr);
+						}
+					}
+					if (str) {
+						r_strbuf_append (ob, str);
+						r_strbuf_append (ob, "\n");
+					}
+					free (str);
+				}
+				if (!grep->range_line) {
+					*show = false;
+				}
+				(*lines)++;
+			} else if (ret < 0) {
+				free (tline);
+				return -1;
+			}
+			free (tline);
+			in += l + 1;
+		} else {
+			in++;
+		}
+	}
+	return (int) (size_t) (in - buf);
+}
+
 R_API void r_cons_grepbuf() {
 	RCons *cons = r_cons_singleton ();
 	const char *buf = cons->context->buffer;
 	const int len = cons->context->buffer_len;
 	RConsGrep *grep = &cons->context->grep;
 	const char *in = buf;
-	int ret, total_lines = 0, buffer_len = 0, l = 0, tl = 0;
+	int total_lines = 0, l = 0;
 	bool show = false;
 	if (cons->filter) {
 		cons->context->buffer_len = 0;
@@ -588,76 +671,9 @@ R_API void r_cons_grepbuf() {
 			grep->l_line = total_lines + grep->l_line;
 		}
 	}
-	in = buf;
-	while ((int) (size_t) (in - buf) < len) {
-		char *p = strchr (in, '\n');
-		if (!p) {
-			break;
-		}
-		l = p - in;
-		if (l > 0) {
-			char *tline = r_str_ndup (in, l);
-			if (cons->grep_color) {
-				tl = l;
-			} else {
-				tl = r_str_ansi_filter (tline, NULL, NULL, l);
-			}
-			if (tl < 0) {
-				ret = -1;
-			} else {
-				ret = r_cons_grep_line (tline, tl);
-				if (!grep->range_line) {
-					if (grep->line == cons->lines) {
-						show = true;
-					}
-				} else if (grep->range_line == 1) {
-					if (grep->f_line == cons->lines) {
-						show = true;
-					}
-					if (grep->l_line == cons->lines) {
-						show = false;
-					}
-				} else {
-					show = true;
-				}
-			}
-			if (ret > 0) {
-				if (show) {
-					char *str = r_str_ndup (tline, ret);
-					if (cons->grep_highlight) {
-						int i;
-						for (i = 0; i < grep->nstrings; i++) {
-							char *newstr = r_str_newf (Color_INVERT"%s"Color_RESET, grep->strings[i]);
-							if (str && newstr) {
-								if (grep->icase) {
-									str = r_str_replace_icase (str, grep->strings[i], newstr, 1, 1);
-								} else {
-									str = r_str_replace (str, grep->strings[i], newstr, 1);
-								}
-							}
-							free (newstr);
-						}
-					}
-					if (str) {
-						r_strbuf_append (ob, str);
-						r_strbuf_append (ob, "\n");
-					}
-					buffer_len += ret + 1;
-					free (str);
-				}
-				if (!grep->range_line) {
-					show = false;
-				}
-				cons->lines++;
-			} else if (ret < 0) {
-				free (tline);
-				return;
-			}
-			free (tline);
-			in += l + 1;
-		} else {
-			in++;
-		}
+	if (grep_lines (grep, buf, len, ob, &cons->lines, &show) < 0) {
+		r_strbuf_free (ob);
+		return;
 	}
 
 	cons->context->buffer_len = r_strbuf_length (ob);
@@ -716,9 +732,7 @@ R_API void r_cons_grepbuf() {
 	}
 }
 
-R_API int r_cons_grep_line(char *buf, int len) {
-	RCons *cons = r_cons_singleton ();
-	RConsGrep *grep = &cons->context->grep;
+static int grep_line(RConsGrep *grep, int lines, char *buf, int len) {
 	const char *delims = " |,;=\t";
 	char *tok = NULL;
 	bool hit = grep->neg;
@@ -774,11 +788,11 @@ R_API int r_cons_grep_line(char *buf, int len) {
 
 	if (hit) {
 		if (!grep->range_line) {
-			if (grep->line == cons->lines) {
+			if (grep->line == lines) {
 				use_tok = true;
 			}
 		} else if (grep->range_line == 1) {
-			use_tok = R_BETWEEN (grep->f_line, cons->lines, grep->l_line);
+			use_tok = R_BETWEEN (grep->f_line, lines, grep->l_line);
 		} else {
 			use_tok = true;
 		}
@@ -830,7 +844,7 @@ R_API int r_cons_grep_line(char *buf, int len) {
 		if (!unsorted_lines) {
 			unsorted_lines = r_list_newf (free);
 		}
-		if (cons->lines >= grep->sort_row) {
+		if (lines >= grep->sort_row) {
 			r_list_append (sorted_lines, strdup (buf));
 		} else {
 			r_list_append (unsorted_lines, strdup (buf));
@@ -841,7 +855,38 @@ R_API int r_cons_grep_line(char *buf, int len) {
 	return len;
 }
 
+R_API int r_cons_grep_line(char *buf, int len) {
+	RCons *cons = r_cons_singleton ();
+	return grep_line (&cons->context->grep, cons->lines, buf, len);
+}
+
+/* Parses a filter for r_cons_grep_stream. Returns false if it needs the whole
+ * output at once (counters, sorting, json, less, zoom, lines counted from the
+ * end) and the command has to be buffered as usual. */
+R_API bool r_cons_grep_stream_parse(RConsGrep *grep, const char *str) {
+	r_return_val_if_fail (grep && str, false);
+	parse_grep_expression (grep, str);
+	if (grep->counter || grep->less || grep->json || grep->hud || grep->human
+			|| grep->zoom || grep->sort != -1) {
+		return false;
+	}
+	if (!grep->range_line && grep->line < 0) {
+		return false;
+	}
+	if (grep->range_line == 1 && (grep->f_line < 0 || grep->l_line <= 0)) {
+		return false;
+	}
+	return true;
+}
+
+/* Filters the complete lines of buf into ob. Returns the number of bytes
+ * consumed, the partial line at the end is left for the next call. */
+R_API int r_cons_grep_stream(RConsStream *s, const char *buf, int len, RStrBuf *ob) {
+	r_return_val_if_fail (s && buf && ob, -1);
+	return grep_lines (&s->grep, buf, len, ob, &s->lines, &s->show);
+}
+
 R_API void r_cons_grep(const char *grep) {
-	parse_grep_expression (grep);
+	parse_grep_expression (&r_cons_singleton ()->context->grep, grep);
 	r_cons_grepbuf ();
 }
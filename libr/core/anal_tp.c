@@ -38,16 +38,17 @@ static void r_anal_emul_restore(RCore *core, RConfigHold *hc) {
 	r_config_hold_free (hc);
 }
 
-#define SDB_CONTAINS(i,s) sdb_array_contains (trace, sdb_fmt ("%d.reg.write", i), s, 0)
+#define TRACE_CONTAINS(i,s) (r_anal_esil_trace_access (esil, i, R_ANAL_ESIL_TRACE_REG_WRITE, s) != NULL)
 
-static bool type_pos_hit(RAnal *anal, Sdb *trace, bool in_stack, int idx, int size, const char *place) {
+static bool type_pos_hit(RAnal *anal, RAnalEsil *esil, bool in_stack, int idx, int size, const char *place) {
 	if (in_stack) {
 		const char *sp_name = r_reg_get_name (anal->reg, R_REG_NAME_SP);
 		ut64 sp = r_reg_getv (anal->reg, sp_name);
-		ut64 write_addr = sdb_num_get (trace, sdb_fmt ("%d.mem.write", idx), 0);
+		RAnalEsilTraceAccess *a = r_anal_esil_trace_access (esil, idx, R_ANAL_ESIL_TRACE_MEM_WRITE, NULL);
+		ut64 write_addr = a? a->addr: 0;
 		return (write_addr == sp + size);
 	}
-	return SDB_CONTAINS (idx, place);
+	return TRACE_CONTAINS (idx, place);
 }
 
 static void __var_rename(RAnal *anal, RAnalVar *v, const char *name, ut64 addr) {
@@ -170,12 +171,12 @@ static void get_src_regname(RCore *core, ut64 addr, char *regname, int size) {
 	r_anal_op_free (op);
 }
 
-static ut64 get_addr(Sdb *trace, const char *regname, int idx) {
+static ut64 get_addr(RAnalEsil *esil, const char *regname, int idx) {
 	if (!regname || !*regname) {
 		return UT64_MAX;
 	}
-	const char *query = sdb_fmt ("%d.reg.read.%s", idx, regname);
-	return r_num_math (NULL, sdb_const_get (trace, query, 0));
+	RAnalEsilTraceAccess *a = r_anal_esil_trace_access (esil, idx, R_ANAL_ESIL_TRACE_REG_READ, regname);
+	return a? a->value: 0;
 }
 
 static _RAnalCond cond_invert(RAnal *anal, _RAnalCond cond) {
@@ -298,11 +299,11 @@ static RList *parse_format(RCore *core, char *fmt) {
 
 static void type_match(RCore *core, ut64 addr, char *fcn_name, ut64 baddr, const char* cc,
 		int prev_idx, bool userfnc, ut64 caddr) {
-	Sdb *trace = core->anal->esil->db_trace;
+	RAnalEsil *esil = core->anal->esil;
 	Sdb *TDB = core->anal->sdb_types;
 	RAnal *anal = core->anal;
 	RList *types = NULL;
-	int idx = sdb_num_get (trace, "idx", 0);
+	int idx = esil->trace_idx - 1;
 	bool verbose = r_config_get_i (core->config, "anal.types.verbose");
 	bool stack_rev = false, in_stack = false, format = false;
 
@@ -356,7 +357,8 @@ static void type_match(RCore *core, ut64 addr, char *fcn_name, ut64 baddr, const
 		bool res = false;
 		// Backtrace instruction from source sink to prev source sink
 		for (j = idx; j >= prev_idx; j--) {
-			ut64 instr_addr = sdb_num_get (trace, sdb_fmt ("%d.addr", j), 0);
+			RAnalEsilTraceStep *step = r_anal_esil_trace_step (esil, j);
+			ut64 instr_addr = step? step->addr: 0;
 			if (instr_addr < baddr) {
 				break;
 			}
@@ -379,12 +381,11 @@ static void type_match(RCore *core, ut64 addr, char *fcn_name, ut64 baddr, const
 			} else {
 				key = sdb_fmt ("fcn.0x%08"PFMT64x".arg.%d", caddr, size);
 			}
-			const char *query = sdb_fmt ("%d.mem.read", j);
-			if (op->type == R_ANAL_OP_TYPE_MOV && sdb_const_get (trace, query, 0)) {
+			if (op->type == R_ANAL_OP_TYPE_MOV && r_anal_esil_trace_access (esil, j, R_ANAL_ESIL_TRACE_MEM_READ, NULL)) {
 				memref = ! (!memref && var && (var->kind != R_ANAL_VAR_KIND_REG));
 			}
 			// Match type from function param to instr
-			if (type_pos_hit (anal, trace, in_stack, j, size, place)) {
+			if (type_pos_hit (anal, esil, in_stack, j, size, place)) {
 				if (!cmt_set && type && name) {
 					r_meta_set_string (anal, R_META_TYPE_VARTYPE, instr_addr,
 							sdb_fmt ("%s%s%s", type, r_str_endswith (type, "*") ? "" : " ", name));
@@ -415,11 +416,11 @@ static void type_match(RCore *core, ut64 addr, char *fcn_name, ut64 baddr, const
 					res = true;
 				} else {
 					get_src_regname (core, instr_addr, regname, sizeof (regname));
-					xaddr = get_addr (trace, regname, j);
+					xaddr = get_addr (esil, regname, j);
 				}
 			}
 			// Type propagate by following source reg
-			if (!res && *regname && SDB_CONTAINS (j, regname)) {
+			if (!res && *regname && TRACE_CONTAINS (j, regname)) {
 				if (var) {
 					if (!userfnc) {
 						__var_retype (anal, var, name, type, addr, memref, false);
@@ -444,7 +445,7 @@ static void type_match(RCore *core, ut64 addr, char *fcn_name, ut64 baddr, const
 			} else if (var && res && xaddr && (xaddr != UT64_MAX)) { // Type progation using value
 				char tmp[REGNAME_SIZE] = {0};
 				get_src_regname (core, instr_addr, tmp, sizeof (tmp));
-				ut64 ptr = get_addr (trace, tmp, j);
+				ut64 ptr = get_addr (esil, tmp, j);
 				if (ptr == xaddr) {
 					__var_retype (anal, var, name, type? type: "int", addr, memref, false);
 				}
@@ -497,13 +498,19 @@ R_API void r_core_anal_type_match(RCore *core, RAnalFunction *fcn) {
 		r_anal_emul_restore (core, hc);
 		return;
 	}
+	HtUP *loop_counts = ht_up_new0 ();
+	if (!loop_counts) {
+		free (buf);
+		r_anal_emul_restore (core, hc);
+		return;
+	}
 	char *fcn_name = NULL;
 	char *ret_type = NULL;
 	bool str_flag = false;
 	bool prop = false;
 	bool prev_var = false;
 	char prev_type[256] = {0};
-	const char *prev_dest = NULL;
+	char *prev_dest = NULL;
 	char *ret_reg = NULL;
 	const char *pc = r_reg_get_name (core->dbg->reg, R_REG_NAME_PC);
 	if (!pc) {
@@ -540,20 +547,20 @@ R_API void r_core_anal_type_match(RCore *core, RAnalFunction *fcn) {
 				r_anal_op_fini (&aop);
 				continue;
 			}
-			int loop_count = sdb_num_get (anal->esil->db_trace, sdb_fmt ("0x%"PFMT64x".count", addr), 0);
+			int loop_count = (int)(size_t)ht_up_find (loop_counts, addr, NULL);
 			if (loop_count > LOOP_MAX || aop.type == R_ANAL_OP_TYPE_RET) {
 				r_anal_op_fini (&aop);
 				break;
 			}
-			sdb_num_set (anal->esil->db_trace, sdb_fmt ("0x%"PFMT64x".count", addr), loop_count + 1, 0);
+			ht_up_update (loop_counts, addr, (void *)(size_t)(loop_count + 1));
 			if (r_anal_op_nonlinear (aop.type)) {   // skip the instr
 				r_reg_set_value (core->dbg->reg, r, addr + ret);
 			} else {
 				r_core_esil_step (core, UT64_MAX, NULL, NULL, false);
 			}
 			bool userfnc = false;
-			Sdb *trace = anal->esil->db_trace;
-			cur_idx = sdb_num_get (trace, "idx", 0);
+			RAnalEsil *esil = anal->esil;
+			cur_idx = esil->trace_idx - 1;
 			RAnalVar *var = aop.var;
 			RAnalOp *next_op = r_core_anal_op (core, addr + ret, R_ANAL_OP_MASK_BASIC); // | _VAL ?
 			ut32 type = aop.type & R_ANAL_OP_TYPE_MASK;
@@ -603,8 +610,8 @@ R_API void r_core_anal_type_match(RCore *core, RAnalFunction *fcn) {
 						free (cc);
 					}
 					if (!strcmp (fcn_name, "__stack_chk_fail")) {
-						const char *query = sdb_fmt ("%d.addr", cur_idx - 1);
-						ut64 mov_addr = sdb_num_get (trace, query, 0);
+						RAnalEsilTraceStep *step = r_anal_esil_trace_step (esil, cur_idx - 1);
+						ut64 mov_addr = step? step->addr: 0;
 						RAnalOp *mop = r_core_anal_op (core, mov_addr, R_ANAL_OP_MASK_VAL | R_ANAL_OP_MASK_BASIC);
 						if (mop && mop->var) {
 							ut32 type = mop->type & R_ANAL_OP_TYPE_MASK;
@@ -619,8 +626,7 @@ R_API void r_core_anal_type_match(RCore *core, RAnalFunction *fcn) {
 			} else if (!resolved && ret_type && ret_reg) {
 				// Forward propgation of function return type
 				char src[REGNAME_SIZE] = {0};
-				const char *query = sdb_fmt ("%d.reg.write", cur_idx);
-				const char *cur_dest = sdb_const_get (trace, query, 0);
+				char *cur_dest = r_anal_esil_trace_regs (esil, cur_idx, R_ANAL_ESIL_TRACE_REG_WRITE);
 				get_src_regname (core, aop.addr, src, sizeof (src));
 				if (ret_reg && *src && strstr (ret_reg, src)) {
 					if (var && aop.direction == R_ANAL_OP_DIR_WRITE) {
@@ -628,9 +634,8 @@ R_API void r_core_anal_type_match(RCore *core, RAnalFunction *fcn) {
 						resolved = true;
 					} else if (type == R_ANAL_OP_TYPE_MOV) {
 						R_FREE (ret_reg);
-						if (cur_dest) {
-							ret_reg = strdup (cur_dest);
-						}
+						ret_reg = cur_dest;
+						cur_dest = NULL;
 					}
 				} else if (cur_dest) {
 					char *foo = strdup (cur_dest);
@@ -654,6 +659,7 @@ R_API void r_core_anal_type_match(RCore *core, RAnalFunction *fcn) {
 					}
 					free (foo);
 				}
+				free (cur_dest);
 			}
 			// Type propagation using instruction access pattern
 			if (var) {
@@ -712,7 +718,7 @@ R_API void r_core_anal_type_match(RCore *core, RAnalFunction *fcn) {
 			prev_var = (var && aop.direction == R_ANAL_OP_DIR_READ);
 			str_flag = false;
 			prop = false;
-			prev_dest = NULL;
+			R_FREE (prev_dest);
 			switch (type) {
 			case R_ANAL_OP_TYPE_MOV:
 			case R_ANAL_OP_TYPE_LEA:
@@ -736,8 +742,7 @@ R_API void r_core_anal_type_match(RCore *core, RAnalFunction *fcn) {
 				if (var && str_flag) {
 					__var_retype (anal, var, NULL, "const char *", addr, false, false);
 				}
-				const char *query = sdb_fmt ("%d.reg.write", cur_idx);
-				prev_dest = sdb_const_get (trace, query, 0);
+				prev_dest = r_anal_esil_trace_regs (esil, cur_idx, R_ANAL_ESIL_TRACE_REG_WRITE);
 				if (var) {
 					strncpy (prev_type, var->type, sizeof (prev_type) - 1);
 					prop = true;
@@ -813,8 +818,10 @@ R_API void r_core_anal_type_match(RCore *core, RAnalFunction *fcn) {
 out_function:
 	R_FREE (ret_reg);
 	R_FREE (ret_type);
+	free (prev_dest);
 	free (buf);
+	ht_up_free (loop_counts);
 	r_cons_break_pop();
 	r_anal_emul_restore (core, hc);
-	sdb_reset (anal->esil->db_trace);
+	r_anal_esil_trace_reset (anal->esil);
 }
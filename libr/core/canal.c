@@ -777,7 +777,10 @@ static int __core_anal_fcn(RCore *core, ut64 at, ut64 from, int reftype, int dep
 	if (!fcn->name) {
 		fcn->name = r_str_newf ("%s.%08"PFMT64x, fcnpfx, at);
 	}
-	r_anal_fcn_invalidate_read_ahead_cache ();
+	if (core->io->debug) {
+		// the memory of the debuggee changes without io writes
+		r_anal_read_cache_invalidate (core->anal);
+	}
 	do {
 		RFlagItem *f;
 		ut64 delta = r_anal_function_linear_size (fcn);
@@ -1368,7 +1368,39 @@ static char *construct_reloc_name(R_NONNULL RBinReloc *reloc, R_NULLABLE const c
 	return r_strbuf_drain (buf);
 }
 
-static void set_bin_relocs(RCore *r, RBinReloc *reloc, ut64 addr, Sdb **db, char **sdb_module) {
+static void flag_batch_item_fini(void *e, void *user) {
+	RFlagBatchItem *b = (RFlagBatchItem *)e;
+	free ((char *)b->name);
+	free ((char *)b->realname);
+}
+
+// queue a flag for flag_batch_flush, taking ownership of name and realname
+static void flag_batch_push(RVector *batch, char *name, char *realname, ut64 addr, ut64 size, RSpace *space, bool demangled) {
+	RFlagBatchItem b = {
+		.name = name, .realname = realname, .offset = addr, .size = size,
+		.space = space, .demangled = demangled
+	};
+	if (!r_vector_push (batch, &b)) {
+		free (name);
+		free (realname);
+	}
+}
+
+static void flag_batch_flush(RCore *r, RVector *batch) {
+	RFlagBatchItem *b;
+	if (!batch->len) {
+		return;
+	}
+	r_flag_set_batch (r->flags, batch->a, batch->len);
+	r_vector_foreach (batch, b) {
+		if (!b->item && R_STR_ISNOTEMPTY (b->name)) {
+			eprintf ("[Warning] Can't find flag (%s)\n", b->name);
+		}
+	}
+	r_vector_clear (batch);
+}
+
+static void set_bin_relocs(RCore *r, RVector *flags, RBinReloc *reloc, ut64 addr, Sdb **db, char **sdb_module) {
 	int bin_demangle = r_config_get_i (r->config, "bin.demangle");
 	bool keep_lib = r_config_get_i (r->config, "bin.demangle.libs");
 	const char *lang = r_config_get (r->config, "bin.lang");
@@ -1448,16 +1480,15 @@ static void set_bin_relocs(RCore *r, RBinReloc *reloc, ut64 addr, Sdb **db, char
 		}
 	}
 	r_name_filter (flagname, 0);
-	RFlagItem *fi = r_flag_set (r->flags, flagname, addr, bin_reloc_size (reloc));
+	char *realname = NULL;
 	if (demname) {
-		char *realname;
 		if (r->bin->prefix) {
-			realname = sdb_fmt ("%s.reloc.%s", r->bin->prefix, demname);
+			realname = r_str_newf ("%s.reloc.%s", r->bin->prefix, demname);
 		} else {
-			realname = sdb_fmt ("reloc.%s", demname);
+			realname = r_str_newf ("reloc.%s", demname);
 		}
-		r_flag_item_set_realname (fi, realname);
 	}
+	flag_batch_push (flags, strdup (flagname), realname, addr, bin_reloc_size (reloc), NULL, false);
 	free (demname);
 }
 
@@ -1519,6 +1550,7 @@ static int bin_relocs(RCore *r, int mode, int va) {
 	Sdb *db = NULL;
 	PJ *pj = NULL;
 	char *sdb_module = NULL;
+	RVector *flags = NULL;
 	int i = 0;
 
 	R_TIME_BEGIN;
@@ -1543,6 +1575,11 @@ static int bin_relocs(RCore *r, int mode, int va) {
 		}
 	} else if (IS_MODE_SET (mode)) {
 		r_flag_space_set (r->flags, R_FLAGS_FS_RELOCS);
+		flags = r_vector_new (sizeof (RFlagBatchItem), flag_batch_item_fini, NULL);
+		if (!flags) {
+			r_table_free (table);
+			return false;
+		}
 	}
 
 	r_rbtree_foreach (relocs, iter, reloc, RBinReloc, vrb) {
@@ -1553,7 +1590,7 @@ static int bin_relocs(RCore *r, int mode, int va) {
 			 * Skip also file reloc because not useful for now.
 			 */
 		} else if (IS_MODE_SET (mode)) {
-			set_bin_relocs (r, reloc, addr, &db, &sdb_module);
+			set_bin_relocs (r, flags, reloc, addr, &db, &sdb_module);
 			add_metadata (r, reloc, addr, mode);
 		} else if (IS_MODE_SIMPLE (mode)) {
 			r_cons_printf ("0x%08"PFMT64x"  %s\n", addr, reloc->import ? reloc->import->name : "");
@@ -1650,6 +1687,11 @@ static int bin_relocs(RCore *r, int mode, int va) {
 		}
 		i++;
 	}
+	if (flags) {
+		// the relocs are walked by address, so the flags come sorted
+		flag_batch_flush (r, flags);
+		r_vector_free (flags);
+	}
 	if (IS_MODE_JSON (mode)) {
 		// close Json output
 		pj_end (pj);
@@ -2096,6 +2138,15 @@ static int bin_symbols(RCore *r, int mode, ut64 laddr, int va, ut64 at, const ch
 	const char *lang = bin_demangle ? r_config_get (r->config, "bin.lang") : NULL;
 
 	RList *symbols = r_bin_get_symbols (r->bin);
+	RVector *flags = NULL;
+	if (IS_MODE_SET (mode)) {
+		flags = r_vector_new (sizeof (RFlagBatchItem), flag_batch_item_fini, NULL);
+		if (!flags) {
+			pj_free (pj);
+			r_table_free (table);
+			return 0;
+		}
+	}
 	r_spaces_push (&r->anal->meta_spaces, "bin");
 
 	if (IS_MODE_JSON (mode) && !printHere) {
@@ -2161,6 +2212,7 @@ static int bin_symbols(RCore *r, int mode, ut64 laddr, int va, ut64 at, const ch
 			select_flag_space (r, symbol);
 			/* If that's a Classed symbol (method or so) */
 			if (sn.classname) {
+				flag_batch_flush (r, flags);
 				RFlagItem *fi = r_flag_get (r->flags, sn.methflag);
 				if (r->bin->prefix) {
 					char *prname = r_str_newf ("%s.%s", r->bin->prefix, sn.methflag);
@@ -2188,16 +2240,8 @@ static int bin_symbols(RCore *r, int mode, ut64 laddr, int va, ut64 at, const ch
 				char *fnp = (r->bin->prefix) ?
 					r_str_newf ("%s.%s", r->bin->prefix, fn):
 					strdup (fn? fn: "");
-				RFlagItem *fi = r_flag_set (r->flags, fnp, addr, symbol->size);
-				if (fi) {
-					r_flag_item_set_realname (fi, n);
-					fi->demangled = (bool)(size_t)sn.demname;
-				} else {
-					if (fn) {
-						eprintf ("[Warning] Can't find flag (%s)\n", fn);
-					}
-				}
-				free (fnp);
+				flag_batch_push (flags, fnp, strdup (n), addr, symbol->size,
+					r_flag_space_cur (r->flags), (bool)(size_t)sn.demname);
 			}
 			if (sn.demname) {
 				r_meta_add (r->anal, R_META_TYPE_COMMENT,
@@ -2314,6 +2358,10 @@ next:
 			break;
 		}
 	}
+	if (flags) {
+		flag_batch_flush (r, flags);
+		r_vector_free (flags);
+	}
 	if (IS_MODE_NORMAL (mode)){
 		if (r->table_query) {
 			r_table_query (table, r->table_query);
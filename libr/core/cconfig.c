@@ -233,6 +233,24 @@ static bool cb_analdepth(void *user, void *data) {
 	return true;
 }
 
+static bool cb_anal_rcache_slots(void *user, void *data) {
+	RCore *core = (RCore*) user;
+	RConfigNode *node = (RConfigNode*) data;
+	if (node->i_value < 0) {
+		return false;
+	}
+	return r_anal_read_cache_setup (core->anal, node->i_value, r_config_get_i (core->config, "anal.rcache.bsize"));
+}
+
+static bool cb_anal_rcache_bsize(void *user, void *data) {
+	RCore *core = (RCore*) user;
+	RConfigNode *node = (RConfigNode*) data;
+	if (node->i_value < 0 || node->i_value > ST32_MAX) {
+		return false;
+	}
+	return r_anal_read_cache_setup (core->anal, r_config_get_i (core->config, "anal.rcache.slots"), node->i_value);
+}
+
 static bool cb_analgraphdepth(void *user, void *data) {
 	RCore *core = (RCore *)user;
 	RConfigNode *node = (RConfigNode *)data;
@@ -1106,6 +1124,7 @@ static bool cb_cfgdebug(void *user, void *data) {
 	if (core->io) {
 		core->io->va = !node->i_value;
 		core->io->debug = node->i_value;
+		core->io->rev++;
 	}
 	if (core->dbg && node->i_value) {
 		const char *dbgbackend = r_config_get (core->config, "dbg.backend");
@@ -1492,6 +1511,21 @@ static bool cb_gotolimit(void *user, void *data) {
 	return true;
 }
 
+static bool cb_esiltracemax(void *user, void *data) {
+	RCore *core = (RCore *) user;
+	RConfigNode *node = (RConfigNode *) data;
+	core->anal->esil_trace_max = node->i_value;
+	return true;
+}
+
+static bool cb_esiltracespill(void *user, void *data) {
+	RCore *core = (RCore *) user;
+	RConfigNode *node = (RConfigNode *) data;
+	free (core->anal->esil_trace_spill);
+	core->anal->esil_trace_spill = R_STR_ISNOTEMPTY (node->value)? strdup (node->value): NULL;
+	return true;
+}
+
 static bool cb_esilverbose (void *user, void *data) {
 	RCore *core = (RCore *) user;
 	RConfigNode *node = (RConfigNode*) data;
@@ -1887,6 +1921,7 @@ static bool cb_io_cache_read(void *user, void *data) {
 	} else {
 		core->io->cached &= ~R_PERM_R;
 	}
+	core->io->rev++;
 	return true;
 }
 
@@ -1931,6 +1966,7 @@ static bool cb_iova(void *user, void *data) {
 	RConfigNode *node = (RConfigNode *) data;
 	if (node->i_value != core->io->va) {
 		core->io->va = node->i_value;
+		core->io->rev++;
 		/* ugly fix for r2 -d ... "r2 is going to die soon ..." */
 		if (core->io->desc) {
 			r_core_block_read (core);
@@ -1949,6 +1985,7 @@ static bool cb_ioff(void *user, void *data) {
 	RCore *core = (RCore *) user;
 	RConfigNode *node = (RConfigNode *) data;
 	core->io->ff = node->i_value;
+	core->io->rev++;
 	return true;
 }
 
@@ -1956,6 +1993,7 @@ static bool cb_io_oxff(void *user, void *data) {
 	RCore *core = (RCore *) user;
 	RConfigNode *node = (RConfigNode *) data;
 	core->io->Oxff = node->i_value;
+	core->io->rev++;
 	return true;
 }
 
@@ -2130,6 +2168,12 @@ static bool cb_scrflush(void *user, void *data) {
 	return true;
 }
 
+static bool cb_scrstream(void *user, void *data) {
+	RConfigNode *node = (RConfigNode *) data;
+	r_cons_singleton ()->stream = R_MAX ((int)node->i_value, 0);
+	return true;
+}
+
 static bool cb_scrstrconv(void *user, void *data) {
 	RCore *core = (RCore*) user;
 	RConfigNode *node = (RConfigNode*) data;
@@ -2428,6 +2472,15 @@ static bool cb_binprefix(void *user, void *data) {
 	return true;
 }
 
+static bool cb_binstrjobs(void *user, void *data) {
+	RCore *core = (RCore *) user;
+	RConfigNode *node = (RConfigNode *) data;
+	if (core->bin) {
+		core->bin->strjobs = R_MIN (R_MAX (1, node->i_value), R_BIN_MAX_STRJOBS);
+	}
+	return true;
+}
+
 static bool cb_binmaxstrbuf(void *user, void *data) {
 	RCore *core = (RCore *) user;
 	RConfigNode *node = (RConfigNode *) data;
@@ -2869,6 +2922,9 @@ R_API int r_core_config_init(RCore *core) {
 		"anal.fcn", "anal.bb",
 	NULL);
 	SETI ("anal.timeout", 0, "Stop analyzing after a couple of seconds");
+	SETI ("anal.jobs", 1, "Number of threads used to find the calls in aac");
+	SETICB ("anal.rcache.slots", R_ANAL_READ_CACHE_SLOTS, &cb_anal_rcache_slots, "Number of blocks kept by the code analysis read cache (0 to disable)");
+	SETICB ("anal.rcache.bsize", R_ANAL_READ_CACHE_BSIZE, &cb_anal_rcache_bsize, "Size of the blocks of the code analysis read cache");
 	SETICB ("anal.jmp.tailcall", 0, &cb_anal_jmptailcall, "Consume a branch as a call if delta is big");
 
 	SETCB ("anal.armthumb", "false", &cb_analarmthumb, "aae computes arm/thumb changes (lot of false positives ahead)");
@@ -2954,6 +3010,8 @@ R_API int r_core_config_init(RCore *core) {
 	SETI ("esil.addr.size", 64, "Maximum address size in accessed by the ESIL VM");
 	SETBPREF ("esil.breakoninvalid", "false", "Break esil execution when instruction is invalid");
 	SETI ("esil.timeout", 0, "A timeout (in seconds) for when we should give up emulating");
+	SETICB ("esil.trace.max", 0, &cb_esiltracemax, "Maximum number of esil trace steps kept in memory, the oldest half is dropped when exceeded (0 for no limit)");
+	SETCB ("esil.trace.spill", "", &cb_esiltracespill, "Append the esil trace steps dropped by esil.trace.max to this file (see dtel)");
 	/* asm */
 	//asm.os needs to be first, since other asm.* depend on it
 	n = NODECB ("asm.os", R_SYS_OS, &cb_asmos);
@@ -3143,6 +3201,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETICB ("bin.minstr", 0, &cb_binminstr, "Minimum string length for r_bin");
 	SETICB ("bin.maxstr", 0, &cb_binmaxstr, "Maximum string length for r_bin");
 	SETICB ("bin.maxstrbuf", 1024*1024*10, & cb_binmaxstrbuf, "Maximum size of range to load strings from");
+	SETICB ("bin.str.jobs", 1, &cb_binstrjobs, "Number of threads scanning sections for strings");
 	n = NODECB ("bin.str.enc", "guess", &cb_binstrenc);
 	SETDESC (n, "Default string encoding of binary");
 	SETOPTIONS (n, "latin1", "utf8", "utf16le", "utf32le", "utf16be", "utf32be", "guess", NULL);
@@ -3160,6 +3219,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETBPREF ("prj.zip", "false", "Use ZIP format for project files");
 	SETBPREF ("prj.gpg", "false", "TODO: Encrypt project with GnuPGv2");
 	SETBPREF ("prj.simple", "false", "Use simple project saving style (functions, comments, options)");
+	SETBPREF ("prj.bin", "false", "Save flags, functions, xrefs, meta, hints and types in a binary file next to the rc script");
 
 	/* cfg */
 	SETBPREF ("cfg.r2wars", "false", "Enable some tweaks for the r2wars game");
@@ -3233,6 +3293,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETBPREF ("zign.autoload", "false", "Autoload all zignatures located in " R_JOIN_2_PATHS ("~", R2_HOME_ZIGNS));
 	SETPREF ("zign.diff.bthresh", "1.0", "Threshold for diffing zign bytes [0, 1] (see zc?)");
 	SETPREF ("zign.diff.gthresh", "1.0", "Threshold for diffing zign graphs [0, 1] (see zc?)");
+	SETI ("zign.diff.jobs", 1, "Number of threads scoring the zignatures to diff (see zc?)");
 
 	/* diff */
 	SETCB ("diff.sort", "addr", &cb_diff_sort, "Specify function diff sorting column see (e diff.sort=?)");
@@ -3503,6 +3564,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETICB ("scr.maxtab", 4096, &cb_completion_maxtab, "Change max number of auto completion suggestions");
 	SETICB ("scr.pagesize", 1, &cb_scrpagesize, "Flush in pages when scr.linesleep is != 0");
 	SETCB ("scr.flush", "false", &cb_scrflush, "Force flush to console in realtime (breaks scripting)");
+	SETICB ("scr.stream", 0, &cb_scrstream, "Write the output of a running command every N bytes instead of at the end (0 = buffer it)");
 	SETBPREF ("scr.slow", "true", "Do slow stuff on visual mode like RFlag.get_at(true)");
 	SETCB ("scr.prompt.popup", "false", &cb_scr_prompt_popup, "Show widget dropdown for autocomplete");
 #if __WINDOWS__
@@ -3581,6 +3643,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETBPREF ("search.flags", "true", "All search results are flagged, otherwise only printed");
 	SETBPREF ("search.overlap", "false", "Look for overlapped search hits");
 	SETI ("search.maxhits", 0, "Maximum number of hits (0: no limit)");
+	SETI ("search.jobs", 1, "Number of threads used to compute the digests in /h");
 	SETI ("search.from", -1, "Search start address");
 	n = NODECB ("search.in", "io.maps", &cb_searchin);
 	SETDESC (n, "Specify search boundaries");
@@ -2729,6 +2729,7 @@ static int r_core_cmd_subst_i(RCore *core, char *cmd, char *colon, bool *tmpseek
 	bool oldfixedarch = core->fixedarch;
 	bool oldfixedbits = core->fixedbits;
 	bool cmd_tmpseek = false;
+	bool cmd_stream = false;
 	ut64 tmpbsz = core->blocksize;
 	int cmd_ignbithints = -1;
 
@@ -3225,6 +3226,8 @@ escape_backtick:
 	if (*cmd != '.') {
 		grep = r_cons_grep_strip (cmd, quotestr);
 	}
+	r_cons_stream_begin (grep);
+	cmd_stream = true;
 
 	/* temporary seek commands */
 	// if (*cmd != '(' && *cmd != '"') {
@@ -3673,6 +3676,10 @@ fuji:
 		rc = false;
 	}
 beach:
+	if (cmd_stream && r_cons_stream_end ()) {
+		// the output was filtered while it was written
+		R_FREE (grep);
+	}
 	r_cons_grep_process (grep);
 	if (scr_html != -1) {
 		r_cons_flush ();
@@ -6441,111 +6441,387 @@ ctrl_c:
 	r_cons_break_pop ();
 }
 
-static void _anal_calls(RCore *core, ut64 addr, ut64 addr_end, bool printCommands, bool importsOnly) {
-	RAnalOp op;
-	int depth = r_config_get_i (core->config, "anal.depth");
-	const int addrbytes = core->io->addrbytes;
-	const int bsz = 4096;
-	int bufi = 0;
-	int bufi_max = bsz - 16;
-	if (addr_end - addr > UT32_MAX) {
-		return;
-	}
-	ut8 *buf = malloc (bsz);
-	ut8 *block0 = calloc (1, bsz);
-	ut8 *block1 = malloc (bsz);
-	if (!buf || !block0 || !block1) {
-		eprintf ("Error: cannot allocate buf or block\n");
-		free (buf);
-		free (block0);
-		free (block1);
-		return;
-	}
-	memset (block1, -1, bsz);
-	int minop = r_anal_archinfo (core->anal, R_ANAL_ARCHINFO_MIN_OP_SIZE);
-	if (minop < 1) {
-		minop = 1;
+#define ANAL_CALLS_BSZ 4096
+#define ANAL_CALLS_SYNC 4096 // addresses tracked at the start of a chunk to resync the sweeps
+#define ANAL_CALLS_MINCHUNK 0x10000
+#define ANAL_CALLS_MAXCHUNK 0x400000
+
+typedef struct {
+	ut64 at;
+	ut64 jump;
+	int size;
+} AnalCallSite;
+
+typedef struct {
+	RCore *core; // only set for the serial sweep
+	RAnal *anal;
+	RAnal *hints; // the core anal, the workers follow its bits hints
+	ut8 *buf; // snapshot of the bytes at from
+	int len;
+	int addrbytes;
+	int minop;
+	int bits;
+	ut64 from;
+	ut64 to;
+	ut64 end; // where the sweep stopped
+	ut8 *mark; // instructions seen in the first ANAL_CALLS_SYNC addresses
+	RVector calls; // AnalCallSite
+} AnalCallsChunk;
+
+typedef struct {
+	ut64 from;
+	ut64 to;
+	bool found;
+} AnalCallsRange;
+
+static bool is_fill_block(const ut8 *buf, int len) {
+	int i;
+	if (*buf && *buf != 0xff) {
+		return false;
 	}
-	int setBits = r_config_get_i (core->config, "asm.bits");
-	r_cons_break_push (NULL, NULL);
-	while (addr < addr_end && !r_cons_is_breaked ()) {
-		// TODO: too many ioreads here
-		if (bufi > bufi_max) {
-			bufi = 0;
+	for (i = 1; i < len; i++) {
+		if (buf[i] != *buf) {
+			return false;
 		}
-		if (!bufi) {
-			(void)r_io_read_at (core->io, addr, buf, bsz);
+	}
+	return true;
+}
+
+// linear sweep of the chunk from addr to c->to, collecting the calls. The
+// resync sweeps stop at the first instruction already seen by the chunk
+// worker, because from there on both sweeps decode the same instructions.
+static ut64 anal_calls_sweep(AnalCallsChunk *c, ut64 addr, RVector *calls, bool resync) {
+	RAnalOp op;
+	while (addr < c->to && !r_cons_is_breaked ()) {
+		const ut64 delta = addr - c->from;
+		if (c->mark && delta < ANAL_CALLS_SYNC) {
+			const ut8 bit = 1 << (delta & 7);
+			if (resync && (c->mark[delta >> 3] & bit)) {
+				break;
+			}
+			if (!resync) {
+				c->mark[delta >> 3] |= bit;
+			}
 		}
-		if (!memcmp (buf, block0, bsz) || !memcmp (buf, block1, bsz)) {
+		const int off = delta * c->addrbytes;
+		if (is_fill_block (c->buf + off, ANAL_CALLS_BSZ)) {
 			//eprintf ("Error: skipping uninitialized block \n");
-			addr += bsz;
+			addr += ANAL_CALLS_BSZ;
 			continue;
 		}
-		RAnalHint *hint = r_anal_hint_get (core->anal, addr);
-		if (hint && hint->bits) {
-			setBits = hint->bits;
-		}
-		r_anal_hint_free (hint);
-		if (setBits != core->assembler->bits) {
-			r_config_set_i (core->config, "asm.bits", setBits);
+		if (c->core) {
+			RAnalHint *hint = r_anal_hint_get (c->core->anal, addr);
+			if (hint && hint->bits) {
+				c->bits = hint->bits;
+			}
+			r_anal_hint_free (hint);
+			if (c->bits != c->core->assembler->bits) {
+				r_config_set_i (c->core->config, "asm.bits", c->bits);
+			}
+		} else if (c->hints) {
+			int bits = r_anal_hint_bits_at (c->hints, addr, NULL);
+			if (!bits) {
+				bits = c->bits;
+			}
+			if (bits != c->anal->bits && r_anal_set_bits (c->anal, bits)) {
+				// like asm.bits does for the core anal
+				const int align = r_anal_archinfo (c->anal, R_ANAL_ARCHINFO_ALIGN);
+				c->anal->pcalign = (align != -1)? align: 0;
+			}
 		}
-		if (r_anal_op (core->anal, &op, addr, buf + bufi, bsz - bufi, 0) > 0) {
+		if (r_anal_op (c->anal, &op, addr, c->buf + off, c->len - off, 0) > 0) {
 			if (op.size < 1) {
-				op.size = minop;
+				op.size = c->minop;
 			}
 			if (op.type == R_ANAL_OP_TYPE_CALL) {
-				bool isValidCall = true;
-				if (importsOnly) {
-					RFlagItem *f = r_flag_get_i (core->flags, op.jump);
-					if (!f || !strstr (f->name, "imp.")) {
-						isValidCall = false;
-					}
-				}
-				RBinReloc *rel = r_core_getreloc (core, addr, op.size);
-				if (rel && (rel->import || rel->symbol)) {
-					isValidCall = false;
-				}
-				if (isValidCall) {
-					ut8 buf[4];
-					r_io_read_at (core->io, op.jump, buf, 4);
-					isValidCall = memcmp (buf, "\x00\x00\x00\x00", 4);
-				}
-				if (isValidCall) {
-#if JAYRO_03
-					if (!anal_is_bad_call (core, from, to, addr, buf, bufi)) {
-						fcn = r_anal_get_fcn_in (core->anal, op.jump, R_ANAL_FCN_TYPE_ROOT);
-						if (!fcn) {
-							r_core_anal_fcn (core, op.jump, addr, R_ANAL_REF_TYPE_CALL, depth);
-						}
-					}
-#else
-					if (printCommands) {
-						r_cons_printf ("ax 0x%08" PFMT64x " 0x%08" PFMT64x "\n", op.jump, addr);
-						r_cons_printf ("af @ 0x%08" PFMT64x"\n", op.jump);
-					} else {
-						// add xref here
-						r_anal_xrefs_set (core->anal, addr, op.jump, R_ANAL_REF_TYPE_CALL);
-						if (r_io_is_valid_offset (core->io, op.jump, 1)) {
-							r_core_anal_fcn (core, op.jump, addr, R_ANAL_REF_TYPE_CALL, depth);
-						}
-					}
-#endif
-				}
+				AnalCallSite cs = { addr, op.jump, op.size };
+				r_vector_push (calls, &cs);
 			}
 		} else {
-			op.size = minop;
+			op.size = c->minop;
 		}
 		if ((int)op.size < 1) {
-			op.size = minop;
+			op.size = c->minop;
 		}
 		addr += op.size;
-		bufi += addrbytes * op.size;
 		r_anal_op_fini (&op);
 	}
+	return addr;
+}
+
+static void anal_calls_run(AnalCallsChunk *c) {
+	c->end = anal_calls_sweep (c, c->from, &c->calls, false);
+}
+
+static RThreadFunctionRet anal_calls_th(RThread *th) {
+	anal_calls_run (th->user);
+	return R_TH_STOP;
+}
+
+// the calls are applied in address order, so the result is the same for any anal.jobs
+static void anal_calls_apply(RCore *core, RVector *calls, ut64 from, bool printCommands, bool importsOnly, int depth) {
+	AnalCallSite *cs;
+	r_vector_foreach (calls, cs) {
+		if (cs->at < from) {
+			continue;
+		}
+		if (r_cons_is_breaked ()) {
+			break;
+		}
+		if (importsOnly) {
+			RFlagItem *f = r_flag_get_i (core->flags, cs->jump);
+			if (!f || !strstr (f->name, "imp.")) {
+				continue;
+			}
+		}
+		RBinReloc *rel = r_core_getreloc (core, cs->at, cs->size);
+		if (rel && (rel->import || rel->symbol)) {
+			continue;
+		}
+		ut8 buf[4];
+		r_io_read_at (core->io, cs->jump, buf, 4);
+		if (!memcmp (buf, "\x00\x00\x00\x00", 4)) {
+			continue;
+		}
+		if (printCommands) {
+			r_cons_printf ("ax 0x%08" PFMT64x " 0x%08" PFMT64x "\n", cs->jump, cs->at);
+			r_cons_printf ("af @ 0x%08" PFMT64x"\n", cs->jump);
+		} else {
+			// add xref here
+			r_anal_xrefs_set (core->anal, cs->at, cs->jump, R_ANAL_REF_TYPE_CALL);
+			if (r_io_is_valid_offset (core->io, cs->jump, 1)) {
+				r_core_anal_fcn (core, cs->jump, cs->at, R_ANAL_REF_TYPE_CALL, depth);
+			}
+		}
+	}
+}
+
+static bool anal_calls_arch_hint_cb(ut64 addr, const char *arch, void *user) {
+	AnalCallsRange *r = user;
+	if (addr > r->from && addr < r->to) {
+		r->found = true;
+	}
+	return !r->found && addr < r->to;
+}
+
+// the workers follow the bits hints but decode with a fixed arch, so no
+// arch hint or section with its own arch or bits may be inside of the range
+static bool anal_calls_uniform(RCore *core, ut64 from, ut64 to) {
+	AnalCallsRange r = { from, to, false };
+	if (!core->fixedarch) {
+		r_anal_arch_hints_foreach (core->anal, anal_calls_arch_hint_cb, &r);
+	}
+	if (r.found) {
+		return false;
+	}
+	RBinObject *o = r_bin_cur_object (core->bin);
+	if (o) {
+		RListIter *iter;
+		RBinSection *s;
+		r_list_foreach (o->sections, iter, s) {
+			if (!s->arch && !s->bits) {
+				continue;
+			}
+			const ut64 at = core->io->va? s->vaddr: s->paddr;
+			const ut64 end = at + (core->io->va? s->vsize: s->size);
+			if (at < to && end > from && (at > from || end < to)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// RIO is not thread safe, the workers take turns to read from it
+static RThreadLock *anal_calls_io_lock = NULL;
+
+static bool anal_calls_io_read_at(RIO *io, ut64 addr, ut8 *buf, int len) {
+	r_th_lock_enter (anal_calls_io_lock);
+	bool ret = r_io_read_at (io, addr, buf, len);
+	r_th_lock_leave (anal_calls_io_lock);
+	return ret;
+}
+
+static bool anal_calls_read_at(RAnal *anal, ut64 addr, ut8 *buf, int len) {
+	return anal_calls_io_read_at (anal->iob.io, addr, buf, len);
+}
+
+// the worker anal gets the bindings of the core anal, except for archbits,
+// which changes asm.bits in the core config. The bits hints are followed
+// by the sweep instead.
+static RAnal *anal_calls_anal_new(RAnal *src) {
+	RAnal *anal = r_anal_new ();
+	if (!anal || !src->cur || !r_anal_use (anal, src->cur->name)) {
+		r_anal_free (anal);
+		return NULL;
+	}
+	r_anal_set_user_ptr (anal, src->user);
+	anal->iob = src->iob;
+	anal->iob.read_at = anal_calls_io_read_at;
+	anal->read_at = anal_calls_read_at;
+	anal->binb = src->binb;
+	anal->flb = src->flb;
+	anal->flag_get = src->flag_get;
+	anal->coreb = src->coreb;
+	anal->coreb.archbits = NULL;
+	anal->cb_printf = src->cb_printf;
+	r_anal_set_cpu (anal, src->cpu);
+	r_anal_set_bits (anal, src->bits);
+	r_anal_set_big_endian (anal, src->big_endian);
+	if (src->reg->reg_profile_str) {
+		r_reg_set_profile_string (anal->reg, src->reg->reg_profile_str);
+	}
+	anal->opt = src->opt;
+	anal->pcalign = src->pcalign;
+	anal->bitshift = src->bitshift;
+	return anal;
+}
+
+static void anal_calls_chunks_free(AnalCallsChunk *chunks, int n) {
+	int i;
+	for (i = 0; i < n; i++) {
+		if (!chunks[i].core) {
+			r_anal_free (chunks[i].anal);
+		}
+		r_vector_clear (&chunks[i].calls);
+		free (chunks[i].buf);
+		free (chunks[i].mark);
+	}
+	free (chunks);
+}
+
+static AnalCallsChunk *anal_calls_chunks_new(RCore *core, int jobs) {
+	AnalCallsChunk *chunks = R_NEWS0 (AnalCallsChunk, jobs);
+	if (!chunks) {
+		return NULL;
+	}
+	if (jobs > 1 && !anal_calls_io_lock) {
+		anal_calls_io_lock = r_th_lock_new (false);
+		if (!anal_calls_io_lock) {
+			free (chunks);
+			return NULL;
+		}
+	}
+	int i, minop = r_anal_archinfo (core->anal, R_ANAL_ARCHINFO_MIN_OP_SIZE);
+	for (i = 0; i < jobs; i++) {
+		AnalCallsChunk *c = &chunks[i];
+		r_vector_init (&c->calls, sizeof (AnalCallSite), NULL, NULL);
+		c->addrbytes = core->io->addrbytes;
+		c->minop = R_MAX (minop, 1);
+		c->bits = r_config_get_i (core->config, "asm.bits");
+		if (jobs == 1) {
+			c->core = core;
+			c->anal = core->anal;
+			continue;
+		}
+		c->anal = anal_calls_anal_new (core->anal);
+		c->hints = core->fixedbits? NULL: core->anal;
+		c->mark = calloc (1, ANAL_CALLS_SYNC / 8);
+		if (!c->anal || !c->mark) {
+			anal_calls_chunks_free (chunks, i + 1);
+			return NULL;
+		}
+	}
+	return chunks;
+}
+
+// snapshots the chunk bytes, plus enough to decode and check for a fill block at its end
+static bool anal_calls_chunk_read(RCore *core, AnalCallsChunk *c, ut64 from, ut64 to) {
+	const int len = (to - from) * c->addrbytes + ANAL_CALLS_BSZ + 32;
+	if (len > c->len) {
+		ut8 *buf = realloc (c->buf, len);
+		if (!buf) {
+			return false;
+		}
+		c->buf = buf;
+	}
+	c->len = len;
+	c->from = from;
+	c->to = to;
+	c->end = from;
+	r_vector_clear (&c->calls);
+	if (c->mark) {
+		memset (c->mark, 0, ANAL_CALLS_SYNC / 8);
+	}
+	(void)r_io_read_at (core->io, from, c->buf, len);
+	return true;
+}
+
+// The range is swept in chunks, up to anal.jobs at once, each one by a worker
+// with its own RAnal. Only the first chunk of a batch starts at an instruction
+// boundary, the others are resynced with the end of the previous chunk before
+// their calls are analyzed in order, on this thread.
+static void _anal_calls(RCore *core, ut64 addr, ut64 addr_end, bool printCommands, bool importsOnly) {
+	int depth = r_config_get_i (core->config, "anal.depth");
+	int jobs = R_MAX (r_config_get_i (core->config, "anal.jobs"), 1);
+	if (addr_end - addr > UT32_MAX) {
+		return;
+	}
+	AnalCallsChunk *chunks = NULL;
+	if (jobs > 1 && anal_calls_uniform (core, addr, addr_end)) {
+		r_core_seek_arch_bits (core, addr);
+		chunks = anal_calls_chunks_new (core, jobs);
+	}
+	if (!chunks) {
+		jobs = 1;
+		chunks = anal_calls_chunks_new (core, jobs);
+		if (!chunks) {
+			eprintf ("Error: cannot allocate buf or block\n");
+			return;
+		}
+	}
+	ut64 csize = (addr_end - addr) / jobs + 1;
+	csize = R_MIN (R_MAX (csize, ANAL_CALLS_MINCHUNK), ANAL_CALLS_MAXCHUNK);
+	// keep the chunks aligned, so the worker sweeps can meet the instructions of the previous chunk
+	csize = R_ROUND (csize, ANAL_CALLS_BSZ);
+	RThread **th = R_NEWS0 (RThread *, jobs);
+	r_cons_break_push (NULL, NULL);
+	while (th && addr < addr_end && !r_cons_is_breaked ()) {
+		ut64 from = addr;
+		int i, n;
+		for (n = 0; n < jobs && from < addr_end; n++) {
+			const ut64 to = R_MIN (from + csize, addr_end);
+			if (!anal_calls_chunk_read (core, &chunks[n], from, to)) {
+				break;
+			}
+			from = to;
+		}
+		if (n == 0) {
+			eprintf ("Error: cannot allocate buf or block\n");
+			break;
+		}
+		for (i = 0; i < n; i++) {
+			th[i] = (n > 1)? r_th_new (anal_calls_th, &chunks[i], 0): NULL;
+			if (!th[i]) {
+				anal_calls_run (&chunks[i]);
+			}
+		}
+		for (i = 0; i < n; i++) {
+			if (th[i]) {
+				r_th_wait (th[i]);
+				th[i] = r_th_free (th[i]);
+			}
+		}
+		anal_calls_apply (core, &chunks[0].calls, 0, printCommands, importsOnly, depth);
+		addr = chunks[0].end;
+		for (i = 1; i < n; i++) {
+			AnalCallsChunk *c = &chunks[i];
+			RVector calls;
+			r_vector_init (&calls, sizeof (AnalCallSite), NULL, NULL);
+			const ut64 at = anal_calls_sweep (c, addr, &calls, true);
+			anal_calls_apply (core, &calls, 0, printCommands, importsOnly, depth);
+			r_vector_clear (&calls);
+			if (at < c->to) {
+				anal_calls_apply (core, &c->calls, at, printCommands, importsOnly, depth);
+				addr = c->end;
+			} else {
+				addr = at;
+			}
+		}
+	}
 	r_cons_break_pop ();
-	free (buf);
-	free (block0);
-	free (block1);
+	free (th);
+	anal_calls_chunks_free (chunks, jobs);
 }
 
 static void cmd_anal_calls(RCore *core, const char *input, bool printCommands, bool importsOnly) {
@@ -483,8 +483,11 @@ static const char *help_msg_dte[] = {
 	"dte", "", "Esil trace log for a single instruction",
 	"dte", " [idx]", "Show commands for that index log",
 	"dte", "-*", "Delete all esil traces",
+	"dtea", " [addr]", "List the esil trace indexes of the instruction at addr",
 	"dtei", "", "Esil trace log single instruction",
 	"dtek", " [sdb query]", "Esil trace log single instruction from sdb",
+	"dtel", " [file]", "Load the esil trace from file (see esil.trace.spill)",
+	"dtes", " [file]", "Save the esil trace to file",
 	NULL
 };
 
@@ -4952,10 +4955,7 @@ static int cmd_debug(void *data, const char *input) {
 			} break;
 			case '-': // "dte-"
 				if (!strcmp (input + 3, "*")) {
-					if (core->anal->esil) {
-						sdb_free (core->anal->esil->db_trace);
-						core->anal->esil->db_trace = sdb_new0 ();
-					}
+					r_anal_esil_trace_reset (core->anal->esil);
 				} else {
 					eprintf ("TODO: dte- cannot delete specific logs. Use dte-*\n");
 				}
@@ -4965,16 +4965,37 @@ static int cmd_debug(void *data, const char *input) {
 				r_anal_esil_trace_show (
 					core->anal->esil, idx);
 			} break;
+			case 'a': { // "dtea"
+				ut64 addr = input[3]? r_num_math (core->num, input + 3): core->offset;
+				r_anal_esil_trace_addr (core->anal->esil, addr);
+			} break;
 			case 'k': // "dtek"
 				if (input[3] == ' ') {
-					char *s = sdb_querys (core->anal->esil->db_trace,
-							NULL, 0, input + 4);
-					r_cons_println (s);
-					free (s);
+					Sdb *db = r_anal_esil_trace_sdb (core->anal->esil);
+					if (db) {
+						char *s = sdb_querys (db, NULL, 0, input + 4);
+						r_cons_println (s);
+						free (s);
+						sdb_free (db);
+					}
 				} else {
 					eprintf ("Usage: dtek [query]\n");
 				}
 				break;
+			case 's': // "dtes"
+			case 'l': // "dtel"
+				if (input[3] == ' ' && input[4]) {
+					const char *file = r_str_trim_head_ro (input + 4);
+					bool ok = input[2] == 's'
+						? r_anal_esil_trace_save (core->anal->esil, file)
+						: r_anal_esil_trace_load (core->anal->esil, file);
+					if (!ok) {
+						eprintf ("Cannot %s the esil trace %s\n", input[2] == 's'? "save": "load", file);
+					}
+				} else {
+					eprintf ("Usage: dte%c [file]\n", input[2]);
+				}
+				break;
 			default:
 				r_core_cmd_help (core, help_msg_dte);
 			}
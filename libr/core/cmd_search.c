@@ -170,74 +170,210 @@ static void cmd_search_init(RCore *core) {
 	DEFINE_CMD_DESCRIPTOR_SPECIAL (core, /x, slash_x);
 }
 
+// start positions hashed per job in each read of /h
+#define SEARCH_HASH_CHUNK (1024 * 1024)
+
+typedef struct {
+	RHash *ctx;
+	ut64 algo;
+	const char *hashstr;
+	const ut8 *want;
+	int size;
+	const ut8 *buf; // bytes of the first window of the job
+	ut32 len;
+	ut64 n; // number of windows hashed by the job
+	ut64 found; // index of the first matching window or UT64_MAX
+} SearchHashJob;
+
+static bool search_hash_match(SearchHashJob *job, const ut8 *digest, int size) {
+	if (job->algo == R_HASH_ENTROPY) {
+		char s[32];
+		snprintf (s, sizeof (s), "%02.8f", job->ctx->entropy);
+		return !strcmp (s, job->hashstr);
+	}
+	return size == job->size && !memcmp (digest, job->want, size);
+}
+
+static void search_hash_run(SearchHashJob *job) {
+	ut64 i;
+	job->found = UT64_MAX;
+	for (i = 0; i < job->n; i++) {
+		int size = r_hash_calculate (job->ctx, job->algo, job->buf + i, job->len);
+		if (search_hash_match (job, job->ctx->digest, size)) {
+			job->found = i;
+			break;
+		}
+	}
+}
+
+static RThreadFunctionRet search_hash_th(RThread *th) {
+	search_hash_run (th->user);
+	return R_TH_STOP;
+}
+
+// The range is read in chunks overlapping by the window length. Checksums that
+// can be rolled are updated with the byte leaving and the one entering the
+// window, the other digests are computed by up to search.jobs threads, each on
+// its own slice of the chunk.
+static ut64 search_hash_range(RCore *core, SearchHashJob *jobs, int njobs, RHashRoll **roll, ut64 from, ut64 to) {
+	const ut32 len = jobs[0].len;
+	const ut64 nwin = to - from - len + 1;
+	const ut64 chunk = R_MIN (nwin, (ut64)SEARCH_HASH_CHUNK * (*roll? 1: njobs));
+	ut8 digest[R_HASH_SIZE_SHA512];
+	ut64 pos, i, at = UT64_MAX;
+	int k;
+
+	ut8 *buf = malloc (chunk + len);
+	RThread **th = R_NEWS0 (RThread *, njobs);
+	if (!buf || !th) {
+		eprintf ("Cannot allocate %"PFMT64d " bytes\n", chunk + len);
+		goto beach;
+	}
+	for (pos = 0; pos < nwin && at == UT64_MAX; pos += chunk) {
+		if (r_cons_is_breaked ()) {
+			break;
+		}
+		eprintf ("0x%08"PFMT64x "\r", from + pos);
+		const ut64 n = R_MIN (chunk, nwin - pos);
+		// one more byte to slide the window to the next chunk
+		const ut64 rd = R_MIN (n + len, to - from - pos);
+		(void)r_io_read_at (core->io, from + pos, buf, rd);
+		if (*roll && !pos) {
+			r_hash_roll_begin (*roll, buf);
+			int size = r_hash_calculate (jobs[0].ctx, jobs[0].algo, buf, len);
+			if (r_hash_roll_digest (*roll, digest) != size || memcmp (digest, jobs[0].ctx->digest, size)) {
+				// never expected, hash this range the slow way
+				r_hash_roll_free (*roll);
+				*roll = NULL;
+			}
+		}
+		if (*roll) {
+			for (i = 0; i < n; i++) {
+				int size = r_hash_roll_digest (*roll, digest);
+				if (search_hash_match (&jobs[0], digest, size)) {
+					at = from + pos + i;
+					break;
+				}
+				if (i + len < rd) {
+					r_hash_roll_next (*roll, buf[i], buf[i + len]);
+				}
+			}
+			continue;
+		}
+		const ut64 slice = (n + njobs - 1) / njobs;
+		for (k = 0; k < njobs; k++) {
+			SearchHashJob *job = &jobs[k];
+			job->buf = buf + R_MIN (k * slice, n);
+			job->n = R_MIN (slice, n - R_MIN (k * slice, n));
+			job->found = UT64_MAX;
+			th[k] = (njobs > 1 && job->n)? r_th_new (search_hash_th, job, 0): NULL;
+			if (!th[k]) {
+				search_hash_run (job);
+			}
+		}
+		for (k = 0; k < njobs; k++) {
+			if (th[k]) {
+				r_th_wait (th[k]);
+				th[k] = r_th_free (th[k]);
+			}
+		}
+		for (k = 0; k < njobs; k++) {
+			if (jobs[k].found != UT64_MAX) {
+				at = from + pos + k * slice + jobs[k].found;
+				break;
+			}
+		}
+	}
+beach:
+	free (buf);
+	free (th);
+	return at;
+}
+
 static int search_hash(RCore *core, const char *hashname, const char *hashstr, ut32 minlen, ut32 maxlen, struct search_parameters *param) {
 	RIOMap *map;
-	ut8 *buf;
-	int i, j;
 	RListIter *iter;
+	int j, k, ret = 0;
 
+	ut64 algo = r_hash_name_to_bits (hashname);
+	if (!algo || (algo & (algo - 1))) {
+		eprintf ("Unknown hash algorithm '%s'\n", hashname);
+		return -1;
+	}
+	int size = r_hash_size (algo);
+	ut8 *want = calloc (strlen (hashstr) / 2 + 1, 1);
+	if (!want) {
+		return -1;
+	}
+	if (algo != R_HASH_ENTROPY && (size <= 0 || r_hex_str2bin (hashstr, want) != size)) {
+		eprintf ("Invalid %s hash '%s'\n", hashname, hashstr);
+		free (want);
+		return -1;
+	}
 	if (!minlen || minlen == UT32_MAX) {
 		minlen = core->blocksize;
 	}
 	if (!maxlen || maxlen == UT32_MAX) {
 		maxlen = minlen;
 	}
+	int njobs = R_MAX (r_config_get_i (core->config, "search.jobs"), 1);
+	SearchHashJob *jobs = R_NEWS0 (SearchHashJob, njobs);
+	if (!jobs) {
+		free (want);
+		return -1;
+	}
+	for (k = 0; k < njobs; k++) {
+		SearchHashJob *job = &jobs[k];
+		job->ctx = r_hash_new (true, algo);
+		job->algo = algo;
+		job->hashstr = hashstr;
+		job->want = want;
+		job->size = size;
+		if (!job->ctx) {
+			ret = -1;
+			goto beach;
+		}
+	}
 
 	r_cons_break_push (NULL, NULL);
-	for (j = minlen; j <= maxlen; j++) {
+	for (j = minlen; j <= maxlen && !ret; j++) {
 		ut32 len = j;
+		RHashRoll *roll = r_hash_roll_new (algo, len);
 		eprintf ("Searching %s for %d byte length.\n", hashname, j);
+		for (k = 0; k < njobs; k++) {
+			jobs[k].len = len;
+		}
 		r_list_foreach (param->boundaries, iter, map) {
 			if (r_cons_is_breaked ()) {
 				break;
 			}
 			ut64 from = map->itv.addr, to = r_itv_end (map->itv);
-			st64 bufsz;
-			bufsz = to - from;
-			if (len > bufsz) {
+			if (len > to - from) {
 				eprintf ("Hash length is bigger than range 0x%"PFMT64x "\n", from);
 				continue;
 			}
-			buf = malloc (bufsz);
-			if (!buf) {
-				eprintf ("Cannot allocate %"PFMT64d " bytes\n", bufsz);
-				goto hell;
-			}
 			eprintf ("Search in range 0x%08"PFMT64x " and 0x%08"PFMT64x "\n", from, to);
-			int blocks = (int) (to - from - len);
-			eprintf ("Carving %d blocks...\n", blocks);
-			(void) r_io_read_at (core->io, from, buf, bufsz);
-			for (i = 0; (from + i + len) < to; i++) {
-				if (r_cons_is_breaked ()) {
-					break;
-				}
-				char *s = r_hash_to_string (NULL, hashname, buf + i, len);
-				if (!(i % 5)) {
-					eprintf ("%d\r", i);
-				}
-				if (!s) {
-					eprintf ("Hash fail\n");
-					break;
-				}
-				// eprintf ("0x%08"PFMT64x" %s\n", from+i, s);
-				if (!strcmp (s, hashstr)) {
-					eprintf ("Found at 0x%"PFMT64x "\n", from + i);
-					r_cons_printf ("f hash.%s.%s = 0x%"PFMT64x "\n",
-						hashname, hashstr, from + i);
-					free (s);
-					free (buf);
-					return 1;
-				}
-				free (s);
+			ut64 at = search_hash_range (core, jobs, njobs, &roll, from, to);
+			if (at != UT64_MAX) {
+				eprintf ("Found at 0x%"PFMT64x "\n", at);
+				r_cons_printf ("f hash.%s.%s = 0x%"PFMT64x "\n", hashname, hashstr, at);
+				ret = 1;
+				break;
 			}
-			free (buf);
 		}
+		r_hash_roll_free (roll);
 	}
 	r_cons_break_pop ();
-	eprintf ("No hashes found\n");
-	return 0;
-hell:
-	return -1;
+	if (!ret) {
+		eprintf ("No hashes found\n");
+	}
+beach:
+	for (k = 0; k < njobs; k++) {
+		r_hash_free (jobs[k].ctx);
+	}
+	free (jobs);
+	free (want);
+	return ret;
 }
 
 static void cmd_search_bin(RCore *core, RInterval itv) {
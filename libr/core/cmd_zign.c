@@ -988,6 +988,16 @@ static bool search(RCore *core, bool rad, bool only_func) {
 		int count = 0;
 
 		RSignSearch *ss = NULL;
+		RSignIndex *idx = NULL;
+
+		if (useGraph || useOffset || useRefs || useHash || useTypes) {
+			idx = r_sign_index_new (core->anal);
+			if (!idx) {
+				eprintf ("error: cannot index the zignatures\n");
+				r_cons_break_pop ();
+				return false;
+			}
+		}
 
 		if (useBytes && only_func) {
 			ss = r_sign_search_new ();
@@ -1001,16 +1011,16 @@ static bool search(RCore *core, bool rad, bool only_func) {
 				break;
 			}
 			if (useGraph) {
-				r_sign_match_graph (core->anal, fcni, mincc, fcnMatchCB, &graph_match_ctx);
+				r_sign_index_match_graph (idx, fcni, mincc, fcnMatchCB, &graph_match_ctx);
 			}
 			if (useOffset) {
-				r_sign_match_addr (core->anal, fcni, fcnMatchCB, &offset_match_ctx);
+				r_sign_index_match_addr (idx, fcni, fcnMatchCB, &offset_match_ctx);
 			}
 			if (useRefs) {
-				r_sign_match_refs (core->anal, fcni, fcnMatchCB, &refs_match_ctx);
+				r_sign_index_match_refs (idx, fcni, fcnMatchCB, &refs_match_ctx);
 			}
 			if (useHash) {
-				r_sign_match_hash (core->anal, fcni, fcnMatchCB, &hash_match_ctx);
+				r_sign_index_match_hash (idx, fcni, fcnMatchCB, &hash_match_ctx);
 			}
 			if (useBytes && only_func) {
 				eprintf ("Matching func %d / %d (hits %d)\n", count, r_list_length (core->anal->fcns), bytes_search_ctx.count);
@@ -1019,7 +1029,7 @@ static bool search(RCore *core, bool rad, bool only_func) {
 				retval &= searchRange2 (core, ss, fcni->addr, fcni->addr + len, rad, &bytes_search_ctx);
 			}
 			if (useTypes) {
-				r_sign_match_types (core->anal, fcni, fcnMatchCB, &types_match_ctx);
+				r_sign_index_match_types (idx, fcni, fcnMatchCB, &types_match_ctx);
 			}
 			count ++;
 #if 0
@@ -1028,6 +1038,7 @@ TODO: add useXRefs, useName
 		}
 		r_cons_break_pop ();
 		r_sign_search_free (ss);
+		r_sign_index_free (idx);
 	}
 
 	if (rad) {
@@ -1052,6 +1063,9 @@ static int cmdCompare(void *data, const char *input) {
 	const char *raw_bytes_thresh = r_config_get (core->config, "zign.diff.bthresh");
 	const char *raw_graph_thresh = r_config_get (core->config, "zign.diff.gthresh");
 	RSignOptions *options = r_sign_options_new (raw_bytes_thresh, raw_graph_thresh);
+	if (options) {
+		options->jobs = r_config_get_i (core->config, "zign.diff.jobs");
+	}
 
 	switch (*input) {
 	case ' ':
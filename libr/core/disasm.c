@@ -2407,30 +2407,25 @@ static void ds_update_ref_lines(RDisasmState *ds) {
 static int ds_disassemble(RDisasmState *ds, ut8 *buf, int len) {
 	RCore *core = ds->core;
 	int ret;
-	const char *info;
-	Sdb *s = core->anal->sdb_meta;
-	char key[100];
 	ut64 mt_sz = UT64_MAX;
 
 	//handle meta info to fix ds->oplen
-	snprintf (key, sizeof (key) - 1, "meta.0x%"PFMT64x, ds->at);
-	info = sdb_const_get (s, key, 0);
-	if (info) {
-		for (;*info; info++) {
-			switch (*info) {
+	RPVector *metas = r_meta_get_all_at (core->anal, ds->at);
+	if (metas) {
+		void **it;
+		r_pvector_foreach (metas, it) {
+			const RAnalMetaItem *mi = *it;
+			switch (mi->type) {
 			case R_META_TYPE_DATA:
 			case R_META_TYPE_STRING:
 			case R_META_TYPE_FORMAT:
 			case R_META_TYPE_MAGIC:
 			case R_META_TYPE_HIDE:
-				snprintf (key, sizeof (key) - 1,
-						"meta.%c.0x%"PFMT64x, *info, ds->at);
-				sdb_const_get (s, key, 0);
-				mt_sz = sdb_array_get_num (s, key, 0, 0);
-				//if (mt_sz) { break; }
+				mt_sz = mi->size;
 				break;
 			}
 		}
+		r_pvector_free (metas);
 	}
 	if (ds->hint && ds->hint->bits) {
 		if (!ds->core->anal->opt.ignbithints) {
@@ -2559,7 +2554,7 @@ static int ds_disassemble(RDisasmState *ds, ut8 *buf, int len) {
 		char *ba = r_asm_op_get_asm (&ds->asmop);
 		*ba = toupper ((ut8)*ba);
 	}
-	if (info && mt_sz != UT64_MAX) {
+	if (mt_sz != UT64_MAX) {
 		ds->oplen = mt_sz;
 	}
 	return ret;
@@ -4563,20 +4558,16 @@ static void delete_last_comment(RDisasmState *ds) {
 
 static bool can_emulate_metadata(RCore * core, ut64 at) {
 	const char *emuskipmeta = r_config_get (core->config, "emu.skip");
-	char key[32];
-	Sdb *s = core->anal->sdb_meta;
-	snprintf (key, sizeof (key)-1, "meta.0x%"PFMT64x, at);
-	const char *infos = sdb_const_get (s, key, 0);
-	if (!infos) {
+	if (!r_meta_get_at (core->anal, at, R_META_TYPE_ANY)) {
 		/* no metadata: let's emulate this */
 		return true;
 	}
-	for (; *infos; infos++) {
+	for (; *emuskipmeta; emuskipmeta++) {
 		/*
 		 * don't emulate if at least one metadata type
 		 * can't be emulated
 		 */
-		if (*infos != ',' && strchr(emuskipmeta, *infos)) {
+		if (r_meta_get_at (core->anal, at, *emuskipmeta)) {
 			return false;
 		}
 	}
@@ -175,6 +175,13 @@ R_API int r_core_project_delete(RCore *core, const char *prjfile) {
 		}
 		free(notes_txt);
 
+		char *prj_bin = r_str_newf ("%s%s%s", prjDir, R_SYS_DIR, "project.r2b");
+		if (r_file_exists (prj_bin)) {
+			r_file_rm (prj_bin);
+			eprintf ("rm %s\n", prj_bin);
+		}
+		free (prj_bin);
+
 		char *rop_d = r_str_newf ("%s%s%s", prjDir, R_SYS_DIR, "rop.d");
 
 		if (r_file_is_directory (rop_d)) {
@@ -628,7 +635,8 @@ static bool simpleProjectSaveScript(RCore *core, const char *file, int opts) {
 	return true;
 }
 
-static bool projectSaveScript(RCore *core, const char *file, int opts) {
+// with bin, the R_CORE_PRJ_BIN items are left to r_core_project_save_bin
+static bool projectSaveScript(RCore *core, const char *file, int opts, bool bin) {
 	char *filename, *hl, *ohl = NULL;
 	int fd, fdold;
 
@@ -653,6 +661,7 @@ static bool projectSaveScript(RCore *core, const char *file, int opts) {
 	r_cons_singleton ()->fdout = fd;
 	r_cons_singleton ()->context->is_interactive = false;
 	r_str_write (fd, "# r2 rdb project file\n");
+	int sopts = bin? opts & ~R_CORE_PRJ_BIN: opts;
 	// Set file.path and file.lastpath to empty string to signal
 	// new behaviour to project load routine (see io maps below).
 	r_config_set (core->config, "file.path", "");
@@ -663,14 +672,14 @@ static bool projectSaveScript(RCore *core, const char *file, int opts) {
 		r_cons_flush ();
 	}
 
-	if (opts & R_CORE_PRJ_FCNS) {
+	if (sopts & R_CORE_PRJ_FCNS) {
 		r_str_write (fd, "# functions\n");
 		r_str_write (fd, "fs functions\n");
 		r_core_cmd (core, "afl*", 0);
 		r_cons_flush ();
 	}
 
-	if (opts & R_CORE_PRJ_FLAGS) {
+	if (sopts & R_CORE_PRJ_FLAGS) {
 		r_str_write (fd, "# flags\n");
 		r_flag_space_push (core->flags, NULL);
 		r_flag_list (core->flags, true, NULL);
@@ -688,16 +697,18 @@ static bool projectSaveScript(RCore *core, const char *file, int opts) {
 	}
 	if (opts & R_CORE_PRJ_META) {
 		r_str_write (fd, "# meta\n");
-		r_meta_list (core->anal, R_META_TYPE_ANY, 1);
-		r_cons_flush ();
+		if (!bin) {
+			r_meta_list (core->anal, R_META_TYPE_ANY, 1);
+			r_cons_flush ();
+		}
 		r_core_cmd (core, "fV*", 0);
 		r_cons_flush ();
 	}
-	if (opts & R_CORE_PRJ_XREFS) {
+	if (sopts & R_CORE_PRJ_XREFS) {
 		r_core_cmd (core, "ax*", 0);
 		r_cons_flush ();
 	}
-	if (opts & R_CORE_PRJ_FLAGS) {
+	if (sopts & R_CORE_PRJ_FLAGS) {
 		r_core_cmd (core, "f.**", 0);
 		r_cons_flush ();
 	}
@@ -705,11 +716,11 @@ static bool projectSaveScript(RCore *core, const char *file, int opts) {
 		r_core_cmd (core, "db*", 0);
 		r_cons_flush ();
 	}
-	if (opts & R_CORE_PRJ_ANAL_HINTS) {
+	if (sopts & R_CORE_PRJ_ANAL_HINTS) {
 		r_core_cmd (core, "ah*", 0);
 		r_cons_flush ();
 	}
-	if (opts & R_CORE_PRJ_ANAL_TYPES) {
+	if (sopts & R_CORE_PRJ_ANAL_TYPES) {
 		r_str_write (fd, "# types\n");
 		r_core_cmd (core, "t*", 0);
 		r_cons_flush ();
@@ -743,7 +754,7 @@ static bool projectSaveScript(RCore *core, const char *file, int opts) {
 
 // TODO: rename to r_core_project_save_script
 R_API bool r_core_project_save_rdb(RCore *core, const char *file, int opts) {
-	return projectSaveScript (core, file, opts);
+	return projectSaveScript (core, file, opts, false);
 }
 
 #define TRANSITION 1
@@ -821,17 +832,29 @@ R_API bool r_core_project_save(RCore *core, const char *prjName) {
 		oldPrjName = strdup (oldPrjNameC);
 	}
 	r_config_set (core->config, "prj.name", prjName);
+	char *binPath = r_str_newf ("%s" R_SYS_DIR "project.r2b", prjDir);
+	bool bin = binPath && r_config_get_i (core->config, "prj.bin") && !r_config_get_i (core->config, "prj.simple");
 	if (r_config_get_i (core->config, "prj.simple")) {
 		if (!simpleProjectSaveScript (core, scriptPath, R_CORE_PRJ_ALL)) {
 			eprintf ("Cannot open '%s' for writing\n", prjName);
 			ret = false;
 		}
 	} else {
-		if (!projectSaveScript (core, scriptPath, R_CORE_PRJ_ALL)) {
+		if (!projectSaveScript (core, scriptPath, R_CORE_PRJ_ALL, bin)) {
 			eprintf ("Cannot open '%s' for writing\n", prjName);
 			ret = false;
 		}
 	}
+	if (ret && bin) {
+		if (!r_core_project_save_bin (core, binPath, R_CORE_PRJ_BIN)) {
+			eprintf ("Cannot write '%s'\n", binPath);
+			ret = false;
+		}
+	} else if (binPath && r_file_exists (binPath)) {
+		// stale, the script has everything now
+		r_file_rm (binPath);
+	}
+	free (binPath);
 
 	if (r_config_get_i (core->config, "prj.files")) {
 		eprintf ("TODO: prj.files: support copying more than one file into the project directory\n");
@@ -908,6 +931,17 @@ R_API bool r_core_project_load(RCore *core, const char *prjName, const char *rcp
 	const bool scr_prompt = r_config_get_i (core->config, "scr.prompt");
 	(void) projectLoadRop (core, prjName);
 	bool ret = r_core_cmd_file (core, rcpath);
+	char *prjDir = r_file_dirname (rcpath);
+	char *binPath = prjDir? r_str_newf ("%s" R_SYS_DIR "project.r2b", prjDir): NULL;
+	if (binPath && r_file_exists (binPath)) {
+		// after the script, which sets up the types db and the io maps
+		if (!r_core_project_load_bin (core, binPath, R_CORE_PRJ_BIN)) {
+			eprintf ("Cannot load '%s'\n", binPath);
+			ret = false;
+		}
+	}
+	free (binPath);
+	free (prjDir);
 	r_config_set_i (core->config, "cfg.fortunes", cfg_fortunes);
 	r_config_set_i (core->config, "scr.interactive", scr_interactive);
 	r_config_set_i (core->config, "scr.prompt", scr_prompt);
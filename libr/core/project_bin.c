@@ -0,0 +1,634 @@
+/* radare - LGPL - Copyright 2020 - pancake */
+
+#include <r_core.h>
+
+/* Binary project file, saved next to the rc script. The items that are the
+ * bulk of a project (flags, functions and their basic blocks, xrefs, meta,
+ * hints, types and the function sdb with vars and labels) are stored as
+ * fixed size little endian records instead of commands, so opening a project
+ * maps the file and walks the records without parsing any command.
+ *
+ * header:  "R2PRJBIN" version:4 nsections:4
+ * table:   id:4 recsize:4 count:8 offset:8 size:8  (one per section)
+ * strings: NUL terminated strings, referenced by offset (UT32_MAX for NULL)
+ */
+
+#define PRJ_BIN_MAGIC "R2PRJBIN"
+#define PRJ_BIN_VERSION 1
+#define PRJ_BIN_HDRSIZE 16
+#define PRJ_BIN_SECSIZE 32
+#define PRJ_BIN_NOSTR UT32_MAX
+
+enum {
+	PRJ_SEC_STRS,
+	PRJ_SEC_FLAGS,
+	PRJ_SEC_FCNS,
+	PRJ_SEC_BBS,
+	PRJ_SEC_XREFS,
+	PRJ_SEC_META,
+	PRJ_SEC_HINTS,
+	PRJ_SEC_SDB,
+	PRJ_SEC_COUNT
+};
+
+// record sizes of each section, 0 for raw data
+static const ut32 prj_recsize[PRJ_SEC_COUNT] = {
+	[PRJ_SEC_FLAGS] = 44, // off:8 size:8 name realname space color comment alias demangled
+	[PRJ_SEC_FCNS] = 44, // addr:8 name cc type bits maxstack stack diff folded nbbs
+	[PRJ_SEC_BBS] = 36, // addr:8 size:8 jump:8 fail:8 diff
+	[PRJ_SEC_XREFS] = 20, // from:8 to:8 type
+	[PRJ_SEC_META] = 32, // from:8 to:8 type subtype str space
+	[PRJ_SEC_HINTS] = 24, // addr:8 type str val:8
+	[PRJ_SEC_SDB] = 16, // root ns key value
+};
+
+// hint records for the ranged arch and bits hints
+#define PRJ_HINT_ARCH 0x100
+#define PRJ_HINT_BITS 0x101
+
+// sdbs saved in PRJ_SEC_SDB
+enum {
+	PRJ_SDB_TYPES,
+	PRJ_SDB_FCNS
+};
+
+typedef struct {
+	RCore *core;
+	RBuffer *sec[PRJ_SEC_COUNT];
+	ut64 count[PRJ_SEC_COUNT];
+	HtPP *strs; // string -> offset + 1
+	ut32 root;
+	const char *ns;
+} PrjBinWriter;
+
+typedef struct {
+	const ut8 *buf;
+	ut64 count;
+} PrjBinSection;
+
+typedef struct {
+	RMmap *map;
+	const char *strs;
+	ut64 strs_size;
+	PrjBinSection sec[PRJ_SEC_COUNT];
+} PrjBinReader;
+
+static ut32 pbw_str(PrjBinWriter *w, const char *s) {
+	if (!s) {
+		return PRJ_BIN_NOSTR;
+	}
+	bool found;
+	ut64 off = (ut64)(size_t)ht_pp_find (w->strs, s, &found);
+	if (found) {
+		return (ut32)(off - 1);
+	}
+	off = r_buf_size (w->sec[PRJ_SEC_STRS]);
+	if (off >= PRJ_BIN_NOSTR) {
+		return PRJ_BIN_NOSTR;
+	}
+	r_buf_append_bytes (w->sec[PRJ_SEC_STRS], (const ut8 *)s, strlen (s) + 1);
+	ht_pp_insert (w->strs, s, (void *)(size_t)(off + 1));
+	return (ut32)off;
+}
+
+static void pbw_rec(PrjBinWriter *w, int sec, const ut8 *rec) {
+	r_buf_append_bytes (w->sec[sec], rec, prj_recsize[sec]);
+	w->count[sec]++;
+}
+
+static bool pbw_flag(RFlagItem *fi, void *user) {
+	PrjBinWriter *w = user;
+	ut8 rec[44];
+	r_write_le64 (rec, fi->offset);
+	r_write_le64 (rec + 8, fi->size);
+	r_write_le32 (rec + 16, pbw_str (w, fi->name));
+	r_write_le32 (rec + 20, pbw_str (w, fi->realname != fi->name? fi->realname: NULL));
+	r_write_le32 (rec + 24, pbw_str (w, fi->space? fi->space->name: NULL));
+	r_write_le32 (rec + 28, pbw_str (w, fi->color));
+	r_write_le32 (rec + 32, pbw_str (w, fi->comment));
+	r_write_le32 (rec + 36, pbw_str (w, fi->alias));
+	r_write_le32 (rec + 40, fi->demangled);
+	pbw_rec (w, PRJ_SEC_FLAGS, rec);
+	return true;
+}
+
+static void pbw_fcn(PrjBinWriter *w, RAnalFunction *fcn) {
+	RAnalBlock *bb;
+	RListIter *iter;
+	ut8 rec[44];
+	r_write_le64 (rec, fcn->addr);
+	r_write_le32 (rec + 8, pbw_str (w, fcn->name));
+	r_write_le32 (rec + 12, pbw_str (w, fcn->cc));
+	r_write_le32 (rec + 16, fcn->type);
+	r_write_le32 (rec + 20, fcn->bits);
+	r_write_le32 (rec + 24, fcn->maxstack);
+	r_write_le32 (rec + 28, fcn->stack);
+	r_write_le32 (rec + 32, fcn->diff? fcn->diff->type: R_ANAL_DIFF_TYPE_NULL);
+	r_write_le32 (rec + 36, fcn->folded);
+	r_write_le32 (rec + 40, r_list_length (fcn->bbs));
+	pbw_rec (w, PRJ_SEC_FCNS, rec);
+	r_list_foreach (fcn->bbs, iter, bb) {
+		ut8 brec[36];
+		r_write_le64 (brec, bb->addr);
+		r_write_le64 (brec + 8, bb->size);
+		r_write_le64 (brec + 16, bb->jump);
+		r_write_le64 (brec + 24, bb->fail);
+		r_write_le32 (brec + 32, bb->diff? bb->diff->type: R_ANAL_DIFF_TYPE_NULL);
+		pbw_rec (w, PRJ_SEC_BBS, brec);
+	}
+}
+
+static bool pbw_ref(RAnalRef *ref, void *user) {
+	PrjBinWriter *w = user;
+	ut8 rec[20];
+	r_write_le64 (rec, ref->at);
+	r_write_le64 (rec + 8, ref->addr);
+	r_write_le32 (rec + 16, ref->type);
+	pbw_rec (w, PRJ_SEC_XREFS, rec);
+	return true;
+}
+
+static void pbw_meta(PrjBinWriter *w, RAnalMetaItem *item) {
+	ut8 rec[32];
+	r_write_le64 (rec, item->from);
+	r_write_le64 (rec + 8, item->to);
+	r_write_le32 (rec + 16, item->type);
+	r_write_le32 (rec + 20, item->subtype);
+	r_write_le32 (rec + 24, pbw_str (w, item->str));
+	r_write_le32 (rec + 28, pbw_str (w, item->space? item->space->name: NULL));
+	pbw_rec (w, PRJ_SEC_META, rec);
+}
+
+/* the items starting at the same address, in the order of the meta.<addr>
+ * list, so adding them back on load lists them in the same order */
+static void pbw_meta_at(PrjBinWriter *w, RPVector *items) {
+	if (r_pvector_empty (items)) {
+		return;
+	}
+	RAnalMetaItem *first = r_pvector_at (items, 0);
+	const char *types = sdb_const_get (w->core->anal->sdb_meta, sdb_fmt ("meta.0x%"PFMT64x, first->from), 0);
+	void **it;
+	for (; types && *types; types++) {
+		r_pvector_foreach (items, it) {
+			RAnalMetaItem *item = *it;
+			if (item && item->type == *types) {
+				pbw_meta (w, item);
+				*it = NULL;
+			}
+		}
+	}
+	// the ones that are not listed, like comments
+	r_pvector_foreach (items, it) {
+		if (*it) {
+			pbw_meta (w, *it);
+		}
+	}
+	r_pvector_clear (items);
+}
+
+static void pbw_hint(PrjBinWriter *w, ut64 addr, ut32 type, const char *str, ut64 val) {
+	ut8 rec[24];
+	r_write_le64 (rec, addr);
+	r_write_le32 (rec + 8, type);
+	r_write_le32 (rec + 12, pbw_str (w, str));
+	r_write_le64 (rec + 16, val);
+	pbw_rec (w, PRJ_SEC_HINTS, rec);
+}
+
+static bool pbw_addr_hints(ut64 addr, const RVector *records, void *user) {
+	PrjBinWriter *w = user;
+	const RAnalAddrHintRecord *record;
+	r_vector_foreach (records, record) {
+		switch (record->type) {
+		case R_ANAL_ADDR_HINT_TYPE_TYPE_OFFSET:
+			pbw_hint (w, addr, record->type, record->type_offset, 0);
+			break;
+		case R_ANAL_ADDR_HINT_TYPE_SYNTAX:
+			pbw_hint (w, addr, record->type, record->syntax, 0);
+			break;
+		case R_ANAL_ADDR_HINT_TYPE_OPCODE:
+			pbw_hint (w, addr, record->type, record->opcode, 0);
+			break;
+		case R_ANAL_ADDR_HINT_TYPE_ESIL:
+			pbw_hint (w, addr, record->type, record->esil, 0);
+			break;
+		case R_ANAL_ADDR_HINT_TYPE_NWORD:
+			pbw_hint (w, addr, record->type, NULL, record->nword);
+			break;
+		case R_ANAL_ADDR_HINT_TYPE_NEW_BITS:
+			pbw_hint (w, addr, record->type, NULL, record->newbits);
+			break;
+		case R_ANAL_ADDR_HINT_TYPE_IMMBASE:
+			pbw_hint (w, addr, record->type, NULL, record->immbase);
+			break;
+		case R_ANAL_ADDR_HINT_TYPE_OPTYPE:
+			pbw_hint (w, addr, record->type, NULL, record->optype);
+			break;
+		default:
+			// every other record is a ut64 in the union
+			pbw_hint (w, addr, record->type, NULL, record->val);
+			break;
+		}
+	}
+	return true;
+}
+
+static bool pbw_arch_hint(ut64 addr, const char *arch, void *user) {
+	pbw_hint (user, addr, PRJ_HINT_ARCH, arch, 0);
+	return true;
+}
+
+static bool pbw_bits_hint(ut64 addr, int bits, void *user) {
+	pbw_hint (user, addr, PRJ_HINT_BITS, NULL, bits);
+	return true;
+}
+
+static int pbw_sdb_kv(void *user, const char *k, const char *v) {
+	PrjBinWriter *w = user;
+	ut8 rec[16];
+	r_write_le32 (rec, w->root);
+	r_write_le32 (rec + 4, pbw_str (w, w->ns));
+	r_write_le32 (rec + 8, pbw_str (w, k));
+	r_write_le32 (rec + 12, pbw_str (w, v));
+	pbw_rec (w, PRJ_SEC_SDB, rec);
+	return 1;
+}
+
+static void pbw_sdb(PrjBinWriter *w, Sdb *db, const char *path) {
+	SdbListIter *it;
+	SdbNs *ns;
+	w->ns = path;
+	sdb_foreach (db, pbw_sdb_kv, w);
+	ls_foreach (db->ns, it, ns) {
+		char *sub = *path? r_str_newf ("%s/%s", path, ns->name): strdup (ns->name);
+		if (sub) {
+			pbw_sdb (w, ns->sdb, sub);
+			free (sub);
+		}
+	}
+}
+
+static bool pbw_dump(PrjBinWriter *w, const char *file) {
+	ut8 hdr[PRJ_BIN_HDRSIZE + PRJ_SEC_COUNT * PRJ_BIN_SECSIZE];
+	ut64 off = sizeof (hdr);
+	int i;
+	memcpy (hdr, PRJ_BIN_MAGIC, 8);
+	r_write_le32 (hdr + 8, PRJ_BIN_VERSION);
+	r_write_le32 (hdr + 12, PRJ_SEC_COUNT);
+	for (i = 0; i < PRJ_SEC_COUNT; i++) {
+		ut8 *sec = hdr + PRJ_BIN_HDRSIZE + i * PRJ_BIN_SECSIZE;
+		ut64 size = r_buf_size (w->sec[i]);
+		r_write_le32 (sec, i);
+		r_write_le32 (sec + 4, prj_recsize[i]);
+		r_write_le64 (sec + 8, prj_recsize[i]? w->count[i]: size);
+		r_write_le64 (sec + 16, off);
+		r_write_le64 (sec + 24, size);
+		off += size;
+	}
+	if (!r_file_dump (file, hdr, sizeof (hdr), false)) {
+		return false;
+	}
+	for (i = 0; i < PRJ_SEC_COUNT; i++) {
+		ut64 size;
+		const ut8 *data = r_buf_data (w->sec[i], &size);
+		if (size > ST32_MAX || (size && !r_file_dump (file, data, (int)size, true))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/* write the items selected by opts (R_CORE_PRJ_FLAGS, FCNS, XREFS, META,
+ * ANAL_HINTS, ANAL_TYPES) in the binary project format */
+R_API bool r_core_project_save_bin(RCore *core, const char *file, int opts) {
+	r_return_val_if_fail (core && file, false);
+	PrjBinWriter w = { .core = core };
+	bool ret = false;
+	int i;
+
+	w.strs = ht_pp_new0 ();
+	if (!w.strs) {
+		return false;
+	}
+	for (i = 0; i < PRJ_SEC_COUNT; i++) {
+		if (!(w.sec[i] = r_buf_new ())) {
+			goto beach;
+		}
+	}
+	if (opts & R_CORE_PRJ_FLAGS) {
+		r_flag_foreach (core->flags, pbw_flag, &w);
+	}
+	if (opts & R_CORE_PRJ_FCNS) {
+		RAnalFunction *fcn;
+		RListIter *iter;
+		r_list_foreach (core->anal->fcns, iter, fcn) {
+			pbw_fcn (&w, fcn);
+		}
+		w.root = PRJ_SDB_FCNS;
+		pbw_sdb (&w, core->anal->sdb_fcns, "");
+	}
+	if (opts & R_CORE_PRJ_XREFS) {
+		r_anal_refs_foreach_in (core->anal, 0, UT64_MAX, pbw_ref, &w);
+	}
+	if (opts & R_CORE_PRJ_META) {
+		RPVector items;
+		RBIter it;
+		RAnalMetaItem *item;
+		r_pvector_init (&items, NULL);
+		r_interval_tree_foreach (&core->anal->meta, it, item) {
+			if (!r_pvector_empty (&items) && ((RAnalMetaItem *)r_pvector_at (&items, 0))->from != item->from) {
+				pbw_meta_at (&w, &items);
+			}
+			r_pvector_push (&items, item);
+		}
+		pbw_meta_at (&w, &items);
+	}
+	if (opts & R_CORE_PRJ_ANAL_HINTS) {
+		r_anal_addr_hints_foreach (core->anal, pbw_addr_hints, &w);
+		r_anal_arch_hints_foreach (core->anal, pbw_arch_hint, &w);
+		r_anal_bits_hints_foreach (core->anal, pbw_bits_hint, &w);
+	}
+	if (opts & R_CORE_PRJ_ANAL_TYPES) {
+		w.root = PRJ_SDB_TYPES;
+		pbw_sdb (&w, core->anal->sdb_types, "");
+	}
+	ret = pbw_dump (&w, file);
+beach:
+	for (i = 0; i < PRJ_SEC_COUNT; i++) {
+		r_buf_free (w.sec[i]);
+	}
+	ht_pp_free (w.strs);
+	return ret;
+}
+
+static const char *pbr_str(PrjBinReader *r, const ut8 *p) {
+	ut32 off = r_read_le32 (p);
+	return off < r->strs_size? r->strs + off: NULL;
+}
+
+static bool pbr_open(PrjBinReader *r, const char *file) {
+	int i;
+	r->map = r_file_mmap (file, false, 0);
+	if (!r->map || !r->map->buf || r->map->len < PRJ_BIN_HDRSIZE) {
+		return false;
+	}
+	const ut8 *buf = r->map->buf;
+	const ut64 len = r->map->len;
+	if (memcmp (buf, PRJ_BIN_MAGIC, 8)) {
+		eprintf ("Invalid binary project file '%s'\n", file);
+		return false;
+	}
+	ut32 version = r_read_le32 (buf + 8);
+	if (version != PRJ_BIN_VERSION) {
+		eprintf ("Unsupported binary project version %u in '%s'\n", version, file);
+		return false;
+	}
+	ut32 nsec = r_read_le32 (buf + 12);
+	if (nsec > (len - PRJ_BIN_HDRSIZE) / PRJ_BIN_SECSIZE) {
+		return false;
+	}
+	for (i = 0; i < nsec; i++) {
+		const ut8 *sec = buf + PRJ_BIN_HDRSIZE + i * PRJ_BIN_SECSIZE;
+		ut32 id = r_read_le32 (sec);
+		ut32 recsize = r_read_le32 (sec + 4);
+		ut64 count = r_read_le64 (sec + 8);
+		ut64 off = r_read_le64 (sec + 16);
+		ut64 size = r_read_le64 (sec + 24);
+		if (off > len || size > len - off) {
+			return false;
+		}
+		if (id >= PRJ_SEC_COUNT) {
+			// added by a later version, not needed to load this one
+			continue;
+		}
+		if (recsize != prj_recsize[id] || (recsize && count > size / recsize)) {
+			return false;
+		}
+		r->sec[id].buf = buf + off;
+		r->sec[id].count = recsize? count: size;
+	}
+	r->strs = (const char *)r->sec[PRJ_SEC_STRS].buf;
+	r->strs_size = r->sec[PRJ_SEC_STRS].count;
+	// every string offset below strs_size must be NUL terminated
+	return !r->strs_size || !r->strs[r->strs_size - 1];
+}
+
+static void pbr_flags(RCore *core, PrjBinReader *r) {
+	PrjBinSection *sec = &r->sec[PRJ_SEC_FLAGS];
+	RFlagBatchItem *items = R_NEWS0 (RFlagBatchItem, sec->count);
+	ut64 i;
+	if (!items) {
+		return;
+	}
+	for (i = 0; i < sec->count; i++) {
+		const ut8 *rec = sec->buf + i * prj_recsize[PRJ_SEC_FLAGS];
+		const char *space = pbr_str (r, rec + 24);
+		items[i].offset = r_read_le64 (rec);
+		items[i].size = r_read_le64 (rec + 8);
+		items[i].name = pbr_str (r, rec + 16);
+		items[i].realname = pbr_str (r, rec + 20);
+		items[i].space = space? r_spaces_add (&core->flags->spaces, space): NULL;
+		items[i].demangled = r_read_le32 (rec + 40);
+	}
+	// flags without a space are saved as such, not in the current one
+	r_flag_space_push (core->flags, NULL);
+	st64 base = core->flags->base;
+	core->flags->base = 0;
+	r_flag_set_batch (core->flags, items, (int)sec->count);
+	core->flags->base = base;
+	r_flag_space_pop (core->flags);
+	for (i = 0; i < sec->count; i++) {
+		const ut8 *rec = sec->buf + i * prj_recsize[PRJ_SEC_FLAGS];
+		RFlagItem *fi = items[i].item;
+		if (!fi) {
+			continue;
+		}
+		const char *color = pbr_str (r, rec + 28);
+		const char *comment = pbr_str (r, rec + 32);
+		const char *alias = pbr_str (r, rec + 36);
+		if (color) {
+			r_flag_item_set_color (fi, color);
+		}
+		if (comment) {
+			r_flag_item_set_comment (fi, comment);
+		}
+		if (alias) {
+			r_flag_item_set_alias (fi, alias);
+		}
+	}
+	free (items);
+}
+
+static void pbr_fcns(RCore *core, PrjBinReader *r) {
+	PrjBinSection *sec = &r->sec[PRJ_SEC_FCNS];
+	PrjBinSection *bbs = &r->sec[PRJ_SEC_BBS];
+	RAnalDiff *diff = r_anal_diff_new ();
+	ut64 i, j, bb = 0;
+	if (!diff) {
+		return;
+	}
+	for (i = 0; i < sec->count; i++) {
+		const ut8 *rec = sec->buf + i * prj_recsize[PRJ_SEC_FCNS];
+		ut64 nbbs = r_read_le32 (rec + 40);
+		diff->type = r_read_le32 (rec + 32);
+		RAnalFunction *fcn = r_anal_create_function (core->anal, pbr_str (r, rec + 8),
+			r_read_le64 (rec), r_read_le32 (rec + 16), diff);
+		if (fcn) {
+			const char *cc = pbr_str (r, rec + 12);
+			if (cc) {
+				fcn->cc = r_str_constpool_get (&core->anal->constpool, cc);
+			}
+			fcn->bits = (int)r_read_le32 (rec + 20);
+			fcn->maxstack = (int)r_read_le32 (rec + 24);
+			fcn->stack = (int)r_read_le32 (rec + 28);
+			fcn->folded = r_read_le32 (rec + 36);
+		} else {
+			eprintf ("Cannot add function at 0x%08"PFMT64x" (duplicated)\n", r_read_le64 (rec));
+		}
+		for (j = 0; j < nbbs && bb < bbs->count; j++, bb++) {
+			const ut8 *brec = bbs->buf + bb * prj_recsize[PRJ_SEC_BBS];
+			if (!fcn) {
+				continue;
+			}
+			diff->type = r_read_le32 (brec + 32);
+			r_anal_fcn_add_bb (core->anal, fcn, r_read_le64 (brec), r_read_le64 (brec + 8),
+				r_read_le64 (brec + 16), r_read_le64 (brec + 24), diff);
+		}
+	}
+	r_anal_diff_free (diff);
+}
+
+static void pbr_xrefs(RCore *core, PrjBinReader *r) {
+	PrjBinSection *sec = &r->sec[PRJ_SEC_XREFS];
+	ut64 i;
+	for (i = 0; i < sec->count; i++) {
+		const ut8 *rec = sec->buf + i * prj_recsize[PRJ_SEC_XREFS];
+		r_anal_xrefs_set (core->anal, r_read_le64 (rec), r_read_le64 (rec + 8), r_read_le32 (rec + 16));
+	}
+}
+
+static void pbr_meta(RCore *core, PrjBinReader *r) {
+	PrjBinSection *sec = &r->sec[PRJ_SEC_META];
+	RSpaces *spaces = &core->anal->meta_spaces;
+	ut64 i;
+	r_spaces_push (spaces, NULL);
+	for (i = 0; i < sec->count; i++) {
+		const ut8 *rec = sec->buf + i * prj_recsize[PRJ_SEC_META];
+		const char *name = pbr_str (r, rec + 28);
+		RSpace *cur = r_spaces_current (spaces);
+		if (!name || !cur || strcmp (cur->name, name)) {
+			r_spaces_set (spaces, name);
+		}
+		ut64 from = r_read_le64 (rec);
+		int type = r_read_le32 (rec + 16);
+		const char *str = pbr_str (r, rec + 24);
+		if (type == R_META_TYPE_COMMENT) {
+			if (str) {
+				r_meta_set_string (core->anal, type, from, str);
+			}
+		} else {
+			r_meta_add_with_subtype (core->anal, type, r_read_le32 (rec + 20),
+				from, r_read_le64 (rec + 8), str);
+		}
+	}
+	r_spaces_pop (spaces);
+}
+
+static void pbr_hints(RCore *core, PrjBinReader *r) {
+	PrjBinSection *sec = &r->sec[PRJ_SEC_HINTS];
+	RAnal *a = core->anal;
+	ut64 i;
+	for (i = 0; i < sec->count; i++) {
+		const ut8 *rec = sec->buf + i * prj_recsize[PRJ_SEC_HINTS];
+		ut64 addr = r_read_le64 (rec);
+		const char *str = pbr_str (r, rec + 12);
+		ut64 val = r_read_le64 (rec + 16);
+		switch (r_read_le32 (rec + 8)) {
+		case PRJ_HINT_ARCH: r_anal_hint_set_arch (a, addr, str); break;
+		case PRJ_HINT_BITS: r_anal_hint_set_bits (a, addr, (int)val); break;
+		case R_ANAL_ADDR_HINT_TYPE_IMMBASE: r_anal_hint_set_immbase (a, addr, (int)val); break;
+		case R_ANAL_ADDR_HINT_TYPE_JUMP: r_anal_hint_set_jump (a, addr, val); break;
+		case R_ANAL_ADDR_HINT_TYPE_FAIL: r_anal_hint_set_fail (a, addr, val); break;
+		case R_ANAL_ADDR_HINT_TYPE_STACKFRAME: r_anal_hint_set_stackframe (a, addr, val); break;
+		case R_ANAL_ADDR_HINT_TYPE_PTR: r_anal_hint_set_pointer (a, addr, val); break;
+		case R_ANAL_ADDR_HINT_TYPE_NWORD: r_anal_hint_set_nword (a, addr, (int)val); break;
+		case R_ANAL_ADDR_HINT_TYPE_RET: r_anal_hint_set_ret (a, addr, val); break;
+		case R_ANAL_ADDR_HINT_TYPE_NEW_BITS: r_anal_hint_set_newbits (a, addr, (int)val); break;
+		case R_ANAL_ADDR_HINT_TYPE_SIZE: r_anal_hint_set_size (a, addr, val); break;
+		case R_ANAL_ADDR_HINT_TYPE_SYNTAX: r_anal_hint_set_syntax (a, addr, str); break;
+		case R_ANAL_ADDR_HINT_TYPE_OPTYPE: r_anal_hint_set_type (a, addr, (int)val); break;
+		case R_ANAL_ADDR_HINT_TYPE_OPCODE: r_anal_hint_set_opcode (a, addr, str); break;
+		case R_ANAL_ADDR_HINT_TYPE_TYPE_OFFSET: r_anal_hint_set_offset (a, addr, str); break;
+		case R_ANAL_ADDR_HINT_TYPE_ESIL: r_anal_hint_set_esil (a, addr, str); break;
+		case R_ANAL_ADDR_HINT_TYPE_HIGH: r_anal_hint_set_high (a, addr); break;
+		case R_ANAL_ADDR_HINT_TYPE_VAL: r_anal_hint_set_val (a, addr, val); break;
+		}
+	}
+}
+
+static void pbr_sdb(RCore *core, PrjBinReader *r, int opts) {
+	PrjBinSection *sec = &r->sec[PRJ_SEC_SDB];
+	const char *last_ns = NULL;
+	ut32 last_root = UT32_MAX;
+	Sdb *db = NULL;
+	ut64 i;
+	for (i = 0; i < sec->count; i++) {
+		const ut8 *rec = sec->buf + i * prj_recsize[PRJ_SEC_SDB];
+		ut32 root = r_read_le32 (rec);
+		const char *ns = pbr_str (r, rec + 4);
+		const char *k = pbr_str (r, rec + 8);
+		const char *v = pbr_str (r, rec + 12);
+		if (!ns || !k) {
+			continue;
+		}
+		if (root == PRJ_SDB_TYPES && !(opts & R_CORE_PRJ_ANAL_TYPES)) {
+			continue;
+		}
+		if (root == PRJ_SDB_FCNS && !(opts & R_CORE_PRJ_FCNS)) {
+			continue;
+		}
+		// consecutive keys share the namespace string
+		if (root != last_root || ns != last_ns) {
+			Sdb *base = root == PRJ_SDB_TYPES? core->anal->sdb_types
+				: root == PRJ_SDB_FCNS? core->anal->sdb_fcns: NULL;
+			db = (base && *ns)? sdb_ns_path (base, ns, 1): base;
+			last_root = root;
+			last_ns = ns;
+		}
+		if (db) {
+			sdb_set (db, k, v, 0);
+		}
+	}
+}
+
+/* load the items selected by opts from a file written by
+ * r_core_project_save_bin. The file is mapped and the items are created
+ * straight from its records, without going through the command parser */
+R_API bool r_core_project_load_bin(RCore *core, const char *file, int opts) {
+	r_return_val_if_fail (core && file, false);
+	PrjBinReader r = {0};
+	if (!pbr_open (&r, file)) {
+		r_file_mmap_free (r.map);
+		return false;
+	}
+	if (opts & R_CORE_PRJ_ANAL_TYPES || opts & R_CORE_PRJ_FCNS) {
+		pbr_sdb (core, &r, opts);
+	}
+	if (opts & R_CORE_PRJ_FLAGS) {
+		pbr_flags (core, &r);
+	}
+	if (opts & R_CORE_PRJ_FCNS) {
+		pbr_fcns (core, &r);
+	}
+	if (opts & R_CORE_PRJ_XREFS) {
+		pbr_xrefs (core, &r);
+	}
+	if (opts & R_CORE_PRJ_META) {
+		pbr_meta (core, &r);
+	}
+	if (opts & R_CORE_PRJ_ANAL_HINTS) {
+		pbr_hints (core, &r);
+	}
+	r_file_mmap_free (r.map);
+	return true;
+}
@@ -37,7 +37,7 @@ R_API void r_debug_bp_update(RDebug *dbg) {
 	RListIter *iter;
 	r_list_foreach (dbg->bp->bps, iter, bp) {
 		if (bp->expr) {
-			bp->addr = dbg->corebind.numGet (dbg->corebind.core, bp->expr);
+			r_bp_item_set_addr (dbg->bp, bp, dbg->corebind.numGet (dbg->corebind.core, bp->expr));
 		}
 	}
 }
@@ -365,6 +365,7 @@ R_API RDebug *r_debug_new(int hard) {
 	dbg->trace_execs = 0;
 	dbg->anal = NULL;
 	dbg->snaps = r_list_newf ((RListFree)r_debug_snap_free);
+	dbg->snap_pages = ht_up_new0 ();
 	dbg->sessions = r_list_newf ((RListFree)r_debug_session_free);
 	dbg->pid = -1;
 	dbg->bpsize = 1;
@@ -414,6 +415,7 @@ R_API RDebug *r_debug_free(RDebug *dbg) {
 		free (dbg->snap_path);
 		r_list_free (dbg->snaps);
 		r_list_free (dbg->sessions);
+		ht_up_free (dbg->snap_pages);
 		r_list_free (dbg->maps);
 		r_list_free (dbg->maps_user);
 		r_list_free (dbg->threads);
@@ -1740,7 +1742,7 @@ R_API void r_debug_bp_rebase(RDebug *dbg, ut64 old_base, ut64 new_base) {
 
 	// update bp's address
 	r_list_foreach (dbg->bp->bps, iter, bp) {
-		bp->addr += diff;
+		r_bp_item_set_addr (dbg->bp, bp, bp->addr + diff);
 		bp->delta = bp->addr - dbg->bp->baddr;
 	}
 }
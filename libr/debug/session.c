@@ -249,6 +249,8 @@ R_API void r_debug_session_save(RDebug *dbg, const char *file) {
 	RSnapEntry snapentry;
 
 	ut32 i;
+	/* page hashes are not stored anymore, the records are kept for the file layout */
+	ut8 hash[128] = {0};
 	const char *path = dbg->snap_path;
 	if (!r_file_is_directory (path)) {
 		eprintf ("%s is not correct path\n", path);
@@ -275,9 +277,8 @@ R_API void r_debug_session_save(RDebug *dbg, const char *file) {
 		snapentry.perm = base->perm;
 		r_file_dump (base_file, (const ut8 *) &snapentry, sizeof (RSnapEntry), 1);
 		r_file_dump (base_file, (const ut8 *) base->data, base->size, 1);
-		/* dump all hashes */
 		for (i = 0; i < base->page_num; i++) {
-			r_file_dump (base_file, (const ut8 *) base->hashes[i], 128, 1);
+			r_file_dump (base_file, hash, sizeof (hash), 1);
 		}
 	}
 
@@ -314,7 +315,7 @@ R_API void r_debug_session_save(RDebug *dbg, const char *file) {
 			r_list_foreach (snapdiff->pages, iter3, page) {
 				r_file_dump (diff_file, (const ut8 *) &page->page_off, sizeof (ut32), 1);
 				r_file_dump (diff_file, (const ut8 *) page->data, SNAP_PAGE_SIZE, 1);
-				r_file_dump (diff_file, (const ut8 *) page->hash, 128, 1);
+				r_file_dump (diff_file, hash, sizeof (hash), 1);
 			}
 		}
 	}
@@ -367,7 +368,7 @@ R_API void r_debug_session_restore(RDebug *dbg, const char *file) {
 		base->addr = snapentry.addr;
 		base->size = snapentry.size;
 		base->addr_end = base->addr + base->size;
-		base->page_num = base->size / SNAP_PAGE_SIZE;
+		base->page_num = (base->size + SNAP_PAGE_SIZE - 1) / SNAP_PAGE_SIZE;
 		base->timestamp = snapentry.timestamp;
 		base->perm = snapentry.perm;
 		base->data = calloc (base->size, 1);
@@ -380,13 +381,11 @@ R_API void r_debug_session_restore(RDebug *dbg, const char *file) {
 			R_FREE (base);
 			break;
 		}
-		/* restore all hashes */
-		base->hashes = R_NEWS0 (ut8 *, base->page_num);
-		for (i = 0; i < base->page_num; i++) {
-			base->hashes[i] = calloc (1, 128);
-			if (fread (base->hashes[i], 128, 1, fd) != 1) {
-				break;
-			}
+		/* skip the page hashes */
+		if (fseek (fd, (long)base->page_num * 128, SEEK_CUR)) {
+			r_debug_snap_free (base);
+			base = NULL;
+			break;
 		}
 		r_list_append (dbg->snaps, base);
 	}
@@ -478,15 +477,22 @@ R_API void r_debug_session_restore(RDebug *dbg, const char *file) {
 				memcpy (snapdiff->last_changes, prev_diff->last_changes, sizeof (RPageData *) * base->page_num);
 			}
 			/* Restore pages */
-			ut32 p;
-			ut32 clust_page = R_MIN (SNAP_PAGE_SIZE, base->size);
+			ut32 p, page_off;
+			ut8 data[SNAP_PAGE_SIZE], hash[128];
 			for (p = 0; p < diffentry.pages_len; p++) {
-				page = R_NEW0 (RPageData);
-				page->data = calloc (1, clust_page);
-				(void) fread (&page->page_off, sizeof (ut32), 1, fd);
-				(void) fread (page->data, SNAP_PAGE_SIZE, 1, fd);
-				(void) fread (page->hash, 128, 1, fd);
-				snapdiff->last_changes[page->page_off] = page;
+				if (fread (&page_off, sizeof (ut32), 1, fd) != 1
+						|| fread (data, SNAP_PAGE_SIZE, 1, fd) != 1
+						|| fread (hash, sizeof (hash), 1, fd) != 1) {
+					break;
+				}
+				if (page_off >= base->page_num) {
+					continue;
+				}
+				page = r_page_data_new (dbg, snapdiff, page_off, data, SNAP_PAGE_SIZE);
+				if (!page) {
+					break;
+				}
+				snapdiff->last_changes[page_off] = page;
 				r_list_append (snapdiff->pages, page);
 			}
 			r_list_append (base->history, snapdiff);
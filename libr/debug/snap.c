@@ -2,23 +2,64 @@
 
 #include <r_debug.h>
 
+/* pages are compared byte by byte against the previous snapshot, and
+ * the dirty ones are interned by xxhash so identical contents are kept once */
+#define SNAP_READ_PAGES 256
+#define SNAP_WRITE_SIZE (256 * SNAP_PAGE_SIZE)
+
 R_API RDebugSnap *r_debug_snap_new() {
 	RDebugSnap *snap = R_NEW0 (RDebugSnap);
-	ut64 algobit = r_hash_name_to_bits ("sha256");
 	if (!snap) {
 		return NULL;
 	}
 	snap->history = r_list_newf (r_debug_diff_free);
-	snap->hash_ctx = r_hash_new (true, algobit);
 	return snap;
 }
 
+static inline int snap_page_len(RDebugSnap *snap, ut32 page_off) {
+	return R_MIN (SNAP_PAGE_SIZE, snap->size - (ut64)page_off * SNAP_PAGE_SIZE);
+}
+
+/* coalesces the writes of adjacent pages into a single io write */
+typedef struct {
+	RDebug *dbg;
+	ut64 addr;
+	ut8 *buf;
+	int len;
+} SnapWriter;
+
+static void snap_writer_flush(SnapWriter *w) {
+	if (w->len > 0) {
+		w->dbg->iob.write_at (w->dbg->iob.io, w->addr, w->buf, w->len);
+	}
+	w->len = 0;
+}
+
+static void snap_writer_add(SnapWriter *w, ut64 addr, const ut8 *data, int len) {
+	if (w->len > 0 && (addr != w->addr + w->len || w->len + len > SNAP_WRITE_SIZE)) {
+		snap_writer_flush (w);
+	}
+	if (!w->buf && !(w->buf = malloc (SNAP_WRITE_SIZE))) {
+		w->dbg->iob.write_at (w->dbg->iob.io, addr, data, len);
+		return;
+	}
+	if (!w->len) {
+		w->addr = addr;
+	}
+	memcpy (w->buf + w->len, data, len);
+	w->len += len;
+}
+
+static void snap_writer_fini(SnapWriter *w) {
+	snap_writer_flush (w);
+	R_FREE (w->buf);
+}
+
 R_API void r_debug_snap_free(void *p) {
 	RDebugSnap *snap = (RDebugSnap *) p;
 	r_list_free (snap->history);
 	free (snap->data);
 	free (snap->comment);
-	free (snap->hashes);
 	free (snap);
 }
 
@@ -99,82 +140,76 @@ R_API RDebugSnap *r_debug_snap_get(RDebug *dbg, ut64 addr) {
 	return r_debug_snap_get_map (dbg, map);
 }
 
-static void r_page_data_set(RDebug *dbg, RPageData *page) {
-	RDebugSnapDiff *diff = page->diff;
-	ut64 addr = diff->base->addr + page->page_off * SNAP_PAGE_SIZE;
-	dbg->iob.write_at (dbg->iob.io, addr, page->data, SNAP_PAGE_SIZE);
+/* last change of each page in the current memory, NULL if it's still the base */
+static RPageData **snap_latest_changes(RDebug *dbg, RDebugSnap *snap, RDebugSnapDiff **latest) {
+	RDebugMap *cur_map = r_debug_map_get (dbg, snap->addr + 1);
+	/* Save current snapshot. It is marked as a finish point of reverse execution */
+	*latest = r_debug_snap_map (dbg, cur_map);
+	if (*latest) {
+		return (*latest)->last_changes;
+	}
+	/* nothing changed since the last diff */
+	RListIter *tail = r_list_tail (snap->history);
+	return tail? ((RDebugSnapDiff *)tail->data)->last_changes: NULL;
+}
+
+static void snap_latest_free(RDebugSnap *snap, RDebugSnapDiff *latest) {
+	if (latest) {
+		r_list_pop (snap->history);
+		r_debug_diff_free (latest);
+	}
 }
 
-/* snap->history must have at least one entry */
 R_API void r_debug_diff_set(RDebug *dbg, RDebugSnapDiff *diff) {
-	RPageData *prev_page, *last_page;
 	RDebugSnap *snap = diff->base;
-	RDebugMap *cur_map = r_debug_map_get (dbg, snap->addr + 1);
 	RDebugSnapDiff *latest;
-	ut64 addr;
+	SnapWriter w = { dbg };
 	ut32 page_off;
 
-	/* Save current snapshot. It is marked as a finish point of reverse execution */
-	latest = r_debug_snap_map (dbg, cur_map);
-	if (!latest) {
+	RPageData **last_changes = snap_latest_changes (dbg, snap, &latest);
+	if (!last_changes) {
 		return;
 	}
 
 	//eprintf ("Apply diff [0x%08"PFMT64x ", 0x%08"PFMT64x "]\n", snap->addr, snap->addr_end);
 
-	/* Roll back page datas that's been changed **after** specified SnapDiff 'diff' */
-	for (addr = snap->addr; addr < snap->addr_end; addr += SNAP_PAGE_SIZE) {
-		page_off = (addr - snap->addr) / SNAP_PAGE_SIZE;
-		prev_page = diff->last_changes[page_off];
-		/* Roll back only latest page, that's been changed after prev_page */
-		if ((last_page = latest->last_changes[page_off]) && !prev_page) {
-			ut64 off = (ut64) last_page->page_off * SNAP_PAGE_SIZE;
-			/* Copy a page data of base snap to current addr. (i.e. roll back) */
-			dbg->iob.write_at (dbg->iob.io, addr, snap->data + off, SNAP_PAGE_SIZE);
-			//eprintf ("Roll back 0x%08"PFMT64x "(page: %d)\n", addr, page_off);
+	for (page_off = 0; page_off < snap->page_num; page_off++) {
+		ut64 addr = snap->addr + (ut64)page_off * SNAP_PAGE_SIZE;
+		int len = snap_page_len (snap, page_off);
+		RPageData *prev_page = diff->last_changes[page_off];
+		if (prev_page) {
+			/* Set all previous history (including specified SnapDiff 'diff') */
+			snap_writer_add (&w, addr, prev_page->data, len);
+		} else if (last_changes[page_off]) {
+			/* Roll back pages changed **after** 'diff' to the base snap */
+			snap_writer_add (&w, addr, snap->data + (ut64)page_off * SNAP_PAGE_SIZE, len);
 		}
 	}
-
-	/* Set all previous history (including specified SnapDiff 'diff')*/
-	for (addr = snap->addr; addr < snap->addr_end; addr += SNAP_PAGE_SIZE) {
-		page_off = (addr - snap->addr) / SNAP_PAGE_SIZE;
-		if ((prev_page = diff->last_changes[page_off])) {
-			r_page_data_set (dbg, prev_page);
-			//eprintf ("Update 0x%08"PFMT64x "(page: %d)\n", addr, page_off);
-		}
-	}
-	r_list_pop (snap->history);
-	r_debug_diff_free (latest);
+	snap_writer_fini (&w);
+	snap_latest_free (snap, latest);
 }
 
 /* Roll back to base snapshot */
 R_API void r_debug_diff_set_base(RDebug *dbg, RDebugSnap *base) {
-	RPageData *last_page;
-	RDebugMap *cur_map = r_debug_map_get (dbg, base->addr + 1);
 	RDebugSnapDiff *latest;
-	ut64 addr;
+	SnapWriter w = { dbg };
 	ut32 page_off;
 
-	/* Save current snapshot. It is marked as a finish point of reverse execution */
-	latest = r_debug_snap_map (dbg, cur_map);
-	if (!latest) {
+	RPageData **last_changes = snap_latest_changes (dbg, base, &latest);
+	if (!last_changes) {
 		return;
 	}
 
-	//eprintf ("Roll back to base [0x%08"PFMT64x ", 0x%08"PFMT64x "]\n", cur_map->addr, cur_map->addr_end);
+	//eprintf ("Roll back to base [0x%08"PFMT64x ", 0x%08"PFMT64x "]\n", base->addr, base->addr_end);
 
-	for (addr = base->addr; addr < base->addr_end; addr += SNAP_PAGE_SIZE) {
-		page_off = (addr - base->addr) / SNAP_PAGE_SIZE;
-		if ((last_page = latest->last_changes[page_off])) {
-			ut64 off = (ut64) last_page->page_off * SNAP_PAGE_SIZE;
-			/* Copy a page data of base snap to current addr. (i.e. roll back) */
-			dbg->iob.write_at (dbg->iob.io, addr, base->data + off, SNAP_PAGE_SIZE);
-			//eprintf ("Roll back 0x%08"PFMT64x "(page: %d)\n", addr, page_off);
+	for (page_off = 0; page_off < base->page_num; page_off++) {
+		if (last_changes[page_off]) {
+			ut64 off = (ut64)page_off * SNAP_PAGE_SIZE;
+			snap_writer_add (&w, base->addr + off, base->data + off, snap_page_len (base, page_off));
 		}
 	}
-
-	r_list_pop (base->history);
-	r_debug_diff_free (latest);
+	snap_writer_fini (&w);
+	snap_latest_free (base, latest);
 }
 
 // XXX: snap_set will be duplicated soon
@@ -199,75 +234,36 @@ R_API int r_debug_snap_set_idx(RDebug *dbg, int idx) {
 	return 1;
 }
 
-/* XXX: Just for debugging. Duplicate soon */
-#if 0
-static void print_hash(ut8 *hash, int digest_size) {
-	int i = 0;
-	for (i = 0; i < digest_size; i++) {
-		eprintf ("%02"PFMT32x, hash[i]);
-	}
-	eprintf ("\n");
-}
-#endif
-
 R_API RDebugSnapDiff *r_debug_snap_map(RDebug *dbg, RDebugMap *map) {
 	if (!dbg || !map || map->size < 1) {
 		eprintf ("Invalid map size\n");
 		return NULL;
 	}
-	ut8 *hash;
-	ut64 addr;
-	ut64 algobit = r_hash_name_to_bits ("sha256");
-	ut32 page_num = map->size / SNAP_PAGE_SIZE;
-	ut32 digest_size;
 	/* Get an existing snapshot entry */
 	RDebugSnap *snap = r_debug_snap_get_map (dbg, map);
-	if (!snap) {
-		/* Create a new one */
-		if (!(snap = r_debug_snap_new ())) {
-			return NULL;
-		}
-		snap->timestamp = sdb_now ();
-		snap->addr = map->addr;
-		snap->addr_end = map->addr_end;
-		snap->size = map->size;
-		snap->page_num = page_num;
-		snap->data = malloc (map->size);
-		snap->perm = map->perm;
-		if (!snap->data) {
-			goto error;
-		}
-		snap->hashes = R_NEWS0 (ut8 *, page_num);
-		if (!snap->hashes) {
-			free (snap->data);
-			goto error;
-		}
-		eprintf ("Reading %d byte(s) from 0x%08"PFMT64x "...\n", snap->size, snap->addr);
-		dbg->iob.read_at (dbg->iob.io, snap->addr, snap->data, snap->size);
-
-		ut32 clust_page = R_MIN (SNAP_PAGE_SIZE, snap->size);
-
-		/* Calculate all hashes of pages */
-		for (addr = snap->addr; addr < snap->addr_end; addr += SNAP_PAGE_SIZE) {
-			ut32 page_off = (addr - snap->addr) / SNAP_PAGE_SIZE;
-			digest_size = r_hash_calculate (snap->hash_ctx, algobit, &snap->data[addr - snap->addr], clust_page);
-			hash = calloc (128, 1);	// Fix hash size to 128 byte
-			memcpy (hash, snap->hash_ctx->digest, digest_size);
-			snap->hashes[page_off] = hash;
-			// eprintf ("0x%08"PFMT64x"(page: %d)...\n",addr, page_off);
-			// print_hash (hash, digest_size);
-		}
-
-		r_list_append (dbg->snaps, snap);
-		goto okay;
-	} else {
+	if (snap) {
 		/* A base snapshot have already been saved. *
 		        So we only need to save different parts. */
 		return r_debug_diff_add (dbg, snap);
 	}
-error:
-	free (snap);
-okay:
+	/* Create a new one */
+	if (!(snap = r_debug_snap_new ())) {
+		return NULL;
+	}
+	snap->timestamp = sdb_now ();
+	snap->addr = map->addr;
+	snap->addr_end = map->addr_end;
+	snap->size = map->size;
+	snap->page_num = (map->size + SNAP_PAGE_SIZE - 1) / SNAP_PAGE_SIZE;
+	snap->perm = map->perm;
+	snap->data = malloc (map->size);
+	if (!snap->data) {
+		r_debug_snap_free (snap);
+		return NULL;
+	}
+	eprintf ("Reading %d byte(s) from 0x%08"PFMT64x "...\n", snap->size, snap->addr);
+	dbg->iob.read_at (dbg->iob.io, snap->addr, snap->data, snap->size);
+	r_list_append (dbg->snaps, snap);
 	return NULL;
 }
 
@@ -313,9 +309,57 @@ R_API int r_debug_snap_comment(RDebug *dbg, int idx, const char *msg) {
 	return 1;
 }
 
+/* returns a reference to the stored page with these contents, adding it if new */
+static RDebugSnapPage *snap_page_get(RDebug *dbg, const ut8 *buf, int len) {
+	RDebugSnapPage *page = R_NEW (RDebugSnapPage);
+	if (!page) {
+		return NULL;
+	}
+	memcpy (page->data, buf, len);
+	memset (page->data + len, 0, SNAP_PAGE_SIZE - len);
+	page->hash = r_hash_xxhash (page->data, SNAP_PAGE_SIZE);
+	RDebugSnapPage *found = ht_up_find (dbg->snap_pages, page->hash, NULL);
+	if (found && !memcmp (found->data, page->data, SNAP_PAGE_SIZE)) {
+		free (page);
+		found->refs++;
+		return found;
+	}
+	page->refs = 1;
+	// a different page with the same hash keeps its slot, this one stays private
+	page->store = ht_up_insert (dbg->snap_pages, page->hash, page)? dbg->snap_pages: NULL;
+	return page;
+}
+
+static void snap_page_unref(RDebugSnapPage *page) {
+	if (--page->refs > 0) {
+		return;
+	}
+	if (page->store) {
+		ht_up_delete (page->store, page->hash);
+	}
+	free (page);
+}
+
+R_API RPageData *r_page_data_new(RDebug *dbg, RDebugSnapDiff *diff, ut32 page_off, const ut8 *buf, int len) {
+	r_return_val_if_fail (dbg && diff && buf && len <= SNAP_PAGE_SIZE, NULL);
+	RPageData *page = R_NEW0 (RPageData);
+	if (!page) {
+		return NULL;
+	}
+	page->page = snap_page_get (dbg, buf, len);
+	if (!page->page) {
+		free (page);
+		return NULL;
+	}
+	page->diff = diff;
+	page->page_off = page_off;
+	page->data = page->page->data;
+	return page;
+}
+
 R_API void r_page_data_free(void *p) {
 	RPageData *page = (RPageData *) p;
-	free (page->data);
+	snap_page_unref (page->page);
 	free (page);
 }
 
@@ -328,20 +372,21 @@ R_API void r_debug_diff_free(void *p) {
 
 R_API RDebugSnapDiff *r_debug_diff_add(RDebug *dbg, RDebugSnap *base) {
 	RDebugSnapDiff *prev_diff = NULL, *new_diff;
-	RPageData *new_page, *last_page;
-	ut64 addr;
-	int digest_size;
-	ut32 page_off;
-	ut64 algobit = r_hash_name_to_bits ("sha256");
-	ut32 clust_page = R_MIN (SNAP_PAGE_SIZE, base->size);
+	ut32 page_off, i;
 
 	new_diff = R_NEW0 (RDebugSnapDiff);
 	if (!new_diff) {
-		goto error;
+		return NULL;
 	}
 	new_diff->base = base;
 	new_diff->pages = r_list_newf (r_page_data_free);
 	new_diff->last_changes = R_NEWS0 (RPageData *, base->page_num);
+	ut8 *buf = malloc (SNAP_READ_PAGES * SNAP_PAGE_SIZE);
+	if (!new_diff->pages || !new_diff->last_changes || !buf) {
+		free (buf);
+		r_debug_diff_free (new_diff);
+		return NULL;
+	}
 	if (r_list_length (base->history)) {
 		/* Inherit last changes from previous SnapDiff */
 		RListIter *tail = r_list_tail (base->history);
@@ -351,57 +396,35 @@ R_API RDebugSnapDiff *r_debug_diff_add(RDebug *dbg, RDebugSnap *base) {
 		}
 	}
 
-	/* Compare hash of pages. */
-	for (addr = base->addr; addr < base->addr_end; addr += SNAP_PAGE_SIZE) {
-		ut8 *prev_hash, *cur_hash;
-		ut8 *buf = malloc (clust_page);
-		/* Copy current memory value to buf and calculate cur_hash from it. */
-		dbg->iob.read_at (dbg->iob.io, addr, buf, clust_page);
-		digest_size = r_hash_calculate (base->hash_ctx, algobit, buf, clust_page);
-		cur_hash = base->hash_ctx->digest;
-
-		page_off = (addr - base->addr) / SNAP_PAGE_SIZE;
-		/* Check If there is any last change for this page. */
-		if (prev_diff && (last_page = prev_diff->last_changes[page_off])) {
-			/* Use hash of last SnapDiff */
-			// eprintf ("use hash of diff\n");
-			prev_hash = last_page->hash;
-		} else {
-			/* Use hash of base snapshot */
-			// eprintf ("use hash of base\n");
-			prev_hash = base->hashes[page_off];
-		}
-		/* Memory has been changed. So add new diff entry for this addr */
-		if (memcmp (cur_hash, prev_hash, digest_size) != 0) {
-			// print_hash (cur_hash, digest_size);
-			// print_hash (prev_hash, digest_size);
-			/* Create new page diff entry, save one page and calculate hash. */
-			new_page = R_NEW0 (RPageData);
-			new_page->diff = new_diff;
-			new_page->page_off = page_off;
-			new_page->data = buf;
-			memcpy (new_page->hash, cur_hash, digest_size);
-			new_diff->last_changes[page_off] = new_page;	// Update last change to new page
+	/* Compare each page with its last saved contents, a chunk of pages per read */
+	for (page_off = 0; page_off < base->page_num; page_off += SNAP_READ_PAGES) {
+		ut32 n = R_MIN (SNAP_READ_PAGES, base->page_num - page_off);
+		ut64 off = (ut64)page_off * SNAP_PAGE_SIZE;
+		int len = R_MIN ((ut64)n * SNAP_PAGE_SIZE, base->size - off);
+		dbg->iob.read_at (dbg->iob.io, base->addr + off, buf, len);
+		for (i = 0; i < n; i++) {
+			ut32 cur = page_off + i;
+			int plen = snap_page_len (base, cur);
+			const ut8 *page = buf + (ut64)i * SNAP_PAGE_SIZE;
+			RPageData *last_page = new_diff->last_changes[cur];
+			const ut8 *prev = last_page? last_page->data: base->data + (ut64)cur * SNAP_PAGE_SIZE;
+			if (!memcmp (page, prev, plen)) {
+				continue;
+			}
+			/* Memory has been changed. So add new diff entry for this page */
+			RPageData *new_page = r_page_data_new (dbg, new_diff, cur, page, plen);
+			if (!new_page) {
+				continue;
+			}
+			new_diff->last_changes[cur] = new_page;	// Update last change to new page
 			r_list_append (new_diff->pages, new_page);
 		}
 	}
+	free (buf);
 	if (r_list_length (new_diff->pages)) {
-#if 0
-		RPageData *page;
-		RListIter *iter;
-		eprintf ("saved: 0x%08"PFMT64x "(page: ", base->addr);
-		r_list_foreach (new_diff->pages, iter, page) {
-			eprintf ("%d ", page->page_off);
-		}
-		eprintf (")\n");
-#endif
 		r_list_append (base->history, new_diff);
 		return new_diff;
-	} else {
-		r_debug_diff_free (new_diff);
-		return NULL;
 	}
-error:
-	free (new_diff);
+	r_debug_diff_free (new_diff);
 	return NULL;
 }
@@ -86,25 +86,20 @@ static RFlagsAtOffset *r_flag_get_nearest_list(RFlag *f, ut64 off, int dir) {
 	return (dir == 0 && flags && flags->off != off)? NULL: flags;
 }
 
-static void remove_offsetmap(RFlag *f, RFlagItem *item) {
-	r_return_if_fail (f && item);
+static bool remove_offsetmap(RFlag *f, RFlagItem *item) {
+	r_return_val_if_fail (f && item, false);
 	RFlagsAtOffset *flags = r_flag_get_nearest_list (f, item->offset, 0);
-	if (flags) {
-		r_list_delete_data (flags->flags, item);
+	if (flags && r_list_delete_data (flags->flags, item)) {
 		if (r_list_empty (flags->flags)) {
 			r_skiplist_delete (f->by_off, flags);
 		}
+		return true;
 	}
+	return false;
 }
 
-static RFlagsAtOffset *flags_at_offset(RFlag *f, ut64 off) {
-	RFlagsAtOffset *res = r_flag_get_nearest_list (f, off, 0);
-	if (res) {
-		return res;
-	}
-
-	// there is no existing flagsAtOffset, we create one now
-	res = R_NEW (RFlagsAtOffset);
+static RFlagsAtOffset *flags_at_offset_new(ut64 off) {
+	RFlagsAtOffset *res = R_NEW (RFlagsAtOffset);
 	if (!res) {
 		return NULL;
 	}
@@ -116,7 +111,20 @@ static RFlagsAtOffset *flags_at_offset(RFlag *f, ut64 off) {
 	}
 
 	res->off = off;
-	r_skiplist_insert (f->by_off, res);
+	return res;
+}
+
+static RFlagsAtOffset *flags_at_offset(RFlag *f, ut64 off) {
+	RFlagsAtOffset *res = r_flag_get_nearest_list (f, off, 0);
+	if (res) {
+		return res;
+	}
+
+	// there is no existing flagsAtOffset, we create one now
+	res = flags_at_offset_new (off);
+	if (res) {
+		r_skiplist_insert (f->by_off, res);
+	}
 	return res;
 }
 
@@ -749,6 +757,165 @@ err:
 	return NULL;
 }
 
+/* make room in ht_name for n more flags at once; letting the table grow on
+ * its own while inserting them rehashes everything many times */
+static void reserve_names(RFlag *f, ut32 n) {
+	HtPP *old = f->ht_name;
+	if (old->count + n <= old->size) {
+		return;
+	}
+	HtPP *ht = ht_pp_new_size (old->count + n, NULL, ht_free_flag, NULL);
+	if (!ht) {
+		return;
+	}
+	ut32 i, j;
+	for (i = 0; i < old->size; i++) {
+		HtPPBucket *bt = &old->table[i];
+		for (j = 0; j < bt->count; j++) {
+			ht_pp_insert_kv (ht, &bt->arr[j], false);
+		}
+	}
+	// the keys and the items now belong to the new table
+	old->opt.freefn = NULL;
+	ht_pp_free (old);
+	f->ht_name = ht;
+}
+
+typedef struct {
+	ut64 off;
+	int seq;
+	RFlagItem *item;
+} FlagBatchSlot;
+
+static int flag_batch_slot_cmp(const void *va, const void *vb) {
+	const FlagBatchSlot *a = va, *b = vb;
+	if (a->off != b->off) {
+		return a->off < b->off? -1: 1;
+	}
+	return a->seq - b->seq;
+}
+
+/* set many flags at once, with the same result as calling r_flag_set (and
+ * r_flag_item_set_realname, when a realname is given) on each item in order.
+ * The name table is grown once for the whole batch, names are filtered in a
+ * single scratch buffer and the new positions are linked in by_off in one
+ * ascending pass, resuming from the previous insertion point instead of
+ * looking each offset up from the head. Items
+ * sorted by offset are the fast path, the others are sorted here.
+ * The flag set for each item is stored in items[i].item (NULL on error).
+ * Returns the number of flags set, -1 on error. */
+R_API int r_flag_set_batch(RFlag *f, RFlagBatchItem *items, int n) {
+	r_return_val_if_fail (f && (items || n <= 0), -1);
+	RSpace *cur = r_flag_space_cur (f);
+	RVector *slots = r_vector_new (sizeof (FlagBatchSlot), NULL, NULL);
+	if (!slots) {
+		return -1;
+	}
+	if (n > 0) {
+		reserve_names (f, n);
+	}
+	HtUP *moved = NULL; // item -> seq of its last slot
+	char *name = NULL;
+	size_t name_size = 0;
+	int i, count = 0;
+
+	for (i = 0; i < n; i++) {
+		RFlagBatchItem *b = &items[i];
+		b->item = NULL;
+		if (R_STR_ISEMPTY (b->name)) {
+			continue;
+		}
+		size_t len = strlen (b->name) + 1;
+		if (len > name_size) {
+			char *tmp = realloc (name, len);
+			if (!tmp) {
+				continue;
+			}
+			name = tmp;
+			name_size = len;
+		}
+		memcpy (name, b->name, len);
+		r_str_trim (name);
+		r_name_filter (name, 0);
+
+		RFlagItem *item = ht_pp_find (f->ht_name, name, NULL);
+		if (!item || item->offset != b->offset) {
+			if (!item) {
+				item = R_NEW0 (RFlagItem);
+				if (!item) {
+					continue;
+				}
+				item->name = strdup (name);
+				if (!item->name || !ht_pp_insert (f->ht_name, item->name, item)) {
+					r_flag_item_free (item);
+					continue;
+				}
+				item->realname = item->name;
+			} else if (!remove_offsetmap (f, item)) {
+				// moved again in the batch, only its last slot counts.
+				// like with r_flag_set, a moved flag keeps its realname
+				if (!moved) {
+					moved = ht_up_new0 ();
+				}
+				ht_up_update (moved, (ut64)(size_t)item, (void *)(size_t)slots->len);
+			}
+			item->space = b->space? b->space: cur;
+			item->offset = b->offset + f->base;
+			FlagBatchSlot slot = { .seq = slots->len, .item = item };
+			r_vector_push (slots, &slot);
+		}
+		item->size = b->size;
+		if (b->realname) {
+			r_flag_item_set_realname (item, b->realname);
+		}
+		item->demangled = b->demangled;
+		b->item = item;
+		count++;
+	}
+	free (name);
+
+	bool sorted = true;
+	FlagBatchSlot *slot, *prev = NULL;
+	r_vector_foreach (slots, slot) {
+		slot->off = slot->item->offset;
+		if (prev && prev->off > slot->off) {
+			sorted = false;
+		}
+		prev = slot;
+	}
+	if (!sorted) {
+		qsort (slots->a, slots->len, sizeof (FlagBatchSlot), flag_batch_slot_cmp);
+	}
+	RSkipListFinger fg;
+	r_skiplist_finger_init (f->by_off, &fg);
+	RFlagsAtOffset *flags = NULL;
+	r_vector_foreach (slots, slot) {
+		bool found = false;
+		if (moved) {
+			size_t last = (size_t)ht_up_find (moved, (ut64)(size_t)slot->item, &found);
+			if (found && (int)last != slot->seq) {
+				continue;
+			}
+		}
+		if (!flags || flags->off != slot->off) {
+			RFlagsAtOffset key = { .off = slot->off };
+			RSkipListNode *node = r_skiplist_finger_find_geq (f->by_off, &fg, &key);
+			flags = node? node->data: NULL;
+			if (!flags || flags->off != slot->off) {
+				flags = flags_at_offset_new (slot->off);
+				if (!flags) {
+					continue;
+				}
+				r_skiplist_finger_insert (f->by_off, &fg, flags);
+			}
+		}
+		r_list_append (flags->flags, slot->item);
+	}
+	r_vector_free (slots);
+	ht_up_free (moved);
+	return count;
+}
+
 /* add/replace/remove the alias of a flag item */
 R_API void r_flag_item_set_alias(RFlagItem *item, const char *alias) {
 	r_return_if_fail (item);
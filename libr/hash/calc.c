@@ -1,6 +1,7 @@
 /* radare2 - LGPL - Copyright 2009-2019 pancake */
 
 #include <r_hash.h>
+#include <r_util.h>
 
 #define HANDLE_CRC_PRESET(rbits, aname) \
 	do { \
@@ -220,3 +221,138 @@ R_API int r_hash_calculate(RHash *ctx, ut64 algobit, const ut8 *buf, int len) {
 
 	return 0;
 }
+
+typedef struct {
+	RHash **ctx;
+	ut64 algobit;
+	const ut8 *buf;
+	int len;
+	RThread *th;
+	RThreadSemaphore *go;   // posted when buf holds a block to hash
+	RThreadSemaphore *done; // posted when the worker is done with it
+	bool quit;
+} HashRangeJob;
+
+static void hash_range_job(HashRangeJob *job) {
+	int i;
+	for (i = 0; i < R_HASH_NBITS; i++) {
+		const ut64 bit = 1ULL << i;
+		if (job->algobit & bit) {
+			r_hash_calculate (job->ctx[i], bit, job->buf, job->len);
+		}
+	}
+}
+
+/* the worker lives for the whole range and hashes one block per go */
+static RThreadFunctionRet hash_range_th(RThread *th) {
+	HashRangeJob *job = th->user;
+	for (;;) {
+		r_th_sem_wait (job->go);
+		if (job->quit) {
+			break;
+		}
+		hash_range_job (job);
+		r_th_sem_post (job->done);
+	}
+	return R_TH_STOP;
+}
+
+static bool hash_range_worker_new(HashRangeJob *job) {
+	job->go = r_th_sem_new (0);
+	job->done = r_th_sem_new (0);
+	if (job->go && job->done) {
+		job->th = r_th_new (hash_range_th, job, 0);
+	}
+	return job->th;
+}
+
+static void hash_range_worker_free(HashRangeJob *job) {
+	if (job->th) {
+		job->quit = true;
+		r_th_sem_post (job->go);
+		r_th_wait (job->th);
+		job->th = r_th_free (job->th);
+	}
+	r_th_sem_free (job->go);
+	r_th_sem_free (job->done);
+	job->go = job->done = NULL;
+}
+
+/* Feeds [from, to) in blocks of bsize bytes to every algorithm in algobit,
+ * ctx[i] being the context of the algorithm (1ULL << i). Each block is read
+ * once for all of them, and the next one is read while the algorithms hash
+ * the current one, spread over up to jobs threads that are started once for
+ * the whole range. */
+R_API bool r_hash_calculate_range(RHash **ctx, ut64 algobit, RHashReadAt read_at, void *user, ut64 from, ut64 to, int bsize, int jobs) {
+	r_return_val_if_fail (ctx && read_at && bsize > 0, false);
+	HashRangeJob job[R_HASH_NBITS] = {{0}};
+	int i, k, n = 0;
+	if (from >= to) {
+		return true;
+	}
+	jobs = R_MAX (1, R_MIN (jobs, R_HASH_NBITS));
+	for (i = 0; i < R_HASH_NBITS; i++) {
+		const ut64 bit = 1ULL << i;
+		if (algobit & bit) {
+			if (!ctx[i]) {
+				return false;
+			}
+			job[n % jobs].algobit |= bit;
+			n++;
+		}
+	}
+	n = R_MIN (n, jobs);
+	const ut64 size = to - from;
+	const int bs = (int)R_MIN ((ut64)bsize, size);
+	ut8 *buf[2] = { malloc (bs), (size > bs)? malloc (bs): NULL };
+	if (!buf[0] || (size > bs && !buf[1])) {
+		free (buf[0]);
+		free (buf[1]);
+		return false;
+	}
+	// a single block for a single job has nothing to overlap with
+	const bool threaded = size > bs || n > 1;
+	for (k = 0; k < n; k++) {
+		job[k].ctx = ctx;
+		if (threaded && !hash_range_worker_new (&job[k])) {
+			// this one is hashed by the caller
+			hash_range_worker_free (&job[k]);
+		}
+	}
+	ut64 at = from;
+	int cur = 0, len = bs;
+	bool ret = read_at (user, at, buf[cur], len);
+	while (ret) {
+		const ut64 next = at + len;
+		const bool more = next < to;
+		for (k = 0; k < n; k++) {
+			job[k].buf = buf[cur];
+			job[k].len = len;
+			if (job[k].th) {
+				r_th_sem_post (job[k].go);
+			} else {
+				hash_range_job (&job[k]);
+			}
+		}
+		if (more) {
+			len = (int)R_MIN ((ut64)bs, to - next);
+			ret = read_at (user, next, buf[cur ^ 1], len);
+		}
+		for (k = 0; k < n; k++) {
+			if (job[k].th) {
+				r_th_sem_wait (job[k].done);
+			}
+		}
+		if (!more) {
+			break;
+		}
+		at = next;
+		cur ^= 1;
+	}
+	for (k = 0; k < n; k++) {
+		hash_range_worker_free (&job[k]);
+	}
+	free (buf[0]);
+	free (buf[1]);
+	return ret;
+}
@@ -0,0 +1,261 @@
+/* radare2 - LGPL - Copyright 2020 - pancake */
+
+#include <r_hash.h>
+
+#define MOD_ADLER 65521
+
+void crc_init_preset (R_CRC_CTX *ctx, enum CRC_PRESETS preset);
+void crc_final (R_CRC_CTX *ctx, utcrc *r);
+
+static const struct {
+	ut64 algo;
+	enum CRC_PRESETS preset;
+} crc_algos[] = {
+	{ R_HASH_CRC8_SMBUS, CRC_PRESET_8_SMBUS },
+#if R_HAVE_CRC8_EXTRA
+	{ R_HASH_CRC8_CDMA2000, CRC_PRESET_CRC8_CDMA2000 },
+	{ R_HASH_CRC8_DARC, CRC_PRESET_CRC8_DARC },
+	{ R_HASH_CRC8_DVB_S2, CRC_PRESET_CRC8_DVB_S2 },
+	{ R_HASH_CRC8_EBU, CRC_PRESET_CRC8_EBU },
+	{ R_HASH_CRC8_ICODE, CRC_PRESET_CRC8_ICODE },
+	{ R_HASH_CRC8_ITU, CRC_PRESET_CRC8_ITU },
+	{ R_HASH_CRC8_MAXIM, CRC_PRESET_CRC8_MAXIM },
+	{ R_HASH_CRC8_ROHC, CRC_PRESET_CRC8_ROHC },
+	{ R_HASH_CRC8_WCDMA, CRC_PRESET_CRC8_WCDMA },
+#endif /* #if R_HAVE_CRC8_EXTRA */
+#if R_HAVE_CRC15_EXTRA
+	{ R_HASH_CRC15_CAN, CRC_PRESET_15_CAN },
+#endif /* #if R_HAVE_CRC15_EXTRA */
+	{ R_HASH_CRC16, CRC_PRESET_16 },
+	{ R_HASH_CRC16_HDLC, CRC_PRESET_16_HDLC },
+	{ R_HASH_CRC16_USB, CRC_PRESET_16_USB },
+	{ R_HASH_CRC16_CITT, CRC_PRESET_16_CITT },
+#if R_HAVE_CRC16_EXTRA
+	{ R_HASH_CRC16_AUG_CCITT, CRC_PRESET_CRC16_AUG_CCITT },
+	{ R_HASH_CRC16_BUYPASS, CRC_PRESET_CRC16_BUYPASS },
+	{ R_HASH_CRC16_CDMA2000, CRC_PRESET_CRC16_CDMA2000 },
+	{ R_HASH_CRC16_DDS110, CRC_PRESET_CRC16_DDS110 },
+	{ R_HASH_CRC16_DECT_R, CRC_PRESET_CRC16_DECT_R },
+	{ R_HASH_CRC16_DECT_X, CRC_PRESET_CRC16_DECT_X },
+	{ R_HASH_CRC16_DNP, CRC_PRESET_CRC16_DNP },
+	{ R_HASH_CRC16_EN13757, CRC_PRESET_CRC16_EN13757 },
+	{ R_HASH_CRC16_GENIBUS, CRC_PRESET_CRC16_GENIBUS },
+	{ R_HASH_CRC16_MAXIM, CRC_PRESET_CRC16_MAXIM },
+	{ R_HASH_CRC16_MCRF4XX, CRC_PRESET_CRC16_MCRF4XX },
+	{ R_HASH_CRC16_RIELLO, CRC_PRESET_CRC16_RIELLO },
+	{ R_HASH_CRC16_T10_DIF, CRC_PRESET_CRC16_T10_DIF },
+	{ R_HASH_CRC16_TELEDISK, CRC_PRESET_CRC16_TELEDISK },
+	{ R_HASH_CRC16_TMS37157, CRC_PRESET_CRC16_TMS37157 },
+	{ R_HASH_CRCA, CRC_PRESET_CRCA },
+	{ R_HASH_CRC16_KERMIT, CRC_PRESET_CRC16_KERMIT },
+	{ R_HASH_CRC16_MODBUS, CRC_PRESET_CRC16_MODBUS },
+	{ R_HASH_CRC16_X25, CRC_PRESET_CRC16_X25 },
+	{ R_HASH_CRC16_XMODEM, CRC_PRESET_CRC16_XMODEM },
+#endif /* #if R_HAVE_CRC16_EXTRA */
+#if R_HAVE_CRC24
+	{ R_HASH_CRC24, CRC_PRESET_24 },
+#endif /* #if R_HAVE_CRC24 */
+	{ R_HASH_CRC32, CRC_PRESET_32 },
+	{ R_HASH_CRC32C, CRC_PRESET_32C },
+	{ R_HASH_CRC32_ECMA_267, CRC_PRESET_32_ECMA_267 },
+#if R_HAVE_CRC32_EXTRA
+	{ R_HASH_CRC32_BZIP2, CRC_PRESET_CRC32_BZIP2 },
+	{ R_HASH_CRC32D, CRC_PRESET_CRC32D },
+	{ R_HASH_CRC32_MPEG2, CRC_PRESET_CRC32_MPEG2 },
+	{ R_HASH_CRC32_POSIX, CRC_PRESET_CRC32_POSIX },
+	{ R_HASH_CRC32Q, CRC_PRESET_CRC32Q },
+	{ R_HASH_CRC32_JAMCRC, CRC_PRESET_CRC32_JAMCRC },
+	{ R_HASH_CRC32_XFER, CRC_PRESET_CRC32_XFER },
+#endif /* #if R_HAVE_CRC32_EXTRA */
+#if R_HAVE_CRC64
+	{ R_HASH_CRC64, CRC_PRESET_CRC64 },
+#endif /* #if R_HAVE_CRC64 */
+#if R_HAVE_CRC64_EXTRA
+	{ R_HASH_CRC64_ECMA182, CRC_PRESET_CRC64_ECMA182 },
+	{ R_HASH_CRC64_WE, CRC_PRESET_CRC64_WE },
+	{ R_HASH_CRC64_XZ, CRC_PRESET_CRC64_XZ },
+	{ R_HASH_CRC64_ISO, CRC_PRESET_CRC64_ISO },
+#endif /* #if R_HAVE_CRC64_EXTRA */
+};
+
+static inline utcrc crc_step(RHashRoll *r, utcrc z, ut8 d) {
+	const ut32 top = r->crc.size - 8;
+	return ((z << 8) & r->mask) ^ r->tab[((z >> top) ^ r->rin[d]) & 0xff];
+}
+
+/* The CRC register is linear on the initial value and on the input, so the
+ * register of a window is the register of len zero bytes from the initial
+ * value xored with the register of the window bytes from zero. Sliding the
+ * window steps the latter with the incoming byte and cancels the outgoing one,
+ * which would have been followed by len zero bytes. */
+static bool crc_roll_init(RHashRoll *r, enum CRC_PRESETS preset) {
+	utcrc bit[8];
+	ut32 i, j;
+
+	crc_init_preset (&r->crc, preset);
+	if (r->crc.size < 8) {
+		return false;
+	}
+	r->mask = (((UTCRC_C(1) << (r->crc.size - 1)) - 1) << 1) | 1;
+	for (i = 0; i < 256; i++) {
+		utcrc crc = (utcrc)i << (r->crc.size - 8);
+		for (j = 0; j < 8; j++) {
+			crc = ((crc >> (r->crc.size - 1)) & 1? r->crc.poly: 0) ^ (crc << 1);
+		}
+		r->tab[i] = crc & r->mask;
+		ut8 d = i;
+		if (r->crc.reflect) {
+			d = 0;
+			for (j = 0; j < 8; j++) {
+				d |= ((i >> j) & 1) << (7 - j);
+			}
+		}
+		r->rin[i] = d;
+	}
+	r->zero = r->crc.crc & r->mask;
+	for (i = 0; i < r->len; i++) {
+		r->zero = crc_step (r, r->zero, 0);
+	}
+	for (j = 0; j < 8; j++) {
+		bit[j] = crc_step (r, 0, 1 << j);
+		for (i = 0; i < r->len; i++) {
+			bit[j] = crc_step (r, bit[j], 0);
+		}
+	}
+	for (i = 0; i < 256; i++) {
+		r->out[i] = 0;
+		for (j = 0; j < 8; j++) {
+			if (i & (1 << j)) {
+				r->out[i] ^= bit[j];
+			}
+		}
+	}
+	return true;
+}
+
+// returns NULL when algo can not be updated one byte at a time
+R_API RHashRoll *r_hash_roll_new(ut64 algo, ut32 len) {
+	size_t i;
+	if (!len) {
+		return NULL;
+	}
+	RHashRoll *r = R_NEW0 (RHashRoll);
+	if (!r) {
+		return NULL;
+	}
+	r->algo = algo;
+	r->len = len;
+	switch (algo) {
+	case R_HASH_ADLER32:
+	case R_HASH_FLETCHER16:
+	case R_HASH_XOR:
+		return r;
+	}
+	for (i = 0; i < R_ARRAY_SIZE (crc_algos); i++) {
+		if (crc_algos[i].algo == algo) {
+			if (crc_roll_init (r, crc_algos[i].preset)) {
+				return r;
+			}
+			break;
+		}
+	}
+	free (r);
+	return NULL;
+}
+
+R_API void r_hash_roll_free(RHashRoll *r) {
+	free (r);
+}
+
+// buf holds the first len bytes
+R_API void r_hash_roll_begin(RHashRoll *r, const ut8 *buf) {
+	ut32 i;
+	r->a = r->b = 0;
+	r->crc.crc = 0;
+	switch (r->algo) {
+	case R_HASH_ADLER32:
+		r->a = 1;
+		for (i = 0; i < r->len; i++) {
+			r->a = (r->a + buf[i]) % MOD_ADLER;
+			r->b = (r->b + r->a) % MOD_ADLER;
+		}
+		break;
+	case R_HASH_FLETCHER16:
+		for (i = 0; i < r->len; i++) {
+			r->a = (r->a + buf[i]) % 0xff;
+			r->b = (r->b + r->a) % 0xff;
+		}
+		break;
+	case R_HASH_XOR:
+		r->a = r_hash_xor (buf, r->len);
+		break;
+	default:
+		for (i = 0; i < r->len; i++) {
+			r->crc.crc = crc_step (r, r->crc.crc, buf[i]);
+		}
+		break;
+	}
+}
+
+// slides the window one byte, out is its first byte and in the following one
+R_API void r_hash_roll_next(RHashRoll *r, ut8 out, ut8 in) {
+	switch (r->algo) {
+	case R_HASH_ADLER32:
+		r->a = (r->a + MOD_ADLER - out + in) % MOD_ADLER;
+		r->b = (r->b + (MOD_ADLER - (ut64)(r->len % MOD_ADLER) * out % MOD_ADLER)
+			+ r->a + MOD_ADLER - 1) % MOD_ADLER;
+		break;
+	case R_HASH_FLETCHER16:
+		r->a = (r->a + 0xff - out + in) % 0xff;
+		r->b = (r->b + (0xff - (r->len % 0xff) * out % 0xff) + r->a) % 0xff;
+		break;
+	case R_HASH_XOR:
+		r->a ^= out ^ in;
+		break;
+	default:
+		r->crc.crc = crc_step (r, r->crc.crc, in) ^ r->out[out];
+		break;
+	}
+}
+
+// same digest layout as r_hash_calculate
+R_API int r_hash_roll_digest(RHashRoll *r, ut8 *digest) {
+	switch (r->algo) {
+	case R_HASH_ADLER32: {
+		ut32 res = (r->b << 16) | r->a;
+		memcpy (digest, &res, R_HASH_SIZE_ADLER32);
+		return R_HASH_SIZE_ADLER32;
+	}
+	case R_HASH_FLETCHER16: {
+		ut16 res = (r->b << 8) | r->a;
+		memcpy (digest, &res, R_HASH_SIZE_FLETCHER16);
+		return R_HASH_SIZE_FLETCHER16;
+	}
+	case R_HASH_XOR:
+		*digest = r->a;
+		return R_HASH_SIZE_XOR;
+	}
+	R_CRC_CTX ctx = r->crc;
+	utcrc res;
+	ctx.crc ^= r->zero;
+	crc_final (&ctx, &res);
+	int size = r_hash_size (r->algo);
+	switch (size) {
+	case 1:
+		r_write_be8 (digest, res);
+		break;
+	case 2:
+		r_write_be16 (digest, res);
+		break;
+	case 3:
+		r_write_be24 (digest, res);
+		break;
+	case 4:
+		r_write_be32 (digest, res);
+		break;
+	case 8:
+		r_write_be64 (digest, res);
+		break;
+	}
+	return size;
+}
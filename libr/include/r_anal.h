@@ -594,6 +594,24 @@ typedef enum {
 	R_ANAL_CPP_ABI_MSVC
 } RAnalCPPABI;
 
+#define R_ANAL_READ_CACHE_SLOTS 8
+#define R_ANAL_READ_CACHE_BSIZE 4096
+
+typedef struct r_anal_read_cache_slot_t {
+	ut64 addr; // aligned to the block size, UT64_MAX if unused
+	ut32 rev; // io->rev when the block was read
+	ut32 used; // last use, for the LRU eviction
+	ut8 *buf;
+} RAnalReadCacheSlot;
+
+// block-granular cache of the bytes read by the code analysis
+typedef struct r_anal_read_cache_t {
+	int bsize;
+	int nslots;
+	ut32 clock;
+	RAnalReadCacheSlot *slots;
+} RAnalReadCache;
+
 typedef struct r_anal_hint_cb_t {
 	//add more cbs as needed
 	void (*on_bits) (struct r_anal_t *a, ut64 addr, int bits, bool set);
@@ -632,19 +650,23 @@ typedef struct r_anal_t {
 	int maxreflines;
 	int trace;
 	int esil_goto_limit;
+	int esil_trace_max; // esil trace steps kept in memory, 0 for no limit
+	char *esil_trace_spill; // file receiving the esil trace steps dropped by the limit
 	int pcalign;
 	int bitshift;
 	//struct r_anal_ctx_t *ctx;
 	struct r_anal_esil_t *esil;
 	struct r_anal_plugin_t *cur;
+	void *plugin_data; // per-instance state of cur, see RAnalPlugin.data_new
 	RAnalRange *limit;
 	RList *plugins;
 	Sdb *sdb_types;
 	Sdb *sdb_fmts;
 	Sdb *sdb_meta; // TODO: Future r_meta api
+	RIntervalTree meta; // RAnalMetaItem by range, mirrors sdb_meta
 	Sdb *sdb_zigns;
-	HtUP *dict_refs;
-	HtUP *dict_xrefs;
+	struct r_anal_xrefs_t *dict_refs;
+	struct r_anal_xrefs_t *dict_xrefs;
 	bool recursive_noreturn;
 	RSpaces meta_spaces;
 	RSpaces zign_spaces;
@@ -684,6 +706,7 @@ typedef struct r_anal_t {
 	SetU *visited;
 	RStrConstPool constpool;
 	RList *leaddrs;
+	RAnalReadCache rcache;
 } RAnal;
 
 typedef enum r_anal_addr_hint_type_t {
@@ -919,6 +942,13 @@ typedef struct r_anal_ref_t {
 } RAnalRef;
 R_API const char *r_anal_ref_type_tostring(RAnalRefType t);
 
+/* references sorted by address, stored by column in fixed size pages */
+typedef struct r_anal_xrefs_t {
+	RPVector pages;
+	ut64 count; // number of references
+	ut64 nkeys; // number of distinct addresses
+} RAnalXrefs;
+
 /* represents a reference line from one address (from) to another (to) */
 typedef struct r_anal_refline_t {
 	ut64 from;
@@ -1106,9 +1136,50 @@ typedef struct r_anal_esil_callbacks_t {
 	int (*reg_write)(ESIL *esil, const char *name, ut64 val);
 } RAnalEsilCallbacks;
 
+/* a stack element pushed as a number or by the compiled code, it only
+ * becomes a string when popped with r_anal_esil_pop() */
+typedef struct r_anal_esil_slot_t {
+	ut64 num;
+	const char *str; // source word, NULL for computed numbers
+	RRegItem *item; // resolved register, valid while reg->rev is the same
+	RReg *reg;
+	ut32 rev;
+} RAnalEsilSlot;
+
+enum {
+	R_ANAL_ESIL_TRACE_REG_READ,
+	R_ANAL_ESIL_TRACE_REG_WRITE,
+	R_ANAL_ESIL_TRACE_MEM_READ,
+	R_ANAL_ESIL_TRACE_MEM_WRITE,
+};
+
+typedef struct r_anal_esil_trace_step_t {
+	ut64 addr; // address of the traced instruction
+	ut32 idx; // value of trace_idx when it was traced
+	ut32 count; // number of accesses
+	ut64 start; // first access in RAnalEsilTrace.accesses
+} RAnalEsilTraceStep;
+
+typedef struct r_anal_esil_trace_access_t {
+	ut64 addr; // memory address, or index in RAnalEsilTrace.names for registers
+	ut64 value; // register value, or offset of the memory bytes in the arena
+	ut32 size; // number of memory bytes
+	ut32 type; // R_ANAL_ESIL_TRACE_*
+} RAnalEsilTraceAccess;
+
+typedef struct r_anal_esil_trace_t {
+	RVector steps; // RAnalEsilTraceStep, sorted by idx
+	RVector accesses; // RAnalEsilTraceAccess
+	RVector arena; // ut8, memory read and written by the steps
+	RPVector names; // register names
+	HtPP *name_idx; // register name -> index in names + 1
+	HtUP *addr_steps; // instruction address -> RVector<ut32> of step idx
+} RAnalEsilTrace;
+
 typedef struct r_anal_esil_t {
 	RAnal *anal;
-	char **stack;
+	char **stack; // NULL entries are typed, see slots
+	RAnalEsilSlot *slots;
 	ut64 addrmask;
 	int stacksize;
 	int stackptr;
@@ -1143,7 +1214,7 @@ typedef struct r_anal_esil_t {
 	RAnalEsilInterrupt *intr0;
 	/* deep esil parsing fills this */
 	Sdb *stats;
-	Sdb *db_trace;
+	RAnalEsilTrace *trace;
 	int trace_idx;
 	RAnalEsilCallbacks cb;
 	RAnalReil *Reil;
@@ -1161,6 +1232,9 @@ typedef struct r_anal_esil_t {
 	void *user;
 	int stack_fd;	// ahem, let's not do this
 	RList *sessions; // <RAnalEsilSession*>
+	HtUP *code; // compiled expressions by address
+	ut32 ops_rev;
+	int parse_depth;
 } RAnalEsil;
 
 #undef ESIL
@@ -1269,6 +1343,10 @@ typedef struct r_anal_plugin_t {
 	int fileformat_type;
 	int (*init)(void *user);
 	int (*fini)(void *user);
+	// decoder state private to each RAnal instance, created when the plugin
+	// is selected with r_anal_use and accessible as anal->plugin_data
+	void *(*data_new)(RAnal *anal);
+	void (*data_free)(void *data);
 	//int (*reset_counter) (RAnal *anal, ut64 start_addr);
 	int (*archinfo)(RAnal *anal, int query);
 	ut8* (*anal_mask)(RAnal *anal, int size, const ut8 *data, ut64 at);
@@ -1489,6 +1567,18 @@ R_API RAnalEsil *r_anal_esil_new(int stacksize, int iotrap, unsigned int addrsiz
 R_API void r_anal_esil_trace(RAnalEsil *esil, RAnalOp *op);
 R_API void r_anal_esil_trace_list(RAnalEsil *esil);
 R_API void r_anal_esil_trace_show(RAnalEsil *esil, int idx);
+R_API void r_anal_esil_trace_addr(RAnalEsil *esil, ut64 addr);
+R_API RAnalEsilTrace *r_anal_esil_trace_new(void);
+R_API void r_anal_esil_trace_free(RAnalEsilTrace *trace);
+R_API void r_anal_esil_trace_reset(RAnalEsil *esil);
+R_API RAnalEsilTraceStep *r_anal_esil_trace_step(RAnalEsil *esil, int idx);
+R_API RAnalEsilTraceAccess *r_anal_esil_trace_access(RAnalEsil *esil, int idx, int type, const char *regname);
+R_API const char *r_anal_esil_trace_regname(RAnalEsil *esil, RAnalEsilTraceAccess *a);
+R_API const ut8 *r_anal_esil_trace_data(RAnalEsil *esil, RAnalEsilTraceAccess *a);
+R_API char *r_anal_esil_trace_regs(RAnalEsil *esil, int idx, int type);
+R_API Sdb *r_anal_esil_trace_sdb(RAnalEsil *esil);
+R_API bool r_anal_esil_trace_save(RAnalEsil *esil, const char *file);
+R_API bool r_anal_esil_trace_load(RAnalEsil *esil, const char *file);
 R_API bool r_anal_esil_set_pc(RAnalEsil *esil, ut64 addr);
 R_API int r_anal_esil_setup(RAnalEsil *esil, RAnal *anal, int romem, int stats, int nonull);
 R_API void r_anal_esil_free(RAnalEsil *esil);
@@ -1551,7 +1641,6 @@ R_API bool r_anal_fcn_add_bb(RAnal *anal, RAnalFunction *fcn,
 		ut64 addr, ut64 size,
 		ut64 jump, ut64 fail, R_BORROW RAnalDiff *diff);
 R_API bool r_anal_check_fcn(RAnal *anal, ut8 *buf, ut16 bufsz, ut64 addr, ut64 low, ut64 high);
-R_API void r_anal_fcn_invalidate_read_ahead_cache(void);
 R_API void r_anal_fcn_check_bp_use(RAnal *anal, RAnalFunction *fcn);
 
 
@@ -1609,6 +1698,8 @@ R_API int r_anal_xrefs_from(RAnal *anal, RList *list, const char *kind, const RA
 R_API int r_anal_xrefs_set(RAnal *anal, ut64 from, ut64 to, const RAnalRefType type);
 R_API int r_anal_xrefs_deln(RAnal *anal, ut64 from, ut64 to, const RAnalRefType type);
 R_API int r_anal_xref_del(RAnal *anal, ut64 at, ut64 addr);
+R_API bool r_anal_xrefs_foreach_in(RAnal *anal, ut64 from, ut64 to, RAnalRefCmp cb, void *user);
+R_API bool r_anal_refs_foreach_in(RAnal *anal, ut64 from, ut64 to, RAnalRefCmp cb, void *user);
 
 R_API RList* r_anal_fcn_get_vars (RAnalFunction *anal);
 R_API RList* r_anal_get_fcns (RAnal *anal);
@@ -1662,6 +1753,7 @@ R_API char *r_anal_fcn_format_sig(R_NONNULL RAnal *anal, R_NONNULL RAnalFunction
 
 /* project */
 R_API bool r_anal_xrefs_init (RAnal *anal);
+R_API void r_anal_xrefs_fini(RAnal *anal);
 
 #define R_ANAL_THRESHOLDFCN 0.7F
 #define R_ANAL_THRESHOLDBB 0.7F
@@ -1756,6 +1848,8 @@ R_API int r_meta_space_count_for(RAnal *a, const RSpace *space_name);
 R_API RList *r_meta_enumerate(RAnal *a, int type);
 R_API int r_meta_count(RAnal *m, int type, ut64 from, ut64 to);
 R_API char *r_meta_get_string(RAnal *m, int type, ut64 addr);
+R_API const RAnalMetaItem *r_meta_get_at(RAnal *a, ut64 addr, int type);
+R_API RPVector *r_meta_get_all_at(RAnal *a, ut64 addr);
 R_API char *r_meta_get_var_comment (RAnal *a, int type, ut64 idx, ut64 addr);
 R_API bool r_meta_set_string(RAnal *m, int type, ut64 addr, const char *s);
 R_API bool r_meta_set_var_comment (RAnal *a, int type, ut64 idx, ut64 addr, const char *s);
@@ -1779,6 +1873,12 @@ R_API RAnalMetaItem *r_meta_item_new(int type);
 R_API bool r_meta_deserialize_val(RAnal *a, RAnalMetaItem *it, int type, ut64 from, const char *v);
 R_API void r_meta_print(RAnal *a, RAnalMetaItem *d, int rad, PJ *pj, bool show_full);
 
+/* read cache */
+R_API bool r_anal_read_cache_setup(RAnal *anal, int nslots, int bsize);
+R_API void r_anal_read_cache_fini(RAnal *anal);
+R_API void r_anal_read_cache_invalidate(RAnal *anal);
+R_API int r_anal_read_cache_read(RAnal *anal, ut64 addr, ut8 *buf, int len);
+
 /* hints */
 
 R_API void r_anal_hint_del(RAnal *anal, ut64 addr, ut64 size); // delete all hints that are contained within the given range, if size > 1, this operation is quite heavy!
@@ -100,6 +100,7 @@ typedef struct r_asm_t {
 	ut64 pc;
 	void *user;
 	_RAsmPlugin *cur;
+	void *plugin_data; // per-instance state of cur, see RAsmPlugin.data_new
 	_RAsmPlugin *acur;
 	RList *plugins;
 	RBinBind binb;
@@ -134,6 +135,10 @@ typedef struct r_asm_plugin_t {
 	int endian;
 	bool (*init)(void *user);
 	bool (*fini)(void *user);
+	// decoder state private to each RAsm instance, created when the plugin
+	// is selected with r_asm_use and accessible as a->plugin_data
+	void *(*data_new)(RAsm *a);
+	void (*data_free)(void *data);
 	int (*disassemble)(RAsm *a, RAsmOp *op, const ut8 *buf, int len);
 	int (*assemble)(RAsm *a, RAsmOp *op, const char *buf);
 	RAsmModifyCallback modify;
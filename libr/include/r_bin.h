@@ -30,6 +30,7 @@ R_LIB_VERSION_HEADER (r_bin);
 
 #define R_BIN_SIZEOF_STRINGS 512
 #define R_BIN_MAX_ARCH 1024
+#define R_BIN_MAX_STRJOBS 64
 
 #define R_BIN_REQ_ALL       UT64_MAX
 #define R_BIN_REQ_UNK       0x000000
@@ -311,6 +312,7 @@ typedef struct r_bin_t {
 	int minstrlen;
 	int maxstrlen;
 	ut64 maxstrbuf;
+	int strjobs; // threads scanning for strings
 	int rawstr;
 	Sdb *sdb;
 	RIDStorage *ids;
@@ -83,6 +83,8 @@ typedef struct r_bp_t {
 	int nbps;
 	int nhwbps;
 	RList *bps; // list of breakpoints
+	HtUP *bps_at; // addr -> RBreakpointItem, for exact hits
+	RIntervalTree bps_in; // [addr, addr + size) -> RBreakpointItem, sorted by addr
 	RBreakpointItem **bps_idx;
 	int bps_idx_count;
 	st64 delta;
@@ -136,6 +138,8 @@ R_API int r_bp_del_index(RBreakpoint *bp, int idx);
 R_API RBreakpointItem *r_bp_get_index(RBreakpoint *bp, int idx);
 R_API int r_bp_get_index_at (RBreakpoint *bp, ut64 addr);
 R_API RBreakpointItem *r_bp_item_new (RBreakpoint *bp);
+R_API void r_bp_item_add(RBreakpoint *bp, RBreakpointItem *b);
+R_API void r_bp_item_set_addr(RBreakpoint *bp, RBreakpointItem *b, ut64 addr);
 
 R_API RBreakpointItem *r_bp_get_at (RBreakpoint *bp, ut64 addr);
 R_API RBreakpointItem *r_bp_get_in (RBreakpoint *bp, ut64 addr, int perm);
@@ -105,6 +105,17 @@ typedef struct r_cons_grep_t {
 	int icase;
 } RConsGrep;
 
+/* state of a command whose output is written while it runs (scr.stream) */
+typedef struct r_cons_stream_t {
+	RConsGrep grep; // only line-incremental filters can be streamed
+	bool grep_used;
+	bool active;
+	bool hold; // a nested filter needs the rest of the output buffered
+	int depth;
+	int lines; // matched lines so far, like RCons.lines for r_cons_grepbuf
+	bool show;
+} RConsStream;
+
 #if 0
 // TODO Might be better than using r_cons_pal_get_i
 // And have smaller RConsPrintablePalette and RConsPalette
@@ -434,6 +445,7 @@ typedef struct r_cons_context_t {
 	char *buffer;
 	int buffer_len;
 	int buffer_sz;
+	RConsStream stream;
 
 	bool breaked;
 	RStack *break_stack;
@@ -514,6 +526,7 @@ typedef struct r_cons_t {
 	int ansicon;
 #endif
 	bool flush;
+	int stream; // write the output of a running command every this many bytes (0 = off)
 	bool use_utf8; // use utf8 features
 	bool use_utf8_curvy; // use utf8 curved corners
 	bool dotted_lines;
@@ -887,6 +900,8 @@ R_API int r_cons_memcat(const char *str, int len);
 R_API void r_cons_newline(void);
 R_API void r_cons_filter(void);
 R_API void r_cons_flush(void);
+R_API bool r_cons_stream_begin(const char *grep);
+R_API bool r_cons_stream_end(void);
 R_API void r_cons_print_fps (int col);
 R_API void r_cons_last(void);
 R_API int r_cons_less_str(const char *str, const char *exitkeys);
@@ -950,6 +965,8 @@ R_API char * r_cons_grep_strip(char *cmd, const char *quotestr);
 R_API void r_cons_grep_process(char * grep);
 R_API int r_cons_grep_line(char *buf, int len); // must be static
 R_API void r_cons_grepbuf(void);
+R_API bool r_cons_grep_stream_parse(RConsGrep *grep, const char *str);
+R_API int r_cons_grep_stream(RConsStream *s, const char *buf, int len, RStrBuf *ob);
 
 R_API void r_cons_rgb(ut8 r, ut8 g, ut8 b, ut8 a);
 R_API void r_cons_rgb_fgbg(ut8 r, ut8 g, ut8 b, ut8 R, ut8 G, ut8 B);
@@ -680,6 +680,8 @@ R_API int r_core_project_cat(RCore *core, const char *name);
 R_API int r_core_project_delete(RCore *core, const char *prjfile);
 R_API int r_core_project_list(RCore *core, int mode);
 R_API bool r_core_project_save_rdb(RCore *core, const char *file, int opts);
+R_API bool r_core_project_save_bin(RCore *core, const char *file, int opts);
+R_API bool r_core_project_load_bin(RCore *core, const char *file, int opts);
 R_API bool r_core_project_save(RCore *core, const char *file);
 R_API char *r_core_project_info(RCore *core, const char *file);
 R_API char *r_core_project_notes_file (RCore *core, const char *file);
@@ -732,6 +734,9 @@ R_API void r_core_recover_vars(RCore *core, RAnalFunction *fcn, bool argonly);
 #define R_CORE_PRJ_ANAL_SEEK	0x0400
 #define R_CORE_PRJ_DBG_BREAK   0x0800
 #define R_CORE_PRJ_ALL		0xFFFF
+/* items saved in the binary project file when prj.bin is set */
+#define R_CORE_PRJ_BIN		(R_CORE_PRJ_FLAGS | R_CORE_PRJ_META | R_CORE_PRJ_XREFS | \
+	R_CORE_PRJ_FCNS | R_CORE_PRJ_ANAL_HINTS | R_CORE_PRJ_ANAL_TYPES)
 
 typedef struct r_core_bin_filter_t {
 	ut64 offset;
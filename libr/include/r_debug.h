@@ -161,12 +161,20 @@ typedef struct r_debug_desc_t {
 	ut64 off;
 } RDebugDesc;
 
+/* page contents are shared by all the snapshots that saw the same bytes */
+typedef struct r_debug_snap_page_t {
+	HtUP *store; // dbg->snap_pages if it's indexed there, NULL on hash collision
+	ut32 hash; // xxhash of data
+	int refs;
+	ut8 data[SNAP_PAGE_SIZE];
+} RDebugSnapPage;
+
 struct r_debug_snap_diff_t;
 typedef struct r_page_data_t {
 	struct r_debug_snap_diff_t *diff; // Pointing SnapDiff that has this pagedata.
 	ut32 page_off;
-	ut8 *data;
-	ut8 hash[128];
+	ut8 *data; // page->data
+	RDebugSnapPage *page;
 } RPageData;
 
 struct r_debug_snap_t;
@@ -183,8 +191,6 @@ typedef struct r_debug_snap_t {
 	ut32 size;
 	ut32 page_num;
 	ut64 timestamp;
-	RHash *hash_ctx;
-	ut8 **hashes; // Hash of each pages
 	RList *history; // <RDebugSnapDiff*>
 	int perm;
 	char *comment;
@@ -313,6 +319,7 @@ typedef struct r_debug_t {
 	RList *maps; // <RDebugMap>
 	RList *maps_user; // <RDebugMap>
 	RList *snaps; // <RDebugSnap>
+	HtUP *snap_pages; // xxhash -> RDebugSnapPage, deduplicated page contents
 	RList *sessions; // <RDebugSession>
 	Sdb *sgnls;
 	RCoreBind corebind;
@@ -588,6 +595,7 @@ R_API int r_debug_snap_set(RDebug *dbg, RDebugSnap *snap);
 /* snap diff */
 R_API void r_debug_diff_free(void *p);
 R_API RDebugSnapDiff *r_debug_diff_add(RDebug *dbg, RDebugSnap *base);
+R_API RPageData *r_page_data_new(RDebug *dbg, RDebugSnapDiff *diff, ut32 page_off, const ut8 *buf, int len);
 R_API void r_debug_diff_set(RDebug *dbg, RDebugSnapDiff *diff);
 R_API void r_debug_diff_set_base(RDebug *dbg, RDebugSnap *base);
 
@@ -48,6 +48,17 @@ typedef struct r_flag_item_t {
 	char *alias;    /* used to define a flag based on a math expression (e.g. foo + 3) */
 } RFlagItem;
 
+/* flag to set with r_flag_set_batch */
+typedef struct r_flag_batch_item_t {
+	const char *name;     /* name of the flag, filtered like in r_flag_set */
+	const char *realname; /* NULL to keep the name */
+	ut64 offset;
+	ut64 size;
+	RSpace *space;        /* NULL for the current flag space */
+	bool demangled;
+	RFlagItem *item;      /* filled with the item set, NULL on error */
+} RFlagBatchItem;
+
 typedef struct r_flag_t {
 	RSpaces spaces;   /* handle flag spaces */
 	st64 base;         /* base address for all flag items */
@@ -116,6 +127,7 @@ R_API bool r_flag_unset_off(RFlag *f, ut64 addr);
 R_API void r_flag_unset_all (RFlag *f);
 R_API RFlagItem *r_flag_set(RFlag *fo, const char *name, ut64 addr, ut32 size);
 R_API RFlagItem *r_flag_set_next(RFlag *fo, const char *name, ut64 addr, ut32 size);
+R_API int r_flag_set_batch(RFlag *f, RFlagBatchItem *items, int n);
 R_API void r_flag_item_set_alias(RFlagItem *item, const char *alias);
 R_API void r_flag_item_free (RFlagItem *item);
 R_API void r_flag_item_set_comment(RFlagItem *item, const char *comment);
@@ -186,6 +186,19 @@ typedef struct r_hash_seed_t {
 	int len;
 } RHashSeed;
 
+/* digest of a fixed size window sliding one byte at a time */
+typedef struct r_hash_roll_t {
+	ut64 algo;
+	ut32 len;
+	ut32 a, b;
+	R_CRC_CTX crc;
+	utcrc mask;
+	utcrc zero; // register after len zero bytes from the initial value
+	utcrc tab[256]; // register update for each top byte
+	utcrc out[256]; // contribution of the byte leaving the window
+	ut8 rin[256]; // reflected input bytes
+} RHashRoll;
+
 #define R_HASH_SIZE_CRC8_SMBUS 1
 #if R_HAVE_CRC8_EXTRA
 #define R_HASH_SIZE_CRC8_CDMA2000 1
@@ -477,6 +490,10 @@ enum HASH_INDICES {
 #endif /* #if R_HAVE_CRC64 */
 
 #define R_HASH_ALL ((1ULL << R_MIN(63, R_HASH_NUM_INDICES))-1)
+/* algorithms giving the same digest whatever the size of the blocks they are fed */
+#define R_HASH_STREAMING (R_HASH_MD5 | R_HASH_SHA1 | R_HASH_SHA256 | R_HASH_SHA384 | R_HASH_SHA512)
+
+typedef bool (*RHashReadAt)(void *user, ut64 addr, ut8 *buf, int len);
 
 #ifdef R_API
 /* OO */
@@ -498,6 +515,7 @@ R_API const char *r_hash_name(ut64 bit);
 R_API ut64 r_hash_name_to_bits(const char *name);
 R_API int r_hash_size(ut64 bit);
 R_API int r_hash_calculate(RHash *ctx, ut64 algobit, const ut8 *input, int len);
+R_API bool r_hash_calculate_range(RHash **ctx, ut64 algobit, RHashReadAt read_at, void *user, ut64 from, ut64 to, int bsize, int jobs);
 
 /* checksums */
 /* XXX : crc16 should use 0 as arg0 by default */
@@ -512,6 +530,13 @@ R_API ut8 r_hash_mod255(const ut8 *b, ut64 len);
 R_API ut64 r_hash_luhn(const ut8 *buf, ut64 len);
 R_API utcrc r_hash_crc_preset (const ut8 *data, ut32 size, enum CRC_PRESETS preset);
 
+/* rolling checksums */
+R_API RHashRoll *r_hash_roll_new(ut64 algo, ut32 len);
+R_API void r_hash_roll_free(RHashRoll *r);
+R_API void r_hash_roll_begin(RHashRoll *r, const ut8 *buf);
+R_API void r_hash_roll_next(RHashRoll *r, ut8 out, ut8 in);
+R_API int r_hash_roll_digest(RHashRoll *r, ut8 *digest);
+
 /* analysis */
 R_API ut8  r_hash_hamdist(const ut8 *buf, int len);
 R_API double r_hash_entropy(const ut8 *data, ut64 len);
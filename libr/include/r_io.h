@@ -88,6 +88,7 @@ typedef struct r_io_t {
 	bool cachemode; // write in cache all the read operations (EXPERIMENTAL)
 	int p_cache;
 	int debug;
+	ut32 rev; // bumped by writes, map changes and ptrace requests, so readers can drop their cached bytes
 //#warning remove debug from RIO
 	RIDPool *map_ids;
 	SdbList *maps; //from tail backwards maps with higher priority are found
@@ -95,8 +96,7 @@ typedef struct r_io_t {
 	RPVector map_skyline_shadow; // map parts that are not covered by others
 	RIDStorage *files;
 	RCache *buffer;
-	RList *cache;	//sdblist?
-	RBNode cacheTree;
+	RBTree cache; // RIOCache extents sorted by address, never overlapping
 	ut8 *write_mask;
 	int write_mask_len;
 	RIOUndo undo;
@@ -123,7 +123,7 @@ typedef struct r_io_desc_t {
 	char *uri;
 	char *name;
 	char *referer;
-	Sdb *cache;
+	HtUP *cache;
 	void *data;
 	struct r_io_plugin_t *plugin;
 	RIO *io;
@@ -204,11 +204,14 @@ typedef struct r_io_cache_t {
 	ut8 *data;
 	ut8 *odata;
 	int written;
+	RBNode _rb; // private, node in io->cache
 } RIOCache;
 
-#define R_IO_DESC_CACHE_SIZE (sizeof(ut64) * 8)
+#define R_IO_DESC_CACHE_SIZE 0x1000
+#define R_IO_DESC_CACHE_WORDS (R_IO_DESC_CACHE_SIZE / 64)
 typedef struct r_io_desc_cache_t {
-	ut64 cached;
+	ut64 addr; // paddr of the first byte of the page
+	ut64 cached[R_IO_DESC_CACHE_WORDS]; // one bit per cached byte
 	ut8 cdata[R_IO_DESC_CACHE_SIZE];
 } RIODescCache;
 
@@ -127,6 +127,7 @@ typedef struct r_reg_t {
 	int size;
 	bool is_thumb;
 	bool big_endian;
+	ut32 rev; // bumped when the items or the aliases change
 } RReg;
 
 typedef struct r_reg_flags_t {
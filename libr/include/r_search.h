@@ -41,6 +41,8 @@ typedef struct r_search_keyword_t {
 	int icase; // ignore case
 	int type;
 	ut64 last; // last hit hint
+	RRegex *regex; // compiled bin_keyword, kept across the blocks of a regexp search
+	ut64 regex_end; // end of the last regexp match
 } RSearchKeyword;
 
 typedef struct r_search_hit_t {
@@ -69,6 +71,7 @@ typedef struct r_search_t {
 	int align;
 	int (*update)(struct r_search_t *s, ut64 from, const ut8 *buf, int len);
 	RList *kws; // TODO: Use r_search_kw_new ()
+	void *kwtable; // first bytes index of kws used by the keyword search, built on demand
 	RIOBind iob;
 	char bckwrds;
 } RSearch;
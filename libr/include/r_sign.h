@@ -83,9 +83,23 @@ typedef struct r_sign_search_t {
 	void *user;
 } RSignSearch;
 
+/* zignatures of a space deserialized once, bucketed by what the matchers compare.
+ * The buckets hold positions in items so candidates keep the r_sign_foreach order */
+typedef struct r_sign_index_t {
+	RAnal *anal;
+	RPVector items;
+	HtUP *graphs; // nbbs << 32 | cc -> RVector of int
+	HtUP *addrs;
+	HtPP *bbhashes;
+	HtPP *refs; // joined by newlines
+	HtPP *vars;
+	HtPP *types;
+} RSignIndex;
+
 typedef struct r_sign_options_t {
 	double bytes_diff_threshold;
 	double graph_diff_threshold;
+	int jobs; // threads scoring the r_sign_diff candidates
 } RSignOptions;
 
 #ifdef R_API
@@ -120,6 +134,15 @@ R_API bool r_sign_match_refs(RAnal *a, RAnalFunction *fcn, RSignRefsMatchCallbac
 R_API bool r_sign_match_vars(RAnal *a, RAnalFunction *fcn, RSignRefsMatchCallback cb, void *user);
 R_API bool r_sign_match_types(RAnal *a, RAnalFunction *fcn, RSignRefsMatchCallback cb, void *user);
 
+R_API RSignIndex *r_sign_index_new(RAnal *a);
+R_API void r_sign_index_free(RSignIndex *idx);
+R_API bool r_sign_index_match_graph(RSignIndex *idx, RAnalFunction *fcn, int mincc, RSignGraphMatchCallback cb, void *user);
+R_API bool r_sign_index_match_addr(RSignIndex *idx, RAnalFunction *fcn, RSignOffsetMatchCallback cb, void *user);
+R_API bool r_sign_index_match_hash(RSignIndex *idx, RAnalFunction *fcn, RSignHashMatchCallback cb, void *user);
+R_API bool r_sign_index_match_refs(RSignIndex *idx, RAnalFunction *fcn, RSignRefsMatchCallback cb, void *user);
+R_API bool r_sign_index_match_vars(RSignIndex *idx, RAnalFunction *fcn, RSignRefsMatchCallback cb, void *user);
+R_API bool r_sign_index_match_types(RSignIndex *idx, RAnalFunction *fcn, RSignRefsMatchCallback cb, void *user);
+
 R_API bool r_sign_load(RAnal *a, const char *file);
 R_API bool r_sign_load_gz(RAnal *a, const char *filename);
 R_API char *r_sign_path(RAnal *a, const char *file);
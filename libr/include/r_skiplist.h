@@ -12,6 +12,8 @@
 
 #include <r_list.h>
 
+#define R_SKIPLIST_MAX_DEPTH 31
+
 typedef struct r_skiplist_node_t {
 	void *data;	// pointer to the value
 	struct r_skiplist_node_t **forward; // forward pointer
@@ -25,10 +27,18 @@ typedef struct r_skiplist_t {
 	RListComparator compare;
 } RSkipList;
 
+// insertion points kept between lookups of ascending elements
+typedef struct r_skiplist_finger_t {
+	RSkipListNode *update[R_SKIPLIST_MAX_DEPTH + 1];
+} RSkipListFinger;
+
 R_API RSkipList* r_skiplist_new(RListFree freefn, RListComparator comparefn);
 R_API void r_skiplist_free(RSkipList *list);
 R_API void r_skiplist_purge(RSkipList *list);
 R_API RSkipListNode* r_skiplist_insert(RSkipList* list, void* data);
+R_API void r_skiplist_finger_init(RSkipList *list, RSkipListFinger *fg);
+R_API RSkipListNode* r_skiplist_finger_find_geq(RSkipList *list, RSkipListFinger *fg, void *data);
+R_API RSkipListNode* r_skiplist_finger_insert(RSkipList *list, RSkipListFinger *fg, void *data);
 R_API bool r_skiplist_delete(RSkipList* list, void* data);
 R_API bool r_skiplist_delete_node(RSkipList *list, RSkipListNode *node);
 R_API RSkipListNode* r_skiplist_find(RSkipList* list, void* data);
@@ -60,8 +60,17 @@ typedef struct {
 	int output[2];
 #endif
 	RCoreBind coreb;
+	char *buf; // last response and the bytes read past it
+	int bufsz;
+	int buflen;
+	int bufpos; // start of the bytes not handed out yet
+	bool framed; // responses are prefixed by their le32 length instead of NUL terminated
 } R2Pipe;
 
+/* sent by r2pipe_open (NULL) when R2PIPE_FRAMED is in the environment,
+ * the server replies "ok" and prefixes the next responses by their length */
+#define R2PIPE_FRAMED_HELLO "\x01r2pipe framed"
+
 typedef struct r_socket_t {
 #ifdef _MSC_VER
 	SOCKET fd;
@@ -268,11 +277,13 @@ R_API char *rap_read(R2Pipe *rap);
 
 R_API int r2pipe_write(R2Pipe *r2pipe, const char *str);
 R_API char *r2pipe_read(R2Pipe *r2pipe);
+R_API const char *r2pipe_read_buf(R2Pipe *r2pipe, int *len);
 R_API int r2pipe_close(R2Pipe *r2pipe);
 R_API R2Pipe *r2pipe_open_corebind(RCoreBind *coreb);
 R_API R2Pipe *r2pipe_open(const char *cmd);
 R_API R2Pipe *r2pipe_open_dl(const char *file);
 R_API char *r2pipe_cmd(R2Pipe *r2pipe, const char *str);
+R_API const char *r2pipe_cmd_buf(R2Pipe *r2pipe, const char *str, int *len);
 R_API char *r2pipe_cmdf(R2Pipe *r2pipe, const char *fmt, ...);
 #endif
 
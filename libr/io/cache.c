@@ -1,16 +1,24 @@
-/* radare - LGPL - Copyright 2008-2018 - pancake */
-
-// TODO: implement a more intelligent way to store cached memory
+/* radare - LGPL - Copyright 2008-2020 - pancake */
 
 #include "r_io.h"
 
-#if 0
-#define CACHE_CONTAINER(x) container_of ((RBNode*)x, RCache, rb)
+// The write cache is a tree of non-overlapping extents sorted by address.
+// Overlapping and adjacent writes are coalesced into a single extent, so
+// reads and lookups only touch the extents covering the requested range.
+
+#define unwrap(rbnode) container_of (rbnode, RIOCache, _rb)
 
-static void _fcn_tree_calc_max_addr(RBNode *node) {
-	RIOCache *c = CACHE_CONTAINER (node);
+static int __cache_addr_cmp(const void *incoming, const RBNode *in_tree, void *user) {
+	ut64 incoming_addr = *(ut64 *)incoming;
+	const RIOCache *c = container_of (in_tree, const RIOCache, _rb);
+	if (incoming_addr < r_itv_begin (c->itv)) {
+		return -1;
+	}
+	if (incoming_addr > r_itv_begin (c->itv)) {
+		return 1;
+	}
+	return 0;
 }
-#endif // 0
 
 static void cache_item_free(RIOCache *cache) {
 	if (!cache) {
@@ -21,25 +29,74 @@ static void cache_item_free(RIOCache *cache) {
 	free (cache);
 }
 
-R_API bool r_io_cache_at(RIO *io, ut64 addr) {
+static void __cache_item_free_rb(RBNode *node, void *user) {
+	cache_item_free (unwrap (node));
+}
+
+static RIOCache *cache_item_new(ut64 addr, ut64 size, const ut8 *data, const ut8 *odata, int written) {
+	RIOCache *ch = R_NEW0 (RIOCache);
+	if (!ch) {
+		return NULL;
+	}
+	ch->itv = (RInterval){addr, size};
+	ch->data = malloc (size);
+	ch->odata = malloc (size);
+	if (!ch->data || !ch->odata) {
+		cache_item_free (ch);
+		return NULL;
+	}
+	memcpy (ch->data, data, size);
+	memcpy (ch->odata, odata, size);
+	ch->written = written;
+	return ch;
+}
+
+// Returns an iterator positioned at the first extent that ends after addr
+static RBIter cache_iter_at(RIO *io, ut64 addr) {
+	RBNode *node = r_rbtree_upper_bound (io->cache, &addr, __cache_addr_cmp, NULL);
+	if (node && r_itv_contain (unwrap (node)->itv, addr)) {
+		addr = r_itv_begin (unwrap (node)->itv);
+	}
+	return r_rbtree_lower_bound_forward (io->cache, &addr, __cache_addr_cmp, NULL);
+}
+
+// Collects all the extents overlapping itv in address order
+static void cache_collect(RIO *io, RInterval itv, RPVector *vec) {
 	RIOCache *c;
-	RListIter *iter;
-	r_list_foreach (io->cache, iter, c) {
-		if (r_itv_contain (c->itv, addr)) {
-			return true;
+	RBIter it = cache_iter_at (io, r_itv_begin (itv));
+	r_rbtree_iter_while (it, c, RIOCache, _rb) {
+		if (!r_itv_overlap (c->itv, itv)) {
+			break;
 		}
+		r_pvector_push (vec, c);
 	}
-	return false;
+}
+
+// Reads the original bytes bypassing the write cache
+static void cache_read_orig(RIO *io, ut64 addr, ut8 *buf, int len) {
+	int cached = io->cached;
+	bool cm = io->cachemode;
+	io->cached = 0;
+	io->cachemode = false;
+	r_io_read_at (io, addr, buf, len);
+	io->cachemode = cm;
+	io->cached = cached;
+}
+
+R_API bool r_io_cache_at(RIO *io, ut64 addr) {
+	RBNode *node = r_rbtree_upper_bound (io->cache, &addr, __cache_addr_cmp, NULL);
+	return node && r_itv_contain (unwrap (node)->itv, addr);
 }
 
 R_API void r_io_cache_init(RIO *io) {
-	io->cache = r_list_newf ((RListFree)cache_item_free);
+	io->cache = NULL;
 	io->buffer = r_cache_new ();
 	io->cached = 0;
 }
 
 R_API void r_io_cache_fini (RIO *io) {
-	r_list_free (io->cache);
+	io->rev++;
+	r_rbtree_free (io->cache, __cache_item_free_rb, NULL);
 	r_cache_free (io->buffer);
 	io->cache = NULL;
 	io->buffer = NULL;
@@ -47,57 +104,80 @@ R_API void r_io_cache_fini (RIO *io) {
 }
 
 R_API void r_io_cache_commit(RIO *io, ut64 from, ut64 to) {
-	RListIter *iter;
 	RIOCache *c;
 	RInterval range = (RInterval){from, to - from};
-	r_list_foreach (io->cache, iter, c) {
-		// if (from <= c->to - 1 && c->from <= to - 1) {
-		if (r_itv_overlap (c->itv, range)) {
-			int cached = io->cached;
-			io->cached = 0;
-			if (r_io_write_at (io, r_itv_begin (c->itv), c->data, r_itv_size (c->itv))) {
-				c->written = true;
-			} else {
-				eprintf ("Error writing change at 0x%08"PFMT64x"\n", r_itv_begin (c->itv));
-			}
-			io->cached = cached;
-			// break; // XXX old behavior, revisit this
+	RBIter it = cache_iter_at (io, from);
+	r_rbtree_iter_while (it, c, RIOCache, _rb) {
+		if (!r_itv_overlap (c->itv, range)) {
+			break;
 		}
+		int cached = io->cached;
+		io->cached = 0;
+		if (r_io_write_at (io, r_itv_begin (c->itv), c->data, r_itv_size (c->itv))) {
+			c->written = true;
+		} else {
+			eprintf ("Error writing change at 0x%08"PFMT64x"\n", r_itv_begin (c->itv));
+		}
+		io->cached = cached;
 	}
 }
 
 R_API void r_io_cache_reset(RIO *io, int set) {
+	io->rev++;
 	io->cached = set;
-	r_list_purge (io->cache);
+	r_rbtree_free (io->cache, __cache_item_free_rb, NULL);
+	io->cache = NULL;
 }
 
 R_API int r_io_cache_invalidate(RIO *io, ut64 from, ut64 to) {
 	int invalidated = 0;
-	RListIter *iter, *tmp;
-	RIOCache *c;
 	RInterval range = (RInterval){from, to - from};
-	r_list_foreach_prev_safe (io->cache, iter, tmp, c) {
-		if (r_itv_overlap (c->itv, range)) {
-			int cached = io->cached;
-			io->cached = 0;
-			r_io_write_at (io, r_itv_begin (c->itv), c->odata, r_itv_size (c->itv));
-			io->cached = cached;
-			c->written = false;
-			r_list_delete (io->cache, iter);
-			invalidated++;
+	RPVector hits;
+	size_t i;
+	r_pvector_init (&hits, NULL);
+	cache_collect (io, range, &hits);
+	io->rev++;
+	for (i = 0; i < r_pvector_len (&hits); i++) {
+		RIOCache *c = r_pvector_at (&hits, i);
+		const ut64 begin = r_itv_begin (c->itv);
+		const ut64 last = begin + r_itv_size (c->itv) - 1;
+		RInterval cut = r_itv_intersect (c->itv, range);
+		const ut64 cut_last = r_itv_begin (cut) + r_itv_size (cut) - 1;
+		const ut64 delta = r_itv_begin (cut) - begin;
+		int cached = io->cached;
+		io->cached = 0;
+		r_io_write_at (io, r_itv_begin (cut), c->odata + delta, r_itv_size (cut));
+		io->cached = cached;
+		// keep the parts of the extent that fall outside of the range
+		RIOCache *head = NULL, *tail = NULL;
+		if (begin < r_itv_begin (cut)) {
+			head = cache_item_new (begin, delta, c->data, c->odata, c->written);
 		}
+		if (cut_last < last) {
+			const ut64 off = cut_last + 1 - begin;
+			tail = cache_item_new (cut_last + 1, last - cut_last, c->data + off, c->odata + off, c->written);
+		}
+		r_rbtree_delete (&io->cache, (void *)&begin, __cache_addr_cmp, NULL, __cache_item_free_rb, NULL);
+		if (head) {
+			r_rbtree_insert (&io->cache, &head->itv.addr, &head->_rb, __cache_addr_cmp, NULL);
+		}
+		if (tail) {
+			r_rbtree_insert (&io->cache, &tail->itv.addr, &tail->_rb, __cache_addr_cmp, NULL);
+		}
+		invalidated++;
 	}
+	r_pvector_clear (&hits);
 	return invalidated;
 }
 
 R_API int r_io_cache_list(RIO *io, int rad) {
 	int i, j = 0;
-	RListIter *iter;
+	RBIter iter;
 	RIOCache *c;
 	if (rad == 2) {
 		io->cb_printf ("[");
 	}
-	r_list_foreach (io->cache, iter, c) {
+	r_rbtree_foreach (io->cache, iter, c, RIOCache, _rb) {
 		const int dataSize = r_itv_size (c->itv);
 		if (rad == 1) {
 			io->cb_printf ("wx ");
@@ -111,8 +191,8 @@ R_API int r_io_cache_list(RIO *io, int rad) {
 			}
 			io->cb_printf ("\n");
 		} else if (rad == 2) {
-			io->cb_printf ("{\"idx\":%"PFMT64d",\"addr\":%"PFMT64d",\"size\":%d,",
-				j, r_itv_begin (c->itv), dataSize);
+			io->cb_printf ("%s{\"idx\":%"PFMT64d",\"addr\":%"PFMT64d",\"size\":%d,",
+				j? ",": "", (ut64)j, r_itv_begin (c->itv), dataSize);
 			io->cb_printf ("\"before\":\"");
 		  	for (i = 0; i < dataSize; i++) {
 				io->cb_printf ("%02x", c->odata[i]);
@@ -121,8 +201,7 @@ R_API int r_io_cache_list(RIO *io, int rad) {
 		  	for (i = 0; i < dataSize; i++) {
 				io->cb_printf ("%02x", c->data[i]);
 			}
-			io->cb_printf ("\",\"written\":%s}%s", c->written
-				? "true": "false", iter->n? ",": "");
+			io->cb_printf ("\",\"written\":%s}", c->written? "true": "false");
 		} else if (rad == 0) {
 			io->cb_printf ("idx=%d addr=0x%08"PFMT64x" size=%d ", j, r_itv_begin (c->itv), dataSize);
 			for (i = 0; i < dataSize; i++) {
@@ -143,52 +222,125 @@ R_API int r_io_cache_list(RIO *io, int rad) {
 }
 
 R_API bool r_io_cache_write(RIO *io, ut64 addr, const ut8 *buf, int len) {
-	RIOCache *ch;
-	ch = R_NEW0 (RIOCache);
-	if (!ch) {
+	r_return_val_if_fail (io && buf, false);
+	if (len < 1) {
 		return false;
 	}
-	ch->itv = (RInterval){addr, len};
-	ch->odata = (ut8*)calloc (1, len + 1);
-	if (!ch->odata) {
-		free (ch);
-		return false;
+	io->rev++;
+	if (addr + len - 1 < addr) {
+		len = UT64_MAX - addr + 1;
 	}
-	ch->data = (ut8*)calloc (1, len + 1);
-	if (!ch->data) {
-		free (ch->odata);
-		free (ch);
-		return false;
+	const ut64 last = addr + len - 1;
+	// widen by one byte on each side to also pick the adjacent extents
+	const ut64 tfrom = addr? addr - 1: 0;
+	const ut64 tlast = last < UT64_MAX? last + 1: last;
+	RInterval touch = (RInterval){tfrom, tlast - tfrom + 1};
+	RPVector merged;
+	size_t i;
+	r_pvector_init (&merged, NULL);
+	cache_collect (io, touch, &merged);
+
+	ut64 from = addr, to = last;
+	for (i = 0; i < r_pvector_len (&merged); i++) {
+		RIOCache *c = r_pvector_at (&merged, i);
+		const ut64 b = r_itv_begin (c->itv);
+		const ut64 e = b + r_itv_size (c->itv) - 1;
+		from = R_MIN (from, b);
+		to = R_MAX (to, e);
+	}
+	const ut64 size = to - from + 1;
+
+	// extend in place the first extent when it starts at the same address,
+	// this keeps sequential patching linear and the tree key untouched
+	RIOCache *ch = NULL;
+	size_t skip = 0;
+	if (!r_pvector_empty (&merged)) {
+		RIOCache *first = r_pvector_at (&merged, 0);
+		if (r_itv_begin (first->itv) == from) {
+			ut8 *data = realloc (first->data, size);
+			if (!data) {
+				r_pvector_clear (&merged);
+				return false;
+			}
+			first->data = data;
+			ut8 *odata = realloc (first->odata, size);
+			if (!odata) {
+				r_pvector_clear (&merged);
+				return false;
+			}
+			first->odata = odata;
+			ch = first;
+			skip = 1;
+		}
+	}
+	if (!ch) {
+		ch = R_NEW0 (RIOCache);
+		if (!ch) {
+			r_pvector_clear (&merged);
+			return false;
+		}
+		ch->data = malloc (size);
+		ch->odata = malloc (size);
+		if (!ch->data || !ch->odata) {
+			cache_item_free (ch);
+			r_pvector_clear (&merged);
+			return false;
+		}
+	}
+
+	// the original bytes of the holes between extents come from io,
+	// everything else is moved from the shadowed extents
+	ut64 cur = from;
+	for (i = 0; i < r_pvector_len (&merged); i++) {
+		RIOCache *c = r_pvector_at (&merged, i);
+		const ut64 b = r_itv_begin (c->itv);
+		const ut64 csize = r_itv_size (c->itv);
+		if (b > cur) {
+			cache_read_orig (io, cur, ch->odata + (cur - from), b - cur);
+		}
+		if (i >= skip) {
+			memcpy (ch->odata + (b - from), c->odata, csize);
+			memcpy (ch->data + (b - from), c->data, csize);
+		}
+		cur = R_MAX (cur, b + csize);
 	}
+	if (cur <= to && cur >= from) {
+		cache_read_orig (io, cur, ch->odata + (cur - from), to - cur + 1);
+	}
+	memcpy (ch->data + (addr - from), buf, len);
+
+	for (i = skip; i < r_pvector_len (&merged); i++) {
+		RIOCache *c = r_pvector_at (&merged, i);
+		ut64 b = r_itv_begin (c->itv);
+		r_rbtree_delete (&io->cache, &b, __cache_addr_cmp, NULL, __cache_item_free_rb, NULL);
+	}
+	ch->itv = (RInterval){from, size};
 	ch->written = false;
-	{
-		bool cm = io->cachemode;
-		io->cachemode = false;
-		r_io_read_at (io, addr, ch->odata, len);
-		io->cachemode = cm;
-	}
-	memcpy (ch->data, buf, len);
-	r_list_append (io->cache, ch);
+	if (!skip) {
+		r_rbtree_insert (&io->cache, &ch->itv.addr, &ch->_rb, __cache_addr_cmp, NULL);
+	}
+	r_pvector_clear (&merged);
 	return true;
 }
 
 R_API bool r_io_cache_read(RIO *io, ut64 addr, ut8 *buf, int len) {
 	bool covered = false;
-	RListIter *iter;
 	RIOCache *c;
 	RInterval range = (RInterval){ addr, len };
-	r_list_foreach (io->cache, iter, c) {
-		if (r_itv_overlap (c->itv, range)) {
-			const ut64 begin = r_itv_begin (c->itv);
-			if (addr < begin) {
-				int l = R_MIN (addr + len - begin, r_itv_size (c->itv));
-				memcpy (buf + begin - addr, c->data, l);
-			} else {
-				int l = R_MIN (r_itv_end (c->itv) - addr, len);
-				memcpy (buf, c->data + addr - begin, l);
-			}
-			covered = true;
+	RBIter it = cache_iter_at (io, addr);
+	r_rbtree_iter_while (it, c, RIOCache, _rb) {
+		if (!r_itv_overlap (c->itv, range)) {
+			break;
+		}
+		const ut64 begin = r_itv_begin (c->itv);
+		if (addr < begin) {
+			int l = R_MIN (addr + len - begin, r_itv_size (c->itv));
+			memcpy (buf + begin - addr, c->data, l);
+		} else {
+			int l = R_MIN (r_itv_end (c->itv) - addr, len);
+			memcpy (buf, c->data + addr - begin, l);
 		}
+		covered = true;
 	}
 	return covered;
 }
@@ -136,6 +136,7 @@ R_API bool r_io_desc_close(RIODesc *desc) {
 		return false;
 	}
 	io = desc->io;
+	io->rev++;
 	// remove entry from idstorage and free the desc-struct
 	r_io_desc_del (io, desc->fd);
 	// remove all dead maps
@@ -149,6 +150,9 @@ R_API int r_io_desc_write(RIODesc *desc, const ut8* buf, int len) {
 	if (len < 0) {
 		return -1;
 	}
+	if (desc->io) {
+		desc->io->rev++;
+	}
 	//check pointers and pcache
 	if (desc->io && (desc->io->p_cache & 2)) {
 		return r_io_desc_cache_write (desc,
@@ -198,6 +202,9 @@ R_API ut64 r_io_desc_size(RIODesc* desc) {
 
 R_API bool r_io_desc_resize(RIODesc *desc, ut64 newsize) {
 	if (desc && desc->plugin && desc->plugin->resize) {
+		if (desc->io) {
+			desc->io->rev++;
+		}
 		bool ret = desc->plugin->resize (desc->io, desc, newsize);
 		if (desc->io && desc->io->p_cache) {
 			r_io_desc_cache_cleanup (desc);
@@ -233,7 +240,7 @@ R_API bool r_io_desc_exchange(RIO* io, int fd, int fdx) {
 	r_id_storage_set (io->files, desc,  fdx);
 	r_id_storage_set (io->files, descx, fd);
 	if (io->p_cache) {
-		Sdb* cache = desc->cache;
+		HtUP *cache = desc->cache;
 		desc->cache = descx->cache;
 		descx->cache = cache;
 		r_io_desc_cache_cleanup (desc);
@@ -615,7 +615,51 @@ static ptrace_wrap_instance *io_ptrace_wrap_instance(RIO *io) {
 }
 #endif
 
+/* register and siginfo reads happen at every step, only resuming or
+ * writing the traced process can change what a read returns */
+static bool ptrace_changes_tracee(r_ptrace_request_t request) {
+#if __linux__
+	switch ((int)request) {
+	case PTRACE_CONT:
+	case PTRACE_SINGLESTEP:
+	case PTRACE_SYSCALL:
+#ifdef PT_SYSEMU
+	case PTRACE_SYSEMU:
+	case PTRACE_SYSEMU_SINGLESTEP:
+#endif
+	case PTRACE_POKETEXT:
+	case PTRACE_POKEDATA:
+	case PTRACE_POKEUSER:
+#ifdef PT_SETREGS
+	case PTRACE_SETREGS:
+#endif
+#ifdef PT_SETFPREGS
+	case PTRACE_SETFPREGS:
+#endif
+#ifdef PTRACE_SETREGSET
+	case PTRACE_SETREGSET:
+#endif
+	case PTRACE_SETSIGINFO:
+	case PTRACE_KILL:
+	case PTRACE_ATTACH:
+	case PTRACE_DETACH:
+#ifdef PTRACE_SEIZE
+	case PTRACE_SEIZE:
+	case PTRACE_INTERRUPT:
+	case PTRACE_LISTEN:
+#endif
+		return true;
+	}
+	return false;
+#else
+	return true;
+#endif
+}
+
 R_API long r_io_ptrace(RIO *io, r_ptrace_request_t request, pid_t pid, void *addr, r_ptrace_data_t data) {
+	if (ptrace_changes_tracee (request)) {
+		io->rev++;
+	}
 #if USE_PTRACE_WRAP
 	ptrace_wrap_instance *wrap = io_ptrace_wrap_instance (io);
 	if (!wrap) {
@@ -666,7 +710,7 @@ R_API int r_io_fini(RIO* io) {
 	r_io_desc_fini (io);
 	r_io_map_fini (io);
 	ls_free (io->plugins);
-	r_list_free (io->cache);
+	r_io_cache_reset (io, io->cached);
 	r_list_free (io->undo.w_list);
 	if (io->runprofile) {
 		R_FREE (io->runprofile);
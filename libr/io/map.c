@@ -78,6 +78,7 @@ void io_map_calculate_skyline(RIO *io) {
 	RBinHeap heap;
 	struct map_event_t *ev;
 	bool *deleted = NULL;
+	io->rev++;
 	r_pvector_clear (&io->map_skyline);
 	r_pvector_clear (&io->map_skyline_shadow);
 	r_pvector_init (&events, free);
@@ -13,30 +13,53 @@
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <errno.h>
+#if __linux__
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#endif
+
+#define PTRACE_PAGE_SIZE 0x1000
+#define PTRACE_CACHE_PAGES 64
+
+typedef struct {
+	ut64 addr; // UT64_MAX when empty
+	ut8 buf[PTRACE_PAGE_SIZE];
+} RIOPtracePage;
 
 typedef struct {
 	int pid;
 	int tid;
 	int fd;
 	int opid;
+	bool vm_rw; // process_vm_readv works for this pid
+	ut32 cache_rev; // io->rev the cached pages were read at
+	RIOPtracePage *cache; // direct mapped, only used by small reads
 } RIOPtrace;
 #define RIOPTRACE_OPID(x) (((RIOPtrace*)(x)->data)->opid)
 #define RIOPTRACE_PID(x) (((RIOPtrace*)(x)->data)->pid)
 #define RIOPTRACE_FD(x) (((RIOPtrace*)(x)->data)->fd)
 static void open_pidmem (RIOPtrace *iop);
 
+static void close_pidmem(RIOPtrace *iop) {
+	if (iop->fd != -1) {
+		close (iop->fd);
+		iop->fd = -1;
+	}
+}
+
 #undef R_IO_NFDS
 #define R_IO_NFDS 2
 #ifndef __ANDROID__
 extern int errno;
 #endif
 
-#if 0
-procpidmem is buggy.. running this sometimes results in ffff
-
-	while : ; do r2 -qc 'oo;x' -d ls ; done
-#endif
+/* memory is read with process_vm_readv, then pread on a persistent
+ * /proc/pid/mem fd, and PTRACE_PEEKTEXT as the last resort */
+#if __linux__
+#define USE_PROC_PID_MEM 1
+#else
 #define USE_PROC_PID_MEM 0
+#endif
 
 static int __waitpid(int pid) {
 	int st = 0;
@@ -70,43 +93,125 @@ static int debug_os_read_at(RIO *io, int pid, ut32 *buf, int sz, ut64 addr) {
 	return sz;
 }
 
-static int __read(RIO *io, RIODesc *desc, ut8 *buf, int len) {
+/* returns the bytes read until the first unreadable page, or -1 if
+ * there's no fast path and ptrace has to be used */
+static int pidmem_read(RIOPtrace *iop, ut64 addr, ut8 *buf, int len) {
+#if __linux__ && defined(SYS_process_vm_readv)
+	if (iop->vm_rw) {
+		struct iovec local = { buf, len };
+		struct iovec remote = { (void *)(size_t)addr, len };
+		long ret = syscall (SYS_process_vm_readv, iop->pid, &local, 1, &remote, 1, 0);
+		if (ret >= 0) {
+			return ret;
+		}
+		if (errno == EFAULT || errno == EIO) {
+			return 0;
+		}
+		iop->vm_rw = false;
+	}
+#endif
 #if USE_PROC_PID_MEM
-	int ret, fd;
+	// a 32bit off_t can't address all the memory
+	if (iop->fd != -1 && (sizeof (off_t) == 8 || addr + len <= ST32_MAX)) {
+		ssize_t ret = pread (iop->fd, buf, len, addr);
+		return ret > 0? ret: 0;
+	}
 #endif
+	return -1;
+}
+
+static int pidmem_read_at(RIOPtrace *iop, ut64 addr, ut8 *buf, int len) {
+	int done = 0;
+	while (done < len) {
+		int ret = pidmem_read (iop, addr + done, buf + done, len - done);
+		if (ret < 0) {
+			return done? done: -1;
+		}
+		if (!ret) {
+			// skip the unreadable page, leaving it filled with 0xff
+			ut64 at = addr + done;
+			ret = R_MIN (len - done, PTRACE_PAGE_SIZE - (at & (PTRACE_PAGE_SIZE - 1)));
+		}
+		done += ret;
+	}
+	return len;
+}
+
+static void cache_flush(RIOPtrace *iop) {
+	if (iop->cache) {
+		int i;
+		for (i = 0; i < PTRACE_CACHE_PAGES; i++) {
+			iop->cache[i].addr = UT64_MAX;
+		}
+	}
+}
+
+/* small reads (disasm, analysis) tend to hit the same pages over and over,
+ * keep them around until the process runs again or is written, which bumps
+ * io->rev */
+static bool cache_read_at(RIO *io, RIOPtrace *iop, ut64 addr, ut8 *buf, int len) {
+	if (!iop->cache) {
+		iop->cache = R_NEWS (RIOPtracePage, PTRACE_CACHE_PAGES);
+		if (!iop->cache) {
+			return false;
+		}
+		cache_flush (iop);
+		iop->cache_rev = io->rev;
+	}
+	if (iop->cache_rev != io->rev) {
+		cache_flush (iop);
+		iop->cache_rev = io->rev;
+	}
+	while (len > 0) {
+		ut64 page = addr & ~(ut64)(PTRACE_PAGE_SIZE - 1);
+		int delta = addr - page;
+		int n = R_MIN (len, PTRACE_PAGE_SIZE - delta);
+		RIOPtracePage *p = &iop->cache[(page / PTRACE_PAGE_SIZE) % PTRACE_CACHE_PAGES];
+		if (p->addr != page) {
+			// only whole readable pages get cached
+			if (pidmem_read (iop, page, p->buf, PTRACE_PAGE_SIZE) != PTRACE_PAGE_SIZE) {
+				p->addr = UT64_MAX;
+				return false;
+			}
+			p->addr = page;
+		}
+		memcpy (buf, p->buf + delta, n);
+		buf += n;
+		addr += n;
+		len -= n;
+	}
+	return true;
+}
+
+static int __read(RIO *io, RIODesc *desc, ut8 *buf, int len) {
 	ut64 addr = io->off;
 	if (!desc || !desc->data) {
 		return -1;
 	}
+	RIOPtrace *iop = desc->data;
 	memset (buf, '\xff', len); // TODO: only memset the non-readed bytes
 	/* reopen procpidmem if necessary */
-#if USE_PROC_PID_MEM
-	fd = RIOPTRACE_FD (desc);
-	if (RIOPTRACE_PID (desc) != RIOPTRACE_OPID (desc)) {
-		if (fd != -1) {
-			close (fd);
-		}
-		open_pidmem ((RIOPtrace*)desc->data);
-		fd = RIOPTRACE_FD (desc);
-		RIOPTRACE_OPID(desc) = RIOPTRACE_PID(desc);
+	if (iop->pid != iop->opid) {
+		close_pidmem (iop);
+		open_pidmem (iop);
+		iop->opid = iop->pid;
 	}
-	// /proc/pid/mem fails on latest linux
-	if (fd != -1) {
-		ret = lseek (fd, addr, SEEK_SET);
-		if (ret >=0) {
-			// Workaround for the buggy Debian Wheeze's /proc/pid/mem
-			if (read (fd, buf, len) != -1) {
-				return ret;
-			}
-		}
+	if (len <= PTRACE_PAGE_SIZE && cache_read_at (io, iop, addr, buf, len)) {
+		return len;
 	}
-#endif
-	ut32 *aligned_buf = (ut32*)r_malloc_aligned (len, sizeof (ut32));
+	int done = pidmem_read_at (iop, addr, buf, len);
+	if (done == len) {
+		return len;
+	}
+	if (done < 0) {
+		done = 0;
+	}
+	ut32 *aligned_buf = (ut32*)r_malloc_aligned (len - done, sizeof (ut32));
 	if (aligned_buf) {
-		int res = debug_os_read_at (io, RIOPTRACE_PID (desc), (ut32*)aligned_buf, len, addr);
-		memcpy (buf, aligned_buf, len);
+		int res = debug_os_read_at (io, iop->pid, (ut32*)aligned_buf, len - done, addr + done);
+		memcpy (buf + done, aligned_buf, len - done);
 		r_free_aligned (aligned_buf);
-		return res;
+		return res < 0? res: len;
 	}
 	return -1;
 }
@@ -140,10 +245,22 @@ static int __write(RIO *io, RIODesc *fd, const ut8 *buf, int len) {
 	if (!fd || !fd->data) {
 		return -1;
 	}
-	return ptrace_write_at (io, RIOPTRACE_PID (fd), buf, len, io->off);
+	RIOPtrace *iop = fd->data;
+	cache_flush (iop);
+#if USE_PROC_PID_MEM
+	// process_vm_writev can't write to read-only pages (breakpoints), /proc/pid/mem can
+	if (iop->fd != -1 && iop->pid == iop->opid && (sizeof (off_t) == 8 || io->off + len <= ST32_MAX)) {
+		if (pwrite (iop->fd, buf, len, io->off) == len) {
+			return len;
+		}
+	}
+#endif
+	return ptrace_write_at (io, iop->pid, buf, len, io->off);
 }
 
 static void open_pidmem (RIOPtrace *iop) {
+	iop->vm_rw = true;
+	cache_flush (iop);
 #if USE_PROC_PID_MEM
 	char pidmem[32];
 	snprintf (pidmem, sizeof (pidmem), "/proc/%d/mem", iop->pid);
@@ -161,12 +278,6 @@ static void open_pidmem (RIOPtrace *iop) {
 #endif
 }
 
-static void close_pidmem(RIOPtrace *iop) {
-	if (iop->fd != -1) {
-		close (iop->fd);
-		iop->fd = -1;
-	}
-}
 
 static bool __plugin_open(RIO *io, const char *file, bool many) {
 	if (!strncmp (file, "ptrace://", 9)) {
@@ -241,7 +352,7 @@ static RIODesc *__open(RIO *io, const char *file, int rw, int mode) {
 		return NULL;
 	}
 
-	riop->pid = riop->tid = pid;
+	riop->pid = riop->tid = riop->opid = pid;
 	open_pidmem (riop);
 	desc = r_io_desc_new (io, &r_io_plugin_ptrace, file, rw | R_PERM_X, mode, riop);
 	desc->name = r_sys_pid_to_path (pid);
@@ -276,6 +387,7 @@ static int __close(RIODesc *desc) {
 	RIOPtrace *riop = desc->data;
 	desc->data = NULL;
 	long ret = r_io_ptrace (desc->io, PTRACE_DETACH, pid, 0, 0);
+	free (riop->cache);
 	free (riop);
 	return ret;
 }
@@ -290,14 +402,17 @@ static char *__system(RIO *io, RIODesc *fd, const char *cmd) {
 	if (!strcmp (cmd, "help")) {
 		eprintf ("Usage: =!cmd args\n"
 			" =!ptrace   - use ptrace io\n"
-			" =!mem      - use /proc/pid/mem io if possible\n"
+			" =!mem      - use process_vm_readv or /proc/pid/mem io if possible\n"
 			" =!pid      - show targeted pid\n"
 			" =!pid <#>  - select new pid\n");
 	} else
 	if (!strcmp (cmd, "ptrace")) {
 		close_pidmem (iop);
+		iop->vm_rw = false;
+		cache_flush (iop);
 	} else
 	if (!strcmp (cmd, "mem")) {
+		close_pidmem (iop);
 		open_pidmem (iop);
 	} else
 	if (!strncmp (cmd, "pid", 3)) {
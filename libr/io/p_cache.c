@@ -1,86 +1,155 @@
-/* radare2 - LGPL - Copyright 2017-2018 - condret, alvaro */
+/* radare2 - LGPL - Copyright 2017-2020 - condret, alvaro */
 
 #include <r_io.h>
 #include <r_types.h>
 #include <string.h>
 
-const ut64 cleanup_masks[] = {
-	0x0000000000000001,
-	0x0000000000000003,
-	0x0000000000000007,
-	0x000000000000000f,
-	0x000000000000001f,
-	0x000000000000003f,
-	0x000000000000007f,
-	0x00000000000000ff,
-	0x00000000000001ff,
-	0x00000000000003ff,
-	0x00000000000007ff,
-	0x0000000000000fff,
-	0x0000000000001fff,
-	0x0000000000003fff,
-	0x0000000000007fff,
-	0x000000000000ffff,
-	0x000000000001ffff,
-	0x000000000003ffff,
-	0x000000000007ffff,
-	0x00000000000fffff,
-	0x00000000001fffff,
-	0x00000000003fffff,
-	0x00000000007fffff,
-	0x0000000000ffffff,
-	0x0000000001ffffff,
-	0x0000000003ffffff,
-	0x0000000007ffffff,
-	0x000000000fffffff,
-	0x000000001fffffff,
-	0x000000003fffffff,
-	0x000000007fffffff,
-	0x00000000ffffffff,
-	0x00000001ffffffff,
-	0x00000003ffffffff,
-	0x00000007ffffffff,
-	0x0000000fffffffff,
-	0x0000001fffffffff,
-	0x0000003fffffffff,
-	0x0000007fffffffff,
-	0x000000ffffffffff,
-	0x000001ffffffffff,
-	0x000003ffffffffff,
-	0x000007ffffffffff,
-	0x00000fffffffffff,
-	0x00001fffffffffff,
-	0x00003fffffffffff,
-	0x00007fffffffffff,
-	0x0000ffffffffffff,
-	0x0001ffffffffffff,
-	0x0003ffffffffffff,
-	0x0007ffffffffffff,
-	0x000fffffffffffff,
-	0x001fffffffffffff,
-	0x003fffffffffffff,
-	0x007fffffffffffff,
-	0x00ffffffffffffff,
-	0x01ffffffffffffff,
-	0x03ffffffffffffff,
-	0x07ffffffffffffff,
-	0x0fffffffffffffff,
-	0x1fffffffffffffff,
-	0x3fffffffffffffff,
-	0x7fffffffffffffff
-};
+// The desc cache is a page table: an HtUP maps the page index to a fixed
+// size RIODescCache page, with one validity bit per cached byte.
+
+typedef bool (*RIODescCacheRunCb)(void *user, ut64 paddr, const ut8 *buf, int len);
+
+static void __desc_cache_free_kv(HtUPKv *kv) {
+	free (kv->value);
+}
+
+static inline ut64 __word_mask(int n) {
+	return (n >= 64)? UT64_MAX: ((1ULL << n) - 1);
+}
+
+// marks the bytes [from, to) of the page as cached
+static void __page_mark(RIODescCache *page, int from, int to) {
+	while (from < to) {
+		const int bit = from % 64;
+		const int n = R_MIN (64 - bit, to - from);
+		page->cached[from / 64] |= __word_mask (n) << bit;
+		from += n;
+	}
+}
+
+static void __page_unmark(RIODescCache *page, int from, int to) {
+	while (from < to) {
+		const int bit = from % 64;
+		const int n = R_MIN (64 - bit, to - from);
+		page->cached[from / 64] &= ~(__word_mask (n) << bit);
+		from += n;
+	}
+}
+
+static bool __page_is_empty(RIODescCache *page) {
+	int i;
+	for (i = 0; i < R_IO_DESC_CACHE_WORDS; i++) {
+		if (page->cached[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// overlays the cached bytes of [off, off + len) on buf
+static void __page_read(RIODescCache *page, int off, ut8 *buf, int len) {
+	const int end = off + len;
+	while (off < end) {
+		const int bit = off % 64;
+		const int n = R_MIN (64 - bit, end - off);
+		const ut64 mask = __word_mask (n);
+		const ut64 word = (page->cached[off / 64] >> bit) & mask;
+		if (word == mask) {
+			memcpy (buf, page->cdata + off, n);
+		} else if (word) {
+			int i;
+			for (i = 0; i < n; i++) {
+				if (word & (1ULL << i)) {
+					buf[i] = page->cdata[off + i];
+				}
+			}
+		}
+		buf += n;
+		off += n;
+	}
+}
+
+static bool __desc_cache_collect_cb(void *user, const ut64 k, const void *v) {
+	r_pvector_push ((RPVector *)user, (void *)v);
+	return true;
+}
+
+static int __desc_cache_page_cmp(const void *a, const void *b) {
+	const RIODescCache *pa = a, *pb = b;
+	return (pa->addr > pb->addr) - (pa->addr < pb->addr);
+}
+
+// returns the pages sorted by address
+static RPVector *__desc_cache_pages(RIODesc *desc) {
+	RPVector *pages = r_pvector_new (NULL);
+	if (pages) {
+		r_pvector_reserve (pages, desc->cache->count);
+		ht_up_foreach (desc->cache, __desc_cache_collect_cb, pages);
+		r_pvector_sort (pages, __desc_cache_page_cmp);
+	}
+	return pages;
+}
+
+// walks the cached bytes in address order, calling cb once for each
+// contiguous run, even when it spans multiple pages
+static bool __desc_cache_foreach_run(RIODesc *desc, RIODescCacheRunCb cb, void *user) {
+	RPVector *pages = __desc_cache_pages (desc);
+	if (!pages) {
+		return false;
+	}
+	int cap = R_IO_DESC_CACHE_SIZE, len = 0;
+	ut8 *run = malloc (cap);
+	ut64 start = 0;
+	bool ret = run != NULL;
+	void **it;
+	r_pvector_foreach (pages, it) {
+		RIODescCache *page = *it;
+		int i;
+		if (!ret) {
+			break;
+		}
+		for (i = 0; i < R_IO_DESC_CACHE_SIZE; i++) {
+			if (!(page->cached[i / 64] & (1ULL << (i % 64)))) {
+				continue;
+			}
+			const ut64 paddr = page->addr + i;
+			if (len > 0 && start + len != paddr) {
+				cb (user, start, run, len);
+				len = 0;
+			}
+			if (!len) {
+				start = paddr;
+			}
+			if (len == cap) {
+				ut8 *tmp = realloc (run, cap * 2);
+				if (!tmp) {
+					ret = false;
+					break;
+				}
+				run = tmp;
+				cap *= 2;
+			}
+			run[len++] = page->cdata[i];
+		}
+	}
+	if (ret && len > 0) {
+		cb (user, start, run, len);
+	}
+	free (run);
+	r_pvector_free (pages);
+	return ret;
+}
 
 R_API bool r_io_desc_cache_init(RIODesc *desc) {
 	if (!desc || desc->cache) {
 		return false;
 	}
-	return (desc->cache = sdb_new0 ()) ? true : false;
+	return (desc->cache = ht_up_new (NULL, __desc_cache_free_kv, NULL)) ? true : false;
 }
 
 R_API int r_io_desc_cache_write(RIODesc *desc, ut64 paddr, const ut8 *buf, int len) {
 	RIODescCache *cache;
 	ut64 caddr, desc_sz = r_io_desc_size (desc);
-	char k[64];
 	int cbaddr, written = 0;
 	if ((len < 1) || !desc || (desc_sz <= paddr) ||
 	    !desc->io || (!desc->cache && !r_io_desc_cache_init (desc))) {
@@ -95,38 +164,19 @@ R_API int r_io_desc_cache_write(RIODesc *desc, ut64 paddr, const ut8 *buf, int l
 	caddr = paddr / R_IO_DESC_CACHE_SIZE;
 	cbaddr = paddr % R_IO_DESC_CACHE_SIZE;
 	while (written < len) {
-		sdb_itoa (caddr, k, 10);
-		//get an existing desc-cache, if it exists
-		if (!(cache = (RIODescCache *)(size_t)sdb_num_get (desc->cache, k, NULL))) {
-			//create new desc-cache
+		//get an existing desc-cache page, if it exists
+		if (!(cache = ht_up_find (desc->cache, caddr, NULL))) {
 			cache = R_NEW0 (RIODescCache);
 			if (!cache) {
-				return 0;
+				return written;
 			}
-			//feed sdb with the new desc-cache
-			sdb_num_set (desc->cache, k, (ut64)(size_t)cache, 0);
-		}
-		//check if the remaining data fits into the cache
-		if ((len - written) > (R_IO_DESC_CACHE_SIZE - cbaddr)) {
-			written += (R_IO_DESC_CACHE_SIZE - cbaddr);
-			//this can be optimized
-			for (; cbaddr < R_IO_DESC_CACHE_SIZE; cbaddr++) {
-				//write to cache
-				cache->cdata[cbaddr] = *buf;
-				//save, that its cached
-				cache->cached |= (0x1ULL << cbaddr);
-				buf++;
-			}
-		} else {
-			//XXX this looks like very suspicious
-			do {
-				cache->cdata[cbaddr] = *buf;
-				cache->cached |= (0x1ULL << cbaddr);
-				buf++;
-				written++;
-				cbaddr++;
-			} while (len > written);
+			cache->addr = caddr * R_IO_DESC_CACHE_SIZE;
+			ht_up_insert (desc->cache, caddr, cache);
 		}
+		const int n = R_MIN (len - written, R_IO_DESC_CACHE_SIZE - cbaddr);
+		memcpy (cache->cdata + cbaddr, buf + written, n);
+		__page_mark (cache, cbaddr, cbaddr + n);
+		written += n;
 		caddr++;
 		cbaddr = 0;
 	}
@@ -135,8 +185,6 @@ R_API int r_io_desc_cache_write(RIODesc *desc, ut64 paddr, const ut8 *buf, int l
 
 R_API int r_io_desc_cache_read(RIODesc *desc, ut64 paddr, ut8 *buf, int len) {
 	RIODescCache *cache;
-	char k[64];
-	ut8 *ptr = buf;
 	ut64 caddr, desc_sz = r_io_desc_size (desc);
 	int cbaddr, amount = 0;
 	if ((len < 1) || !desc || (desc_sz <= paddr) || !desc->io || !desc->cache) {
@@ -151,32 +199,11 @@ R_API int r_io_desc_cache_read(RIODesc *desc, ut64 paddr, ut8 *buf, int len) {
 	caddr = paddr / R_IO_DESC_CACHE_SIZE;
 	cbaddr = paddr % R_IO_DESC_CACHE_SIZE;
 	while (amount < len) {
-		sdb_itoa (caddr, k, 10);
-		// get an existing desc-cache, if it exists
-		if (!(cache = (RIODescCache *)(size_t)sdb_num_get (desc->cache, k, NULL))) {	
-			amount += (R_IO_DESC_CACHE_SIZE - cbaddr);
-			ptr += (R_IO_DESC_CACHE_SIZE - cbaddr);
-			goto beach;
-		}
-		if ((len - amount) > (R_IO_DESC_CACHE_SIZE - cbaddr)) {
-			amount += (R_IO_DESC_CACHE_SIZE - cbaddr);
-			for (; cbaddr < R_IO_DESC_CACHE_SIZE; cbaddr++) {
-				if (cache->cached & (0x1ULL << cbaddr)) {
-					*ptr = cache->cdata[cbaddr];
-				}
-				ptr++;
-			}
-		} else {
-			do {
-				if (cache->cached & (0x1ULL << cbaddr)) {
-					*ptr = cache->cdata[cbaddr];
-				}
-				ptr++;
-				amount++;
-				cbaddr++;
-			} while (len > amount);
+		const int n = R_MIN (len - amount, R_IO_DESC_CACHE_SIZE - cbaddr);
+		if ((cache = ht_up_find (desc->cache, caddr, NULL))) {
+			__page_read (cache, cbaddr, buf + amount, n);
 		}
-beach:
+		amount += n;
 		caddr++;
 		cbaddr = 0;
 	}
@@ -192,57 +219,19 @@ static void __riocache_free(void *user) {
 	free (cache);
 }
 
-static int __desc_cache_list_cb(void *user, const char *k, const char *v) {
+static bool __desc_cache_list_cb(void *user, ut64 paddr, const ut8 *buf, int len) {
 	RList *writes = (RList *)user;
-	RIODescCache *dcache;
-	RIOCache *cache = NULL;
-	ut64 blockaddr;
-	int byteaddr, i;
-	if (!writes) {
+	RIOCache *cache = R_NEW0 (RIOCache);
+	if (!cache) {
 		return false;
 	}
-	dcache = (RIODescCache *)(size_t)sdb_atoi (v);
-	if (!dcache) {
+	cache->data = r_mem_dup (buf, len);
+	if (!cache->data) {
+		free (cache);
 		return false;
 	}
-	blockaddr = sdb_atoi (k) * R_IO_DESC_CACHE_SIZE;
-	for (i = byteaddr = 0; byteaddr < R_IO_DESC_CACHE_SIZE; byteaddr++) {
-		if (dcache->cached & (0x1LL << byteaddr)) {
-			if (!cache) {
-				cache = R_NEW0 (RIOCache);
-				if (!cache) {
-					return false;
-				}
-				cache->data = malloc (R_IO_DESC_CACHE_SIZE - byteaddr);
-				if (!cache->data) {
-					free (cache);
-					return false;
-				}
-				cache->itv.addr = blockaddr + byteaddr;
-			}
-			cache->data[i] = dcache->cdata[byteaddr];
-			i++;
-		} else if (cache) {
-			ut8 *data = realloc (cache->data, i);
-			if (!data) {
-				__riocache_free ((void *) cache);
-				return false;
-			}
-			cache->data = data;
-			cache->itv.size = i;
-			i = 0;
-			r_list_push (writes, cache);
-			cache = NULL;
-		}
-	}
-	if (cache) {
-#if 0
-		cache->size = i;
-		cache->to = blockaddr + R_IO_DESC_CACHE_SIZE;
-#endif
-		cache->itv.size = i;
-		r_list_push (writes, cache);
-	}
+	cache->itv = (RInterval){paddr, len};
+	r_list_append (writes, cache);
 	return true;
 }
 
@@ -254,7 +243,7 @@ R_API RList *r_io_desc_cache_list(RIODesc *desc) {
 	if (!writes) {
 		return NULL;
 	}
-	sdb_foreach (desc->cache, __desc_cache_list_cb, writes);
+	__desc_cache_foreach_run (desc, __desc_cache_list_cb, writes);
 	RIODesc *current = desc->io->desc;
 	desc->io->desc = desc;
 	desc->io->p_cache = false;
@@ -275,32 +264,9 @@ R_API RList *r_io_desc_cache_list(RIODesc *desc) {
 	return writes;
 }
 
-static int __desc_cache_commit_cb(void *user, const char *k, const char *v) {
+static bool __desc_cache_commit_cb(void *user, ut64 paddr, const ut8 *buf, int len) {
 	RIODesc *desc = (RIODesc *)user;
-	ut64 blockaddr;
-	int byteaddr, i;
-	ut8 buf[R_IO_DESC_CACHE_SIZE] = {0};
-	if (!desc || !desc->io) {
-		return false;
-	}
-	RIODescCache *dcache = (RIODescCache *)(size_t)sdb_atoi (v);
-	if (!dcache) {
-		return false;
-	}
-	blockaddr = R_IO_DESC_CACHE_SIZE * sdb_atoi (k);
-	for (i = byteaddr = 0; byteaddr < R_IO_DESC_CACHE_SIZE; byteaddr++) {
-		if (dcache->cached & (0x1LL << byteaddr)) {
-			buf[i] = dcache->cdata[byteaddr];
-			i++;
-		} else if (i > 0) {
-			r_io_pwrite_at (desc->io, blockaddr + byteaddr - i, buf, i);
-			i = 0;
-		}
-	}
-	if (i > 0) {
-		r_io_pwrite_at (desc->io, blockaddr + R_IO_DESC_CACHE_SIZE - i, buf, i);
-	}
-	free (dcache);
+	r_io_pwrite_at (desc->io, paddr, buf, len);
 	return true;
 }
 
@@ -315,55 +281,48 @@ R_API bool r_io_desc_cache_commit(RIODesc *desc) {
 	current = desc->io->desc;
 	desc->io->desc = desc;
 	desc->io->p_cache = false;
-	sdb_foreach (desc->cache, __desc_cache_commit_cb, desc);
-	sdb_free (desc->cache);
+	desc->io->rev++;
+	__desc_cache_foreach_run (desc, __desc_cache_commit_cb, desc);
+	ht_up_free (desc->cache);
 	desc->cache = NULL;
 	desc->io->p_cache = true;
 	desc->io->desc = current;
 	return true;
 }
 
-static int __desc_cache_cleanup_cb(void *user, const char *k, const char *v) {
-	RIODesc *desc = (RIODesc *)user;
-	RIODescCache *cache;
-	ut64 size, blockaddr;
-	int byteaddr;
+R_API void r_io_desc_cache_cleanup(RIODesc *desc) {
 	if (!desc || !desc->cache) {
-		return false;
+		return;
 	}
-	cache = (RIODescCache *) (size_t)sdb_atoi (v);
-	blockaddr = R_IO_DESC_CACHE_SIZE * sdb_atoi (k);
-	size = r_io_desc_size (desc);
-	if (size <= blockaddr) {
-		free (cache);
-		sdb_unset (desc->cache, k, 0);
-		return true;
-	}
-	if (size <= (blockaddr + R_IO_DESC_CACHE_SIZE - 1)) {
-		//this looks scary, but it isn't
-		byteaddr = (int)(size - blockaddr) - 1;		
-		cache->cached &= cleanup_masks[byteaddr];
+	RPVector *pages = __desc_cache_pages (desc);
+	if (!pages) {
+		return;
 	}
-	return true;
-}
-
-R_API void r_io_desc_cache_cleanup(RIODesc *desc) {
-	if (desc && desc->cache) {
-		sdb_foreach (desc->cache, __desc_cache_cleanup_cb, desc);
+	const ut64 size = r_io_desc_size (desc);
+	size_t i = r_pvector_len (pages);
+	// drop the bytes that are now past the end of the file
+	while (i-- > 0) {
+		RIODescCache *page = r_pvector_at (pages, i);
+		if (page->addr + R_IO_DESC_CACHE_SIZE <= size) {
+			break;
+		}
+		if (size > page->addr) {
+			__page_unmark (page, (int)(size - page->addr), R_IO_DESC_CACHE_SIZE);
+		}
+		if (size <= page->addr || __page_is_empty (page)) {
+			ht_up_delete (desc->cache, page->addr / R_IO_DESC_CACHE_SIZE);
+		}
 	}
+	r_pvector_free (pages);
 }
 
-static int __desc_cache_free_cb(void *user, const char* k, const char *v) {
-	RIODescCache *cache = (RIODescCache *)(size_t)sdb_atoi (v);
-	free (cache);
-	return true;
-}
-
-static bool __desc_fini_cb (void *user, void *data, ut32 id) {
+static bool __desc_fini_cb(void *user, void *data, ut32 id) {
 	RIODesc *desc = (RIODesc *)data;
 	if (desc->cache) {
-		sdb_foreach (desc->cache, __desc_cache_free_cb, NULL);
-		sdb_free (desc->cache);
+		if (desc->io) {
+			desc->io->rev++;
+		}
+		ht_up_free (desc->cache);
 		desc->cache = NULL;
 	}
 	return true;
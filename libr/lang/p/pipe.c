@@ -147,6 +147,7 @@ static int lang_pipe_run(RLang *lang, const char *code, int len) {
 	
 	env ("R2PIPE_IN", input[0]);
 	env ("R2PIPE_OUT", output[1]);
+	r_sys_setenv ("R2PIPE_FRAMED", "1");
 
 	child = r_sys_fork ();
 	if (child == -1) {
@@ -167,6 +168,7 @@ static int lang_pipe_run(RLang *lang, const char *code, int len) {
 	} else {
 		/* parent */
 		char *res, buf[8192]; // TODO: use the heap?
+		bool framed = false;
 		/* Close pipe ends not required in the parent */
 		close (output[1]);
 		close (input[0]);
@@ -186,15 +188,30 @@ static int lang_pipe_run(RLang *lang, const char *code, int len) {
 				continue;
 			}
 			buf[sizeof (buf) - 1] = 0;
+			if (!framed && r_str_startswith (buf, R2PIPE_FRAMED_HELLO)) {
+				framed = true;
+				write (input[1], "ok", 3);
+				continue;
+			}
 			res = lang->cmd_str ((RCore*)lang->user, buf);
 			//eprintf ("%d %s\n", ret, buf);
-			if (res) {
+			if (!res) {
+				eprintf ("r_lang_pipe: NULL reply for (%s)\n", buf);
+			}
+			if (framed) {
+				ut8 hdr[4];
+				int res_len = res? strlen (res): 0;
+				r_write_le32 (hdr, res_len);
+				write (input[1], hdr, sizeof (hdr));
+				if (res_len > 0) {
+					write (input[1], res, res_len);
+				}
+			} else if (res) {
 				write (input[1], res, strlen (res) + 1);
-				free (res);
 			} else {
-				eprintf ("r_lang_pipe: NULL reply for (%s)\n", buf);
 				write (input[1], "", 1); // NULL byte
 			}
+			free (res);
 		}
 		r_cons_break_pop ();
 		/* workaround to avoid stdin closed */
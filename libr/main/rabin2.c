@@ -79,6 +79,7 @@ static int rabin_show_help(int v) {
 		" RABIN2_NOPLUGINS: # do not load shared plugins (speedup loading)\n"
 		" RABIN2_DEMANGLE=0:e bin.demangle     # do not demangle symbols\n"
 		" RABIN2_MAXSTRBUF: e bin.maxstrbuf    # specify maximum buffer size\n"
+		" RABIN2_STRJOBS:   e bin.str.jobs     # threads used to scan for strings\n"
 		" RABIN2_STRFILTER: e bin.str.filter   #  r2 -qc 'e bin.str.filter=?" "?' -\n"
 		" RABIN2_STRPURGE:  e bin.str.purge    # try to purge false positives\n"
 		" RABIN2_DEBASE64:  e bin.debase64     # try to debase64 all strings\n"
@@ -622,6 +623,10 @@ R_API int r_main_rabin2(int argc, char **argv) {
 		r_config_set (core.config, "bin.maxstrbuf", tmp);
 		free (tmp);
 	}
+	if ((tmp = r_sys_getenv ("RABIN2_STRJOBS"))) {
+		r_config_set (core.config, "bin.str.jobs", tmp);
+		free (tmp);
+	}
 	if ((tmp = r_sys_getenv ("RABIN2_STRFILTER"))) {
 		r_config_set (core.config, "bin.str.filter", tmp);
 		free (tmp);
@@ -1035,6 +1040,7 @@ R_API int r_main_rabin2(int argc, char **argv) {
 	}
 	bin->minstrlen = r_config_get_i (core.config, "bin.minstr");
 	bin->maxstrbuf = r_config_get_i (core.config, "bin.maxstrbuf");
+	bin->strjobs = R_MIN (R_MAX (1, r_config_get_i (core.config, "bin.str.jobs")), R_BIN_MAX_STRJOBS);
 
 	r_bin_force_plugin (bin, forcebin);
 	r_bin_load_filter (bin, action);
@@ -21,24 +21,84 @@ static int nonstop = 0;
 static bool identify = false;
 static bool quiet = false;
 static int mode = R_SEARCH_STRING;
-static ut64 cur = 0;
-static ut8 *buf = NULL;
-static const char *curfile = NULL;
 static ut64 bsize = 4096;
+#define RAFIND_READAHEAD (1024 * 1024)
 static int hexstr = 0;
 static int widestr = 0;
 static RPrint *pr = NULL;
 static RList *keywords;
 static const char *comma = "";
 static bool json = false;
+static int jobs = 1;
+static bool unordered = false;
+static ut8 *stdin_buf = NULL;
+static int stdin_len = 0;
+
+typedef struct {
+	char *out;
+	int nhits;
+	int comma_at; // where the json comma goes if a file before had hits
+	bool done;
+} RafindOutput;
+
+/* files to scan, taken in order by the workers as they get free */
+typedef struct {
+	RPVector *files;
+	RafindOutput *outs;
+	int next; // next file to scan
+	int printed; // files printed so far, in order
+	RThreadLock *lock;
+} RafindPool;
+
+typedef struct {
+	RafindPool *pool;
+	RIO *io;
+	RSearch *rs; // made once with the keywords and reused for every file
+	ut8 *ra; // read ahead buffer, holds several blocks
+	ut64 ralen;
+	ut8 *buf; // block being searched, points into ra
+	ut64 bsize;
+	ut64 cur;
+	const char *curfile;
+	const char *comma;
+	int nhits;
+	int comma_at;
+	RStrBuf *sb; // output of the file, NULL to print it right away
+} RafindWorker;
+
+static void rafind_printf(RafindWorker *w, const char *fmt, ...) {
+	va_list ap;
+	va_start (ap, fmt);
+	if (w->sb) {
+		r_strbuf_vappendf (w->sb, fmt, ap);
+	} else {
+		vprintf (fmt, ap);
+	}
+	va_end (ap);
+}
+
+static void rafind_system(RafindWorker *w, const char *cmd) {
+	if (w->sb) {
+		char *out = r_sys_cmd_str (cmd, NULL, NULL);
+		if (out) {
+			r_strbuf_append (w->sb, out);
+			free (out);
+		}
+	} else {
+		r_sandbox_system (cmd, 1);
+	}
+}
 
 static int hit(RSearchKeyword *kw, void *user, ut64 addr) {
+	RafindWorker *w = user;
+	const ut8 *buf = w->buf;
+	const ut64 cur = w->cur;
 	int delta = addr - cur;
 	if (cur > addr && (cur - addr == kw->keyword_length - 1)) {
 		// This case occurs when there is hit in search left over
 		delta = cur - addr;
 	}
-	if (delta < 0 || delta >= bsize) {
+	if (delta < 0 || delta >= w->bsize) {
 		eprintf ("Invalid delta\n");
 		return 0;
 	}
@@ -97,17 +157,21 @@ static int hit(RSearchKeyword *kw, void *user, ut64 addr) {
 		}
 		str[i] = 0;
 	}
+	w->nhits++;
 	if (json) {
 		const char *type = "string";
-		printf ("%s{\"offset\":%"PFMT64d",\"type\":\"%s\",\"data\":\"%s\"}", comma, addr, type, str);
-		comma = ",";
+		if (w->sb && w->nhits == 1) {
+			w->comma_at = r_strbuf_length (w->sb);
+		}
+		rafind_printf (w, "%s{\"offset\":%"PFMT64d",\"type\":\"%s\",\"data\":\"%s\"}", w->comma, addr, type, str);
+		w->comma = ",";
 	} else if (rad) {
-		printf ("f hit%d_%d 0x%08"PFMT64x" ; %s\n", 0, kw->count, addr, curfile);
+		rafind_printf (w, "f hit%d_%d 0x%08"PFMT64x" ; %s\n", 0, kw->count, addr, w->curfile);
 	} else {
 		if (showstr) {
-			printf ("0x%"PFMT64x" %s\n", addr, str);
+			rafind_printf (w, "0x%"PFMT64x" %s\n", addr, str);
 		} else {
-			printf ("0x%"PFMT64x"\n", addr);
+			rafind_printf (w, "0x%"PFMT64x"\n", addr);
 			if (pr) {
 				r_print_hexdump (pr, addr, (ut8*)buf + delta, 78, 16, 1, 1);
 				r_cons_flush ();
@@ -118,7 +182,7 @@ static int hit(RSearchKeyword *kw, void *user, ut64 addr) {
 }
 
 static int show_help(char *argv0, int line) {
-	printf ("Usage: %s [-mXnzZhqv] [-a align] [-b sz] [-f/t from/to] [-[e|s|S] str] [-x hex] -|file|dir ..\n", argv0);
+	printf ("Usage: %s [-mXnzZhqvu] [-a align] [-b sz] [-T n] [-f/t from/to] [-[e|s|S] str] [-x hex] -|file|dir ..\n", argv0);
 	if (line) {
 		return 0;
 	}
@@ -137,6 +201,8 @@ static int show_help(char *argv0, int line) {
 	" -s [str]   search for a specific string (can be used multiple times)\n"
 	" -S [str]   search for a specific wide string (can be used multiple times). Assumes str is UTF-8.\n"
 	" -t [to]    stop search at address 'to'\n"
+	" -T [n]     scan up to n files at once\n"
+	" -u         print the hits of every file as it is done, not in order (with -T)\n"
 	" -q         quiet - do not show headings (filenames) above matching contents (default for searching a single file)\n"
 	" -v         print version and exit\n"
 	" -x [hex]   search for hexpair string (909090) (can be used multiple times)\n"
@@ -147,120 +213,141 @@ static int show_help(char *argv0, int line) {
 	return 0;
 }
 
-static int rafind_open_file(const char *file, const ut8 *data, int datalen) {
+static RSearch *rafind_search_new(RafindWorker *w) {
+	RListIter *iter;
+	const char *kw;
+	RSearch *rs = r_search_new (mode);
+	if (!rs) {
+		return NULL;
+	}
+	rs->align = align;
+	r_search_set_callback (rs, &hit, w);
+	if (mode == R_SEARCH_KEYWORD) {
+		r_list_foreach (keywords, iter, kw) {
+			if (hexstr) {
+				if (mask) {
+					r_search_kw_add (rs, r_search_keyword_new_hex (kw, mask, NULL));
+				} else {
+					r_search_kw_add (rs, r_search_keyword_new_hexmask (kw, NULL));
+				}
+			} else if (widestr) {
+				r_search_kw_add (rs, r_search_keyword_new_wide (kw, mask, NULL, 0));
+			} else {
+				r_search_kw_add (rs, r_search_keyword_new_str (kw, mask, NULL, 0));
+			}
+		}
+	}
+	return rs;
+}
+
+static int rafind_open_file(RafindWorker *w, const char *file, const ut8 *data, int datalen) {
 	RListIter *iter;
-	RSearch *rs = NULL;
 	const char *kw;
 	bool last = false;
 	int ret, result = 0;
+	ut64 cur, fto = to;
 
-	buf = NULL;
 	if (!quiet) {
-		printf ("File: %s\n", file);
+		rafind_printf (w, "File: %s\n", file);
 	}
 
 	if (identify) {
 		char *cmd = r_str_newf ("r2 -e search.show=false -e search.maxhits=1 -nqcpm '%s'", file);
-		r_sandbox_system (cmd, 1);
+		rafind_system (w, cmd);
 		free (cmd);
 		return 0;
 	}
 
-	RIO *io = r_io_new ();
-	if (!io) {
-		return 1;
+	if (!w->io) {
+		w->io = r_io_new ();
+		if (!w->io) {
+			return 1;
+		}
 	}
-
-	if (!r_io_open_nomap (io, file, R_PERM_R, 0)) {
+	RIO *io = w->io;
+	RIODesc *desc = r_io_open_nomap (io, file, R_PERM_R, 0);
+	if (!desc) {
 		eprintf ("Cannot open file '%s'\n", file);
-		result = 1;
-		goto err;
+		return 1;
 	}
 
 	if (data) {
 		r_io_write_at (io, 0, data, datalen);
 	}
 
-	rs = r_search_new (mode);
-	if (!rs) {
-		result = 1;
-		goto err;
-	}
-
-	buf = calloc (1, bsize);
-	if (!buf) {
-		eprintf ("Cannot allocate %"PFMT64d" bytes\n", bsize);
-		result = 1;
-		goto err;
-	}
-	rs->align = align;
-	r_search_set_callback (rs, &hit, buf);
-	if (to == -1) {
-		to = r_io_size (io);
-	}
-
-	if (!r_cons_new ()) {
-		result = 1;
-		goto err;
+	if (fto == -1) {
+		fto = r_io_size (io);
 	}
 
 	if (mode == R_SEARCH_STRING) {
 		/* TODO: implement using api */
-		r_sys_cmdf ("rabin2 -q%szzz '%s'", json? "j": "", file);
-		goto done;
+		char *cmd = r_str_newf ("rabin2 -q%szzz '%s'", json? "j": "", file);
+		rafind_system (w, cmd);
+		free (cmd);
+		goto err;
 	}
 	if (mode == R_SEARCH_MAGIC) {
-		char *tostr = (to && to != UT64_MAX)?
-			r_str_newf ("-e search.to=%"PFMT64d, to): strdup ("");
+		char *tostr = (fto && fto != UT64_MAX)?
+			r_str_newf ("-e search.to=%"PFMT64d, fto): strdup ("");
 		char *cmd = r_str_newf ("r2"
 			" -e search.in=range"
 			" -e search.align=%d"
 			" -e search.from=%"PFMT64d
 			" %s -qnc/m%s '%s'",
 			align, from, tostr, json? "j": "", file);
-		r_sandbox_system (cmd, 1);
+		rafind_system (w, cmd);
 		free (cmd);
 		free (tostr);
-		goto done;
+		goto err;
 	}
 	if (mode == R_SEARCH_ESIL) {
 		r_list_foreach (keywords, iter, kw) {
 			char *cmd = r_str_newf ("r2 -qc \"/E %s\" %s", kw, file);
 			if (cmd) {
-				r_sandbox_system (cmd, 1);
+				rafind_system (w, cmd);
 				free (cmd);
 			}
 		}
-		goto done;
+		goto err;
 	}
-	if (mode == R_SEARCH_KEYWORD) {
-		r_list_foreach (keywords, iter, kw) {
-			if (hexstr) {
-				if (mask) {
-					r_search_kw_add (rs, r_search_keyword_new_hex (kw, mask, NULL));
-				} else {
-					r_search_kw_add (rs, r_search_keyword_new_hexmask (kw, NULL));
-				}
-			} else if (widestr) {
-				r_search_kw_add (rs, r_search_keyword_new_wide (kw, mask, NULL, 0));
-			} else {
-				r_search_kw_add (rs, r_search_keyword_new_str (kw, mask, NULL, 0));
-			}
+
+	if (!w->rs) {
+		/* a whole number of blocks, read with a single call */
+		ut64 ralen = R_MAX (1, RAFIND_READAHEAD / bsize) * bsize;
+		w->rs = rafind_search_new (w);
+		w->ra = calloc (1, ralen);
+		if (!w->rs || !w->ra) {
+			eprintf ("Cannot allocate %"PFMT64d" bytes\n", ralen);
+			r_search_free (w->rs);
+			w->rs = NULL;
+			R_FREE (w->ra);
+			result = 1;
+			goto err;
 		}
-	} else if (mode == R_SEARCH_STRING) {
-		r_search_kw_add (rs, r_search_keyword_new_hexmask ("00", NULL)); //XXX
+		w->ralen = ralen;
 	}
-
-	curfile = file;
-	r_search_begin (rs);
+	w->bsize = bsize;
+	w->curfile = file;
+	r_search_begin (w->rs);
 	(void)r_io_seek (io, from, R_IO_SEEK_SET);
 	result = 0;
-	for (cur = from; !last && cur < to; cur += bsize) {
-		if ((cur + bsize) > to) {
-			bsize = to - cur;
+	ut64 ra_at = 0;
+	int ra_len = 0;
+	for (cur = from; !last && cur < fto; cur += w->bsize) {
+		if ((cur + w->bsize) > fto) {
+			w->bsize = fto - cur;
 			last = true;
 		}
-		ret = r_io_pread_at (io, cur, buf, bsize);
+		if (cur < ra_at || cur + w->bsize > ra_at + ra_len) {
+			ra_at = cur;
+			ra_len = r_io_pread_at (io, cur, w->ra, (int)R_MIN (w->ralen, fto - cur));
+			if (ra_len < 0) {
+				ra_len = 0;
+			}
+		}
+		w->cur = cur;
+		w->buf = w->ra + (cur - ra_at);
+		ret = R_MIN (w->bsize, ra_at + ra_len - cur);
 		if (ret == 0) {
 			if (nonstop) {
 				continue;
@@ -268,59 +355,176 @@ static int rafind_open_file(const char *file, const ut8 *data, int datalen) {
 			result = 1;
 			break;
 		}
-		if (ret != bsize && ret > 0) {
-			bsize = ret;
+		if (ret != w->bsize && ret > 0) {
+			w->bsize = ret;
 		}
 
-		if (r_search_update (rs, cur, buf, ret) == -1) {
+		if (r_search_update (w->rs, cur, w->buf, ret) == -1) {
 			eprintf ("search: update read error at 0x%08"PFMT64x"\n", cur);
 			break;
 		}
 	}
-done:
-	r_cons_free ();
 err:
-	free (buf);
-	r_search_free (rs);
-	r_io_free (io);
+	r_io_desc_close (desc);
 	return result;
 }
-static int rafind_open_dir(const char *dir);
 
-static int rafind_open(const char *file) {
-	if (!strcmp (file, "-")) {
-		int sz = 0;
-		ut8 *buf = (ut8 *)r_stdin_slurp (&sz);
-		char *ff = r_str_newf ("malloc://%d", sz);
-		int res = rafind_open_file (ff, buf, sz);
-		free (ff);
-		free (buf);
-		return res;
-	}
-	return r_file_is_directory (file)
-		? rafind_open_dir (file)
-		: rafind_open_file (file, NULL, -1);
-}
+static void rafind_files_add(RPVector *files, const char *file);
 
-static int rafind_open_dir(const char *dir) {
+static void rafind_dir_add(RPVector *files, const char *dir) {
 	RListIter *iter;
-	char *fullpath;
 	char *fname = NULL;
 
-	RList *files = r_sys_dir (dir);
+	RList *dirfiles = r_sys_dir (dir);
 
-	if (files) {
-		r_list_foreach (files, iter, fname) {
+	if (dirfiles) {
+		r_list_foreach (dirfiles, iter, fname) {
 			/* Filter-out unwanted entries */
 			if (*fname == '.') {
 				continue;
 			}
-			fullpath = r_str_newf ("%s"R_SYS_DIR"%s", dir, fname);
-			(void)rafind_open (fullpath);
-			free (fullpath);
+			char *fullpath = r_str_newf ("%s"R_SYS_DIR"%s", dir, fname);
+			if (fullpath) {
+				rafind_files_add (files, fullpath);
+				free (fullpath);
+			}
+		}
+		r_list_free (dirfiles);
+	}
+}
+
+static void rafind_files_add(RPVector *files, const char *file) {
+	if (strcmp (file, "-") && r_file_is_directory (file)) {
+		rafind_dir_add (files, file);
+	} else {
+		r_pvector_push (files, strdup (file));
+	}
+}
+
+static int rafind_open(RafindWorker *w, const char *file) {
+	if (!strcmp (file, "-")) {
+		char *ff = r_str_newf ("malloc://%d", stdin_len);
+		int res = rafind_open_file (w, ff, stdin_buf, stdin_len);
+		free (ff);
+		return res;
+	}
+	return rafind_open_file (w, file, NULL, -1);
+}
+
+static void rafind_output_print(RafindOutput *o) {
+	if (o->out) {
+		const char *rest = o->out;
+		if (json && o->nhits > 0) {
+			fwrite (o->out, 1, o->comma_at, stdout);
+			fputs (comma, stdout);
+			comma = ",";
+			rest += o->comma_at;
+		}
+		fputs (rest, stdout);
+		R_FREE (o->out);
+	}
+}
+
+/* hands the output of the i-th file to the pool, printing all the files
+ * done in order, or this one right away if the output is unordered */
+static void rafind_done(RafindPool *pool, int i, RafindWorker *w) {
+	r_th_lock_enter (pool->lock);
+	RafindOutput *o = &pool->outs[i];
+	o->out = r_strbuf_drain (w->sb);
+	o->nhits = w->nhits;
+	o->comma_at = w->comma_at;
+	o->done = true;
+	w->sb = NULL;
+	if (unordered) {
+		rafind_output_print (o);
+	} else {
+		const int n = r_pvector_len (pool->files);
+		while (pool->printed < n && pool->outs[pool->printed].done) {
+			rafind_output_print (&pool->outs[pool->printed++]);
 		}
-		r_list_free (files);
 	}
+	fflush (stdout);
+	r_th_lock_leave (pool->lock);
+}
+
+static void rafind_work(RafindWorker *w) {
+	RafindPool *pool = w->pool;
+	const int n = r_pvector_len (pool->files);
+	for (;;) {
+		r_th_lock_enter (pool->lock);
+		int i = pool->next++;
+		r_th_lock_leave (pool->lock);
+		if (i >= n) {
+			break;
+		}
+		w->sb = r_strbuf_new (NULL);
+		w->comma = "";
+		w->nhits = 0;
+		w->comma_at = 0;
+		(void)rafind_open (w, r_pvector_at (pool->files, i));
+		rafind_done (pool, i, w);
+	}
+}
+
+static RThreadFunctionRet rafind_th(RThread *th) {
+	rafind_work (th->user);
+	return R_TH_STOP;
+}
+
+static void rafind_worker_fini(RafindWorker *w) {
+	r_io_free (w->io);
+	r_search_free (w->rs);
+	free (w->ra);
+	r_strbuf_free (w->sb);
+}
+
+static int rafind_run(RPVector *files) {
+	RafindPool pool = {0};
+	int i, n = r_pvector_len (files);
+	if (jobs < 2 || n < 2) {
+		/* print as it goes, files are scanned in order anyway */
+		RafindWorker w = {0};
+		w.comma = comma;
+		for (i = 0; i < n; i++) {
+			(void)rafind_open (&w, r_pvector_at (files, i));
+		}
+		rafind_worker_fini (&w);
+		return 0;
+	}
+	jobs = R_MIN (jobs, n);
+	pool.files = files;
+	pool.outs = R_NEWS0 (RafindOutput, n);
+	pool.lock = r_th_lock_new (false);
+	RafindWorker *ws = R_NEWS0 (RafindWorker, jobs);
+	RThread **th = R_NEWS0 (RThread *, jobs);
+	if (!pool.outs || !pool.lock || !ws || !th) {
+		free (pool.outs);
+		r_th_lock_free (pool.lock);
+		free (ws);
+		free (th);
+		return 1;
+	}
+	for (i = 0; i < jobs; i++) {
+		ws[i].pool = &pool;
+		th[i] = r_th_new (rafind_th, &ws[i], 0);
+		if (!th[i]) {
+			rafind_work (&ws[i]);
+		}
+	}
+	for (i = 0; i < jobs; i++) {
+		if (th[i]) {
+			r_th_wait (th[i]);
+			r_th_free (th[i]);
+		}
+		rafind_worker_fini (&ws[i]);
+	}
+	for (i = 0; i < n; i++) {
+		free (pool.outs[i].out);
+	}
+	free (pool.outs);
+	r_th_lock_free (pool.lock);
+	free (ws);
+	free (th);
 	return 0;
 }
 
@@ -328,7 +532,7 @@ R_API int r_main_rafind2(int argc, char **argv) {
 	int c;
 
 	keywords = r_list_new ();
-	while ((c = r_getopt (argc, argv, "a:ie:b:jmM:s:S:x:Xzf:t:E:rqnhvZ")) != -1) {
+	while ((c = r_getopt (argc, argv, "a:ie:b:jmM:s:S:x:Xzf:t:T:E:rqnhuvZ")) != -1) {
 		switch (c) {
 		case 'a':
 			align = r_num_math (NULL, r_optarg);
@@ -371,6 +575,10 @@ R_API int r_main_rafind2(int argc, char **argv) {
 			break;
 		case 'b':
 			bsize = r_num_math (NULL, r_optarg);
+			if (!bsize) {
+				eprintf ("Invalid block size\n");
+				return 1;
+			}
 			break;
 		case 'x':
 			mode = R_SEARCH_KEYWORD;
@@ -388,6 +596,12 @@ R_API int r_main_rafind2(int argc, char **argv) {
 		case 't':
 			to = r_num_math (NULL, r_optarg);
 			break;
+		case 'T':
+			jobs = r_num_math (NULL, r_optarg);
+			break;
+		case 'u':
+			unordered = true;
+			break;
 		case 'X':
 			pr = r_print_new ();
 			break;
@@ -415,14 +629,30 @@ R_API int r_main_rafind2(int argc, char **argv) {
 	if (r_optind + 1 == argc && !r_file_is_directory (argv[r_optind])) {
 		quiet = true;
 	}
-	if (json) {
-		printf ("[");
+	if (pr) {
+		/* the hexdumps go through r_cons */
+		jobs = 1;
 	}
+	if (!r_cons_new ()) {
+		return 1;
+	}
+	RPVector files;
+	r_pvector_init (&files, free);
 	for (; r_optind < argc; r_optind++) {
-		rafind_open (argv[r_optind]);
+		if (!strcmp (argv[r_optind], "-") && !stdin_buf) {
+			stdin_buf = (ut8 *)r_stdin_slurp (&stdin_len);
+		}
+		rafind_files_add (&files, argv[r_optind]);
 	}
+	if (json) {
+		printf ("[");
+	}
+	rafind_run (&files);
 	if (json) {
 		printf ("]\n");
 	}
+	r_pvector_clear (&files);
+	R_FREE (stdin_buf);
+	r_cons_free ();
 	return 0;
 }
@@ -9,6 +9,8 @@
 #include <r_util.h>
 #include <r_crypto.h>
 
+#define RAHASH2_BLOCK_SIZE (4 * 1024 * 1024)
+
 static ut64 from = 0LL;
 static ut64 to = 0LL;
 static bool incremental = true;
@@ -136,11 +138,16 @@ static int do_hash_internal(RHash *ctx, ut64 hash, const ut8 *buf, int len, int
 	return 1;
 }
 
+static bool do_hash_read_at(void *user, ut64 addr, ut8 *buf, int len) {
+	r_io_pread_at ((RIO *)user, addr, buf, len);
+	return true;
+}
+
 static int do_hash(const char *file, const char *algo, RIO *io, int bsize, int rad, int ule, const ut8 *compare) {
 	ut64 j, fsize, algobit = r_hash_name_to_bits (algo);
-	RHash *ctx;
-	ut8 *buf;
-	int ret = 0;
+	RHash *ctx = NULL, *ctxs[R_HASH_NBITS] = {0};
+	ut8 *buf = NULL;
+	int b, ret = 0;
 	ut64 i;
 	bool first = true;
 	if (algobit == R_HASH_NONE) {
@@ -169,29 +176,37 @@ static int do_hash(const char *file, const char *algo, RIO *io, int bsize, int r
 		eprintf ("rahash2: Unknown file size\n");
 		return 1;
 	}
-	buf = calloc (1, bsize + 1);
-	if (!buf) {
-		return 1;
-	}
-	ctx = r_hash_new (true, algobit);
 
 	if (rad == 'j') {
 		printf ("[");
 	}
 	if (incremental) {
-		for (i = 1; i < R_HASH_ALL; i <<= 1) {
+		/* a context per algorithm, all fed by a single pass over the range */
+		int jobs = 0;
+		for (b = 0, i = 1; i < R_HASH_ALL; b++, i <<= 1) {
 			if (algobit & i) {
-				ut64 hashbit = i & algobit;
-				int dlen = r_hash_size (hashbit);
-				r_hash_do_begin (ctx, i);
-				if (s.buf && s.prefix) {
-					do_hash_internal (ctx, hashbit, s.buf, s.len, rad, 0, ule);
+				ctxs[b] = r_hash_new (true, i);
+				if (!ctxs[b]) {
+					ret = 1;
+					goto beach;
 				}
-				for (j = from; j < to; j += bsize) {
-					int len = ((j + bsize) > to)? (to - j): bsize;
-					r_io_pread_at (io, j, buf, len);
-					do_hash_internal (ctx, hashbit, buf, len, rad, 0, ule);
+				r_hash_do_begin (ctxs[b], i);
+				if (s.buf && s.prefix) {
+					do_hash_internal (ctxs[b], i, s.buf, s.len, rad, 0, ule);
 				}
+				jobs++;
+			}
+		}
+		if (!(algobit & ~R_HASH_STREAMING)) {
+			/* the block size only changes the digests of the other algorithms */
+			bsize = R_MIN (bsize, RAHASH2_BLOCK_SIZE);
+		}
+		r_hash_calculate_range (ctxs, algobit & R_HASH_ALL, do_hash_read_at, io, from, to, bsize, jobs);
+		for (b = 0, i = 1; i < R_HASH_ALL; b++, i <<= 1) {
+			if (algobit & i) {
+				ut64 hashbit = i & algobit;
+				int dlen = r_hash_size (hashbit);
+				ctx = ctxs[b];
 				if (s.buf && !s.prefix) {
 					do_hash_internal (ctx, hashbit, s.buf, s.len, rad, 0, ule);
 				}
@@ -230,6 +245,12 @@ static int do_hash(const char *file, const char *algo, RIO *io, int bsize, int r
 		if (s.buf) {
 			eprintf ("Warning: Seed ignored on per-block hashing.\n");
 		}
+		buf = calloc (1, bsize + 1);
+		ctx = r_hash_new (true, algobit);
+		if (!buf || !ctx) {
+			ret = 1;
+			goto beach;
+		}
 		for (i = 1; i < R_HASH_ALL; i <<= 1) {
 			ut64 f, t, ofrom, oto;
 			if (algobit & i) {
@@ -259,6 +280,12 @@ static int do_hash(const char *file, const char *algo, RIO *io, int bsize, int r
 	}
 
 	compare_hashes (ctx, compare, r_hash_size (algobit), &ret);
+beach:
+	for (b = 0; b < R_HASH_NBITS; b++) {
+		if (ctxs[b] != ctx) {
+			r_hash_free (ctxs[b]);
+		}
+	}
 	r_hash_free (ctx);
 	free (buf);
 	return ret;
@@ -126,6 +126,7 @@ R_API bool r_reg_set_name(RReg *reg, int role, const char *name) {
 	r_return_val_if_fail (reg && name, false);
 	if (role >= 0 && role < R_REG_NAME_LAST) {
 		reg->name[role] = r_str_dup (reg->name[role], name);
+		reg->rev++;
 		return true;
 	}
 	return false;
@@ -158,6 +159,7 @@ R_API void r_reg_free_internal(RReg *reg, bool init) {
 	r_return_if_fail (reg);
 	ut32 i;
 
+	reg->rev++;
 	r_list_free (reg->roregs);
 	reg->roregs = NULL;
 	R_FREE (reg->reg_profile_str);
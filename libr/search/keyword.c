@@ -49,6 +49,7 @@ R_API void r_search_keyword_free (RSearchKeyword *kw) {
 	if (!kw) {
 		return;
 	}
+	r_regex_free (kw->regex);
 	free (kw->bin_binmask);
 	free (kw->bin_keyword);
 	free (kw);
@@ -1,33 +1,110 @@
-/* radare - LGPL - Copyright 2008-2014 - pancake, TheLemonMan */
+/* radare - LGPL - Copyright 2008-2020 - pancake, TheLemonMan */
 
 #include "r_search.h"
 #include <r_regex.h>
 
+// bytes of the previous block kept to find the matches crossing its end
+#define REGEXP_WINDOW 4096
+
+typedef struct {
+	ut64 end; // address following the last block
+	int len; // bytes of the last block at the start of data
+	int size; // allocated bytes of data
+	ut8 data[]; // window followed by the current block
+} RSearchRegexpStream;
+
+/* number of literal bytes every match of the pattern starts with */
+static int regexp_prefix(const char *re) {
+	int i;
+	if (strchr (re, '|')) {
+		return 0;
+	}
+	for (i = 0; re[i] && !strchr (".[]()*+?{}|^$\\", re[i]); i++) {
+		;
+	}
+	if (i > 0 && re[i] && strchr ("*?{", re[i])) {
+		// the last literal is optional
+		i--;
+	}
+	return i;
+}
+
+static bool regexp_compile(RSearchKeyword *kw) {
+	if (kw->regex) {
+		return true;
+	}
+	int reflags = R_REGEX_EXTENDED;
+	if (kw->icase) {
+		reflags |= R_REGEX_ICASE;
+	}
+	kw->regex = R_NEW0 (RRegex);
+	if (!kw->regex) {
+		return false;
+	}
+	if (r_regex_comp (kw->regex, (char *)kw->bin_keyword, reflags)) {
+		eprintf ("Cannot compile '%s' regexp\n", kw->bin_keyword);
+		R_FREE (kw->regex);
+		return false;
+	}
+	return true;
+}
+
+// Supported search variants: icase, matches across consecutive blocks
 R_API int r_search_regexp_update(RSearch *s, ut64 from, const ut8 *buf, int len) {
 	RSearchKeyword *kw;
 	RListIter *iter;
 	RRegexMatch match;
-	RRegex compiled = {0};
+	RSearchRegexpStream *st = s->data;
 	const int old_nhits = s->nhits;
 	int ret = 0;
 
-	r_list_foreach (s->kws, iter, kw) {
-		int reflags = R_REGEX_EXTENDED;
-
-		if (kw->icase) {
-			reflags |= R_REGEX_ICASE;
-		}
-
-		if (r_regex_comp (&compiled, (char *)kw->bin_keyword, reflags)) {
-			eprintf ("Cannot compile '%s' regexp\n", kw->bin_keyword);
+	if (len < 0) {
+		return -1;
+	}
+	int keep = (st && !s->bckwrds && st->end == from)? st->len: 0;
+	if (!st || st->size < keep + len) {
+		RSearchRegexpStream *nst = realloc (st, sizeof (RSearchRegexpStream) + keep + len);
+		if (!nst) {
 			return -1;
 		}
+		if (!st) {
+			nst->len = 0;
+		}
+		nst->size = keep + len;
+		s->data = st = nst;
+	}
+	memcpy (st->data + keep, buf, len);
+	const char *data = (const char *)st->data;
+	const int dlen = keep + len;
+	const ut64 base = from - keep;
 
-		match.rm_so = 0;
-		match.rm_eo = len;
-
-		while (!r_regex_exec (&compiled, (char *)buf, 1, &match, R_REGEX_STARTEND)) {
-			int t = r_search_hit_new (s, kw, from + match.rm_so);
+	r_list_foreach (s->kws, iter, kw) {
+		if (!regexp_compile (kw)) {
+			ret = -1;
+			goto beach;
+		}
+		const int prefix = kw->icase? 0: regexp_prefix ((const char *)kw->bin_keyword);
+		int at = 0;
+		if (keep && kw->regex_end > base) {
+			// the matches ending in the window were reported with the previous block
+			at = (int)R_MIN (kw->regex_end - base, dlen);
+		}
+		while (at < dlen) {
+			if (prefix > 0) {
+				const ut8 *p = r_mem_mem ((const ut8 *)data + at, dlen - at, kw->bin_keyword, prefix);
+				if (!p) {
+					break;
+				}
+				at = p - (const ut8 *)data;
+			}
+			/* Setup the boundaries for R_REGEX_STARTEND */
+			match.rm_so = at;
+			match.rm_eo = dlen;
+			if (r_regex_exec (kw->regex, data, 1, &match, R_REGEX_STARTEND)) {
+				break;
+			}
+			kw->regex_end = base + match.rm_eo;
+			int t = r_search_hit_new (s, kw, base + match.rm_so);
 			if (!t) {
 				ret = -1;
 				goto beach;
@@ -35,14 +112,15 @@ R_API int r_search_regexp_update(RSearch *s, ut64 from, const ut8 *buf, int len)
 			if (t > 1) {
 				goto beach;
 			}
-			/* Setup the boundaries for R_REGEX_STARTEND */
-			match.rm_so = match.rm_eo;
-			match.rm_eo = len;
+			at = match.rm_eo > match.rm_so? match.rm_eo: match.rm_so + 1;
 		}
 	}
 
 beach:
-	r_regex_fini (&compiled);
+	// keep the end of the block for the next one
+	st->len = R_MIN (dlen, REGEXP_WINDOW);
+	memmove (st->data, st->data + dlen - st->len, st->len);
+	st->end = from + len;
 	if (!ret) {
 		ret = s->nhits - old_nhits;
 	}
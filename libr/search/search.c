@@ -15,6 +15,39 @@ typedef struct {
 	ut8 data[];
 } RSearchLeftover;
 
+/* keywords grouped by the bytes they can start with, so every block is
+ * scanned once for all of them and only the candidates are verified */
+typedef struct {
+	ut64 addr;
+	int link; // next hit of the same keyword, or -1
+} RSearchKwHit;
+
+typedef struct {
+	RSearchKeyword **kws;
+	int n_kws;
+	int *ids; // keyword indexes, the ones starting with b are ids[start[b]] .. ids[start[b + 1] - 1]
+	int start[UT8_MAX + 2];
+	int *next; // first position of the block where every keyword can match again
+	int single; // the only byte all the keywords start with, or -1
+	ut8 pairs[(UT16_MAX + 1) / 8]; // bitmap of the first two bytes of a possible match
+	RVector hits; // RSearchKwHit of the block, reported keyword by keyword
+	int *head, *tail; // first and last hit of every keyword
+} RSearchKwTable;
+
+static void kwtable_free(RSearch *s) {
+	RSearchKwTable *t = s->kwtable;
+	if (t) {
+		free (t->kws);
+		free (t->ids);
+		free (t->next);
+		free (t->head);
+		free (t->tail);
+		r_vector_clear (&t->hits);
+		free (t);
+		s->kwtable = NULL;
+	}
+}
+
 R_API RSearch *r_search_new(int mode) {
 	RSearch *s = R_NEW0 (RSearch);
 	if (!s) {
@@ -54,6 +87,7 @@ R_API RSearch *r_search_free(RSearch *s) {
 	}
 	r_list_free (s->hits);
 	r_list_free (s->kws);
+	kwtable_free (s);
 	//r_io_free(s->iob.io); this is supposed to be a weak reference
 	free (s->data);
 	free (s);
@@ -98,7 +132,10 @@ R_API int r_search_begin(RSearch *s) {
 	r_list_foreach (s->kws, iter, kw) {
 		kw->count = 0;
 		kw->last = 0;
+		kw->regex_end = 0;
 	}
+	// the keyword table only changes with the keywords, a new search just drops what was streamed
+	R_FREE (s->data);
 	return true;
 }
 
@@ -354,11 +391,183 @@ static bool brute_force_match(RSearch *s, RSearchKeyword *kw, const ut8 *buf, in
 	return j == kw->keyword_length;
 }
 
+static inline bool kw_byte_match(RSearchKeyword *kw, int j, ut8 a) {
+	ut8 b = kw->bin_keyword[j];
+	if (kw->icase) {
+		a = tolower (a);
+		b = tolower (b);
+	}
+	if (kw->binmask_length > 0) {
+		ut8 m = kw->bin_binmask[j % kw->binmask_length];
+		return (a & m) == (b & m);
+	}
+	return a == b;
+}
+
+static RSearchKwTable *kwtable_new(RSearch *s) {
+	RSearchKwTable *t = R_NEW0 (RSearchKwTable);
+	if (!t) {
+		return NULL;
+	}
+	RListIter *iter;
+	RSearchKeyword *kw;
+	int b, c, i, n = r_list_length (s->kws);
+	r_vector_init (&t->hits, sizeof (RSearchKwHit), NULL, NULL);
+	t->kws = R_NEWS (RSearchKeyword *, n);
+	t->next = R_NEWS0 (int, n);
+	t->head = R_NEWS (int, n);
+	t->tail = R_NEWS (int, n);
+	if (!t->kws || !t->next || !t->head || !t->tail) {
+		goto fail;
+	}
+	r_list_foreach (s->kws, iter, kw) {
+		t->kws[t->n_kws++] = kw;
+	}
+	// count the keywords of every first byte, and the pairs they can start with
+	for (i = 0; i < n; i++) {
+		kw = t->kws[i];
+		for (b = 0; b <= UT8_MAX; b++) {
+			if (!kw_byte_match (kw, 0, b)) {
+				continue;
+			}
+			t->start[b + 1]++;
+			for (c = 0; c <= UT8_MAX; c++) {
+				if (kw->keyword_length < 2 || kw_byte_match (kw, 1, c)) {
+					int pair = (b << 8) | c;
+					t->pairs[pair >> 3] |= 1 << (pair & 7);
+				}
+			}
+		}
+	}
+	t->single = -1;
+	for (b = 0; b <= UT8_MAX; b++) {
+		if (t->start[b + 1]) {
+			t->single = t->single == -1? b: -2;
+		}
+		t->start[b + 1] += t->start[b];
+	}
+	t->ids = R_NEWS (int, t->start[UT8_MAX + 1] + 1);
+	if (!t->ids) {
+		goto fail;
+	}
+	int pos[UT8_MAX + 1];
+	memcpy (pos, t->start, sizeof (pos));
+	for (i = 0; i < n; i++) {
+		for (b = 0; b <= UT8_MAX; b++) {
+			if (kw_byte_match (t->kws[i], 0, b)) {
+				t->ids[pos[b]++] = i;
+			}
+		}
+	}
+	return t;
+fail:
+	free (t->kws);
+	free (t->next);
+	free (t->head);
+	free (t->tail);
+	free (t);
+	return NULL;
+}
+
+/* tries every keyword at the positions of data below end, matches must
+ * fit in size bytes. delta is the position of the block in data. The hits
+ * are queued by keyword, to be reported in the order of the keywords */
+static bool kwtable_scan(RSearch *s, RSearchKwTable *t, const ut8 *data, int end, int size, ut64 from, int delta) {
+	int i = end, k;
+	for (k = 0; k < t->n_kws; k++) {
+		i = R_MIN (i, t->next[k]);
+	}
+	for (; i < end; i++) {
+		if (t->single >= 0) {
+			const ut8 *p = memchr (data + i, t->single, end - i);
+			if (!p) {
+				break;
+			}
+			i = p - data;
+		}
+		const ut8 b = data[i];
+		const int lo = t->start[b], hi = t->start[b + 1];
+		if (lo == hi) {
+			continue;
+		}
+		if (i + 1 < size) {
+			int pair = (b << 8) | data[i + 1];
+			if (!(t->pairs[pair >> 3] & (1 << (pair & 7)))) {
+				continue;
+			}
+		}
+		for (k = lo; k < hi; k++) {
+			int id = t->ids[k];
+			RSearchKeyword *kw = t->kws[id];
+			// overlapping matches that end before the block were found with the previous one
+			if (i < t->next[id] || i + kw->keyword_length > size || (s->overlap && i + kw->keyword_length <= delta)) {
+				continue;
+			}
+			if (brute_force_match (s, kw, data, i)) {
+				RSearchKwHit *hit = r_vector_push (&t->hits, NULL);
+				if (!hit) {
+					return false;
+				}
+				hit->addr = s->bckwrds ? from - kw->keyword_length - i + delta : from + i - delta;
+				hit->link = -1;
+				const int n = t->hits.len - 1;
+				if (t->tail[id] < 0) {
+					t->head[id] = n;
+				} else {
+					((RSearchKwHit *)r_vector_index_ptr (&t->hits, t->tail[id]))->link = n;
+				}
+				t->tail[id] = n;
+				if (!s->overlap) {
+					t->next[id] = i + kw->keyword_length;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+/* the kw->last and kw->count r_search_hit_new leaves after the queued hits of a keyword */
+static void kwtable_after(RSearch *s, RSearchKwTable *t, int id, ut64 *last, int *count) {
+	RSearchKeyword *kw = t->kws[id];
+	int h;
+	for (h = t->head[id]; h >= 0; h = ((RSearchKwHit *)r_vector_index_ptr (&t->hits, h))->link) {
+		const ut64 addr = ((RSearchKwHit *)r_vector_index_ptr (&t->hits, h))->addr;
+		if (s->align && (addr % s->align)) {
+			continue;
+		}
+		if (!s->contiguous && *last && addr == *last) {
+			(*count)--;
+		} else {
+			(*count)++;
+		}
+		*last = s->bckwrds ? addr : addr + kw->keyword_length;
+	}
+}
+
+/* reports the queued hits keyword by keyword, like the plain loop does.
+ * Returns -1 on error, 1 when the search must stop, 0 otherwise */
+static int kwtable_report(RSearch *s, RSearchKwTable *t) {
+	int id, h, r = 0;
+	for (id = 0; id < t->n_kws && !r; id++) {
+		for (h = t->head[id]; h >= 0; h = ((RSearchKwHit *)r_vector_index_ptr (&t->hits, h))->link) {
+			RSearchKwHit *hit = r_vector_index_ptr (&t->hits, h);
+			int ret = r_search_hit_new (s, t->kws[id], hit->addr);
+			if (!ret || ret > 1) {
+				r = ret? 1: -1;
+				break;
+			}
+		}
+	}
+	t->hits.len = 0; // keeps the room for the next block
+	return r;
+}
+
 // Supported search variants: backward, binmask, icase, inverse, overlap
 R_API int r_search_mybinparse_update(RSearch *s, ut64 from, const ut8 *buf, int len) {
 	RSearchKeyword *kw;
 	RListIter *iter;
 	RSearchLeftover *left;
+	RSearchKwTable *table = NULL;
 	int longest = 0, i;
 	const int old_nhits = s->nhits;
 
@@ -393,40 +602,85 @@ R_API int r_search_mybinparse_update(RSearch *s, ut64 from, const ut8 *buf, int
 
 	ut64 len1 = left->len + R_MIN (longest - 1, len);
 	memcpy (left->data + left->len, buf, len1 - left->len);
-	r_list_foreach (s->kws, iter, kw) {
-		i = s->overlap || !kw->count ? 0 :
-				s->bckwrds
-				? kw->last - from < left->len ? from + left->len - kw->last : 0
-				: from - kw->last < left->len ? kw->last + left->len - from : 0;
-		for (; i + kw->keyword_length <= len1 && i < left->len; i++) {
-			if (brute_force_match (s, kw, left->data, i) != s->inverse) {
-				int t = r_search_hit_new (s, kw, s->bckwrds ? from - kw->keyword_length - i + left->len : from + i - left->len);
-				if (!t) {
-					return -1;
-				}
-				if (t > 1) {
-					return s->nhits - old_nhits;
-				}
-				if (!s->overlap) {
-					i += kw->keyword_length - 1;
-				}
-			}
+	if (!s->distance && !s->inverse) {
+		if (!s->kwtable) {
+			s->kwtable = kwtable_new (s);
 		}
-		i = s->overlap || !kw->count ? 0 :
-				s->bckwrds
-				? from > kw->last ? from - kw->last : 0
-				: from < kw->last ? kw->last - from : 0;
-		for (; i + kw->keyword_length <= len; i++) {
-			if (brute_force_match (s, kw, buf, i) != s->inverse) {
-				int t = r_search_hit_new (s, kw, s->bckwrds ? from - kw->keyword_length - i : from + i);
-				if (!t) {
-					return -1;
-				}
-				if (t > 1) {
-					return s->nhits - old_nhits;
+		table = s->kwtable;
+	}
+	if (table) {
+		// the leftover of the previous block, then the block itself
+		for (i = 0; i < table->n_kws; i++) {
+			kw = table->kws[i];
+			table->next[i] = s->overlap || !kw->count ? 0 :
+					s->bckwrds
+					? kw->last - from < left->len ? from + left->len - kw->last : 0
+					: from - kw->last < left->len ? kw->last + left->len - from : 0;
+			table->head[i] = table->tail[i] = -1;
+		}
+		if (!kwtable_scan (s, table, left->data, left->len, len1, from, left->len)) {
+			table->hits.len = 0;
+			return -1;
+		}
+		for (i = 0; i < table->n_kws; i++) {
+			kw = table->kws[i];
+			ut64 last = kw->last;
+			int count = kw->count;
+			// the hits in the leftover are not reported yet
+			kwtable_after (s, table, i, &last, &count);
+			table->next[i] = s->overlap || !count ? 0 :
+					s->bckwrds
+					? from > last ? from - last : 0
+					: from < last ? last - from : 0;
+		}
+		if (!kwtable_scan (s, table, buf, len, len, from, 0)) {
+			table->hits.len = 0;
+			return -1;
+		}
+		int r = kwtable_report (s, table);
+		if (r) {
+			return r < 0? -1: s->nhits - old_nhits;
+		}
+	} else {
+		r_list_foreach (s->kws, iter, kw) {
+			i = s->overlap || !kw->count ? 0 :
+					s->bckwrds
+					? kw->last - from < left->len ? from + left->len - kw->last : 0
+					: from - kw->last < left->len ? kw->last + left->len - from : 0;
+			if (s->overlap) {
+				// the matches that end before the block were found with the previous one
+				i = R_MAX (i, left->len - kw->keyword_length + 1);
+			}
+			for (; i + kw->keyword_length <= len1 && i < left->len; i++) {
+				if (brute_force_match (s, kw, left->data, i) != s->inverse) {
+					int t = r_search_hit_new (s, kw, s->bckwrds ? from - kw->keyword_length - i + left->len : from + i - left->len);
+					if (!t) {
+						return -1;
+					}
+					if (t > 1) {
+						return s->nhits - old_nhits;
+					}
+					if (!s->overlap) {
+						i += kw->keyword_length - 1;
+					}
 				}
-				if (!s->overlap) {
-					i += kw->keyword_length - 1;
+			}
+			i = s->overlap || !kw->count ? 0 :
+					s->bckwrds
+					? from > kw->last ? from - kw->last : 0
+					: from < kw->last ? kw->last - from : 0;
+			for (; i + kw->keyword_length <= len; i++) {
+				if (brute_force_match (s, kw, buf, i) != s->inverse) {
+					int t = r_search_hit_new (s, kw, s->bckwrds ? from - kw->keyword_length - i : from + i);
+					if (!t) {
+						return -1;
+					}
+					if (t > 1) {
+						return s->nhits - old_nhits;
+					}
+					if (!s->overlap) {
+						i += kw->keyword_length - 1;
+					}
 				}
 			}
 		}
@@ -513,6 +767,7 @@ R_API int r_search_kw_add(RSearch *s, RSearchKeyword *kw) {
 	}
 	kw->kwidx = s->n_kws++;
 	r_list_append (s->kws, kw);
+	kwtable_free (s);
 	return true;
 }
 
@@ -520,6 +775,7 @@ R_API int r_search_kw_add(RSearch *s, RSearchKeyword *kw) {
 R_API void r_search_string_prepare_backward(RSearch *s) {
 	RListIter *iter;
 	RSearchKeyword *kw;
+	kwtable_free (s);
 	// Precondition: !kw->binmask_length || kw->keyword_length % kw->binmask_length == 0
 	r_list_foreach (s->kws, iter, kw) {
 		ut8 *i = kw->bin_keyword, *j = kw->bin_keyword + kw->keyword_length;
@@ -540,6 +796,10 @@ R_API void r_search_string_prepare_backward(RSearch *s) {
 
 R_API void r_search_reset(RSearch *s, int mode) {
 	s->nhits = 0;
+	if (s->mode != mode) {
+		// the leftover of each mode has its own layout
+		R_FREE (s->data);
+	}
 	if (!r_search_set_mode (s, mode)) {
 		eprintf ("Cannot init search for mode %d\n", mode);
 	}
@@ -549,4 +809,5 @@ R_API void r_search_kw_reset(RSearch *s) {
 	r_list_purge (s->kws);
 	r_list_purge (s->hits);
 	R_FREE (s->data);
+	kwtable_free (s);
 }
@@ -33,18 +33,18 @@ static void env(const char *s, int f) {
 #endif
 
 R_API int r2pipe_write(R2Pipe *r2pipe, const char *str) {
-	char *cmd;
+	char *cmd, tmp[1024];
 	int ret, len;
 	if (!r2pipe || !str) {
 		return -1;
 	}
 	len = strlen (str) + 2; /* include \n\x00 */
-	cmd = malloc (len + 2);
+	cmd = (len <= sizeof (tmp))? tmp: malloc (len);
 	if (!cmd) {
 		return 0;
 	}
-	memcpy (cmd, str, len - 1);
-	strcpy (cmd + len - 2, "\n");
+	memcpy (cmd, str, len - 2);
+	memcpy (cmd + len - 2, "\n", 2);
 #if __WINDOWS__
 	DWORD dwWritten = -1;
 	WriteFile (r2pipe->pipe, cmd, len, &dwWritten, NULL);
@@ -52,58 +52,126 @@ R_API int r2pipe_write(R2Pipe *r2pipe, const char *str) {
 #else
 	ret = (write (r2pipe->input[1], cmd, len) == len);
 #endif
-	free (cmd);
+	if (cmd != tmp) {
+		free (cmd);
+	}
 	return ret;
 }
 
-/* TODO: add timeout here ? */
-R_API char *r2pipe_read(R2Pipe *r2pipe) {
-	int bufsz = 0;
-	char *buf = NULL;
-	if (!r2pipe) {
-		return NULL;
+static int pipe_read(R2Pipe *r2pipe, char *buf, int len) {
+#if __WINDOWS__
+	DWORD dwRead = 0;
+	if (!ReadFile (r2pipe->pipe, buf, len, &dwRead, NULL) && GetLastError () != ERROR_MORE_DATA) {
+		return -1;
+	}
+	return dwRead;
+#else
+	return read (r2pipe->output[0], buf, len);
+#endif
+}
+
+static bool buf_reserve(R2Pipe *r2pipe, int size) {
+	if (size <= r2pipe->bufsz) {
+		return true;
+	}
+	int bufsz = R_MAX (r2pipe->bufsz, 4096);
+	while (bufsz < size) {
+		if (bufsz > ST32_MAX / 2) {
+			return false;
+		}
+		bufsz *= 2;
 	}
-	bufsz = 4096;
-	buf = calloc (1, bufsz);
+	char *buf = realloc (r2pipe->buf, bufsz);
 	if (!buf) {
-		return NULL;
+		return false;
 	}
-#if __WINDOWS__
-	BOOL bSuccess = FALSE;
-	DWORD dwRead = 0;
-	// TODO: handle > 4096 buffers here
-	bSuccess = ReadFile (r2pipe->pipe, buf, bufsz, &dwRead, NULL);
-	if (!bSuccess || !buf[0]) {
-		return NULL;
+	r2pipe->buf = buf;
+	r2pipe->bufsz = bufsz;
+	return true;
+}
+
+/* reads until there are at least size bytes in the buffer, but not past it
+ * if exact, returns false if the pipe is closed before */
+static bool buf_fill(R2Pipe *r2pipe, int size, bool exact) {
+	while (r2pipe->buflen < size) {
+		int room = exact? size - r2pipe->buflen: r2pipe->bufsz - r2pipe->buflen - 1;
+		int rv = pipe_read (r2pipe, r2pipe->buf + r2pipe->buflen, room);
+		if (rv < 1) {
+			return false;
+		}
+		r2pipe->buflen += rv;
 	}
-	if (dwRead > 0) {
-		buf[dwRead] = 0;
+	return true;
+}
+
+/* Returns the next response without copying it out of the read buffer, the
+ * pointer is valid until the next read. Responses are NUL terminated, the
+ * pipe is read in bulk and the bytes past the NUL are kept for the next one.
+ * In framed mode the length prefix tells how much to read in one go. */
+R_API const char *r2pipe_read_buf(R2Pipe *r2pipe, int *len) {
+	r_return_val_if_fail (r2pipe, NULL);
+	/* drop the previous response */
+	if (r2pipe->bufpos > 0) {
+		r2pipe->buflen -= r2pipe->bufpos;
+		memmove (r2pipe->buf, r2pipe->buf + r2pipe->bufpos, r2pipe->buflen);
+		r2pipe->bufpos = 0;
+	}
+	if (r2pipe->framed) {
+		ut32 n = 0;
+		if (buf_reserve (r2pipe, 4) && buf_fill (r2pipe, 4, true)) {
+			n = r_read_le32 (r2pipe->buf);
+		}
+		if (n > ST32_MAX - 5 || !buf_reserve (r2pipe, n + 5)) {
+			return NULL;
+		}
+		if (!buf_fill (r2pipe, n + 4, true)) {
+			n = r2pipe->buflen > 4? r2pipe->buflen - 4: 0;
+		}
+		char *res = r2pipe->buf + 4;
+		if (r2pipe->buflen > n + 4) {
+			/* the next frame was read already, make room for the NUL over the prefix */
+			memmove (--res, r2pipe->buf + 4, n);
+		}
+		res[n] = 0;
+		r2pipe->bufpos = R_MIN (n + 4, r2pipe->buflen);
+		if (len) {
+			*len = n;
+		}
+		return res;
 	}
-	buf[bufsz - 1] = 0;
-#else
-	char *newbuf;
-	int i, rv;
-	for (i = 0; i < bufsz; i++) {
-		rv = read (r2pipe->output[0], buf + i, 1);
-		if (i + 2 >= bufsz) {
-			bufsz += 4096;
-			newbuf = realloc (buf, bufsz);
-			if (!newbuf) {
-				R_FREE (buf);
-				break;
-			}
-			buf = newbuf;
+	int n = 0;
+	for (;;) {
+		if (!buf_reserve (r2pipe, r2pipe->buflen + 4096)) {
+			return NULL;
 		}
-		if (rv != 1 || !buf[i]) {
+		char *z = memchr (r2pipe->buf + n, 0, r2pipe->buflen - n);
+		if (z) {
+			n = z - r2pipe->buf;
+			r2pipe->bufpos = n + 1;
+			break;
+		}
+		n = r2pipe->buflen;
+		if (!buf_fill (r2pipe, r2pipe->buflen + 1, false)) {
+			/* closed, hand out what we got */
+			r2pipe->buf[n] = 0;
+			r2pipe->bufpos = n;
 			break;
 		}
 	}
-	if (buf) {
-		int zpos = (i < bufsz)? i: i - 1;
-		buf[zpos] = 0;
+	if (len) {
+		*len = n;
 	}
-#endif
-	return buf;
+	return r2pipe->buf;
+}
+
+/* TODO: add timeout here ? */
+R_API char *r2pipe_read(R2Pipe *r2pipe) {
+	int len = 0;
+	if (!r2pipe) {
+		return NULL;
+	}
+	const char *res = r2pipe_read_buf (r2pipe, &len);
+	return res? r_str_ndup (res, len): NULL;
 }
 
 R_API int r2pipe_close(R2Pipe *r2pipe) {
@@ -146,6 +214,7 @@ R_API int r2pipe_close(R2Pipe *r2pipe) {
 		r2pipe->child = -1;
 	}
 #endif
+	free (r2pipe->buf);
 	free (r2pipe);
 	return 0;
 }
@@ -184,6 +253,13 @@ static R2Pipe* r2pipe_open_spawn(R2Pipe* r2pipe) {
 	if (!done) {
 		eprintf ("Cannot find R2PIPE_IN or R2PIPE_OUT environment\n");
 		R_FREE (r2pipe);
+	} else if (r_sys_getenv_asbool ("R2PIPE_FRAMED")) {
+		/* the server can prefix the responses by their length */
+		const char *res = NULL;
+		if (r2pipe_write (r2pipe, R2PIPE_FRAMED_HELLO)) {
+			res = r2pipe_read_buf (r2pipe, NULL);
+		}
+		r2pipe->framed = res && !strcmp (res, "ok");
 	}
 	free (in);
 	free (out);
@@ -268,6 +344,7 @@ R_API R2Pipe *r2pipe_open(const char *cmd) {
 	}
 	env ("R2PIPE_IN", r2pipe->input[0]);
 	env ("R2PIPE_OUT", r2pipe->output[1]);
+	r_sys_setenv ("R2PIPE_FRAMED", NULL);
 
 	if (r2pipe->child) {
 		char ch = 1;
@@ -319,6 +396,30 @@ R_API char *r2pipe_cmd(R2Pipe *r2pipe, const char *str) {
 	return r2pipe_read (r2pipe);
 }
 
+/* like r2pipe_cmd, but the result is owned by r2pipe and valid until the next command */
+R_API const char *r2pipe_cmd_buf(R2Pipe *r2pipe, const char *str, int *len) {
+	r_return_val_if_fail (r2pipe && str, NULL);
+	if (r2pipe->coreb.core) {
+		char *res = r2pipe->coreb.cmdstr (r2pipe->coreb.core, str);
+		if (!res) {
+			return NULL;
+		}
+		free (r2pipe->buf);
+		r2pipe->buf = res;
+		r2pipe->buflen = r2pipe->bufpos = strlen (res);
+		r2pipe->bufsz = r2pipe->buflen + 1;
+		if (len) {
+			*len = r2pipe->buflen;
+		}
+		return res;
+	}
+	if (!r2pipe_write (r2pipe, str)) {
+		perror ("r2pipe_write");
+		return NULL;
+	}
+	return r2pipe_read_buf (r2pipe, len);
+}
+
 R_API char *r2pipe_cmdf(R2Pipe *r2pipe, const char *fmt, ...) {
 	int ret, ret2;
 	char *p, string[1024];
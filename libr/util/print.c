@@ -11,6 +11,7 @@
 #define IS_ALPHA(C) (((C) >= 'a' && (C) <= 'z') || ((C) >= 'A' && (C) <= 'Z'))
 
 static const char hex[16] = "0123456789ABCDEF";
+static const char hexlo[16] = "0123456789abcdef";
 
 static int nullprinter(const char *a, ...) {
 	return 0;
@@ -701,11 +702,37 @@ R_API int r_print_string(RPrint *p, ut64 seek, const ut8 *buf, int len, int opti
 	return i;
 }
 
-R_API void r_print_hexpairs(RPrint *p, ut64 addr, const ut8 *buf, int len) {
-	int i;
+static void print_write(RPrint *p, const char *buf, int len) {
+	if (len < 1) {
+		return;
+	}
+	if (p->write) {
+		p->write ((const ut8 *)buf, len);
+	} else {
+		p->cb_printf ("%.*s", len, buf);
+	}
+}
+
+// formats the bytes in a stack buffer instead of calling printf for each one
+static void print_hexpairs(RPrint *p, const ut8 *buf, int len, bool space) {
+	char out[4096];
+	int i, o = 0;
 	for (i = 0; i < len; i++) {
-		p->cb_printf ("%02x ", buf[i]);
+		if (o + 3 > sizeof (out)) {
+			print_write (p, out, o);
+			o = 0;
+		}
+		out[o++] = hexlo[buf[i] >> 4];
+		out[o++] = hexlo[buf[i] & 0xf];
+		if (space) {
+			out[o++] = ' ';
+		}
 	}
+	print_write (p, out, o);
+}
+
+R_API void r_print_hexpairs(RPrint *p, ut64 addr, const ut8 *buf, int len) {
+	print_hexpairs (p, buf, len, true);
 }
 
 static bool checkSparse(const ut8 *p, int len, int ch) {
@@ -813,6 +840,118 @@ R_API void r_print_section(RPrint *p, ut64 at) {
 	}
 }
 
+/* Rows of a plain "px": no cursor, alignment, sparse rows, comments or
+ * per-byte io checks. They are formatted straight into a buffer and
+ * written out in big chunks, colors are only emitted when they change. */
+static void hexdump_rows(RPrint *p, ut64 addr, const ut8 *buf, int len, int inc, bool pairs, bool compact) {
+	const bool use_color = p->flags & R_PRINT_FLAGS_COLOR;
+	const bool use_ascii = !(p->flags & R_PRINT_FLAGS_NONASCII);
+	const bool use_offset = p->flags & R_PRINT_FLAGS_OFFSET;
+	const char *offcolor = use_color? (Pal (p, offset): Color_GREEN): NULL;
+	const int resetlen = strlen (Color_RESET);
+	const char *bytecolor[256] = {0};
+	int bytecolorlen[256] = {0};
+	int i, j, o = 0, rows = 0, maxcol = 0;
+	if (use_color) {
+		for (i = 0; i < 256; i++) {
+			bytecolor[i] = r_print_byte_color (p, i);
+			bytecolorlen[i] = bytecolor[i]? strlen (bytecolor[i]): 0;
+			maxcol = R_MAX (maxcol, bytecolorlen[i]);
+		}
+	}
+	const int offcolorlen = offcolor? strlen (offcolor): 0;
+	const int rowmax = offcolorlen + 32 + 3 * resetlen + inc * (2 * maxcol + 5) + 8;
+	const int size = R_MAX (rowmax * 2, 64 * 1024);
+	char *out = malloc (size);
+	if (!out) {
+		return;
+	}
+#define APPEND(x, n) memcpy (d, (x), (n)); d += (n)
+	for (i = 0; i < len; i += inc) {
+		if (p->cons && p->cons->context && p->cons->context->breaked) {
+			break;
+		}
+		if (o + rowmax > size) {
+			print_write (p, out, o);
+			o = 0;
+		}
+		char *d = out + o;
+		const char *last = NULL;
+		ut64 at = addr + i;
+		if (use_offset) {
+			if (offcolor) {
+				APPEND (offcolor, offcolorlen);
+			}
+			d += snprintf (d, 32, p->wide_offsets? "0x%016" PFMT64x: "0x%08" PFMT64x, at);
+			if (offcolor) {
+				APPEND (Color_RESET, resetlen);
+			}
+			*d++ = ' ';
+		}
+		if (!compact) {
+			*d++ = ' ';
+		}
+		int bytes = 0;
+		for (j = i; j < i + inc; j++) {
+			if (j >= len) {
+				if (compact) {
+					break;
+				}
+				if (last) {
+					APPEND (Color_RESET, resetlen);
+					last = NULL;
+				}
+				if (j % 2) {
+					APPEND ("   ", 3);
+				} else {
+					APPEND ("  ", 2);
+				}
+				continue;
+			}
+			ut8 ch = buf[j];
+			if (bytecolor[ch] != last) {
+				last = bytecolor[ch];
+				APPEND (last, bytecolorlen[ch]);
+			}
+			*d++ = hexlo[ch >> 4];
+			*d++ = hexlo[ch & 0xf];
+			if (pairs && !compact && (inc & 1)) {
+				bool mustspace = (rows % 2)? !(j & 1): (j & 1);
+				if (mustspace) {
+					*d++ = ' ';
+				}
+			} else if ((bytes % 2 || !pairs) && !compact) {
+				*d++ = ' ';
+			}
+			bytes++;
+		}
+		if (last) {
+			APPEND (Color_RESET, resetlen);
+			last = NULL;
+		}
+		*d++ = ' ';
+		if (use_ascii) {
+			for (j = i; j < i + inc && j < len; j++) {
+				ut8 ch = buf[j];
+				if (bytecolor[ch] != last) {
+					last = bytecolor[ch];
+					APPEND (last, bytecolorlen[ch]);
+				}
+				*d++ = IS_PRINTABLE (ch)? ch: '.';
+			}
+			if (last) {
+				APPEND (Color_RESET, resetlen);
+			}
+		}
+		*d++ = '\n';
+		o = d - out;
+		rows++;
+	}
+#undef APPEND
+	print_write (p, out, o);
+	free (out);
+}
+
 R_API void r_print_hexdump(RPrint *p, ut64 addr, const ut8 *buf, int len, int base, int step, int zoomsz) {
 	PrintfCallback printfmt = (PrintfCallback) printf;
 	bool c = p? (p->flags & R_PRINT_FLAGS_COLOR): false;
@@ -1024,6 +1163,15 @@ R_API void r_print_hexdump(RPrint *p, ut64 addr, const ut8 *buf, int len, int ba
 	bool printValue = true;
 	bool oPrintValue = true;
 	bool isPxr = (p && p->flags & R_PRINT_FLAGS_REFS);
+	const int slowflags = R_PRINT_FLAGS_RAINBOW | R_PRINT_FLAGS_SECTION | R_PRINT_FLAGS_SEGOFF
+		| R_PRINT_FLAGS_ADDRDEC | R_PRINT_FLAGS_ADDRMOD;
+
+	if (p && base == 16 && step == 1 && zoomsz == 1 && use_hexa && !stride && !col
+			&& !use_sparse && !use_align && !use_unalloc && !hex_style && !isPxr
+			&& !p->use_comments && !p->cur_enabled && !p->pava && !(p->flags & slowflags)) {
+		hexdump_rows (p, addr, buf, len, inc, pairs, compact);
+		return;
+	}
 
 	for (i = j = 0; i < len; i += (stride? stride: inc)) {
 		if (p && p->cons && p->cons->context && p->cons->context->breaked) {
@@ -1458,7 +1606,10 @@ R_API void r_print_hexdiff(RPrint *p, ut64 aa, const ut8 *_a, ut64 ba, const ut8
 
 R_API void r_print_bytes(RPrint *p, const ut8 *buf, int len, const char *fmt) {
 	int i;
-	if (p) {
+	if (p && !strcmp (fmt, "%02x")) {
+		print_hexpairs (p, buf, len, false);
+		p->cb_printf ("\n");
+	} else if (p) {
 		for (i = 0; i < len; i++) {
 			p->cb_printf (fmt, buf[i]);
 		}
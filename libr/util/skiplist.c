@@ -9,7 +9,7 @@
 
 #include <r_skiplist.h>
 
-#define SKIPLIST_MAX_DEPTH 31
+#define SKIPLIST_MAX_DEPTH R_SKIPLIST_MAX_DEPTH
 
 static RSkipListNode *r_skiplist_node_new (void *data, int level) {
 	RSkipListNode *res = R_NEW0 (RSkipListNode);
@@ -152,20 +152,12 @@ R_API void r_skiplist_free(RSkipList *list) {
 	free (list);
 }
 
-// Inserts an element to the skiplist, and returns a pointer to the element's
-// node.
-R_API RSkipListNode* r_skiplist_insert(RSkipList* list, void* data) {
-	RSkipListNode *update[SKIPLIST_MAX_DEPTH + 1];
+// Link `data` after the nodes in `update`, which must be the insertion points
+// returned by find_insertpoint.
+static RSkipListNode *insert_after(RSkipList *list, void *data, RSkipListNode **update) {
 	RSkipListNode *x;
 	int i, x_level, new_level;
 
-	// locate insertion points in the lists of all levels
-	x = find_insertpoint (list, data, update, true);
-	// check whether the element is already in the list
-	if (x != list->head && !list->compare(x->data, data)) {
-		return x;
-	}
-
 	// randomly choose the number of levels the new node will be put in
 	for (x_level = 0; rand () < RAND_MAX / 2 && x_level < SKIPLIST_MAX_DEPTH; x_level++) {
 		;
@@ -198,6 +190,63 @@ R_API RSkipListNode* r_skiplist_insert(RSkipList* list, void* data) {
 	return x;
 }
 
+// Inserts an element to the skiplist, and returns a pointer to the element's
+// node.
+R_API RSkipListNode* r_skiplist_insert(RSkipList* list, void* data) {
+	RSkipListNode *update[SKIPLIST_MAX_DEPTH + 1];
+	RSkipListNode *x;
+
+	// locate insertion points in the lists of all levels
+	x = find_insertpoint (list, data, update, true);
+	// check whether the element is already in the list
+	if (x != list->head && !list->compare(x->data, data)) {
+		return x;
+	}
+	return insert_after (list, data, update);
+}
+
+// Prepare a finger to look up or insert elements in ascending order. Each
+// step resumes from the previous insertion points instead of the head, so
+// feeding n sorted elements costs about n steps per level instead of n * lg n.
+// Deleting elements from the list invalidates the finger.
+R_API void r_skiplist_finger_init(RSkipList *list, RSkipListFinger *fg) {
+	int i;
+	for (i = 0; i <= SKIPLIST_MAX_DEPTH; i++) {
+		fg->update[i] = list->head;
+	}
+}
+
+// Find the first node not smaller than `data`. `data` must not be smaller
+// than the element given in the previous call with the same finger.
+R_API RSkipListNode* r_skiplist_finger_find_geq(RSkipList *list, RSkipListFinger *fg, void *data) {
+	RSkipListNode *x = list->head;
+	int i;
+
+	for (i = list->list_level; i >= 0; i--) {
+		RSkipListNode *y = fg->update[i];
+		// resume from the furthest of the two known predecessors
+		if (x == list->head || (y != list->head && list->compare (y->data, x->data) > 0)) {
+			x = y;
+		}
+		while (x->forward[i] != list->head
+			&& list->compare (x->forward[i]->data, data) < 0) {
+			x = x->forward[i];
+		}
+		fg->update[i] = x;
+	}
+	x = x->forward[0];
+	return x == list->head? NULL: x;
+}
+
+// Same as r_skiplist_insert, for elements given in ascending order.
+R_API RSkipListNode* r_skiplist_finger_insert(RSkipList *list, RSkipListFinger *fg, void *data) {
+	RSkipListNode *x = r_skiplist_finger_find_geq (list, fg, data);
+	if (x && !list->compare (x->data, data)) {
+		return x;
+	}
+	return insert_after (list, data, fg->update);
+}
+
 // Delete node with data as it's payload.
 R_API bool r_skiplist_delete(RSkipList* list, void* data) {
 	return delete_element (list, data, true);
@@ -738,7 +738,7 @@ R_API int *r_utf_block_list(const ut8 *str, int len, int **freq_list) {
 	if (len < 0) {
 		len = strlen ((const char *)str);
 	}
-	static int block_freq[r_utf_blocks_count] = {0};
+	int block_freq[r_utf_blocks_count] = {0};
 	int *list = R_NEWS (int, len + 1);
 	if (!list) {
 		return NULL;
@@ -780,9 +780,6 @@ R_API int *r_utf_block_list(const ut8 *str, int len, int **freq_list) {
 		}
 		*freq_list_ptr = -1;
 	}
-	for (list_ptr = list; *list_ptr != -1; list_ptr++) {
-		block_freq[*list_ptr] = 0;
-	}
 	return list;
 }
 
@@ -0,0 +1,208 @@
+#include <r_core.h>
+#include "minunit.h"
+
+#define CODE_SIZE 0x30000
+#define NFCNS 64
+
+#define FCN(i) (((i) + 1) * 0x40)
+
+/* 64 functions at the start, followed by random code calling them with
+ * instructions of one to four bytes, some immediates looking like calls
+ * and a band of zeros */
+static ut8 *calls_code(int *ncalls) {
+	ut8 *buf = calloc (1, CODE_SIZE);
+	ut32 seed = 0x2357;
+	int i, at;
+	*ncalls = 0;
+	for (i = 0; i < NFCNS; i++) {
+		buf[FCN (i)] = 0x3e; // ld a, i
+		buf[FCN (i) + 1] = i;
+		buf[FCN (i) + 2] = 0xc9; // ret
+	}
+	for (at = FCN (NFCNS); at < CODE_SIZE - 4;) {
+		if (at >= 0x10000 && at < 0x12000) {
+			at++;
+			continue;
+		}
+		seed = seed * 1103515245 + 12345;
+		const ut32 r = seed >> 16;
+		const ut8 imm = (r & 0x300)? 0xcd: r >> 10;
+		switch (r % 6) {
+		case 0: // call
+			buf[at++] = 0xcd;
+			buf[at++] = FCN ((r >> 3) % NFCNS);
+			buf[at++] = FCN ((r >> 3) % NFCNS) >> 8;
+			(*ncalls)++;
+			break;
+		case 1: // ld hl, nn
+			buf[at++] = 0x21;
+			buf[at++] = imm;
+			buf[at++] = 0xcd;
+			break;
+		case 2: // ld ix, nn
+			buf[at++] = 0xdd;
+			buf[at++] = 0x21;
+			buf[at++] = 0xcd;
+			buf[at++] = imm;
+			break;
+		case 3: // ld a, n
+			buf[at++] = 0x3e;
+			buf[at++] = imm;
+			break;
+		default: // inc a
+			buf[at++] = 0x3c;
+			break;
+		}
+	}
+	return buf;
+}
+
+#define THUMB_FROM 0x18000
+#define THUMB_TO 0x28000
+
+static void arm_bl(ut8 *buf, int at, int to) {
+	r_write_le32 (buf + at, 0xeb000000 | (((to - at - 8) >> 2) & 0xffffff));
+}
+
+static void thumb_bl(ut8 *buf, int at, int to) {
+	const int off = to - at - 4;
+	r_write_le16 (buf + at, 0xf000 | ((off >> 12) & 0x7ff));
+	r_write_le16 (buf + at + 2, 0xf800 | ((off >> 1) & 0x7ff));
+}
+
+static void arm_fcn(ut8 *buf, int at, int i) {
+	r_write_le32 (buf + at, 0xe3a00000 | i); // mov r0, i
+	r_write_le32 (buf + at + 4, 0xe12fff1e); // bx lr
+}
+
+/* arm code calling the functions before it, with a thumb region in the
+ * middle only told apart by the bits hints, calling the functions after it */
+static ut8 *arm_calls_code(int *ncalls) {
+	ut8 *buf = calloc (1, CODE_SIZE);
+	ut32 seed = 0x2357;
+	int i, at;
+	*ncalls = 0;
+	for (i = 0; i < NFCNS; i++) {
+		arm_fcn (buf, FCN (i), i);
+		arm_fcn (buf, THUMB_TO + FCN (i), i);
+	}
+	for (at = FCN (NFCNS); at < CODE_SIZE - 4;) {
+		if (at == THUMB_TO) {
+			at += FCN (NFCNS);
+		}
+		seed = seed * 1103515245 + 12345;
+		const ut32 r = seed >> 16;
+		int to = FCN ((r >> 3) % NFCNS);
+		if (at > THUMB_TO && (r & 0x100)) {
+			to += THUMB_TO;
+		}
+		if (at >= THUMB_FROM && at < THUMB_TO) {
+			if (at > THUMB_TO - 4) {
+				r_write_le16 (buf + at, 0xbf00); // nop
+				at += 2;
+				continue;
+			}
+			switch (r % 4) {
+			case 0:
+				thumb_bl (buf, at, THUMB_TO + to);
+				at += 4;
+				(*ncalls)++;
+				break;
+			case 1: // movs r0, 0xf0
+				r_write_le16 (buf + at, 0x20f0);
+				at += 2;
+				break;
+			default: // nop
+				r_write_le16 (buf + at, 0xbf00);
+				at += 2;
+				break;
+			}
+			continue;
+		}
+		switch (r % 4) {
+		case 0:
+			arm_bl (buf, at, to);
+			(*ncalls)++;
+			break;
+		case 1: // mov r0, n
+			r_write_le32 (buf + at, 0xe3a00000 | (r >> 8));
+			break;
+		default: // nop
+			r_write_le32 (buf + at, 0xe1a00000);
+			break;
+		}
+		at += 4;
+	}
+	return buf;
+}
+
+static RCore *calls_core(const char *cmds, const ut8 *code, int jobs) {
+	RCore *core = r_core_new ();
+	r_core_cmd0 (core, cmds);
+	r_config_set_i (core->config, "anal.jobs", jobs);
+	r_io_open_at (core->io, "malloc://0x30000", R_PERM_RWX, 0644, 0);
+	r_io_write_at (core->io, 0, code, CODE_SIZE);
+	r_core_cmd0 (core, "aac");
+	return core;
+}
+
+static bool calls_same_for_jobs(const char *cmds, const ut8 *code, int nfcns, int ncalls) {
+	const int jobs[] = { 2, 3, 4 };
+	RListIter *iter;
+	RAnalFunction *fcn;
+	int i;
+	RCore *serial = calls_core (cmds, code, 1);
+	mu_assert_eq (r_list_length (serial->anal->fcns), nfcns, "functions");
+	int nxrefs = 0;
+	r_list_foreach (serial->anal->fcns, iter, fcn) {
+		RList *refs = r_anal_xrefs_get (serial->anal, fcn->addr);
+		nxrefs += r_list_length (refs);
+		r_list_free (refs);
+	}
+	mu_assert_eq (nxrefs, ncalls, "every call is found");
+	char *fcns = r_core_cmd_str (serial, "afl");
+	char *xrefs = r_core_cmd_str (serial, "ax*");
+	for (i = 0; i < R_ARRAY_SIZE (jobs); i++) {
+		RCore *core = calls_core (cmds, code, jobs[i]);
+		char *f = r_core_cmd_str (core, "afl");
+		char *x = r_core_cmd_str (core, "ax*");
+		// the chunks of the workers are resynced with the serial sweep
+		mu_assert ("same functions", !strcmp (f, fcns));
+		mu_assert ("same xrefs", !strcmp (x, xrefs));
+		free (f);
+		free (x);
+		r_core_free (core);
+	}
+	free (fcns);
+	free (xrefs);
+	r_core_free (serial);
+	return true;
+}
+
+bool test_anal_calls_jobs(void) {
+	int ncalls;
+	ut8 *code = calls_code (&ncalls);
+	mu_assert ("z80", calls_same_for_jobs ("e asm.arch=z80;e anal.arch=z80;e asm.bits=8", code, NFCNS, ncalls));
+	free (code);
+	mu_end;
+}
+
+bool test_anal_calls_bits_hints(void) {
+	int ncalls;
+	ut8 *code = arm_calls_code (&ncalls);
+	// the workers switch to thumb on their own
+	mu_assert ("arm and thumb", calls_same_for_jobs ("e asm.arch=arm.gnu;e anal.arch=arm.gnu;e asm.bits=32;"
+		"ahb 16 @ 0x18000;ahb 32 @ 0x28000", code, 2 * NFCNS, ncalls));
+	free (code);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test (test_anal_calls_jobs);
+	mu_run_test (test_anal_calls_bits_hints);
+	return tests_passed != tests_run;
+}
+
+int main(int argc, char **argv) {
+	return all_tests();
+}
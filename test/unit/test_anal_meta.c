@@ -0,0 +1,130 @@
+#include <r_anal.h>
+#include "minunit.h"
+
+static bool meta_is(const RAnalMetaItem *mi, int type, ut64 from, ut64 size) {
+	return mi && mi->type == type && mi->from == from && mi->size == size;
+}
+
+bool test_meta_find_in(void) {
+	RAnal *anal = r_anal_new ();
+	r_meta_add (anal, R_META_TYPE_DATA, 0x100, 0x110, NULL);
+	r_meta_add (anal, R_META_TYPE_STRING, 0x108, 0x120, "str");
+
+	RAnalMetaItem *mi = r_meta_find_in (anal, 0x10a, R_META_TYPE_DATA, R_META_WHERE_HERE);
+	mu_assert ("data covering 0x10a", meta_is (mi, R_META_TYPE_DATA, 0x100, 0x10));
+	r_meta_item_free (mi);
+	mi = r_meta_find_in (anal, 0x10a, R_META_TYPE_STRING, R_META_WHERE_HERE);
+	mu_assert ("string covering 0x10a", meta_is (mi, R_META_TYPE_STRING, 0x108, 0x18));
+	mu_assert_streq (mi->str, "str", "string");
+	r_meta_item_free (mi);
+	mi = r_meta_find_in (anal, 0x118, R_META_TYPE_ANY, R_META_WHERE_HERE);
+	mu_assert ("only the string covers 0x118", meta_is (mi, R_META_TYPE_STRING, 0x108, 0x18));
+	r_meta_item_free (mi);
+	mi = r_meta_find_in (anal, 0x120, R_META_TYPE_ANY, R_META_WHERE_HERE);
+	mu_assert_null (mi, "the end is not covered");
+	mi = r_meta_find_in (anal, 0xff, R_META_TYPE_ANY, R_META_WHERE_HERE);
+	mu_assert_null (mi, "nothing before");
+
+	RList *l = r_meta_find_list_in (anal, 0x10a, R_META_TYPE_ANY, R_META_WHERE_HERE);
+	mu_assert_eq (r_list_length (l), 2, "overlapping items");
+	mu_assert ("first by address", meta_is (r_list_get_n (l, 0), R_META_TYPE_DATA, 0x100, 0x10));
+	mu_assert ("second by address", meta_is (r_list_get_n (l, 1), R_META_TYPE_STRING, 0x108, 0x18));
+	r_list_free (l);
+	l = r_meta_find_list_in (anal, 0x104, R_META_TYPE_ANY, R_META_WHERE_HERE);
+	mu_assert_eq (r_list_length (l), 1, "before the overlap");
+	r_list_free (l);
+	l = r_meta_find_list_in (anal, 0x130, R_META_TYPE_ANY, R_META_WHERE_HERE);
+	mu_assert_null (l, "no items");
+
+	r_anal_free (anal);
+	mu_end;
+}
+
+bool test_meta_types_at(void) {
+	RAnal *anal = r_anal_new ();
+	r_meta_add (anal, R_META_TYPE_HIDE, 0x200, 0x204, NULL);
+	r_meta_add (anal, R_META_TYPE_DATA, 0x200, 0x208, NULL);
+	r_meta_add (anal, R_META_TYPE_FORMAT, 0x200, 0x202, "x");
+
+	// listed in the order they were added, disasm takes the size of the last one
+	RPVector *v = r_meta_get_all_at (anal, 0x200);
+	mu_assert_eq (r_pvector_len (v), 3, "items at 0x200");
+	mu_assert ("hide", meta_is (r_pvector_at (v, 0), R_META_TYPE_HIDE, 0x200, 4));
+	mu_assert ("data", meta_is (r_pvector_at (v, 1), R_META_TYPE_DATA, 0x200, 8));
+	mu_assert ("format", meta_is (r_pvector_at (v, 2), R_META_TYPE_FORMAT, 0x200, 2));
+	r_pvector_free (v);
+	mu_assert ("first listed", meta_is (r_meta_get_at (anal, 0x200, R_META_TYPE_ANY), R_META_TYPE_HIDE, 0x200, 4));
+	mu_assert ("by type", meta_is (r_meta_get_at (anal, 0x200, R_META_TYPE_DATA), R_META_TYPE_DATA, 0x200, 8));
+
+	RAnalMetaItem *mi = r_meta_find_in (anal, 0x201, R_META_TYPE_ANY, R_META_WHERE_HERE);
+	mu_assert ("first listed covering 0x201", meta_is (mi, R_META_TYPE_HIDE, 0x200, 4));
+	r_meta_item_free (mi);
+	RList *l = r_meta_find_list_in (anal, 0x201, R_META_TYPE_ANY, R_META_WHERE_HERE);
+	mu_assert_eq (r_list_length (l), 3, "all cover 0x201");
+	mu_assert ("hide first", meta_is (r_list_get_n (l, 0), R_META_TYPE_HIDE, 0x200, 4));
+	mu_assert ("data second", meta_is (r_list_get_n (l, 1), R_META_TYPE_DATA, 0x200, 8));
+	mu_assert ("format last", meta_is (r_list_get_n (l, 2), R_META_TYPE_FORMAT, 0x200, 2));
+	r_list_free (l);
+	l = r_meta_find_list_in (anal, 0x204, R_META_TYPE_ANY, R_META_WHERE_HERE);
+	mu_assert_eq (r_list_length (l), 1, "only data covers 0x204");
+	mu_assert ("data", meta_is (r_list_get_n (l, 0), R_META_TYPE_DATA, 0x200, 8));
+	r_list_free (l);
+
+	r_anal_free (anal);
+	mu_end;
+}
+
+bool test_meta_del_resize(void) {
+	RAnal *anal = r_anal_new ();
+	r_meta_add (anal, R_META_TYPE_HIDE, 0x200, 0x204, NULL);
+	r_meta_add (anal, R_META_TYPE_DATA, 0x200, 0x208, NULL);
+	r_meta_add (anal, R_META_TYPE_FORMAT, 0x200, 0x202, "x");
+
+	r_meta_del (anal, R_META_TYPE_DATA, 0x200, 1);
+	RPVector *v = r_meta_get_all_at (anal, 0x200);
+	mu_assert_eq (r_pvector_len (v), 2, "items left at 0x200");
+	mu_assert ("hide", meta_is (r_pvector_at (v, 0), R_META_TYPE_HIDE, 0x200, 4));
+	mu_assert ("format", meta_is (r_pvector_at (v, 1), R_META_TYPE_FORMAT, 0x200, 2));
+	r_pvector_free (v);
+	mu_assert_null (r_meta_get_at (anal, 0x200, R_META_TYPE_DATA), "data deleted");
+	RAnalMetaItem *mi = r_meta_find_in (anal, 0x206, R_META_TYPE_ANY, R_META_WHERE_HERE);
+	mu_assert_null (mi, "the data range is gone");
+
+	// adding the same type again resizes the item and moves it to the end of the list
+	r_meta_add (anal, R_META_TYPE_HIDE, 0x200, 0x210, NULL);
+	v = r_meta_get_all_at (anal, 0x200);
+	mu_assert_eq (r_pvector_len (v), 2, "items at 0x200");
+	mu_assert ("format", meta_is (r_pvector_at (v, 0), R_META_TYPE_FORMAT, 0x200, 2));
+	mu_assert ("hide last", meta_is (r_pvector_at (v, 1), R_META_TYPE_HIDE, 0x200, 0x10));
+	r_pvector_free (v);
+	mi = r_meta_find_in (anal, 0x20c, R_META_TYPE_ANY, R_META_WHERE_HERE);
+	mu_assert ("grown", meta_is (mi, R_META_TYPE_HIDE, 0x200, 0x10));
+	r_meta_item_free (mi);
+
+	r_meta_add (anal, R_META_TYPE_DATA, 0x300, 0x310, NULL);
+	r_meta_add (anal, R_META_TYPE_DATA, 0x300, 0x304, NULL);
+	mu_assert_null (r_meta_find_in (anal, 0x308, R_META_TYPE_ANY, R_META_WHERE_HERE), "shrunk");
+	mi = r_meta_find_in (anal, 0x303, R_META_TYPE_DATA, R_META_WHERE_HERE);
+	mu_assert ("shrunk data", meta_is (mi, R_META_TYPE_DATA, 0x300, 4));
+	r_meta_item_free (mi);
+
+	r_meta_del (anal, R_META_TYPE_ANY, 0x200, 1);
+	v = r_meta_get_all_at (anal, 0x200);
+	mu_assert_eq (r_pvector_len (v), 0, "all deleted");
+	r_pvector_free (v);
+	mu_assert_null (r_meta_find_in (anal, 0x200, R_META_TYPE_ANY, R_META_WHERE_HERE), "nothing covers 0x200");
+
+	r_anal_free (anal);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test (test_meta_find_in);
+	mu_run_test (test_meta_types_at);
+	mu_run_test (test_meta_del_resize);
+	return tests_passed != tests_run;
+}
+
+int main(int argc, char **argv) {
+	return all_tests();
+}
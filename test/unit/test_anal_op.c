@@ -0,0 +1,103 @@
+#include <r_anal.h>
+#include <r_th.h>
+#include "minunit.h"
+
+// mov eax, [ebx + 8] in 32 bits, mov eax, [rbx + 8] in 64 bits
+static const ut8 mov_mem[] = { 0x8b, 0x43, 0x08 };
+
+#define OP_MASK (R_ANAL_OP_MASK_ESIL | R_ANAL_OP_MASK_VAL)
+#define OP_LOOPS 2000
+
+typedef struct {
+	RAnal *anal;
+	const char *esil;
+	int mismatches;
+} OpJob;
+
+static RAnal *x86_anal(int bits) {
+	RAnal *anal = r_anal_new ();
+	if (!r_anal_use (anal, "x86")) {
+		r_anal_free (anal);
+		return NULL;
+	}
+	r_anal_set_bits (anal, bits);
+	return anal;
+}
+
+static char *op_esil(RAnal *anal) {
+	RAnalOp op;
+	r_anal_op (anal, &op, 0, mov_mem, sizeof (mov_mem), OP_MASK);
+	char *esil = strdup (r_strbuf_get (&op.esil));
+	r_anal_op_fini (&op);
+	return esil;
+}
+
+static RThreadFunctionRet op_th(RThread *th) {
+	OpJob *job = th->user;
+	int i;
+	for (i = 0; i < OP_LOOPS; i++) {
+		RAnalOp op;
+		r_anal_op (job->anal, &op, 0, mov_mem, sizeof (mov_mem), OP_MASK);
+		if (strcmp (r_strbuf_get (&op.esil), job->esil)) {
+			job->mismatches++;
+		}
+		r_anal_op_fini (&op);
+	}
+	return R_TH_STOP;
+}
+
+bool test_anal_op_instances(void) {
+	RAnal *a32 = x86_anal (32);
+	RAnal *a64 = x86_anal (64);
+	mu_assert_notnull (a32, "x86 32");
+	mu_assert_notnull (a64, "x86 64");
+	mu_assert ("own decoder state", a32->plugin_data && a64->plugin_data && a32->plugin_data != a64->plugin_data);
+
+	char *esil32 = op_esil (a32);
+	char *esil64 = op_esil (a64);
+	mu_assert ("ebx", strstr (esil32, "ebx") != NULL);
+	mu_assert ("rbx", strstr (esil64, "rbx") != NULL);
+
+	// the operand registers of an op stay valid while the other instance decodes
+	RAnalOp op32, op64;
+	r_anal_op (a32, &op32, 0, mov_mem, sizeof (mov_mem), OP_MASK);
+	r_anal_op (a64, &op64, 0, mov_mem, sizeof (mov_mem), OP_MASK);
+	mu_assert ("32 bits base", op32.src[0] && op32.src[0]->reg && !strcmp (op32.src[0]->reg->name, "ebx"));
+	mu_assert ("64 bits base", op64.src[0] && op64.src[0]->reg && !strcmp (op64.src[0]->reg->name, "rbx"));
+	mu_assert ("same esil as alone", !strcmp (r_strbuf_get (&op32.esil), esil32));
+	r_anal_op_fini (&op32);
+	r_anal_op_fini (&op64);
+
+	// and both can decode at the same time
+	OpJob jobs[2] = {
+		{ a32, esil32, 0 },
+		{ a64, esil64, 0 },
+	};
+	RThread *th[2];
+	int i;
+	for (i = 0; i < 2; i++) {
+		th[i] = r_th_new (op_th, &jobs[i], 0);
+		mu_assert_notnull (th[i], "thread");
+	}
+	for (i = 0; i < 2; i++) {
+		r_th_wait (th[i]);
+		r_th_free (th[i]);
+	}
+	mu_assert_eq (jobs[0].mismatches, 0, "32 bits esil in a thread");
+	mu_assert_eq (jobs[1].mismatches, 0, "64 bits esil in a thread");
+
+	free (esil32);
+	free (esil64);
+	r_anal_free (a32);
+	r_anal_free (a64);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test (test_anal_op_instances);
+	return tests_passed != tests_run;
+}
+
+int main(int argc, char **argv) {
+	return all_tests();
+}
@@ -0,0 +1,137 @@
+#include <r_anal.h>
+
+#include "minunit.h"
+
+static bool is_valid_offset(void *io, ut64 addr, int hasperm) {
+	return true;
+}
+
+static RAnal *anal_new(void) {
+	RAnal *anal = r_anal_new ();
+	anal->iob.is_valid_offset = (RIOIsValidOff)is_valid_offset;
+	return anal;
+}
+
+static bool collect_cb(RAnalRef *ref, void *user) {
+	r_list_append (user, r_mem_dup (ref, sizeof (RAnalRef)));
+	return true;
+}
+
+bool test_r_anal_xrefs_set_get() {
+	RAnal *anal = anal_new ();
+	r_anal_xrefs_set (anal, 0x10, 0x20, R_ANAL_REF_TYPE_CALL);
+	r_anal_xrefs_set (anal, 0x16, 0x10, R_ANAL_REF_TYPE_CODE);
+	r_anal_xrefs_set (anal, 0x20, 0x10, R_ANAL_REF_TYPE_CALL);
+	r_anal_xrefs_set (anal, 0x20, 0x10, R_ANAL_REF_TYPE_DATA);
+	mu_assert_eq (r_anal_xrefs_count (anal), 2, "xrefs count");
+
+	RList *list = r_anal_xrefs_get (anal, 0x10);
+	mu_assert_eq (r_list_length (list), 2, "xrefs to 0x10");
+	RAnalRef *ref = r_list_get_n (list, 0);
+	mu_assert_eq (ref->at, 0x16, "first xref from");
+	mu_assert_eq (ref->addr, 0x10, "first xref to");
+	mu_assert_eq (ref->type, R_ANAL_REF_TYPE_CODE, "first xref type");
+	ref = r_list_get_n (list, 1);
+	mu_assert_eq (ref->at, 0x20, "second xref from");
+	mu_assert_eq (ref->type, R_ANAL_REF_TYPE_DATA, "type updated");
+	r_list_free (list);
+
+	list = r_anal_refs_get (anal, 0x10);
+	mu_assert_eq (r_list_length (list), 1, "refs from 0x10");
+	ref = r_list_get_n (list, 0);
+	mu_assert_eq (ref->addr, 0x20, "ref to");
+	r_list_free (list);
+
+	mu_assert_null (r_anal_xrefs_get (anal, 0x30), "no xrefs");
+	r_anal_free (anal);
+	mu_end;
+}
+
+bool test_r_anal_xrefs_del() {
+	RAnal *anal = anal_new ();
+	r_anal_xrefs_set (anal, 0x10, 0x20, R_ANAL_REF_TYPE_CALL);
+	r_anal_xrefs_set (anal, 0x18, 0x20, R_ANAL_REF_TYPE_CALL);
+	r_anal_xrefs_set (anal, 0x10, 0x30, R_ANAL_REF_TYPE_DATA);
+	r_anal_xrefs_set (anal, 0x18, 0x40, R_ANAL_REF_TYPE_DATA);
+	// every ref from 0x10 and every xref to 0x20 go away
+	r_anal_xref_del (anal, 0x10, 0x20);
+	mu_assert_null (r_anal_refs_get (anal, 0x10), "refs from the source deleted");
+	mu_assert_null (r_anal_xrefs_get (anal, 0x20), "xrefs to the target deleted");
+
+	RList *list = r_anal_xrefs_get (anal, 0x30);
+	mu_assert_eq (r_list_length (list), 1, "xref of the other ref kept");
+	r_list_free (list);
+	list = r_anal_refs_get (anal, 0x18);
+	mu_assert_eq (r_list_length (list), 2, "refs of the other source kept");
+	RAnalRef *ref = r_list_get_n (list, 0);
+	mu_assert_eq (ref->addr, 0x20, "ref to");
+	r_list_free (list);
+	mu_assert_eq (r_anal_xrefs_count (anal), 2, "xrefs count");
+
+	r_anal_xrefs_deln (anal, 0x18, 0x40, R_ANAL_REF_TYPE_DATA);
+	mu_assert_null (r_anal_refs_get (anal, 0x18), "all refs deleted");
+	mu_assert_null (r_anal_xrefs_get (anal, 0x40), "xref deleted");
+	r_anal_free (anal);
+	mu_end;
+}
+
+bool test_r_anal_xrefs_del_pages() {
+	RAnal *anal = anal_new ();
+	ut64 i;
+	// the refs of a source span several pages
+	for (i = 0; i < 1000; i++) {
+		r_anal_xrefs_set (anal, 0x100, 0x1000 + i, R_ANAL_REF_TYPE_CODE);
+		r_anal_xrefs_set (anal, 0x80 + (i % 2) * 0x100, 0x5000 + i, R_ANAL_REF_TYPE_CODE);
+	}
+	r_anal_xrefs_deln (anal, 0x100, 0x1000, R_ANAL_REF_TYPE_CODE);
+	mu_assert_null (r_anal_refs_get (anal, 0x100), "refs deleted");
+	RList *list = r_anal_refs_get (anal, 0x80);
+	mu_assert_eq (r_list_length (list), 500, "refs before kept");
+	r_list_free (list);
+	list = r_anal_refs_get (anal, 0x180);
+	mu_assert_eq (r_list_length (list), 500, "refs after kept");
+	r_list_free (list);
+	r_anal_free (anal);
+	mu_end;
+}
+
+bool test_r_anal_xrefs_range() {
+	RAnal *anal = anal_new ();
+	ut64 i;
+	// enough refs to span several pages, inserted out of order
+	for (i = 0; i < 3000; i++) {
+		ut64 to = 0x1000 + (i * 7919) % 3000;
+		r_anal_xrefs_set (anal, 0x100000 + i, to, R_ANAL_REF_TYPE_CODE);
+	}
+	mu_assert_eq (r_anal_xrefs_count (anal), 3000, "xrefs count");
+
+	RList *list = r_list_newf (free);
+	r_anal_xrefs_foreach_in (anal, 0x1100, 0x1200, collect_cb, list);
+	mu_assert_eq (r_list_length (list), 0x100, "xrefs in range");
+	RListIter *iter;
+	RAnalRef *ref;
+	ut64 addr = 0x1100;
+	r_list_foreach (list, iter, ref) {
+		mu_assert_eq (ref->addr, addr, "xrefs sorted by address");
+		addr++;
+	}
+	r_list_purge (list);
+
+	r_anal_refs_foreach_in (anal, 0x100000, 0x100010, collect_cb, list);
+	mu_assert_eq (r_list_length (list), 0x10, "refs in range");
+	r_list_free (list);
+	r_anal_free (anal);
+	mu_end;
+}
+
+bool all_tests() {
+	mu_run_test (test_r_anal_xrefs_set_get);
+	mu_run_test (test_r_anal_xrefs_del);
+	mu_run_test (test_r_anal_xrefs_del_pages);
+	mu_run_test (test_r_anal_xrefs_range);
+	return tests_passed != tests_run;
+}
+
+int main(int argc, char **argv) {
+	return all_tests();
+}
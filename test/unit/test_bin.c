@@ -22,9 +22,99 @@ bool test_r_bin(void) {
 	mu_end;
 }
 
+// R_STRING_SCAN_CHUNK in libr/bin/bfile.c
+#define STRING_SCAN_CHUNK (4 * 1024 * 1024)
+
+static int put_string(ut8 *buf, int at, const char *s, int width) {
+	int i, len = strlen (s);
+	for (i = 0; i < len; i++) {
+		buf[at + i * width] = s[i];
+	}
+	return len * width;
+}
+
+static RList *raw_strings(const ut8 *data, int len, int jobs) {
+	RBin *bin = r_bin_new ();
+	bin->strjobs = jobs;
+	RBinOptions opt;
+	r_bin_options_init (&opt, -1, 0, 0, false);
+	opt.filename = "strings";
+	RBuffer *b = r_buf_new_with_bytes (data, len);
+	RList *list = NULL;
+	if (r_bin_open_buf (bin, b, &opt)) {
+		list = r_bin_raw_strings (r_bin_cur (bin), 4);
+	}
+	r_buf_free (b);
+	r_bin_free (bin);
+	return list;
+}
+
+bool test_r_bin_strings_jobs(void) {
+	const int len = 7 * STRING_SCAN_CHUNK - 100;
+	ut8 *buf = malloc (len);
+	mu_assert_notnull (buf, "buffer");
+	ut32 seed = 1;
+	int i, at;
+	// binary noise with zero runs of 64KB and strings in it
+	for (i = 0; i < len; i++) {
+		seed = seed * 1103515245 + 12345;
+		buf[i] = (i / 0x10000) % 3? (seed >> 16) & 0xff: 0;
+	}
+	for (at = 0x100; at < len - 0x1000; at += 0x2345) {
+		put_string (buf, at, "plain ascii string", 1);
+	}
+	// ascii, utf16 and utf32 strings straddling the chunk boundaries at
+	// different offsets, and strings longer than the scan buffer
+	char longstr[3000];
+	memset (longstr, 'L', sizeof (longstr) - 1);
+	longstr[sizeof (longstr) - 1] = 0;
+	const char *s = "straddling string";
+	const int width[] = { 1, 2, 4 };
+	for (i = 1; i < 7; i++) {
+		const int cb = i * STRING_SCAN_CHUNK;
+		memset (buf + cb - 0x1000, 0, 0x2000);
+		if (i % 4 == 3) {
+			put_string (buf, cb - 2500, longstr, 1);
+		} else {
+			const int w = width[i % 3];
+			put_string (buf, cb - 1 - (i * 7) % (strlen (s) * w), s, w);
+		}
+	}
+	RList *serial = raw_strings (buf, len, 1);
+	RList *parallel = raw_strings (buf, len, 4);
+	mu_assert ("strings found", r_list_length (serial) > 1000);
+	mu_assert_eq (r_list_length (parallel), r_list_length (serial), "same number of strings");
+	RListIter *a = r_list_iterator (serial), *b = r_list_iterator (parallel);
+	ut64 end = 0;
+	int straddled = 0;
+	for (; a && b; a = a->n, b = b->n) {
+		RBinString *sa = a->data, *sb = b->data;
+		char msg[128];
+		snprintf (msg, sizeof (msg), "string at 0x%"PFMT64x, sa->paddr);
+		mu_assert (msg, sa->paddr == sb->paddr && sa->ordinal == sb->ordinal
+			&& sa->size == sb->size && sa->length == sb->length
+			&& sa->type == sb->type && !strcmp (sa->string, sb->string));
+		// both scan in chunks, a string found twice or cut in two at a chunk shows up here
+		mu_assert (msg, sa->paddr >= end);
+		end = sa->paddr + sa->size;
+		if (!strcmp (sa->string, s) && sa->paddr / STRING_SCAN_CHUNK != (end - 1) / STRING_SCAN_CHUNK) {
+			straddled++;
+		}
+	}
+	mu_assert_eq (straddled, 5, "strings across the chunks");
+	// no more jobs than chunks are started, each one holds a chunk buffer
+	RList *many = raw_strings (buf, len, 100000);
+	mu_assert_eq (r_list_length (many), r_list_length (serial), "same number of strings with more jobs than chunks");
+	r_list_free (many);
+	r_list_free (serial);
+	r_list_free (parallel);
+	free (buf);
+	mu_end;
+}
 
 bool all_tests() {
 	mu_run_test(test_r_bin);
+	mu_run_test(test_r_bin_strings_jobs);
 	return tests_passed != tests_run;
 }
 
@@ -0,0 +1,157 @@
+#include <r_bp.h>
+#include <r_debug.h>
+#include "minunit.h"
+
+static ut8 mem[0x3000];
+static int writes;
+
+static bool mem_read_at(RIO *io, ut64 addr, ut8 *buf, int len) {
+	if (addr + len > sizeof (mem)) {
+		return false;
+	}
+	memcpy (buf, mem + addr, len);
+	return true;
+}
+
+static bool mem_write_at(RIO *io, ut64 addr, const ut8 *buf, int len) {
+	if (addr + len > sizeof (mem)) {
+		return false;
+	}
+	memcpy (mem + addr, buf, len);
+	writes++;
+	return true;
+}
+
+static RBreakpoint *bp_new_mem(void) {
+	RBreakpoint *bp = r_bp_new ();
+	r_bp_use (bp, "x86", 64);
+	bp->iob.io = (RIO *)mem;
+	bp->iob.read_at = mem_read_at;
+	bp->iob.write_at = mem_write_at;
+	int i;
+	for (i = 0; i < sizeof (mem); i++) {
+		mem[i] = i & 0xff;
+	}
+	return bp;
+}
+
+bool test_r_bp_get(void) {
+	RBreakpoint *bp = bp_new_mem ();
+	RBreakpointItem *a = r_bp_add_sw (bp, 0x100, 1, R_BP_PROT_EXEC);
+	RBreakpointItem *b = r_bp_add_hw (bp, 0x200, 8, R_BP_PROT_WRITE);
+	mu_assert_notnull (a, "sw bp added");
+	mu_assert_notnull (b, "hw bp added");
+	mu_assert_null (r_bp_add_sw (bp, 0x204, 1, R_BP_PROT_EXEC), "bp inside another one");
+
+	mu_assert_ptreq (r_bp_get_at (bp, 0x100), a, "get_at exact");
+	mu_assert_null (r_bp_get_at (bp, 0x204), "get_at only matches the start");
+	mu_assert_ptreq (r_bp_get_in (bp, 0x100, 0), a, "get_in exact");
+	mu_assert_ptreq (r_bp_get_in (bp, 0x204, 0), b, "get_in range");
+	mu_assert_ptreq (r_bp_get_in (bp, 0x207, R_BP_PROT_WRITE), b, "get_in last byte");
+	mu_assert_null (r_bp_get_in (bp, 0x208, 0), "get_in end is exclusive");
+	mu_assert_null (r_bp_get_in (bp, 0x101, 0), "get_in past a sw bp");
+
+	r_bp_item_set_addr (bp, b, 0x300);
+	mu_assert_null (r_bp_get_in (bp, 0x204, 0), "moved away");
+	mu_assert_ptreq (r_bp_get_in (bp, 0x304, 0), b, "moved here");
+
+	mu_assert ("del", r_bp_del (bp, 0x100));
+	mu_assert_null (r_bp_get_at (bp, 0x100), "deleted");
+	mu_assert_null (r_bp_get_in (bp, 0x100, 0), "deleted");
+	mu_assert ("del again", !r_bp_del (bp, 0x100));
+
+	r_bp_del_all (bp);
+	mu_assert_null (r_bp_get_in (bp, 0x304, 0), "all deleted");
+	mu_assert_notnull (r_bp_add_sw (bp, 0x304, 1, R_BP_PROT_EXEC), "add after del_all");
+	mu_assert_notnull (r_bp_get_at (bp, 0x304), "found after del_all");
+	r_bp_free (bp);
+	mu_end;
+}
+
+bool test_r_bp_restore(void) {
+	RBreakpoint *bp = bp_new_mem ();
+	r_bp_add_sw (bp, 0x1010, 1, R_BP_PROT_EXEC);
+	r_bp_add_sw (bp, 0x1000, 1, R_BP_PROT_EXEC);
+	r_bp_add_sw (bp, 0x1ff0, 1, R_BP_PROT_EXEC);
+	r_bp_add_sw (bp, 0x2000, 1, R_BP_PROT_EXEC);
+	r_bp_add_sw (bp, 0x10, 1, R_BP_PROT_EXEC);
+	r_bp_enable (bp, 0x1ff0, false, 0);
+
+	writes = 0;
+	r_bp_restore (bp, true);
+	mu_assert_eq (writes, 3, "one write per page");
+	mu_assert_eq (mem[0x10], 0xcc, "bp set");
+	mu_assert_eq (mem[0x1000], 0xcc, "bp set");
+	mu_assert_eq (mem[0x1008], 0x08, "gap preserved");
+	mu_assert_eq (mem[0x1010], 0xcc, "bp set");
+	mu_assert_eq (mem[0x1ff0], 0xf0, "disabled bp not set");
+	mu_assert_eq (mem[0x2000], 0xcc, "bp set");
+
+	writes = 0;
+	r_bp_restore (bp, false);
+	mu_assert_eq (writes, 3, "one write per page");
+	mu_assert_eq (mem[0x10], 0x10, "bp unset");
+	mu_assert_eq (mem[0x1000], 0x00, "bp unset");
+	mu_assert_eq (mem[0x1010], 0x10, "bp unset");
+	mu_assert_eq (mem[0x2000], 0x00, "bp unset");
+
+	r_bp_restore_except (bp, true, 0x1000);
+	mu_assert_eq (mem[0x1000], 0x00, "excluded bp not set");
+	mu_assert_eq (mem[0x1010], 0xcc, "bp set");
+	r_bp_free (bp);
+	mu_end;
+}
+
+static RList *restored;
+
+static int bp_plugin_cb(RBreakpoint *bp, RBreakpointItem *b, bool set) {
+	r_list_append (restored, b);
+	return b->hw;
+}
+
+bool test_r_bp_rebase(void) {
+	RDebug *dbg = r_debug_new (true);
+	RBreakpoint *bp = bp_new_mem ();
+	r_bp_free (dbg->bp);
+	dbg->bp = bp;
+	RBreakpointItem *a = r_bp_add_sw (bp, 0x100, 1, R_BP_PROT_EXEC);
+	RBreakpointItem *b = r_bp_add_hw (bp, 0x1100, 8, R_BP_PROT_WRITE);
+	RBreakpointItem *c = r_bp_add_sw (bp, 0x10, 1, R_BP_PROT_EXEC);
+
+	// a lands where b was before b moves away
+	r_debug_bp_rebase (dbg, 0, 0x1000);
+	mu_assert_eq (a->addr, 0x1100, "a moved");
+	mu_assert_eq (b->addr, 0x2100, "b moved");
+	mu_assert_ptreq (r_bp_get_at (bp, 0x1100), a, "get_at new address");
+	mu_assert_null (r_bp_get_at (bp, 0x100), "get_at old address");
+	mu_assert_ptreq (r_bp_get_in (bp, 0x2104, 0), b, "get_in new range");
+	mu_assert_null (r_bp_get_in (bp, 0x1104, 0), "get_in old range");
+	mu_assert_ptreq (r_bp_get_at (bp, 0x1010), c, "get_at new address");
+
+	mu_assert ("del at new address", r_bp_del (bp, 0x1100));
+	mu_assert_null (r_bp_get_in (bp, 0x1100, 0), "deleted");
+	mu_assert_ptreq (r_bp_get_in (bp, 0x2107, 0), b, "others kept");
+
+	// plugins see the breakpoints in the order they were added
+	restored = r_list_new ();
+	bp->breakpoint = bp_plugin_cb;
+	r_bp_restore (bp, true);
+	mu_assert_eq (r_list_length (restored), 2, "all restored");
+	mu_assert_ptreq (r_list_get_n (restored, 0), b, "insertion order");
+	mu_assert_ptreq (r_list_get_n (restored, 1), c, "insertion order");
+	mu_assert_eq (mem[0x1010], 0xcc, "sw bp set");
+	r_list_free (restored);
+	r_debug_free (dbg);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test (test_r_bp_get);
+	mu_run_test (test_r_bp_restore);
+	mu_run_test (test_r_bp_rebase);
+	return tests_passed != tests_run;
+}
+
+int main(int argc, char **argv) {
+	return all_tests();
+}
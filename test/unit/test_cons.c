@@ -118,8 +118,50 @@ bool test_r_cons() {
 	mu_end;
 }
 
+bool test_r_cons_grep_stream() {
+	const char *text = "mov eax, 1\npush rbp\nmov ebx, 2\npush rax\nret\n";
+	RConsStream s = {0};
+	s.grep.sort = -1;
+	mu_assert ("words can be streamed", r_cons_grep_stream_parse (&s.grep, "mov"));
+	RStrBuf *ob = r_strbuf_new (NULL);
+	// feed it a few bytes at a time, partial lines must be left alone
+	int off = 0, end = 0, len = strlen (text);
+	while (end < len) {
+		end = R_MIN (end + 7, len);
+		int n = r_cons_grep_stream (&s, text + off, end - off, ob);
+		mu_assert ("consumed", n >= 0 && off + n <= end);
+		off += n;
+	}
+	mu_assert_eq (off, len, "all lines consumed");
+	mu_assert_streq (r_strbuf_get (ob), "mov eax, 1\nmov ebx, 2\n", "filtered");
+	mu_assert_eq (s.lines, 2, "matched lines");
+	r_strbuf_free (ob);
+	free (s.grep.str);
+
+	memset (&s, 0, sizeof (s));
+	s.grep.sort = -1;
+	mu_assert ("columns of a line range", r_cons_grep_stream_parse (&s.grep, "push[1]:1"));
+	ob = r_strbuf_new (NULL);
+	r_cons_grep_stream (&s, text, len, ob);
+	mu_assert_streq (r_strbuf_get (ob), "rax\n", "second push, second column");
+	r_strbuf_free (ob);
+	free (s.grep.str);
+
+	const char *buffered[] = { "mov?", "$", "{}", "mov:-1", "..", NULL };
+	int i;
+	for (i = 0; buffered[i]; i++) {
+		RConsGrep g = {0};
+		g.sort = -1;
+		mu_assert (buffered[i], !r_cons_grep_stream_parse (&g, buffered[i]));
+		free (g.str);
+		free (g.json_path);
+	}
+	mu_end;
+}
+
 bool all_tests() {
 	mu_run_test (test_r_cons);
+	mu_run_test (test_r_cons_grep_stream);
 	return tests_passed != tests_run;
 }
 
@@ -0,0 +1,141 @@
+#include <r_debug.h>
+#include <r_io.h>
+#include "minunit.h"
+
+#define MAP_ADDR 0x10000
+#define MAP_SIZE (3 * SNAP_PAGE_SIZE + 0x123)
+#define PAGE(i) (MAP_ADDR + (i) * SNAP_PAGE_SIZE)
+
+static RIO *io;
+
+static RDebug *snap_debug(void) {
+	io = r_io_new ();
+	io->va = true;
+	RDebug *dbg = r_debug_new (true);
+	// the io goes past the map, to catch writes after its partial last page
+	r_io_open_at (io, "malloc://0x8000", R_PERM_RW, 0644, MAP_ADDR);
+	r_io_bind (io, &dbg->iob);
+	r_list_append (dbg->maps, r_debug_map_new ("snap", MAP_ADDR, MAP_ADDR + MAP_SIZE, R_PERM_RW, 0));
+	return dbg;
+}
+
+static void snap_debug_free(RDebug *dbg) {
+	r_debug_free (dbg);
+	r_io_free (io);
+}
+
+static void fill(ut64 addr, ut8 b, int len) {
+	ut8 *buf = malloc (len);
+	memset (buf, b, len);
+	r_io_write_at (io, addr, buf, len);
+	free (buf);
+}
+
+static bool mem_is(const ut8 *expected, int len) {
+	ut8 *buf = malloc (len);
+	r_io_read_at (io, MAP_ADDR, buf, len);
+	bool ret = !memcmp (buf, expected, len);
+	free (buf);
+	return ret;
+}
+
+static RPageData *diff_page(RDebugSnapDiff *diff, ut32 page_off) {
+	RListIter *iter;
+	RPageData *page;
+	r_list_foreach (diff->pages, iter, page) {
+		if (page->page_off == page_off) {
+			return page;
+		}
+	}
+	return NULL;
+}
+
+bool test_debug_snap_pages(void) {
+	RDebug *dbg = snap_debug ();
+	RDebugMap *map = r_debug_map_get (dbg, MAP_ADDR);
+	const int len = MAP_SIZE + 0x10;
+	ut8 *base = malloc (len);
+	ut8 *first = malloc (len);
+
+	// two identical pages, another one and the partial last page
+	fill (PAGE (0), 'A', 2 * SNAP_PAGE_SIZE);
+	fill (PAGE (2), 'B', SNAP_PAGE_SIZE);
+	fill (PAGE (3), 'C', 0x123);
+	fill (MAP_ADDR + MAP_SIZE, 'Z', 0x10);
+	r_io_read_at (io, MAP_ADDR, base, len);
+	mu_assert_null (r_debug_snap_map (dbg, map), "the first snapshot is the base");
+	RDebugSnap *snap = r_debug_snap_get (dbg, MAP_ADDR);
+	mu_assert_notnull (snap, "base snapshot");
+	mu_assert_eq (snap->page_num, 4, "pages");
+
+	// the same contents in two pages are stored once
+	fill (PAGE (0), 'X', SNAP_PAGE_SIZE);
+	fill (PAGE (2), 'X', SNAP_PAGE_SIZE);
+	r_io_read_at (io, MAP_ADDR, first, len);
+	RDebugSnapDiff *d1 = r_debug_snap_map (dbg, map);
+	mu_assert_notnull (d1, "first diff");
+	mu_assert_eq (r_list_length (d1->pages), 2, "changed pages");
+	RPageData *p0 = diff_page (d1, 0);
+	RPageData *p2 = diff_page (d1, 2);
+	mu_assert ("both pages saved", p0 && p2);
+	mu_assert_ptreq (p0->page, p2->page, "shared page");
+	mu_assert_eq (p0->page->refs, 2, "page refs");
+	mu_assert_eq (dbg->snap_pages->count, 1, "stored pages");
+
+	// and across snapshots, the partial last page is padded
+	fill (PAGE (1), 'X', SNAP_PAGE_SIZE);
+	fill (PAGE (3), 'D', 0x123);
+	RDebugSnapDiff *d2 = r_debug_snap_map (dbg, map);
+	mu_assert_notnull (d2, "second diff");
+	mu_assert_eq (r_list_length (d2->pages), 2, "changed pages");
+	RPageData *p1 = diff_page (d2, 1);
+	RPageData *p3 = diff_page (d2, 3);
+	mu_assert ("both pages saved", p1 && p3);
+	mu_assert_ptreq (p1->page, p0->page, "shared with the first diff");
+	mu_assert_eq (p0->page->refs, 3, "page refs");
+	mu_assert_eq (p3->data[0x122], 'D', "last byte");
+	mu_assert_eq (p3->data[0x123], 0, "padding");
+	mu_assert_eq (dbg->snap_pages->count, 2, "stored pages");
+	mu_assert_ptreq (d2->last_changes[0], p0, "inherited change");
+
+	// restore the first diff, then the base, over changes not in any snapshot
+	fill (PAGE (2), 'Y', 0x20);
+	fill (PAGE (3) + 0x100, 'Y', 0x23);
+	r_debug_diff_set (dbg, d1);
+	mu_assert ("first diff restored", mem_is (first, len));
+	fill (PAGE (1) + 0x10, 'Y', 0x20);
+	r_debug_diff_set_base (dbg, snap);
+	mu_assert ("base restored", mem_is (base, len));
+
+	free (base);
+	free (first);
+	snap_debug_free (dbg);
+	mu_end;
+}
+
+bool test_debug_snap_free_pages(void) {
+	RDebug *dbg = snap_debug ();
+	RDebugMap *map = r_debug_map_get (dbg, MAP_ADDR);
+	fill (PAGE (0), 'A', MAP_SIZE);
+	r_debug_snap_map (dbg, map);
+	fill (PAGE (0), 'X', SNAP_PAGE_SIZE);
+	fill (PAGE (1), 'X', SNAP_PAGE_SIZE);
+	fill (PAGE (2), 'Y', SNAP_PAGE_SIZE);
+	mu_assert_notnull (r_debug_snap_map (dbg, map), "diff");
+	mu_assert_eq (dbg->snap_pages->count, 2, "stored pages");
+	// deleting the snapshot drops its pages from the store
+	r_debug_snap_delete (dbg, 0);
+	mu_assert_eq (dbg->snap_pages->count, 0, "no stored pages");
+	snap_debug_free (dbg);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test (test_debug_snap_pages);
+	mu_run_test (test_debug_snap_free_pages);
+	return tests_passed != tests_run;
+}
+
+int main(int argc, char **argv) {
+	return all_tests();
+}
@@ -0,0 +1,287 @@
+#include <r_anal.h>
+#include <r_io.h>
+#include "minunit.h"
+
+static const char *profile =
+	"=PC pc\n"
+	"=SP sp\n"
+	"gpr a .64 0 0\n"
+	"gpr b .64 8 0\n"
+	"gpr c .64 16 0\n"
+	"gpr d .64 24 0\n"
+	"gpr sp .64 32 0\n"
+	"gpr pc .64 40 0\n"
+	"gpr zf .1 .384 0\n"
+	"gpr cf .1 .385 0\n"
+	"gpr sf .1 .386 0\n"
+	"gpr of .1 .387 0\n"
+	"gpr pf .1 .388 0\n";
+
+static const char *regs[] = { "a", "b", "c", "d", "sp", "pc", "zf", "cf", "sf", "of", "pf" };
+
+typedef struct {
+	RAnal *anal;
+	RIO *io;
+	RAnalEsil *esil;
+} EsilEnv;
+
+static void env_init(EsilEnv *env) {
+	env->anal = r_anal_new ();
+	r_reg_set_profile_string (env->anal->reg, profile);
+	env->io = r_io_new ();
+	r_io_open_at (env->io, "malloc://0x1000", R_PERM_RW, 0644, 0);
+	r_io_bind (env->io, &env->anal->iob);
+	env->esil = r_anal_esil_new (64, 0, 1);
+	r_anal_esil_setup (env->esil, env->anal, 0, 0, 0);
+}
+
+static void env_fini(EsilEnv *env) {
+	r_anal_esil_free (env->esil);
+	r_io_free (env->io);
+	r_anal_free (env->anal);
+}
+
+static bool esil_cached(EsilEnv *env) {
+	return ht_up_find (env->esil->code, env->esil->address, NULL);
+}
+
+static bool dbl(RAnalEsil *esil) {
+	ut64 n = 0;
+	char *src = r_anal_esil_pop (esil);
+	bool ret = src && r_anal_esil_get_parm (esil, src, &n);
+	free (src);
+	return ret && r_anal_esil_pushnum (esil, n * 2);
+}
+
+/* runs expr twice through the compiled words and through the string
+ * parser, then compares the registers, memory, traps and stack */
+static bool esil_same(const char *expr) {
+	EsilEnv c, s;
+	env_init (&c);
+	env_init (&s);
+	r_anal_esil_set_op (c.esil, "DBL", dbl, 1, 1, R_ANAL_ESIL_OP_TYPE_MATH);
+	r_anal_esil_set_op (s.esil, "DBL", dbl, 1, 1, R_ANAL_ESIL_OP_TYPE_MATH);
+	c.esil->address = s.esil->address = 0x100;
+	// a trailing comma is only understood by the string parser
+	char *sexpr = r_str_newf ("%s,", expr);
+	bool ret = true;
+	int i;
+	for (i = 0; i < 2; i++) {
+		ret &= r_anal_esil_parse (c.esil, expr) == r_anal_esil_parse (s.esil, sexpr);
+		ret &= c.esil->trap == s.esil->trap;
+	}
+	ret &= esil_cached (&c) && !esil_cached (&s);
+	for (i = 0; i < R_ARRAY_SIZE (regs); i++) {
+		ret &= r_reg_getv (c.anal->reg, regs[i]) == r_reg_getv (s.anal->reg, regs[i]);
+	}
+	ut8 cmem[0x400], smem[0x400];
+	r_io_read_at (c.io, 0, cmem, sizeof (cmem));
+	r_io_read_at (s.io, 0, smem, sizeof (smem));
+	ret &= !memcmp (cmem, smem, sizeof (cmem));
+	ret &= c.esil->stackptr == s.esil->stackptr;
+	while (ret && c.esil->stackptr > 0) {
+		char *a = r_anal_esil_pop (c.esil);
+		char *b = r_anal_esil_pop (s.esil);
+		ret &= a && b && !strcmp (a, b);
+		free (a);
+		free (b);
+	}
+	free (sexpr);
+	env_fini (&c);
+	env_fini (&s);
+	return ret;
+}
+
+bool test_esil_arith(void) {
+	mu_assert ("mov", esil_same ("3,a,=,0x50,b,=,-1,c,="));
+	mu_assert ("ops", esil_same ("3,a,=,5,b,=,a,b,*,c,=,7,c,+=,2,c,<<=,3,c,%,d,=,2,b,/=,a,!,c,^=,b,--=,a,++="));
+	mu_assert ("shifts", esil_same ("0x8000000000000001,a,=,1,a,>>>,b,=,4,a,<<<,c,=,63,a,>>>>,d,=,1,a,>>=,4,a,|=,0xf0,a,&="));
+	mu_assert ("stack", esil_same ("1,2,a,+,b,DUP,SWAP,3,POP"));
+	mu_assert ("weak", esil_same ("0x1234,a,:=,a,b,=,b,c,-,d,=,d,sp,^"));
+	mu_end;
+}
+
+bool test_esil_flags(void) {
+	mu_assert ("zero", esil_same ("5,a,=,5,b,=,a,b,-=,$z,zf,:=,63,$s,sf,:=,64,$b,cf,:=,63,$o,of,:=,$p,pf,:="));
+	mu_assert ("borrow", esil_same ("3,a,=,5,b,=,b,a,-=,$z,zf,:=,63,$s,sf,:=,64,$b,cf,:=,63,$o,of,:="));
+	mu_assert ("carry", esil_same ("0xffffffffffffffff,a,=,1,a,+=,63,$c,cf,:=,$z,zf,:="));
+	mu_assert ("cmp", esil_same ("3,a,=,a,3,==,$z,zf,:=,a,4,<,b,=,a,2,>=,c,="));
+	mu_end;
+}
+
+bool test_esil_mem(void) {
+	mu_assert ("poke peek", esil_same ("0x1122334455667788,0x100,=[8],0x100,[4],a,=,0xff,0x104,=[1],0x100,[8],b,=,0x200,c,=,a,c,=[2],c,[2],sp,="));
+	mu_assert ("mem ops", esil_same ("0xf0f0,0x80,=[2],0x0f,0x80,|=[1],0xff,0x81,^=[1],0x80,[2],a,=,0x80,[],b,="));
+	mu_assert ("push", esil_same ("0x300,sp,=,8,sp,-=,0xdead,sp,=[8],sp,[8],a,=,8,sp,+="));
+	mu_end;
+}
+
+bool test_esil_flow(void) {
+	mu_assert ("if", esil_same ("1,a,=,a,?{,2,b,=,},0,?{,3,c,=,}"));
+	mu_assert ("else", esil_same ("0,?{,1,a,=,}{,2,a,=,},1,?{,3,b,=,}{,4,b,=,}"));
+	mu_assert ("goto loop", esil_same ("0,a,=,1,a,+=,a,5,==,$z,!,?{,3,GOTO,},a,b,="));
+	mu_assert ("break", esil_same ("0,b,=,b,++=,b,3,==,$z,?{,BREAK,},3,GOTO,9,b,="));
+	mu_assert ("todo", esil_same ("1,a,=,TODO,2,a,="));
+
+	EsilEnv env;
+	env_init (&env);
+	r_anal_esil_parse (env.esil, "0,a,=,1,a,+=,a,5,==,$z,!,?{,3,GOTO,},a,b,=");
+	mu_assert_eq (r_reg_getv (env.anal->reg, "b"), 5, "looped");
+	r_anal_esil_parse (env.esil, "0,b,=,b,++=,b,3,==,$z,?{,BREAK,},3,GOTO,9,b,=");
+	mu_assert_eq (r_reg_getv (env.anal->reg, "b"), 3, "broke out");
+	env_fini (&env);
+	mu_end;
+}
+
+bool test_esil_cache(void) {
+	EsilEnv env;
+	env_init (&env);
+	RAnalEsil *esil = env.esil;
+	RReg *reg = env.anal->reg;
+
+	// same address, different bytes
+	esil->address = 0x10;
+	r_anal_esil_parse (esil, "1,a,=");
+	r_anal_esil_parse (esil, "2,a,=");
+	mu_assert_eq (r_reg_getv (reg, "a"), 2, "new expression at the same address");
+	esil->address = 0x20;
+	r_anal_esil_parse (esil, "3,a,=");
+	mu_assert_eq (r_reg_getv (reg, "a"), 3, "other address");
+	esil->address = 0x10;
+	r_anal_esil_parse (esil, "2,a,=");
+	mu_assert_eq (r_reg_getv (reg, "a"), 2, "back to the first address");
+	mu_assert ("cached", esil_cached (&env));
+
+	// ops added after the code was compiled
+	r_anal_esil_parse (esil, "4,DBL,b,=");
+	mu_assert_eq (r_reg_getv (reg, "b"), 0, "unknown word");
+	r_anal_esil_set_op (esil, "DBL", dbl, 1, 1, R_ANAL_ESIL_OP_TYPE_MATH);
+	r_anal_esil_parse (esil, "4,DBL,b,=");
+	mu_assert_eq (r_reg_getv (reg, "b"), 8, "new op");
+
+	// new register profile
+	r_anal_esil_parse (esil, "5,c,=");
+	r_reg_set_profile_string (reg, "=PC pc\ngpr pc .64 0 0\ngpr c .32 8 0\n");
+	r_anal_esil_parse (esil, "5,c,=");
+	mu_assert_eq (r_reg_getv (reg, "c"), 5, "new profile");
+	mu_assert_eq (r_reg_get (reg, "c", -1)->offset, 64, "register moved");
+
+	// expressions the compiled words don't handle
+	esil->address = 0x30;
+	r_anal_esil_parse (esil, "6,c,=,");
+	mu_assert_eq (r_reg_getv (reg, "c"), 6, "string parser");
+	mu_assert ("not cached", !esil_cached (&env));
+	env_fini (&env);
+	mu_end;
+}
+
+/* traces n instructions at a few addresses, each reading and writing
+ * registers and memory */
+static void trace_record(EsilEnv *env, int n) {
+	RAnalOp op;
+	int i;
+	for (i = 0; i < n; i++) {
+		r_anal_op_init (&op);
+		op.addr = 0x100 + (i % 3) * 4;
+		r_strbuf_setf (&op.esil, "%d,a,+=,a,b,=,a,0x%x,=[4],0x200,[4],c,=", i + 1, 0x200 + (i % 2) * 4);
+		r_anal_esil_trace (env->esil, &op);
+		r_anal_op_fini (&op);
+	}
+}
+
+static bool trace_same_step(EsilEnv *x, EsilEnv *y, int idx) {
+	RAnalEsilTraceStep *a = r_anal_esil_trace_step (x->esil, idx);
+	RAnalEsilTraceStep *b = r_anal_esil_trace_step (y->esil, idx);
+	if (!a || !b || a->idx != b->idx || a->addr != b->addr) {
+		return false;
+	}
+	bool ret = true;
+	int type;
+	for (type = R_ANAL_ESIL_TRACE_REG_READ; type <= R_ANAL_ESIL_TRACE_MEM_WRITE; type++) {
+		char *ra = r_anal_esil_trace_regs (x->esil, idx, type);
+		char *rb = r_anal_esil_trace_regs (y->esil, idx, type);
+		ret &= ra && rb && !strcmp (ra, rb);
+		free (ra);
+		free (rb);
+	}
+	RAnalEsilTraceAccess *wa = r_anal_esil_trace_access (x->esil, idx, R_ANAL_ESIL_TRACE_REG_WRITE, "b");
+	RAnalEsilTraceAccess *wb = r_anal_esil_trace_access (y->esil, idx, R_ANAL_ESIL_TRACE_REG_WRITE, "b");
+	ret &= wa && wb && wa->value == wb->value;
+	wa = r_anal_esil_trace_access (x->esil, idx, R_ANAL_ESIL_TRACE_MEM_WRITE, NULL);
+	wb = r_anal_esil_trace_access (y->esil, idx, R_ANAL_ESIL_TRACE_MEM_WRITE, NULL);
+	ret &= wa && wb && wa->addr == wb->addr && wa->size == wb->size;
+	if (ret) {
+		const ut8 *da = r_anal_esil_trace_data (x->esil, wa);
+		const ut8 *db = r_anal_esil_trace_data (y->esil, wb);
+		ret &= da && db && !memcmp (da, db, wa->size);
+	}
+	return ret;
+}
+
+bool test_esil_trace(void) {
+	EsilEnv ref, bounded, loaded;
+	char *file = r_file_temp ("esiltrace");
+	char *spill = r_file_temp ("esilspill");
+	int i;
+	env_init (&ref);
+	trace_record (&ref, 10);
+	mu_assert_eq (r_reg_getv (ref.anal->reg, "b"), 55, "traced code runs");
+	mu_assert_eq (r_anal_esil_trace_step (ref.esil, 4)->addr, 0x104, "step address");
+
+	// replay a saved trace
+	mu_assert ("save", r_anal_esil_trace_save (ref.esil, file));
+	env_init (&loaded);
+	mu_assert ("load", r_anal_esil_trace_load (loaded.esil, file));
+	for (i = 0; i < 10; i++) {
+		mu_assert ("same step", trace_same_step (&ref, &loaded, i));
+	}
+	mu_assert_eq (loaded.esil->trace_idx, 10, "next step index");
+	env_fini (&loaded);
+
+	// the bounded trace spills its oldest steps
+	env_init (&bounded);
+	bounded.anal->esil_trace_max = 4;
+	bounded.anal->esil_trace_spill = strdup (spill);
+	r_file_rm (spill);
+	trace_record (&bounded, 10);
+	mu_assert ("steps kept", bounded.esil->trace->steps.len <= 4);
+	mu_assert_null (r_anal_esil_trace_step (bounded.esil, 0), "dropped step");
+	mu_assert ("same last step", trace_same_step (&ref, &bounded, 9));
+
+	// the last steps followed by the spilled ones load in step order
+	mu_assert ("save", r_anal_esil_trace_save (bounded.esil, file));
+	int spill_len;
+	char *spilled = r_file_slurp (spill, &spill_len);
+	mu_assert ("spilled", spilled && spill_len > 0);
+	r_file_dump (file, (const ut8 *)spilled, spill_len, true);
+	env_init (&loaded);
+	mu_assert ("load", r_anal_esil_trace_load (loaded.esil, file));
+	mu_assert_eq (loaded.esil->trace->steps.len, 10, "all the steps");
+	for (i = 0; i < 10; i++) {
+		mu_assert ("same step", trace_same_step (&ref, &loaded, i));
+	}
+	mu_assert_eq (loaded.esil->trace_idx, 10, "next step index");
+	free (spilled);
+	env_fini (&loaded);
+	env_fini (&bounded);
+	env_fini (&ref);
+	r_file_rm (file);
+	r_file_rm (spill);
+	free (file);
+	free (spill);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test (test_esil_arith);
+	mu_run_test (test_esil_flags);
+	mu_run_test (test_esil_mem);
+	mu_run_test (test_esil_flow);
+	mu_run_test (test_esil_cache);
+	mu_run_test (test_esil_trace);
+	return tests_passed != tests_run;
+}
+
+int main(int argc, char **argv) {
+	return all_tests();
+}
@@ -127,10 +127,69 @@ bool test_r_flag_get_at() {
 	mu_end;
 }
 
+bool test_r_flag_set_batch(void) {
+	RFlag *flags = r_flag_new ();
+	RFlagItem *fi;
+	RFlagBatchItem items[] = {
+		{ .name = "sym.main", .offset = 0x1000, .size = 16 },
+		{ .name = "sym.exit", .offset = 0x800, .size = 4, .realname = "exit" },
+		{ .name = "sym.start", .offset = 0x1000, .size = 8 },
+		{ .name = "sym.exit", .offset = 0x2000, .size = 4 },
+		{ .name = "sym.foo", .offset = 0x3000, .size = 4 },
+	};
+
+	fi = r_flag_set (flags, "sym.start", 0x400, 0);
+	r_flag_item_set_realname (fi, "start");
+	fi = r_flag_set (flags, "sym.foo", 0x3000, 0);
+	r_flag_item_set_realname (fi, "foo");
+	int n = r_flag_set_batch (flags, items, 5);
+	mu_assert_eq (n, 5, "all the flags are set");
+	mu_assert_ptreq (items[1].item, items[3].item, "the same name is the same flag");
+
+	fi = r_flag_get (flags, "sym.exit");
+	mu_assert_notnull (fi, "cannot find 'sym.exit' flag");
+	mu_assert_eq (fi->offset, 0x2000, "the last offset of 'sym.exit' wins");
+	mu_assert_streq (fi->realname, "exit", "realname of 'sym.exit'");
+	mu_assert_null (r_flag_get_list (flags, 0x800), "no flag left at 0x800");
+	mu_assert_null (r_flag_get_list (flags, 0x400), "'sym.start' moved from 0x400");
+
+	const RList *list = r_flag_get_list (flags, 0x1000);
+	mu_assert_eq (r_list_length (list), 2, "two flags at 0x1000");
+	fi = r_flag_get_i (flags, 0x1000);
+	mu_assert_streq (fi->name, "sym.start", "last flag set at 0x1000 is on top");
+
+	// the same flags set one by one
+	RFlag *seq = r_flag_new ();
+	fi = r_flag_set (seq, "sym.start", 0x400, 0);
+	r_flag_item_set_realname (fi, "start");
+	fi = r_flag_set (seq, "sym.foo", 0x3000, 0);
+	r_flag_item_set_realname (fi, "foo");
+	int i;
+	for (i = 0; i < R_ARRAY_SIZE (items); i++) {
+		fi = r_flag_set (seq, items[i].name, items[i].offset, items[i].size);
+		if (items[i].realname) {
+			r_flag_item_set_realname (fi, items[i].realname);
+		}
+	}
+	const char *names[] = { "sym.main", "sym.exit", "sym.start", "sym.foo" };
+	for (i = 0; i < R_ARRAY_SIZE (names); i++) {
+		RFlagItem *a = r_flag_get (flags, names[i]);
+		RFlagItem *b = r_flag_get (seq, names[i]);
+		mu_assert_eq (a->offset, b->offset, "same offset as r_flag_set");
+		mu_assert_streq (a->realname, b->realname, "same realname as r_flag_set");
+	}
+	mu_assert_streq (r_flag_get (flags, "sym.start")->realname, "start", "a moved flag keeps its realname");
+	r_flag_free (seq);
+
+	r_flag_free (flags);
+	mu_end;
+}
+
 int all_tests() {
 	mu_run_test (test_r_flag_get_set);
 	mu_run_test (test_r_flag_by_spaces);
 	mu_run_test (test_r_flag_get_at);
+	mu_run_test (test_r_flag_set_batch);
 	return tests_passed != tests_run;
 }
 
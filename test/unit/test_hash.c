@@ -0,0 +1,134 @@
+#include <r_hash.h>
+#include "minunit.h"
+
+typedef struct {
+	const ut8 *data;
+	int reads;
+} HashSource;
+
+static bool source_read_at(void *user, ut64 addr, ut8 *buf, int len) {
+	HashSource *src = user;
+	memcpy (buf, src->data + addr, len);
+	src->reads++;
+	return true;
+}
+
+static void fill(ut8 *buf, int len) {
+	ut32 seed = 0x1234;
+	int i;
+	for (i = 0; i < len; i++) {
+		seed = seed * 1103515245 + 12345;
+		buf[i] = seed >> 16;
+	}
+}
+
+/* index of the context of algo in the array given to r_hash_calculate_range */
+static int algo_index(ut64 algo) {
+	int i = 0;
+	while (!(algo & (1ULL << i))) {
+		i++;
+	}
+	return i;
+}
+
+bool test_r_hash_calculate_range(void) {
+	const ut64 algos[] = {
+		R_HASH_MD5, R_HASH_SHA1, R_HASH_SHA256, R_HASH_SHA512,
+		R_HASH_CRC32, R_HASH_ADLER32, R_HASH_XOR, R_HASH_LUHN
+	};
+	const int jobs[] = { 1, 3, 8 };
+	// four blocks, the last one short
+	const int bsize = 1024;
+	const ut64 from = 100, to = from + 3 * bsize + 77;
+	ut8 data[8192];
+	RHash *ctx[R_HASH_NBITS] = {0};
+	ut64 algobit = 0;
+	int a, j;
+	fill (data, sizeof (data));
+	for (a = 0; a < R_ARRAY_SIZE (algos); a++) {
+		algobit |= algos[a];
+	}
+	for (j = 0; j < R_ARRAY_SIZE (jobs); j++) {
+		for (a = 0; a < R_ARRAY_SIZE (algos); a++) {
+			const int bit = algo_index (algos[a]);
+			ctx[bit] = r_hash_new (true, algos[a]);
+			r_hash_do_begin (ctx[bit], algos[a]);
+		}
+		HashSource src = { data, 0 };
+		mu_assert ("range", r_hash_calculate_range (ctx, algobit, source_read_at, &src, from, to, bsize, jobs[j]));
+		mu_assert_eq (src.reads, 4, "each block is read once");
+		for (a = 0; a < R_ARRAY_SIZE (algos); a++) {
+			const ut64 algo = algos[a];
+			RHash *got = ctx[algo_index (algo)];
+			r_hash_do_end (got, algo);
+			// the streaming digests cover the range, the others its last block
+			RHash *expect = r_hash_new (true, algo);
+			r_hash_do_begin (expect, algo);
+			if (algo & R_HASH_STREAMING) {
+				r_hash_calculate (expect, algo, data + from, to - from);
+			} else {
+				r_hash_calculate (expect, algo, data + from + 3 * bsize, 77);
+			}
+			r_hash_do_end (expect, algo);
+			char msg[64];
+			snprintf (msg, sizeof (msg), "%s with %d jobs", r_hash_name (algo), jobs[j]);
+			mu_assert (msg, !memcmp (got->digest, expect->digest, r_hash_size (algo)));
+			r_hash_free (expect);
+			r_hash_free (got);
+		}
+	}
+	mu_end;
+}
+
+bool test_r_hash_roll(void) {
+	const ut32 lens[] = { 1, 7, 64 };
+	ut8 data[512];
+	ut8 got[R_HASH_SIZE_SHA512], expect[R_HASH_SIZE_SHA512];
+	int i, l, rolled = 0;
+	ut32 off;
+	fill (data, sizeof (data));
+	mu_assert_null (r_hash_roll_new (R_HASH_MD5, 16), "md5 does not roll");
+	mu_assert_null (r_hash_roll_new (R_HASH_XXHASH, 16), "xxhash does not roll");
+	mu_assert_null (r_hash_roll_new (R_HASH_CRC32, 0), "empty window");
+	for (i = 0; i < R_HASH_NBITS; i++) {
+		const ut64 algo = 1ULL << i;
+		for (l = 0; l < R_ARRAY_SIZE (lens); l++) {
+			const ut32 len = lens[l];
+			RHashRoll *r = r_hash_roll_new (algo, len);
+			if (!r) {
+				continue;
+			}
+			RHash *ctx = r_hash_new (true, algo);
+			r_hash_roll_begin (r, data);
+			for (off = 0; off + len <= sizeof (data); off++) {
+				if (off) {
+					r_hash_roll_next (r, data[off - 1], data[off + len - 1]);
+				}
+				int size = r_hash_roll_digest (r, got);
+				mu_assert_eq (size, r_hash_calculate (ctx, algo, data + off, len), "digest size");
+				memcpy (expect, ctx->digest, size);
+				if (memcmp (got, expect, size)) {
+					char msg[64];
+					snprintf (msg, sizeof (msg), "%s window %u at %u", r_hash_name (algo), len, off);
+					mu_fail (msg);
+				}
+			}
+			r_hash_free (ctx);
+			r_hash_roll_free (r);
+			rolled++;
+		}
+	}
+	// adler32, fletcher16, xor and the CRCs, with each window length
+	mu_assert ("rollable algorithms", rolled >= 3 * 8);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test (test_r_hash_calculate_range);
+	mu_run_test (test_r_hash_roll);
+	return tests_passed != tests_run;
+}
+
+int main(int argc, char **argv) {
+	return all_tests();
+}
@@ -52,6 +52,33 @@ bool test_r_io_pcache (void) {
 	mu_end;
 }
 
+bool test_r_io_pcache_pages (void) {
+	RIO *io = r_io_new ();
+	ut8 buf[4];
+	const ut64 at = R_IO_DESC_CACHE_SIZE - 2;
+	int fd = r_io_fd_open (io, "malloc://0x2000", R_PERM_RW, 0);
+	RIODesc *desc = r_io_desc_get (io, fd);
+	io->p_cache = 3;
+	io->va = false;
+	r_io_use_fd (io, fd);
+	r_io_pwrite_at (io, at, (const ut8 *)"ABCD", 4);
+	mu_assert_eq (desc->cache->count, 2, "write should span two pages");
+	r_io_pread_at (io, at, buf, 4);
+	mu_assert_memeq (buf, (ut8 *)"ABCD", 4, "cached bytes should be read back");
+	RList *writes = r_io_desc_cache_list (desc);
+	mu_assert_eq (r_list_length (writes), 1, "runs across pages should be merged");
+	RIOCache *c = r_list_first (writes);
+	mu_assert_eq (r_itv_begin (c->itv), at, "run should start at the written address");
+	mu_assert_eq (r_itv_size (c->itv), 4, "run should have the written size");
+	r_list_free (writes);
+	r_io_desc_cache_commit (desc);
+	io->p_cache = 0;
+	r_io_pread_at (io, at, buf, 4);
+	mu_assert_memeq (buf, (ut8 *)"ABCD", 4, "committed bytes should be in the desc");
+	r_io_free (io);
+	mu_end;
+}
+
 bool test_r_io_desc_exchange (void) {
 	RIO *io = r_io_new ();
 	int fd = r_io_fd_open (io, "malloc://3", R_PERM_R, 0),
@@ -161,13 +188,72 @@ bool test_r_io_priority2(void) {
 	mu_end;
 }
 
+bool test_r_io_cache(void) {
+	RIO *io = r_io_new ();
+	ut8 buf[8];
+	io->va = true;
+	r_io_open_at (io, "malloc://8", R_PERM_RW, 0644, 0x0);
+	r_io_write_at (io, 0, (const ut8 *)"ABCDEFGH", 8);
+	io->cached = R_PERM_RW;
+	r_io_write_at (io, 1, (const ut8 *)"xx", 2);
+	r_io_write_at (io, 5, (const ut8 *)"yy", 2);
+	mu_assert ("cache should cover 0x1", r_io_cache_at (io, 1));
+	mu_assert ("cache should not cover 0x3", !r_io_cache_at (io, 3));
+	r_io_read_at (io, 0, buf, 8);
+	mu_assert_memeq (buf, (ut8 *)"AxxDEyyH", 8, "cached writes should be visible");
+	r_io_write_at (io, 2, (const ut8 *)"zzz", 3);
+	r_io_write_at (io, 3, (const ut8 *)"w", 1);
+	r_io_read_at (io, 0, buf, 8);
+	mu_assert_memeq (buf, (ut8 *)"AxzwzyyH", 8, "latest write should win");
+	mu_assert_notnull (io->cache, "cache should not be empty");
+	mu_assert ("writes should be coalesced in one extent", !io->cache->child[0] && !io->cache->child[1]);
+	RIOCache *c = container_of (io->cache, RIOCache, _rb);
+	mu_assert_eq (r_itv_begin (c->itv), 1, "extent should start at 0x1");
+	mu_assert_eq (r_itv_size (c->itv), 6, "extent should span 6 bytes");
+	mu_assert_memeq (c->odata, (ut8 *)"BCDEFG", 6, "original bytes should be kept");
+	r_io_cache_invalidate (io, 3, 5);
+	r_io_read_at (io, 0, buf, 8);
+	mu_assert_memeq (buf, (ut8 *)"AxzDEyyH", 8, "invalidated bytes should be restored");
+	mu_assert ("cache should not cover 0x4", !r_io_cache_at (io, 4));
+	r_io_cache_commit (io, 0, 8);
+	r_io_cache_reset (io, 0);
+	r_io_read_at (io, 0, buf, 8);
+	mu_assert_memeq (buf, (ut8 *)"AxzDEyyH", 8, "committed bytes should be written");
+	r_io_free (io);
+	mu_end;
+}
+
+bool test_r_io_rev(void) {
+	RIO *io = r_io_new ();
+	ut8 buf[4];
+	io->va = true;
+	RIODesc *desc = r_io_open_at (io, "malloc://8", R_PERM_RW, 0644, 0x0);
+	ut32 rev = io->rev;
+	r_io_read_at (io, 0, buf, 4);
+	mu_assert_eq (io->rev, rev, "reads should not change the revision");
+	r_io_write_at (io, 0, (const ut8 *)"AB", 2);
+	mu_assert ("writes should bump the revision", io->rev != rev);
+	rev = io->rev;
+	io->cached = R_PERM_RW;
+	r_io_write_at (io, 2, (const ut8 *)"C", 1);
+	mu_assert ("cached writes should bump the revision", io->rev != rev);
+	rev = io->rev;
+	r_io_map_add (io, desc->fd, R_PERM_R, 0, 0x100, 8);
+	mu_assert ("map changes should bump the revision", io->rev != rev);
+	r_io_free (io);
+	mu_end;
+}
+
 int all_tests() {
 	mu_run_test(test_r_io_mapsplit);
 	mu_run_test(test_r_io_mapsplit2);
 	mu_run_test(test_r_io_pcache);
+	mu_run_test(test_r_io_pcache_pages);
 	mu_run_test(test_r_io_desc_exchange);
 	mu_run_test(test_r_io_priority);
 	mu_run_test(test_r_io_priority2);
+	mu_run_test(test_r_io_cache);
+	mu_run_test(test_r_io_rev);
 	mu_run_test(test_va_malloc_zero);
 	return tests_passed != tests_run;
 }
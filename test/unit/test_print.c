@@ -0,0 +1,82 @@
+#include <r_util.h>
+#include <r_util/r_print.h>
+#include "minunit.h"
+
+static RStrBuf *out;
+
+static int out_printf(const char *fmt, ...) {
+	va_list ap;
+	va_start (ap, fmt);
+	r_strbuf_vappendf (out, fmt, ap);
+	va_end (ap);
+	return 0;
+}
+
+static char *hexdump(RPrint *p, const ut8 *buf, int len) {
+	r_strbuf_set (out, "");
+	r_print_hexdump (p, 0x8048000, buf, len, 16, 1, 1);
+	char *s = strdup (r_strbuf_get (out));
+	r_str_ansi_filter (s, NULL, NULL, -1);
+	return s;
+}
+
+bool test_r_print_hexdump(void) {
+	const int cols[] = { 16, 8, 5, 1 };
+	const int flags[] = {
+		0,
+		R_PRINT_FLAGS_OFFSET,
+		R_PRINT_FLAGS_OFFSET | R_PRINT_FLAGS_HEADER,
+		R_PRINT_FLAGS_OFFSET | R_PRINT_FLAGS_COLOR,
+		R_PRINT_FLAGS_OFFSET | R_PRINT_FLAGS_COMPACT,
+		R_PRINT_FLAGS_OFFSET | R_PRINT_FLAGS_NONASCII,
+		R_PRINT_FLAGS_COLOR | R_PRINT_FLAGS_COMPACT,
+	};
+	ut8 buf[300];
+	int c, f, i, pairs, wide;
+	for (i = 0; i < sizeof (buf); i++) {
+		buf[i] = (i * 7) & 0xff;
+	}
+	out = r_strbuf_new (NULL);
+	RPrint *p = r_print_new ();
+	p->cb_printf = out_printf;
+	for (c = 0; c < R_ARRAY_SIZE (cols); c++) {
+		for (f = 0; f < R_ARRAY_SIZE (flags); f++) {
+			for (i = 0; i < 4; i++) {
+				pairs = i & 1;
+				wide = i & 2;
+				p->cols = cols[c];
+				p->flags = flags[f];
+				p->pairs = pairs;
+				p->wide_offsets = wide;
+				p->stride = 0;
+				char *fast = hexdump (p, buf, sizeof (buf) - cols[c] / 2);
+				// a stride of one row takes the generic path and prints the same rows
+				p->stride = cols[c];
+				char *slow = hexdump (p, buf, sizeof (buf) - cols[c] / 2);
+				char msg[128];
+				snprintf (msg, sizeof (msg), "cols %d flags 0x%x pairs %d wide %d", cols[c], flags[f], pairs, wide);
+				mu_assert (msg, !strcmp (fast, slow));
+				free (fast);
+				free (slow);
+			}
+		}
+	}
+	p->cols = 16;
+	p->flags = 0;
+	p->stride = 0;
+	char *s = hexdump (p, (const ut8 *)"hello", 5);
+	mu_assert_streq (s, " 6865 6c6c 6f                             hello\n", "no offset column");
+	free (s);
+	r_print_free (p);
+	r_strbuf_free (out);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test (test_r_print_hexdump);
+	return tests_passed != tests_run;
+}
+
+int main(int argc, char **argv) {
+	return all_tests();
+}
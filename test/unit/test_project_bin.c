@@ -0,0 +1,116 @@
+#include <r_core.h>
+#include "minunit.h"
+
+static RCore *project_core(void) {
+	RCore *core = r_core_new ();
+	// blocks are added as they are, without analyzing the code
+	r_core_cmd0 (core, "e asm.arch=null;e anal.arch=null");
+	// xrefs are only set between mapped addresses
+	r_io_open_at (core->io, "malloc://0x10000", R_PERM_RW, 0644, 0);
+	return core;
+}
+
+static void project_fill(RCore *core) {
+	RAnal *anal = core->anal;
+	r_flag_space_set (core->flags, "symbols");
+	RFlagItem *fi = r_flag_set (core->flags, "sym.main", 0x1000, 0x20);
+	r_flag_item_set_realname (fi, "main");
+	r_flag_item_set_color (fi, "red");
+	r_flag_item_set_comment (fi, "entry point");
+	r_flag_item_set_alias (fi, "0x1004");
+	r_flag_set (core->flags, "sym.helper", 0x2000, 0x10);
+	r_flag_space_set (core->flags, "strings");
+	r_flag_set (core->flags, "str.hello", 0x3000, 6);
+	r_flag_space_set (core->flags, NULL);
+	r_flag_set (core->flags, "nospace", 0x3100, 1);
+
+	RAnalFunction *fcn = r_anal_create_function (anal, "sym.main", 0x1000, R_ANAL_FCN_TYPE_SYM, NULL);
+	fcn->bits = 32;
+	fcn->maxstack = 0x20;
+	r_anal_fcn_add_bb (anal, fcn, 0x1000, 0x10, 0x1010, 0x1018, NULL);
+	r_anal_fcn_add_bb (anal, fcn, 0x1010, 0x8, UT64_MAX, UT64_MAX, NULL);
+	r_anal_fcn_add_bb (anal, fcn, 0x1018, 0x8, 0x1010, UT64_MAX, NULL);
+	fcn = r_anal_create_function (anal, "fcn.helper", 0x2000, R_ANAL_FCN_TYPE_FCN, NULL);
+	r_anal_fcn_add_bb (anal, fcn, 0x2000, 0x10, UT64_MAX, UT64_MAX, NULL);
+
+	r_anal_xrefs_set (anal, 0x1004, 0x2000, R_ANAL_REF_TYPE_CALL);
+	r_anal_xrefs_set (anal, 0x1008, 0x3000, R_ANAL_REF_TYPE_DATA);
+	r_anal_xrefs_set (anal, 0x1018, 0x1010, R_ANAL_REF_TYPE_CODE);
+
+	// the first item listed at an address is the one shown there
+	r_meta_add (anal, R_META_TYPE_STRING, 0x3000, 0x3006, "hello");
+	r_meta_add (anal, R_META_TYPE_DATA, 0x3000, 0x3004, NULL);
+	r_meta_add (anal, R_META_TYPE_DATA, 0x3100, 0x3104, NULL);
+	r_meta_add (anal, R_META_TYPE_STRING, 0x3100, 0x3102, "a");
+	// adding the data item again lists it last, its place in the tree stays
+	r_meta_add (anal, R_META_TYPE_DATA, 0x3100, 0x3108, NULL);
+	r_meta_set_string (anal, R_META_TYPE_COMMENT, 0x1000, "main comment");
+
+	r_anal_hint_set_bits (anal, 0x2000, 16);
+	r_anal_hint_set_arch (anal, 0x2000, "arm");
+	r_anal_hint_set_immbase (anal, 0x1004, 10);
+	r_anal_hint_set_jump (anal, 0x1008, 0x2000);
+	r_anal_hint_set_esil (anal, 0x1008, "1,eax,=");
+	r_anal_hint_set_opcode (anal, 0x100c, "nop");
+
+	sdb_set (anal->sdb_types, "int", "type", 0);
+	sdb_set (anal->sdb_types, "type.int", "d", 0);
+	sdb_set (anal->sdb_types, "type.int.size", "32", 0);
+	sdb_set (anal->sdb_types, "point", "struct", 0);
+	sdb_set (anal->sdb_types, "struct.point", "x,y", 0);
+	sdb_set (anal->sdb_types, "struct.point.x", "int,0,0", 0);
+	sdb_set (anal->sdb_types, "struct.point.y", "int,4,0", 0);
+}
+
+static bool same_cmd(RCore *a, RCore *b, const char *cmd) {
+	char *sa = r_core_cmd_str (a, cmd);
+	char *sb = r_core_cmd_str (b, cmd);
+	bool ret = sa && sb && *sa && !strcmp (sa, sb);
+	if (!ret) {
+		eprintf ("%s\n--- saved\n%s--- loaded\n%s", cmd, sa, sb);
+	}
+	free (sa);
+	free (sb);
+	return ret;
+}
+
+bool test_project_bin_roundtrip(void) {
+	RCore *core = project_core ();
+	project_fill (core);
+	char *file = r_file_temp ("prjbin");
+	mu_assert ("save", r_core_project_save_bin (core, file, R_CORE_PRJ_BIN));
+
+	RCore *loaded = project_core ();
+	mu_assert ("load", r_core_project_load_bin (loaded, file, R_CORE_PRJ_BIN));
+	mu_assert ("flags", same_cmd (core, loaded, "fs*;f*"));
+	mu_assert ("flag items", same_cmd (core, loaded, "fj"));
+	mu_assert ("functions", same_cmd (core, loaded, "aflj"));
+	mu_assert ("blocks", same_cmd (core, loaded, "afbj@0x1000"));
+	mu_assert ("xrefs", same_cmd (core, loaded, "ax*"));
+	mu_assert ("meta", same_cmd (core, loaded, "C*"));
+	mu_assert ("hints", same_cmd (core, loaded, "ah*"));
+	mu_assert ("types", same_cmd (core, loaded, "ts*"));
+
+	RFlagItem *fi = r_flag_get (loaded->flags, "sym.main");
+	mu_assert_notnull (fi, "flag");
+	mu_assert_streq (fi->realname, "main", "realname");
+	mu_assert_streq (fi->alias, "0x1004", "alias");
+	mu_assert_eq (r_meta_get_at (loaded->anal, 0x3000, R_META_TYPE_ANY)->type, R_META_TYPE_STRING, "meta order");
+	mu_assert_eq (r_meta_get_at (loaded->anal, 0x3100, R_META_TYPE_ANY)->type, R_META_TYPE_STRING, "meta order");
+	mu_assert_streq (r_meta_get_string (loaded->anal, R_META_TYPE_COMMENT, 0x1000), "main comment", "comment");
+
+	r_file_rm (file);
+	free (file);
+	r_core_free (loaded);
+	r_core_free (core);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test (test_project_bin_roundtrip);
+	return tests_passed != tests_run;
+}
+
+int main(int argc, char **argv) {
+	return all_tests();
+}
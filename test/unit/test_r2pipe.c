@@ -0,0 +1,91 @@
+#include <r_util.h>
+#include <r_socket.h>
+#include "minunit.h"
+
+static int cmd[2], rsp[2];
+
+static R2Pipe *r2pipe_open_fake(const char *data, int len, bool framed) {
+	if (pipe (cmd) || pipe (rsp)) {
+		return NULL;
+	}
+	write (rsp[1], data, len);
+	close (rsp[1]);
+	char *s = r_str_newf ("%d", rsp[0]);
+	r_sys_setenv ("R2PIPE_IN", s);
+	free (s);
+	s = r_str_newf ("%d", cmd[1]);
+	r_sys_setenv ("R2PIPE_OUT", s);
+	free (s);
+	r_sys_setenv ("R2PIPE_FRAMED", framed? "1": NULL);
+	return r2pipe_open (NULL);
+}
+
+bool test_r2pipe_read(void) {
+	const int big = 40000;
+	char *data = malloc (big + 32);
+	memcpy (data, "hello", 6);
+	memset (data + 6, 'A', big);
+	memcpy (data + 6 + big, "\0tail", 5);
+	R2Pipe *r2p = r2pipe_open_fake (data, big + 11, false);
+	mu_assert_notnull (r2p, "r2pipe opened");
+	mu_assert ("not framed", !r2p->framed);
+
+	int len = -1;
+	const char *res = r2pipe_cmd_buf (r2p, "?e hello", &len);
+	mu_assert_streq (res, "hello", "first response");
+	mu_assert_eq (len, 5, "first response length");
+	char cmdbuf[32] = {0};
+	mu_assert_eq (read (cmd[0], cmdbuf, sizeof (cmdbuf)), 10, "command written");
+	mu_assert_memeq ((ut8 *)cmdbuf, (ut8 *)"?e hello\n", 10, "command and terminator");
+
+	char *s = r2pipe_read (r2p);
+	mu_assert_eq (strlen (s), big, "response bigger than a read");
+	mu_assert ("big response", !memcmp (s, data + 6, big));
+	free (s);
+
+	res = r2pipe_read_buf (r2p, &len);
+	mu_assert_streq (res, "tail", "unterminated response at eof");
+	mu_assert_eq (len, 4, "tail length");
+	res = r2pipe_read_buf (r2p, &len);
+	mu_assert_streq (res, "", "nothing left");
+	r2pipe_close (r2p);
+	close (cmd[0]);
+	free (data);
+	mu_end;
+}
+
+bool test_r2pipe_framed(void) {
+	const ut8 data[] = "ok\0" "\x05\0\0\0" "hello" "\x03\0\0\0" "a\0b" "\0\0\0\0";
+	R2Pipe *r2p = r2pipe_open_fake ((const char *)data, sizeof (data) - 1, true);
+	mu_assert_notnull (r2p, "r2pipe opened");
+	mu_assert ("framed", r2p->framed);
+	char cmdbuf[32] = {0};
+	const int hello_len = strlen (R2PIPE_FRAMED_HELLO) + 2;
+	mu_assert_eq (read (cmd[0], cmdbuf, sizeof (cmdbuf)), hello_len, "hello sent");
+	mu_assert_streq (cmdbuf, R2PIPE_FRAMED_HELLO "\n", "hello");
+
+	int len = -1;
+	const char *res = r2pipe_read_buf (r2p, &len);
+	mu_assert_streq (res, "hello", "first frame");
+	mu_assert_eq (len, 5, "first frame length");
+	res = r2pipe_read_buf (r2p, &len);
+	mu_assert_eq (len, 3, "frame length covers the NUL");
+	mu_assert_memeq ((ut8 *)res, (ut8 *)"a\0b", 4, "second frame");
+	res = r2pipe_read_buf (r2p, &len);
+	mu_assert_eq (len, 0, "empty frame");
+	mu_assert_streq (res, "", "empty frame");
+	r2pipe_close (r2p);
+	close (cmd[0]);
+	r_sys_setenv ("R2PIPE_FRAMED", NULL);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test (test_r2pipe_read);
+	mu_run_test (test_r2pipe_framed);
+	return tests_passed != tests_run;
+}
+
+int main(int argc, char **argv) {
+	return all_tests();
+}
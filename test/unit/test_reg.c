@@ -138,11 +138,32 @@ bool test_r_reg_get_value_flag(void) {
 	mu_end;
 }
 
+bool test_r_reg_rev(void) {
+	RReg *reg = r_reg_new ();
+	mu_assert_notnull (reg, "r_reg_new () failed");
+
+	ut32 rev = reg->rev;
+	r_reg_set_profile_string (reg, "gpr eax .32 0 0");
+	mu_assert ("profile change bumps rev", reg->rev != rev);
+	RRegItem *item = r_reg_get (reg, "eax", -1);
+	mu_assert_notnull (item, "eax is defined");
+
+	rev = reg->rev;
+	r_reg_setv (reg, "eax", 1);
+	mu_assert_eq (reg->rev, rev, "value changes keep rev");
+	r_reg_set_name (reg, R_REG_NAME_PC, "eax");
+	mu_assert ("alias change bumps rev", reg->rev != rev);
+
+	r_reg_free (reg);
+	mu_end;
+}
+
 int all_tests() {
 	mu_run_test (test_r_reg_set_name);
 	mu_run_test (test_r_reg_set_profile_string);
 	mu_run_test (test_r_reg_get_value_gpr);
 	mu_run_test (test_r_reg_get_value_flag);
+	mu_run_test (test_r_reg_rev);
 	return tests_passed != tests_run;
 }
 
@@ -0,0 +1,217 @@
+#include <r_search.h>
+#include "minunit.h"
+
+static int hitcb(RSearchKeyword *kw, void *user, ut64 addr) {
+	r_strbuf_appendf (user, "%d@%"PFMT64d" ", kw->kwidx, addr);
+	return 1;
+}
+
+static RSearch *search_new(RStrBuf *sb, const char **kws) {
+	RSearch *s = r_search_new (R_SEARCH_KEYWORD);
+	// like search.contiguous, on by default
+	s->contiguous = true;
+	for (; *kws; kws++) {
+		r_search_kw_add (s, r_search_keyword_new_str (*kws, NULL, NULL, 0));
+	}
+	r_search_set_callback (s, hitcb, sb);
+	return s;
+}
+
+/* feeds data to the search in blocks of bs bytes, from the end if the search is backwards */
+static const char *search_blocks(RSearch *s, RStrBuf *sb, const char *data, int bs) {
+	const int len = strlen (data);
+	int i, n;
+	r_strbuf_set (sb, "");
+	s->nhits = 0;
+	r_search_begin (s);
+	for (i = 0; i < len; i += n) {
+		n = R_MIN (bs, len - i);
+		ut8 *block = r_mem_dup (s->bckwrds? data + len - i - n: data + i, n);
+		int r = r_search_update (s, s->bckwrds? len - i: i, block, n);
+		free (block);
+		if (r == -1 || (s->maxhits && s->nhits >= s->maxhits)) {
+			break;
+		}
+	}
+	return r_strbuf_get (sb);
+}
+
+bool test_r_search_keywords(void) {
+	RStrBuf *sb = r_strbuf_new (NULL);
+	const char *kws[] = { "abc", "def", "bcd", NULL };
+	RSearch *s = search_new (sb, kws);
+	const char *data = "abcdef..def.abc";
+	// the hits of a block are reported keyword by keyword
+	mu_assert_streq (search_blocks (s, sb, data, 64), "0@0 0@12 1@3 1@8 2@1 ", "one block");
+	mu_assert_streq (search_blocks (s, sb, data, 4), "0@0 2@1 1@3 1@8 0@12 ", "small blocks");
+	mu_assert_streq (search_blocks (s, sb, data, 1), "0@0 2@1 1@3 1@8 0@12 ", "one byte blocks");
+	r_search_free (s);
+	r_strbuf_free (sb);
+	mu_end;
+}
+
+bool test_r_search_binmask(void) {
+	RStrBuf *sb = r_strbuf_new (NULL);
+	RSearch *s = r_search_new (R_SEARCH_KEYWORD);
+	// the mask ignores the case of the second byte, a nibble mask the low half of the first
+	r_search_kw_add (s, r_search_keyword_new ((const ut8 *)"AB", 2, (const ut8 *)"\xff\xdf", 2, NULL));
+	r_search_kw_add (s, r_search_keyword_new_hexmask ("3.7a", NULL));
+	r_search_kw_add (s, r_search_keyword_new_str ("xZ", NULL, NULL, 1));
+	r_search_set_callback (s, hitcb, sb);
+	mu_assert_streq (search_blocks (s, sb, "AbaBAB5zXz1zxz", 3), "0@0 0@4 1@6 1@10 2@8 2@12 ", "masked hits");
+	r_search_free (s);
+	r_strbuf_free (sb);
+	mu_end;
+}
+
+bool test_r_search_overlap(void) {
+	RStrBuf *sb = r_strbuf_new (NULL);
+	const char *kws[] = { "aa", "aaa", NULL };
+	RSearch *s = search_new (sb, kws);
+	const char *data = "aaaaa.aa";
+	mu_assert_streq (search_blocks (s, sb, data, 3), "0@0 1@0 0@2 0@6 ", "no overlap");
+	s->overlap = true;
+	mu_assert_streq (search_blocks (s, sb, data, 3), "0@0 0@1 1@0 0@2 0@3 1@1 1@2 0@6 ", "overlap, once at the block ends");
+	r_search_free (s);
+	r_strbuf_free (sb);
+	mu_end;
+}
+
+bool test_r_search_leftover(void) {
+	RStrBuf *sb = r_strbuf_new (NULL);
+	const char *kws[] = { "abcdef", "fab", "b", NULL };
+	RSearch *s = search_new (sb, kws);
+	const char *data = "..abcdefab..";
+	int bs;
+	// keywords across the blocks are found in the leftover of the previous one
+	for (bs = 1; bs < 7; bs++) {
+		search_blocks (s, sb, data, bs);
+		mu_assert_notnull (strstr (r_strbuf_get (sb), "0@2 "), "whole keyword");
+		mu_assert_notnull (strstr (r_strbuf_get (sb), "1@7 "), "keyword after it");
+		mu_assert_eq (s->nhits, 4, "hits");
+	}
+	mu_assert_streq (search_blocks (s, sb, data, 5), "2@3 0@2 1@7 2@9 ", "block by block");
+	// a gap between the blocks drops the leftover
+	r_strbuf_set (sb, "");
+	s->nhits = 0;
+	r_search_begin (s);
+	r_search_update (s, 0, (ut8 *)"..abc", 5);
+	r_search_update (s, 100, (ut8 *)"def..", 5);
+	mu_assert_streq (r_strbuf_get (sb), "2@3 ", "not contiguous");
+	r_search_free (s);
+	r_strbuf_free (sb);
+	mu_end;
+}
+
+bool test_r_search_backwards(void) {
+	RStrBuf *sb = r_strbuf_new (NULL);
+	const char *kws[] = { "abc", "cab", NULL };
+	RSearch *s = search_new (sb, kws);
+	s->bckwrds = true;
+	r_search_string_prepare_backward (s);
+	const char *data = "abcab..abc";
+	// the blocks and the hits go from the end
+	mu_assert_streq (search_blocks (s, sb, data, 64), "0@7 0@0 1@2 ", "one block");
+	mu_assert_streq (search_blocks (s, sb, data, 3), "0@7 1@2 0@0 ", "small blocks");
+	r_search_free (s);
+	r_strbuf_free (sb);
+	mu_end;
+}
+
+bool test_r_search_maxhits(void) {
+	RStrBuf *sb = r_strbuf_new (NULL);
+	const char *kws[] = { "abc", "def", NULL };
+	RSearch *s = search_new (sb, kws);
+	const char *data = "def.abc.def.abc";
+	s->maxhits = 3;
+	// the first keyword takes the hits of the block before the second one
+	mu_assert_streq (search_blocks (s, sb, data, 64), "0@4 0@12 1@0 ", "one block");
+	mu_assert_streq (search_blocks (s, sb, data, 8), "0@4 1@0 0@12 ", "two blocks");
+	mu_assert_eq (s->nhits, 3, "stopped");
+	r_search_free (s);
+	r_strbuf_free (sb);
+	mu_end;
+}
+
+static RSearch *regexp_new(RStrBuf *sb, const char **res) {
+	RSearch *s = r_search_new (R_SEARCH_REGEXP);
+	s->contiguous = true;
+	for (; *res; res++) {
+		r_search_kw_add (s, r_search_keyword_new_regexp (*res, NULL));
+	}
+	r_search_set_callback (s, hitcb, sb);
+	return s;
+}
+
+bool test_r_search_regexp_blocks(void) {
+	RStrBuf *sb = r_strbuf_new (NULL);
+	const char *res[] = { "/ab+c/", "/x[0-9]+y/", NULL };
+	RSearch *s = regexp_new (sb, res);
+	const char *data = "..abbbbbbc...abc.x1234y..x5y.";
+	const char *expect = "0@2 0@13 1@17 1@25 ";
+	int bs;
+	mu_assert_streq (search_blocks (s, sb, data, 64), expect, "one block");
+	// the matches crossing a block end are found once, with the next block
+	for (bs = 1; bs < 9; bs++) {
+		char msg[32];
+		snprintf (msg, sizeof (msg), "blocks of %d", bs);
+		mu_assert_streq (search_blocks (s, sb, data, bs), expect, msg);
+	}
+	// a gap between the blocks drops the window
+	r_strbuf_set (sb, "");
+	r_search_begin (s);
+	r_search_update (s, 0, (ut8 *)"..abb", 5);
+	r_search_update (s, 100, (ut8 *)"bc.abc", 6);
+	mu_assert_streq (r_strbuf_get (sb), "0@103 ", "not contiguous");
+	r_search_free (s);
+	r_strbuf_free (sb);
+	mu_end;
+}
+
+bool test_r_search_regexp_cache(void) {
+	RStrBuf *sb = r_strbuf_new (NULL);
+	const char *res[] = { "/ab+c/", NULL };
+	RSearch *s = regexp_new (sb, res);
+	const char *data = "abc.xyz.abbc";
+	RSearchKeyword *kw = r_list_first (s->kws);
+	mu_assert_streq (search_blocks (s, sb, data, 5), "0@0 0@8 ", "first search");
+	RRegex *re = kw->regex;
+	mu_assert_notnull (re, "compiled on the first block");
+	mu_assert_streq (search_blocks (s, sb, data, 5), "0@0 0@8 ", "second search");
+	mu_assert_ptreq (kw->regex, re, "compiled once");
+
+	// a new keyword is compiled, the old one is kept
+	r_search_kw_add (s, r_search_keyword_new_regexp ("/x.z/", NULL));
+	mu_assert_streq (search_blocks (s, sb, data, 5), "0@0 1@4 0@8 ", "keyword added");
+	mu_assert_ptreq (kw->regex, re, "kept");
+
+	// new keywords replace the old ones
+	r_search_kw_reset (s);
+	r_search_kw_add (s, r_search_keyword_new_regexp ("/b+c/i", NULL));
+	mu_assert_streq (search_blocks (s, sb, "ABC.xyz.abbc", 5), "2@1 2@9 ", "keywords replaced");
+
+	// the keyword search does not take over the regexp window
+	r_search_kw_reset (s);
+	r_search_reset (s, R_SEARCH_KEYWORD);
+	r_search_kw_add (s, r_search_keyword_new_str ("bbc", NULL, NULL, 0));
+	mu_assert_streq (search_blocks (s, sb, data, 5), "3@9 ", "keyword mode");
+	r_search_free (s);
+	r_strbuf_free (sb);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test (test_r_search_keywords);
+	mu_run_test (test_r_search_binmask);
+	mu_run_test (test_r_search_overlap);
+	mu_run_test (test_r_search_leftover);
+	mu_run_test (test_r_search_backwards);
+	mu_run_test (test_r_search_maxhits);
+	mu_run_test (test_r_search_regexp_blocks);
+	mu_run_test (test_r_search_regexp_cache);
+	return tests_passed != tests_run;
+}
+
+int main(int argc, char **argv) {
+	return all_tests();
+}
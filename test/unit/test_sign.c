@@ -0,0 +1,213 @@
+#include <r_anal.h>
+#include <r_sign.h>
+#include "minunit.h"
+
+static int hitcb(RSignItem *it, RAnalFunction *fcn, void *user) {
+	r_strbuf_appendf (user, "%s@0x%"PFMT64x" ", it->name, fcn->addr);
+	return 1;
+}
+
+static RAnalFunction *fcn_new(RAnal *anal, const char *name, ut64 addr, int nbbs) {
+	RAnalFunction *fcn = r_anal_create_function (anal, name, addr, 0, NULL);
+	int i;
+	for (i = 0; i < nbbs; i++) {
+		RAnalBlock *block = r_anal_create_block (anal, addr + i * 0x10, 0x10);
+		r_anal_function_add_block (fcn, block);
+		r_anal_block_unref (block);
+	}
+	return fcn;
+}
+
+bool test_r_sign_index(void) {
+	RAnal *anal = r_anal_new ();
+	RAnalFunction *fa = fcn_new (anal, "fa", 0x1000, 1);
+	RAnalFunction *fb = fcn_new (anal, "fb", 0x2000, 3);
+
+	RSignGraph graph = { .cc = r_anal_fcn_cc (anal, fb), .nbbs = 3, .edges = -1, .ebbs = -1, .bbsum = 0 };
+	r_sign_add_graph (anal, "z0", graph);
+	graph.cc = -1;
+	r_sign_add_graph (anal, "z1", graph);
+	graph.nbbs = -1;
+	r_sign_add_graph (anal, "z2", graph);
+	graph.nbbs = 1;
+	r_sign_add_graph (anal, "z3", graph);
+	graph.nbbs = 3;
+	graph.cc = 1234;
+	r_sign_add_graph (anal, "z4", graph);
+	r_sign_add_addr (anal, "z5", 0x2000);
+	r_sign_add_addr (anal, "z6", 0x1000);
+	r_sign_add_addr (anal, "z7", 0x2000);
+
+	RSignIndex *idx = r_sign_index_new (anal);
+	mu_assert_notnull (idx, "index");
+	RAnalFunction *fcns[] = { fa, fb };
+	int i;
+	for (i = 0; i < 2; i++) {
+		RStrBuf *expect = r_strbuf_new (NULL);
+		RStrBuf *got = r_strbuf_new (NULL);
+		r_sign_match_graph (anal, fcns[i], -1, hitcb, expect);
+		r_sign_match_addr (anal, fcns[i], hitcb, expect);
+		r_sign_index_match_graph (idx, fcns[i], -1, hitcb, got);
+		r_sign_index_match_addr (idx, fcns[i], hitcb, got);
+		mu_assert_streq (r_strbuf_get (got), r_strbuf_get (expect), "same hits in the same order");
+		if (i) {
+			mu_assert_notnull (strstr (r_strbuf_get (got), "z0@"), "all metrics");
+			mu_assert_notnull (strstr (r_strbuf_get (got), "z2@"), "no metrics");
+			mu_assert_null (strstr (r_strbuf_get (got), "z3@"), "other nbbs");
+			mu_assert_null (strstr (r_strbuf_get (got), "z4@"), "other cc");
+		}
+		r_strbuf_free (expect);
+		r_strbuf_free (got);
+	}
+	r_sign_index_free (idx);
+	r_anal_free (anal);
+	mu_end;
+}
+
+static RStrBuf *diff_out;
+
+static int diff_printf(const char *fmt, ...) {
+	va_list ap;
+	va_start (ap, fmt);
+	r_strbuf_vappendf (diff_out, fmt, ap);
+	va_end (ap);
+	return 0;
+}
+
+bool test_r_sign_diff(void) {
+	RAnal *anal = r_anal_new ();
+	anal->cb_printf = diff_printf;
+	const ut8 bytes[] = "\x55\x48\x89\xe5\x48\x83\xec\x10";
+	const ut8 mask[] = "\xff\xff\xff\xff\xff\xff\xff\x00";
+	RSignGraph graph = { .cc = 2, .nbbs = 3, .edges = 3, .ebbs = 1, .bbsum = 40 };
+	r_spaces_set (&anal->zign_spaces, "a");
+	r_sign_add_bytes (anal, "a.f", 8, bytes, mask);
+	r_sign_add_graph (anal, "a.f", graph);
+	r_sign_add_addr (anal, "a.f", 0x100);
+	r_spaces_set (&anal->zign_spaces, "b");
+	r_sign_add_bytes (anal, "b.f", 8, bytes, mask);
+	r_sign_add_addr (anal, "b.f", 0x200);
+	graph.bbsum = 44;
+	r_sign_add_bytes (anal, "b.g", 7, bytes, mask);
+	r_sign_add_graph (anal, "b.g", graph);
+	r_sign_add_addr (anal, "b.g", 0x300);
+	r_spaces_set (&anal->zign_spaces, "a");
+
+	RSignOptions *options = r_sign_options_new ("1.0", "1.0");
+	diff_out = r_strbuf_new (NULL);
+	mu_assert ("diff", r_sign_diff (anal, options, "b"));
+	mu_assert_streq (r_strbuf_get (diff_out), "0x00000100 0x00000200 1.00000 B a.f\n", "same bytes");
+
+	r_strbuf_set (diff_out, "");
+	options->bytes_diff_threshold = 0.8;
+	options->graph_diff_threshold = 0.9;
+	mu_assert ("diff", r_sign_diff (anal, options, "b"));
+	mu_assert_notnull (strstr (r_strbuf_get (diff_out), "0x00000100 0x00000300 0.87500 B a.f\n"), "close size");
+	mu_assert_notnull (strstr (r_strbuf_get (diff_out), "0x00000100 0x00000300 0.98182 G a.f\n"), "close graph");
+
+	r_strbuf_set (diff_out, "");
+	mu_assert ("diff by name", r_sign_diff_by_name (anal, options, "b", false));
+	mu_assert_streq (r_strbuf_get (diff_out), "0x00000100 0x00000200 1.00000 B a.f\n", "same name");
+	r_strbuf_free (diff_out);
+	r_sign_options_free (options);
+	r_anal_free (anal);
+	mu_end;
+}
+
+static void diff_zigns(RAnal *anal, const char *space, int n, ut32 seed) {
+	ut8 bytes[64], mask[64];
+	char name[32];
+	int i, j;
+	r_spaces_set (&anal->zign_spaces, space);
+	for (i = 0; i < n; i++) {
+		seed = seed * 1103515245 + 12345;
+		const ut32 r = seed >> 8;
+		// sizes up to 64, so no size ratio is within rounding of the threshold
+		const int size = 8 + r % 57;
+		for (j = 0; j < size; j++) {
+			bytes[j] = j;
+			mask[j] = 0xff;
+		}
+		bytes[0] = (r >> 8) % 3;
+		mask[size - 1] = 0;
+		RSignGraph graph = {
+			.cc = 1 + (r >> 10) % 4,
+			.nbbs = 2 + (r >> 12) % 6,
+			.edges = 3 + (r >> 15) % 6,
+			.ebbs = 1,
+			.bbsum = (r >> 18) % 8? 40 + (r >> 18) % 120: -2,
+		};
+		snprintf (name, sizeof (name), "%s.%s%03d", space, (i % 50 == 7)? "imp.": "f", i);
+		r_sign_add_bytes (anal, name, size, bytes, mask);
+		r_sign_add_graph (anal, name, graph);
+		r_sign_add_addr (anal, name, 0x1000 + i * 0x10);
+	}
+}
+
+static char *diff_run(RAnal *anal, RSignOptions *options, double bt, int jobs) {
+	r_strbuf_set (diff_out, "");
+	options->bytes_diff_threshold = bt;
+	options->jobs = jobs;
+	return r_sign_diff (anal, options, "b")? strdup (r_strbuf_get (diff_out)): NULL;
+}
+
+bool test_r_sign_diff_jobs(void) {
+	RAnal *anal = r_anal_new ();
+	anal->cb_printf = diff_printf;
+	diff_out = r_strbuf_new (NULL);
+	// enough zignatures for diffRun to start the jobs
+	diff_zigns (anal, "b", 300, 7);
+	diff_zigns (anal, "a", 200, 11);
+
+	RSignOptions *options = r_sign_options_new ("0.8", "0.9");
+	char *pruned = diff_run (anal, options, 0.8, 1);
+	char *parallel = diff_run (anal, options, 0.8, 3);
+	char *all = diff_run (anal, options, 0.0, 1);
+	mu_assert ("diffs", pruned && parallel && all);
+	mu_assert ("pairs found", strstr (pruned, " B ") && strstr (pruned, " G "));
+	mu_assert ("same lines with jobs", !strcmp (parallel, pruned));
+
+	// comparing every pair with no bytes threshold prints a B line for each
+	// pair, the ones below the threshold are left out
+	RStrBuf *filtered = r_strbuf_new (NULL);
+	RList *lines = r_str_split_list (all, "\n", 0);
+	RListIter *iter;
+	char *line;
+	int nb = 0;
+	r_list_foreach (lines, iter, line) {
+		double score;
+		if (!*line) {
+			continue;
+		}
+		if (strstr (line, " B ")) {
+			nb++;
+			if (sscanf (line, "%*s %*s %lf", &score) != 1 || score < 0.8) {
+				continue;
+			}
+		}
+		r_strbuf_appendf (filtered, "%s\n", line);
+	}
+	mu_assert_eq (nb, 196 * 294, "a B line for every pair but the imports");
+	mu_assert ("same lines as every pair", !strcmp (r_strbuf_get (filtered), pruned));
+
+	r_list_free (lines);
+	r_strbuf_free (filtered);
+	free (pruned);
+	free (parallel);
+	free (all);
+	r_strbuf_free (diff_out);
+	r_sign_options_free (options);
+	r_anal_free (anal);
+	mu_end;
+}
+
+int all_tests() {
+	mu_run_test (test_r_sign_index);
+	mu_run_test (test_r_sign_diff);
+	mu_run_test (test_r_sign_diff_jobs);
+	return tests_passed != tests_run;
+}
+
+int main(int argc, char **argv) {
+	return all_tests();
+}
@@ -160,6 +160,37 @@ bool test_join(void) {
 	mu_end;
 }
 
+bool test_finger(void) {
+	RSkipList *list = r_skiplist_new (NULL, (RListComparator)cmp_int);
+	RSkipListFinger fg;
+	RSkipListNode *it;
+	void *data;
+	int i, prev = -1;
+
+	for (i = 0; i < 100; i += 2) {
+		r_skiplist_insert (list, (void *)(intptr_t)i);
+	}
+	r_skiplist_finger_init (list, &fg);
+	for (i = 0; i < 150; i += 3) {
+		r_skiplist_finger_insert (list, &fg, (void *)(intptr_t)i);
+	}
+	mu_assert_eq (r_skiplist_length (list), 50 + 50 - 17, "no double elements with a finger");
+	r_skiplist_foreach (list, it, data) {
+		mu_assert ("elements are sorted", (int)(intptr_t)data > prev);
+		prev = (int)(intptr_t)data;
+	}
+	r_skiplist_finger_init (list, &fg);
+	it = r_skiplist_finger_find_geq (list, &fg, (void *)(intptr_t)5);
+	mu_assert_eq ((int)(intptr_t)it->data, 6, "6 is the first element >= 5");
+	it = r_skiplist_finger_find_geq (list, &fg, (void *)(intptr_t)100);
+	mu_assert_eq ((int)(intptr_t)it->data, 102, "102 is the first element >= 100");
+	it = r_skiplist_finger_find_geq (list, &fg, (void *)(intptr_t)148);
+	mu_assert_null (it, "no element >= 148");
+
+	r_skiplist_free (list);
+	mu_end;
+}
+
 int all_tests() {
 	mu_run_test(test_empty);
 	mu_run_test(test_oneelement);
@@ -168,6 +199,7 @@ int all_tests() {
 	mu_run_test(test_purge);
 	mu_run_test(test_delete);
 	mu_run_test(test_join);
+	mu_run_test(test_finger);
 	return tests_passed != tests_run;
 }
 